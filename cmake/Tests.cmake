@@ -19,3 +19,8 @@ function(BuildTests ExecutableName PathInTestFolder)
 
     gtest_discover_tests(${ExecutableName})
 endfunction()
+
+function(BuildBenchmark ExecutableName Path)
+    add_executable(${ExecutableName} ${CMAKE_CURRENT_SOURCE_DIR}/tests/${Path})
+    target_link_libraries(${ExecutableName} PRIVATE ${ARGN} benchmark::benchmark_main)
+endfunction()
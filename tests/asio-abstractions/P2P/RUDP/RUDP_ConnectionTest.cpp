@@ -0,0 +1,192 @@
+#include <gtest/gtest.h>
+#include <Client.h>
+
+#include <thread>
+#include <future>
+#include <chrono>
+
+#include <fstream>
+
+static std::vector<std::future<void>> leaked_futures;
+
+static void RunWithTimeout(std::function<void()> test) {
+    auto future = std::async(std::launch::async, std::move(test));
+
+    if (future.wait_for(std::chrono::seconds(3)) == std::future_status::timeout) {
+        leaked_futures.emplace_back(std::move(future));
+        FAIL() << "Test timed out!";
+    } else {
+        try {
+            future.get();
+        } catch (const std::exception& e) {
+            FAIL() << "Test failed with an exception: " << e.what();
+        }
+    }
+}
+
+static std::string ReadFile(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+
+static void WriteFile(const std::filesystem::path& path, const std::string& data) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(data.data(), static_cast<std::streamsize>(data.size()));
+}
+
+TEST(RUDP_Test, MessagesAndFileOverLossyLink) {
+    std::string data(256 * 1024, '\0');
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = static_cast<char>(i * 13);
+    }
+
+    std::filesystem::remove("rudp_test.bin");
+    std::filesystem::remove("rudp_test_result.bin");
+    WriteFile("rudp_test.bin", data);
+
+    RunWithTimeout([&data] {
+        IOContext context;
+        auto workGuard = asio::make_work_guard(context);
+        std::thread contextThread([&context]() { context.run(); });
+
+        moodycamel::ConcurrentQueue<std::unique_ptr<PackageIn<P2P::MessageType>>> serverQueue;
+        moodycamel::ConcurrentQueue<std::unique_ptr<PackageIn<P2P::MessageType>>> clientQueue;
+
+        const auto server = ReliableUDPConnection<P2P::MessageType>::Create(context, serverQueue);
+        const auto client = ReliableUDPConnection<P2P::MessageType>::Create(context, clientQueue);
+
+        const DatagramImpairment impairment{0.05, std::chrono::milliseconds(2), std::chrono::milliseconds(1)};
+        server->SetImpairment(impairment);
+        client->SetImpairment(impairment);
+
+        std::atomic<bool> ready{false};
+        server->Seek(asio::ip::make_address("127.0.0.1"), {0, 0}, [&ready]() { ready.store(true); }, []() {});
+
+        while (!ready.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        client->Start(server->GetAddress(), server->GetPorts(), []() {});
+
+        while (client->GetConnectionState() != ConnectionState::CONNECTED || server->GetConnectionState() != ConnectionState::CONNECTED) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        std::promise<bool> fileResult;
+        client->RequestFileRange("rudp_test.bin", "rudp_test_result.bin", 0, 0, FILE_TRANSFER_DEFAULT_WEIGHT, [&fileResult](const bool succeeded) {
+            fileResult.set_value(succeeded);
+        });
+
+        constexpr uint32_t messageCount = 200;
+        for (uint32_t i = 0; i < messageCount; i++) {
+            client->Send(Package<P2P::MessageType>::CreateUnique(P2P::MessageType::message, uint32_t{i}));
+        }
+
+        std::vector<uint32_t> received;
+        while (received.size() < messageCount) {
+            if (std::unique_ptr<PackageIn<P2P::MessageType>> package; serverQueue.try_dequeue(package)) {
+                uint32_t value;
+                package->package->GetValue(value);
+                received.push_back(value);
+            } else {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+
+        const bool fileSucceeded = fileResult.get_future().get();
+        const ReliableTransportStats stats = server->GetTransportStats();
+
+        client->Disconnect();
+        server->Disconnect();
+
+        workGuard.reset();
+        context.stop();
+        contextThread.join();
+
+        for (uint32_t i = 0; i < messageCount; i++) {
+            ASSERT_EQ(received[i], i);
+        }
+
+        ASSERT_TRUE(fileSucceeded);
+        ASSERT_EQ(ReadFile("rudp_test_result.bin"), data);
+        ASSERT_GT(stats.packetsSent, 0);
+        ASSERT_GT(stats.packetsLost, 0);
+    });
+}
+
+TEST(RUDP_Test, CongestionControllerReactsOncePerLossEvent) {
+    using Clock = CongestionController::Clock;
+    const Clock::time_point start = Clock::now();
+
+    for (const CongestionControlAlgorithm algorithm : {CongestionControlAlgorithm::NEW_RENO, CongestionControlAlgorithm::CUBIC}) {
+        const std::unique_ptr<CongestionController> controller = CongestionController::Create(algorithm);
+        ASSERT_EQ(controller->GetAlgorithm(), algorithm);
+        ASSERT_EQ(controller->GetCongestionWindow(), CONGESTION_INITIAL_WINDOW);
+
+        controller->OnPacketAcked(CONGESTION_MAX_DATAGRAM_SIZE, start, start + std::chrono::milliseconds(10));
+        ASSERT_EQ(controller->GetCongestionWindow(), CONGESTION_INITIAL_WINDOW + CONGESTION_MAX_DATAGRAM_SIZE);
+
+        controller->OnPacketLost(start + std::chrono::milliseconds(1), start + std::chrono::milliseconds(20));
+        const size_t reduced = controller->GetCongestionWindow();
+        ASSERT_LT(reduced, CONGESTION_INITIAL_WINDOW + CONGESTION_MAX_DATAGRAM_SIZE);
+
+        controller->OnPacketLost(start + std::chrono::milliseconds(2), start + std::chrono::milliseconds(21));
+        ASSERT_EQ(controller->GetCongestionWindow(), reduced);
+
+        controller->OnRetransmissionTimeout();
+        ASSERT_EQ(controller->GetCongestionWindow(), CONGESTION_MIN_WINDOW);
+    }
+}
+
+TEST(RUDP_Test, TransfersMoreThanWindowToStalledReader) {
+    RunWithTimeout([] {
+        IOContext context;
+
+        const auto server = std::make_shared<ReliableDatagramTransport>(context.get_executor());
+        const auto client = std::make_shared<ReliableDatagramTransport>(context.get_executor());
+
+        const uint16_t port = server->Bind(UDPEndpoint(asio::ip::make_address("127.0.0.1"), 0));
+
+        std::vector<char> sent(2 * RELIABLE_STREAM_WINDOW + 12345);
+        for (size_t i = 0; i < sent.size(); i++) {
+            sent[i] = static_cast<char>(i * 31 + i / 4096);
+        }
+
+        std::vector<char> received(sent.size());
+        bool sendSucceeded = false;
+        bool receiveSucceeded = false;
+
+        asio::co_spawn(context, [&]() -> asio::awaitable<void> {
+            co_await server->Accept();
+
+            // The reader stalls until the sender has filled the whole window, so the transfer depends on window updates
+            asio::steady_timer timer(context, std::chrono::milliseconds(200));
+            co_await timer.async_wait(asio::use_awaitable);
+
+            // The window update for the first read is dropped, leaving a blocked sender with nothing in flight to elicit another
+            server->SetImpairment({1.0, std::chrono::microseconds(0), std::chrono::microseconds(0)});
+            const size_t first = co_await server->GetStream(MultiplexedStream::FILE).async_read_some(asio::buffer(received), asio::use_awaitable);
+
+            timer.expires_after(std::chrono::milliseconds(50));
+            co_await timer.async_wait(asio::use_awaitable);
+            server->SetImpairment({});
+
+            co_await asio::async_read(server->GetStream(MultiplexedStream::FILE), asio::buffer(received.data() + first, received.size() - first), asio::use_awaitable);
+            receiveSucceeded = true;
+            server->Close();
+            client->Close();
+        }, asio::detached);
+
+        asio::co_spawn(context, [&]() -> asio::awaitable<void> {
+            co_await client->Connect(UDPEndpoint(asio::ip::make_address("127.0.0.1"), port));
+            co_await asio::async_write(client->GetStream(MultiplexedStream::FILE), asio::buffer(sent), asio::use_awaitable);
+            sendSucceeded = true;
+        }, asio::detached);
+
+        context.run();
+
+        ASSERT_TRUE(sendSucceeded);
+        ASSERT_TRUE(receiveSucceeded);
+        ASSERT_TRUE(sent == received);
+    });
+}
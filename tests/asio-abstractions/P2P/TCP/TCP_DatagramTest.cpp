@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+#include <Client.h>
+
+#include <thread>
+#include <future>
+#include <chrono>
+
+static std::vector<std::future<void>> leaked_futures;
+
+static void RunWithTimeout(std::function<void()> test) {
+    auto future = std::async(std::launch::async, std::move(test));
+
+    if (future.wait_for(std::chrono::seconds(3)) == std::future_status::timeout) {
+        leaked_futures.emplace_back(std::move(future));
+        FAIL() << "Test timed out!";
+    } else {
+        try {
+            future.get();
+        } catch (const std::exception& e) {
+            FAIL() << "Test failed with an exception: " << e.what();
+        }
+    }
+}
+
+static std::vector<char> MakeDatagram(const uint64_t sequence, const PackageTypeInt type, const uint32_t value) {
+    DatagramHeader header{sequence, {type, sizeof(value), 0}};
+    header.FromNativeToBigEndian();
+
+    std::vector<char> datagram(sizeof(DatagramHeader) + sizeof(value));
+    std::memcpy(datagram.data(), &header, sizeof(DatagramHeader));
+    std::memcpy(datagram.data() + sizeof(DatagramHeader), &value, sizeof(value));
+    return datagram;
+}
+
+TEST(TCP_Test, Datagram_DropsStaleSequences) {
+    RunWithTimeout([] {
+        IOContext context;
+        auto workGuard = asio::make_work_guard(context);
+
+        const IPAddress address = asio::ip::make_address("127.0.0.1");
+        UDPSocket peer(context, UDPEndpoint(address, 0));
+
+        std::mutex mutex;
+        std::vector<std::pair<PackageTypeInt, uint32_t>> received;
+
+        const auto channel = std::make_shared<DatagramChannel>(context);
+        const uint16_t port = channel->Open(address);
+        ASSERT_NE(port, 0);
+
+        channel->Start([&](const PackageHeader& header, const char* body) {
+            uint32_t value;
+            std::memcpy(&value, body, sizeof(value));
+
+            std::lock_guard lock(mutex);
+            received.emplace_back(header.type, value);
+        });
+        channel->Connect(peer.local_endpoint());
+
+        std::thread contextThread([&context]() { context.run(); });
+
+        const UDPEndpoint target(address, port);
+        for (const auto& [sequence, type, value] : std::vector<std::tuple<uint64_t, PackageTypeInt, uint32_t>>{{5, 0, 1}, {3, 0, 2}, {4, 1, 3}, {6, 0, 4}, {6, 0, 5}}) {
+            peer.send_to(asio::buffer(MakeDatagram(sequence, type, value)), target);
+        }
+
+        UDPSocket stranger(context, UDPEndpoint(address, 0));
+        stranger.send_to(asio::buffer(MakeDatagram(7, 0, 6)), target);
+
+        while (channel->GetDroppedCount() < 3) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        channel->Close();
+        workGuard.reset();
+        contextThread.join();
+
+        const std::vector<std::pair<PackageTypeInt, uint32_t>> expected = {{0, 1}, {1, 3}, {0, 4}};
+        ASSERT_EQ(received, expected);
+    });
+}
+
+TEST(TCP_Test, Datagram_UnreliableRoundTrip) {
+    RunWithTimeout([] {
+        IOContext context;
+        auto workGuard = asio::make_work_guard(context);
+        std::thread contextThread([&context]() { context.run(); });
+
+        moodycamel::ConcurrentQueue<std::unique_ptr<PackageIn<P2P::MessageType>>> serverQueue;
+        moodycamel::ConcurrentQueue<std::unique_ptr<PackageIn<P2P::MessageType>>> clientQueue;
+
+        const auto server = TCPConnection<P2P::MessageType>::Create(context, serverQueue);
+        const auto client = TCPConnection<P2P::MessageType>::Create(context, clientQueue);
+
+        std::atomic<bool> ready{false};
+        server->Seek(asio::ip::make_address("127.0.0.1"), {0, 0}, [&ready]() { ready.store(true); }, []() {});
+
+        while (!ready.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        client->SetUnreliable(P2P::MessageType::echo, true);
+        client->Start(server->GetAddress(), server->GetPorts(), []() {});
+
+        while (!client->IsDatagramChannelOpen() || !server->IsDatagramChannelOpen()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        client->Send(Package<P2P::MessageType>::CreateUnique(P2P::MessageType::echo, uint32_t{42}));
+        client->Send(Package<P2P::MessageType>::CreateUnique(P2P::MessageType::echo, std::vector<char>(4 * DATAGRAM_MAX_PAYLOAD_SIZE, 'x')));
+
+        std::vector<PackageSizeInt> sizes;
+        while (sizes.size() < 2) {
+            if (std::unique_ptr<PackageIn<P2P::MessageType>> package; serverQueue.try_dequeue(package)) {
+                ASSERT_EQ(package->package->GetHeader().type, static_cast<PackageTypeInt>(P2P::MessageType::echo));
+                sizes.push_back(package->package->GetHeader().size);
+            } else {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+
+        client->Disconnect();
+        server->Disconnect();
+
+        workGuard.reset();
+        context.stop();
+        contextThread.join();
+
+        std::ranges::sort(sizes);
+        ASSERT_EQ(sizes[0], sizeof(uint32_t));
+        ASSERT_GT(sizes[1], DATAGRAM_MAX_PAYLOAD_SIZE);
+    });
+}
@@ -87,4 +87,160 @@ TEST(TCP_Test, FileStreamTest_SmallFile) {
             FAIL() << "Test failed with an exception: " << e.what();
         }
     }
-}
\ No newline at end of file
+}
+static std::string ReadWholeFile(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+
+TEST(TCP_Test, FileStreamTest_DeltaSync) {
+    std::string data(256 * 1024, 'a');
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<char>('a' + i * 7 % 23);
+    }
+
+    std::string stale = data;
+    std::fill_n(stale.begin() + 100 * 1024, 4096, 'z');
+
+    std::ofstream("delta_source.bin", std::ios::binary | std::ios::trunc).write(data.data(), static_cast<std::streamsize>(data.size()));
+    std::ofstream("delta_result.bin", std::ios::binary | std::ios::trunc).write(stale.data(), static_cast<std::streamsize>(stale.size()));
+
+    P2PSettings::SetDeltaSyncEnabled(true);
+
+    auto future = std::async(std::launch::async, [&data] {
+        std::array<uint16_t, 2> ports{};
+        asio::ip::address address{};
+
+        std::atomic<bool> ready{false};
+        std::atomic<bool> done{false};
+
+        std::thread clientThread([&]() {
+            P2P::Client client;
+            client.SetClientMode(P2P::ClientMode::TCP_Client);
+
+            while (!ready.load()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+
+            client.Connect(address, ports, [&]() {
+                client.RequestFile("./delta_source.bin", "delta_result.bin");
+            });
+
+            while (ReadWholeFile("delta_result.bin") != data) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            }
+
+            done.store(true);
+        });
+
+        std::thread serverThread([&]() {
+            P2P::Client server;
+            server.SetClientMode(P2P::ClientMode::TCP_Client);
+
+            server.SeekLocalConnection([&]() {
+                ports = server.GetConnectionPorts();
+                address = server.GetConnectionAddress();
+
+                ready.store(true);
+            });
+
+            while (!done.load()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+
+        serverThread.join();
+        clientThread.join();
+    });
+
+    if (future.wait_for(std::chrono::seconds(3)) == std::future_status::timeout) {
+        leaked_futures.emplace_back(std::move(future));
+        FAIL() << "Test timed out!";
+    } else {
+        P2PSettings::SetDeltaSyncEnabled(false);
+
+        try {
+            future.get();
+        } catch (const std::exception& e) {
+            FAIL() << "Test failed with an exception: " << e.what();
+        }
+    }
+}
+
+TEST(TCP_Test, FileStreamTest_ChunkStore) {
+    std::string data(1024 * 1024, 'a');
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<char>(i * 2654435761u >> 13);
+    }
+
+    std::filesystem::remove_all("tcp_chunk_store");
+    std::filesystem::remove("chunk_store_result.bin");
+    P2PSettings::SetChunkStoreDirectory("tcp_chunk_store");
+
+    std::ofstream("chunk_store_basis.bin", std::ios::binary | std::ios::trunc).write(data.data(), 512 * 1024);
+    std::ofstream("chunk_store_source.bin", std::ios::binary | std::ios::trunc).write(data.data(), static_cast<std::streamsize>(data.size()));
+    ASSERT_TRUE(ChunkStore::Import("chunk_store_basis.bin"));
+
+    P2PSettings::SetChunkStoreEnabled(true);
+
+    auto future = std::async(std::launch::async, [&data] {
+        std::array<uint16_t, 2> ports{};
+        asio::ip::address address{};
+
+        std::atomic<bool> ready{false};
+        std::atomic<bool> done{false};
+
+        std::thread clientThread([&]() {
+            P2P::Client client;
+            client.SetClientMode(P2P::ClientMode::TCP_Client);
+
+            while (!ready.load()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+
+            client.Connect(address, ports, [&]() {
+                client.RequestFile("./chunk_store_source.bin", "chunk_store_result.bin");
+            });
+
+            while (ReadWholeFile("chunk_store_result.bin") != data) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            }
+
+            done.store(true);
+        });
+
+        std::thread serverThread([&]() {
+            P2P::Client server;
+            server.SetClientMode(P2P::ClientMode::TCP_Client);
+
+            server.SeekLocalConnection([&]() {
+                ports = server.GetConnectionPorts();
+                address = server.GetConnectionAddress();
+
+                ready.store(true);
+            });
+
+            while (!done.load()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+
+        serverThread.join();
+        clientThread.join();
+    });
+
+    if (future.wait_for(std::chrono::seconds(3)) == std::future_status::timeout) {
+        leaked_futures.emplace_back(std::move(future));
+        FAIL() << "Test timed out!";
+    } else {
+        P2PSettings::SetChunkStoreEnabled(false);
+        P2PSettings::SetChunkStoreDirectory(".chunk-store");
+        std::filesystem::remove_all("tcp_chunk_store");
+
+        try {
+            future.get();
+        } catch (const std::exception& e) {
+            FAIL() << "Test failed with an exception: " << e.what();
+        }
+    }
+}
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include <HappyEyeballs.h>
+
+#include <thread>
+#include <future>
+#include <chrono>
+
+static std::vector<std::future<void>> leaked_futures;
+
+TEST(TCP_Test, HappyEyeballs_InterleavesFamilies) {
+    const std::vector<IPAddress> addresses = {
+        asio::ip::make_address("10.0.0.1"),
+        asio::ip::make_address("10.0.0.2"),
+        asio::ip::make_address("fd00::1"),
+        asio::ip::make_address("10.0.0.1"),
+        asio::ip::make_address("0.0.0.0")
+    };
+
+    const std::vector<TCPEndpoint> candidates = HappyEyeballs::OrderCandidates(addresses, 50000);
+
+    ASSERT_EQ(candidates.size(), 3);
+    ASSERT_EQ(candidates[0].address(), asio::ip::make_address("fd00::1"));
+    ASSERT_EQ(candidates[1].address(), asio::ip::make_address("10.0.0.1"));
+    ASSERT_EQ(candidates[2].address(), asio::ip::make_address("10.0.0.2"));
+    ASSERT_EQ(candidates[0].port(), 50000);
+}
+
+TEST(TCP_Test, HappyEyeballs_BackoffGrowsWithJitter) {
+    for (uint32_t attempt = 0; attempt < 32; attempt++) {
+        const auto ceiling = std::min(CONNECT_BACKOFF_BASE_DELAY * (int64_t{1} << std::min<uint32_t>(attempt, 16)), CONNECT_BACKOFF_MAX_DELAY);
+        const std::chrono::milliseconds delay = HappyEyeballs::GetBackoffDelay(attempt);
+
+        ASSERT_GE(delay, ceiling / 2);
+        ASSERT_LE(delay, ceiling);
+    }
+}
+
+TEST(TCP_Test, HappyEyeballs_SkipsRefusedCandidate) {
+    auto future = std::async(std::launch::async, [] {
+        IOContext context;
+
+        TCPAcceptor acceptor = HappyEyeballs::OpenAcceptor(context, TCPEndpoint(asio::ip::make_address("127.0.0.1"), 0));
+        const uint16_t port = acceptor.local_endpoint().port();
+
+        TCPSocket accepted(context);
+        acceptor.async_accept(accepted, [](const asio::error_code&) {});
+
+        TCPSocket socket(context);
+        std::exception_ptr error;
+        const std::vector<TCPEndpoint> candidates = {TCPEndpoint(asio::ip::make_address("127.0.0.2"), port), TCPEndpoint(asio::ip::make_address("127.0.0.1"), port)};
+
+        asio::co_spawn(context, HappyEyeballs::CoConnect(socket, candidates), [&error](const std::exception_ptr& exception) { error = exception; });
+        context.run();
+
+        ASSERT_EQ(error, nullptr);
+        ASSERT_TRUE(socket.is_open());
+        ASSERT_EQ(socket.remote_endpoint().address(), asio::ip::make_address("127.0.0.1"));
+    });
+
+    if (future.wait_for(std::chrono::seconds(3)) == std::future_status::timeout) {
+        leaked_futures.emplace_back(std::move(future));
+        FAIL() << "Test timed out!";
+    } else {
+        try {
+            future.get();
+        } catch (const std::exception& e) {
+            FAIL() << "Test failed with an exception: " << e.what();
+        }
+    }
+}
+
+TEST(TCP_Test, HappyEyeballs_AcceptsOnEveryListedAddress) {
+    auto future = std::async(std::launch::async, [] {
+        IOContext context;
+
+        const std::vector<IPAddress> addresses = {asio::ip::make_address("127.0.0.1"), asio::ip::make_address("127.0.0.2")};
+        std::vector<TCPAcceptor> acceptors = HappyEyeballs::OpenAcceptors(context, addresses, 0);
+
+        ASSERT_EQ(acceptors.size(), 2);
+        ASSERT_EQ(acceptors[0].local_endpoint().address(), addresses[0]);
+        ASSERT_EQ(acceptors[1].local_endpoint().address(), addresses[1]);
+        ASSERT_EQ(acceptors[0].local_endpoint().port(), acceptors[1].local_endpoint().port());
+
+        TCPSocket accepted(context);
+        std::exception_ptr error;
+        asio::co_spawn(context, HappyEyeballs::CoAccept(acceptors, accepted), [&error](const std::exception_ptr& exception) { error = exception; });
+
+        TCPSocket socket(context);
+        socket.async_connect(acceptors[1].local_endpoint(), [](const asio::error_code&) {});
+        context.run();
+
+        ASSERT_EQ(error, nullptr);
+        ASSERT_TRUE(accepted.is_open());
+        ASSERT_EQ(accepted.local_endpoint().address(), addresses[1]);
+    });
+
+    if (future.wait_for(std::chrono::seconds(3)) == std::future_status::timeout) {
+        leaked_futures.emplace_back(std::move(future));
+        FAIL() << "Test timed out!";
+    } else {
+        try {
+            future.get();
+        } catch (const std::exception& e) {
+            FAIL() << "Test failed with an exception: " << e.what();
+        }
+    }
+}
@@ -0,0 +1,27 @@
+#include <gtest/gtest.h>
+#include <Client.h>
+
+#include <thread>
+
+TEST(TLS_Test, CertificateCache_ReloadsOnlyChangedFiles) {
+    std::filesystem::remove_all("cache_certificates");
+    EXPECT_EQ(TLS::CertificateManager::LoadCredentials("cache_certificates"), nullptr);
+    EXPECT_FALSE(TLS::CertificateManager::IsCertificateValid("cache_certificates"));
+
+    TLS::CertificateManager::GenerateCertificate("cache_certificates");
+
+    const std::shared_ptr<const TLS::Credentials> generated = TLS::CertificateManager::LoadCredentials("cache_certificates");
+    ASSERT_NE(generated, nullptr);
+    EXPECT_EQ(TLS::CertificateManager::LoadCredentials("cache_certificates"), generated);
+    EXPECT_TRUE(TLS::CertificateManager::IsCertificateValid("cache_certificates"));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    std::filesystem::last_write_time("cache_certificates/certificate.crt", std::filesystem::file_time_type::clock::now());
+
+    const std::shared_ptr<const TLS::Credentials> reloaded = TLS::CertificateManager::LoadCredentials("cache_certificates");
+    ASSERT_NE(reloaded, nullptr);
+    EXPECT_NE(reloaded, generated);
+    EXPECT_NE(TLS::ContextProvider::CreateContext(*reloaded, true), nullptr);
+
+    std::filesystem::remove_all("cache_certificates");
+}
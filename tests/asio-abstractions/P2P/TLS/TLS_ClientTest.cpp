@@ -1,6 +1,8 @@
 #include <gtest/gtest.h>
 #include <Client.h>
 
+#include <fstream>
+
 static std::vector<std::future<void>> leaked_futures;
 
 TEST(TLS_Test, ConnectionTest) {
@@ -40,4 +42,60 @@ TEST(TLS_Test, ConnectionTest) {
             FAIL() << "Test failed with an exception: " << e.what();
         }
     }
-}
\ No newline at end of file
+}
+TEST(TLS_Test, ConnectionWaitsForContext) {
+    TLS::ContextProvider::Stop();
+    std::filesystem::remove_all("client_blocked");
+    std::ofstream("client_blocked").put('\0');
+
+    // No context can be built while the certificate directory sits below a regular file
+    TLS::ContextProvider::Start("client_blocked/certificates");
+    ASSERT_EQ(TLS::ContextProvider::Get(true), nullptr);
+
+    auto future = std::async(std::launch::async, [] {
+        P2P::Client client1, client2;
+
+        client1.SetClientMode(P2P::ClientMode::TLS_Client);
+        client2.SetClientMode(P2P::ClientMode::TLS_Client);
+
+        std::atomic<bool> seeking = false;
+
+        client1.SeekLocalConnection([&seeking]() {
+            seeking.store(true);
+        });
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        EXPECT_FALSE(seeking.load());
+        std::filesystem::remove("client_blocked");
+
+        while (!seeking.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        client2.Connect(client1.GetConnectionAddress(), client1.GetConnectionPorts());
+
+        while (client1.GetConnectionState() != ConnectionState::CONNECTED || client2.GetConnectionState() != ConnectionState::CONNECTED) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        client1.Disconnect();
+        client2.Disconnect();
+    });
+
+    const bool timedOut = future.wait_for(std::chrono::seconds(5)) == std::future_status::timeout;
+
+    TLS::ContextProvider::Stop();
+    std::filesystem::remove_all("client_blocked");
+    TLS::ContextProvider::Start();
+
+    if (timedOut) {
+        leaked_futures.emplace_back(std::move(future));
+        FAIL() << "Test timed out!";
+    } else {
+        try {
+            future.get();
+        } catch (const std::exception& e) {
+            FAIL() << "Test failed with an exception: " << e.what();
+        }
+    }
+}
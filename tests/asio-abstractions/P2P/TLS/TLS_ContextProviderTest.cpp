@@ -0,0 +1,39 @@
+#include <gtest/gtest.h>
+#include <Client.h>
+
+#include <fstream>
+
+TEST(TLS_Test, ContextProvider_SharesPrewarmedContexts) {
+    TLS::ContextProvider::Stop();
+    std::filesystem::remove_all("provider_certificates");
+    TLS::ContextProvider::Start("provider_certificates");
+
+    const std::shared_ptr<SSLContext> serverContext = TLS::ContextProvider::Get(true);
+    const std::shared_ptr<SSLContext> clientContext = TLS::ContextProvider::Get(false);
+
+    ASSERT_NE(serverContext, nullptr);
+    ASSERT_NE(clientContext, nullptr);
+    EXPECT_NE(serverContext, clientContext);
+
+    EXPECT_EQ(TLS::ContextProvider::Get(true), serverContext);
+    EXPECT_EQ(TLS::ContextProvider::Get(false), clientContext);
+    EXPECT_TRUE(TLS::CertificateManager::IsCertificateValid("provider_certificates", TLS_CERTIFICATE_ROTATION_MARGIN));
+
+    TLS::ContextProvider::Stop();
+    std::filesystem::remove_all("provider_certificates");
+}
+
+TEST(TLS_Test, ContextProvider_ReportsMissingContextsWithoutBlocking) {
+    TLS::ContextProvider::Stop();
+    std::filesystem::remove_all("provider_blocked");
+    std::ofstream("provider_blocked").put('\0');
+
+    // The certificate directory cannot be created below a regular file, so no contexts can be built
+    TLS::ContextProvider::Start("provider_blocked/certificates");
+
+    EXPECT_EQ(TLS::ContextProvider::Get(true), nullptr);
+    EXPECT_EQ(TLS::ContextProvider::Get(false), nullptr);
+
+    TLS::ContextProvider::Stop();
+    std::filesystem::remove_all("provider_blocked");
+}
@@ -0,0 +1,28 @@
+#include <gtest/gtest.h>
+#include <CryptoPreferences.h>
+#include <ContextProvider.h>
+
+#include <openssl/ssl.h>
+
+TEST(TLS_Test, CryptoPreferences_ExplicitOrder) {
+    ASSERT_TRUE(TLS::CryptoPreferences::GetCipherSuiteList(TLS::CipherSuite::AES_GCM).starts_with("TLS_AES_128_GCM_SHA256"));
+    ASSERT_TRUE(TLS::CryptoPreferences::GetCipherSuiteList(TLS::CipherSuite::CHACHA20_POLY1305).starts_with("TLS_CHACHA20_POLY1305_SHA256"));
+    ASSERT_TRUE(TLS::CryptoPreferences::GetKeyExchangeGroupList(TLS::KeyExchangeGroup::X25519).starts_with("X25519"));
+    ASSERT_TRUE(TLS::CryptoPreferences::GetKeyExchangeGroupList(TLS::KeyExchangeGroup::P256).starts_with("P-256"));
+}
+
+TEST(TLS_Test, CryptoPreferences_AutoFollowsHardware) {
+    const TLS::CipherSuite expected = TLS::CryptoPreferences::HasAESAcceleration() ? TLS::CipherSuite::AES_GCM : TLS::CipherSuite::CHACHA20_POLY1305;
+    ASSERT_EQ(TLS::CryptoPreferences::GetCipherSuiteList(TLS::CipherSuite::AUTO), TLS::CryptoPreferences::GetCipherSuiteList(expected));
+}
+
+TEST(TLS_Test, CryptoPreferences_ApplyToContext) {
+    SSLContext context(SSLContext::tlsv13_client);
+
+    ASSERT_TRUE(TLS::CryptoPreferences::Apply(context.native_handle(), TLS::CipherSuite::CHACHA20_POLY1305, TLS::KeyExchangeGroup::P256));
+
+    SSL* ssl = SSL_new(context.native_handle());
+    ASSERT_NE(ssl, nullptr);
+    ASSERT_STREQ(SSL_CIPHER_get_name(sk_SSL_CIPHER_value(SSL_get_ciphers(ssl), 0)), "TLS_CHACHA20_POLY1305_SHA256");
+    SSL_free(ssl);
+}
@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+#include <Client.h>
+
+#include <thread>
+#include <future>
+#include <chrono>
+
+static std::vector<std::future<void>> leaked_futures;
+
+TEST(TLS_Test, Datagram_EncryptedRoundTrip) {
+    auto future = std::async(std::launch::async, [] {
+        const std::filesystem::path certificatePath = "./certificates/";
+        if (!TLS::CertificateManager::IsCertificateValid(certificatePath)) {
+            TLS::CertificateManager::GenerateCertificate(certificatePath);
+        }
+
+        IOContext context;
+        auto workGuard = asio::make_work_guard(context);
+        std::thread contextThread([&context]() { context.run(); });
+
+        moodycamel::ConcurrentQueue<std::unique_ptr<PackageIn<P2P::MessageType>>> serverQueue;
+        moodycamel::ConcurrentQueue<std::unique_ptr<PackageIn<P2P::MessageType>>> clientQueue;
+
+        const auto server = TLSConnection<P2P::MessageType>::Create(context, TLSConnection<P2P::MessageType>::CreateSSLContext(certificatePath, true), serverQueue);
+        const auto client = TLSConnection<P2P::MessageType>::Create(context, TLSConnection<P2P::MessageType>::CreateSSLContext(certificatePath, false), clientQueue);
+
+        std::atomic<bool> ready{false};
+        server->Seek(asio::ip::make_address("127.0.0.1"), {0, 0}, [&ready]() { ready.store(true); }, []() {});
+
+        while (!ready.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        server->SetUnreliable(P2P::MessageType::echo, true);
+        client->Start(server->GetAddress(), server->GetPorts(), []() {});
+
+        while (!client->IsDatagramChannelOpen() || !server->IsDatagramChannelOpen()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        server->Send(Package<P2P::MessageType>::CreateUnique(P2P::MessageType::echo, std::string("cursor")));
+
+        std::unique_ptr<PackageIn<P2P::MessageType>> package;
+        while (!clientQueue.try_dequeue(package)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        client->Disconnect();
+        server->Disconnect();
+
+        workGuard.reset();
+        context.stop();
+        contextThread.join();
+
+        std::string value;
+        package->package->GetValue(value);
+
+        ASSERT_EQ(package->package->GetHeader().type, static_cast<PackageTypeInt>(P2P::MessageType::echo));
+        ASSERT_EQ(value, "cursor");
+    });
+
+    if (future.wait_for(std::chrono::seconds(3)) == std::future_status::timeout) {
+        leaked_futures.emplace_back(std::move(future));
+        FAIL() << "Test timed out!";
+    } else {
+        try {
+            future.get();
+        } catch (const std::exception& e) {
+            FAIL() << "Test failed with an exception: " << e.what();
+        }
+    }
+}
+
+TEST(TLS_Test, Datagram_RejectsForeignKey) {
+    IOContext context;
+    const IPAddress address = asio::ip::make_address("127.0.0.1");
+
+    DatagramKey key{};
+    DatagramKey otherKey{};
+    otherKey.fill(1);
+
+    const auto sender = std::make_shared<DatagramChannel>(context);
+    const auto receiver = std::make_shared<DatagramChannel>(context);
+
+    const uint16_t senderPort = sender->Open(address);
+    const uint16_t receiverPort = receiver->Open(address);
+
+    sender->SetKeys(key, key);
+    receiver->SetKeys(otherKey, otherKey);
+
+    size_t received = 0;
+    sender->Start([](const PackageHeader&, const char*) {});
+    receiver->Start([&received](const PackageHeader&, const char*) { received++; });
+
+    sender->Connect(UDPEndpoint(address, receiverPort));
+    receiver->Connect(UDPEndpoint(address, senderPort));
+
+    const auto package = Package<P2P::MessageType>::CreateUnique(P2P::MessageType::echo, uint32_t{7});
+    ASSERT_TRUE(sender->Send(package->GetHeader(), package->GetRawBody()));
+
+    while (receiver->GetDroppedCount() == 0) {
+        context.run_one_for(std::chrono::milliseconds(100));
+    }
+
+    sender->Close();
+    receiver->Close();
+    context.run();
+
+    ASSERT_EQ(received, 0);
+}
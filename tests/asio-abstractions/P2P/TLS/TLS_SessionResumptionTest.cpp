@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include <Client.h>
+
+#include <thread>
+#include <future>
+#include <chrono>
+
+static std::vector<std::future<void>> leaked_futures;
+
+static bool ConnectOnce(IOContext& context, const std::shared_ptr<SSLContext>& serverContext, const std::shared_ptr<SSLContext>& clientContext) {
+    moodycamel::ConcurrentQueue<std::unique_ptr<PackageIn<P2P::MessageType>>> serverQueue;
+    moodycamel::ConcurrentQueue<std::unique_ptr<PackageIn<P2P::MessageType>>> clientQueue;
+
+    const auto server = TLSConnection<P2P::MessageType>::Create(context, serverContext, serverQueue);
+    const auto client = TLSConnection<P2P::MessageType>::Create(context, clientContext, clientQueue);
+    const IPAddress address = asio::ip::make_address("127.0.0.1");
+
+    std::atomic<bool> ready{false};
+    server->Seek(address, {0, 0}, [&ready]() { ready.store(true); }, []() {});
+
+    while (!ready.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    client->Start(server->GetAddress(), server->GetPorts(), []() {});
+
+    while (client->GetConnectionState() != ConnectionState::CONNECTED || server->GetConnectionState() != ConnectionState::CONNECTED) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    while (TLS::SessionCache::GetTicketCount(address) == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    const bool resumed = client->IsSessionResumed() && server->IsSessionResumed();
+
+    client->Disconnect();
+    server->Disconnect();
+
+    while (client->GetConnectionState() != ConnectionState::DISCONNECTED || server->GetConnectionState() != ConnectionState::DISCONNECTED) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    return resumed;
+}
+
+TEST(TLS_Test, SessionResumption_Reconnect) {
+    auto future = std::async(std::launch::async, [] {
+        const std::filesystem::path certificatePath = "./certificates/";
+        if (!TLS::CertificateManager::IsCertificateValid(certificatePath)) {
+            TLS::CertificateManager::GenerateCertificate(certificatePath);
+        }
+
+        TLS::SessionCache::Clear();
+
+        IOContext context;
+        auto workGuard = asio::make_work_guard(context);
+        std::thread contextThread([&context]() { context.run(); });
+
+        const auto serverContext = TLSConnection<P2P::MessageType>::CreateSSLContext(certificatePath, true);
+        const auto clientContext = TLSConnection<P2P::MessageType>::CreateSSLContext(certificatePath, false);
+
+        const bool firstResumed = ConnectOnce(context, serverContext, clientContext);
+        const bool secondResumed = ConnectOnce(context, serverContext, clientContext);
+
+        workGuard.reset();
+        context.stop();
+        contextThread.join();
+
+        ASSERT_FALSE(firstResumed);
+        ASSERT_TRUE(secondResumed);
+    });
+
+    if (future.wait_for(std::chrono::seconds(3)) == std::future_status::timeout) {
+        leaked_futures.emplace_back(std::move(future));
+        FAIL() << "Test timed out!";
+    } else {
+        try {
+            future.get();
+        } catch (const std::exception& e) {
+            FAIL() << "Test failed with an exception: " << e.what();
+        }
+    }
+}
@@ -0,0 +1,212 @@
+#include <gtest/gtest.h>
+#include <Client.h>
+#include <SharedMemoryChannel.h>
+
+#include <thread>
+#include <future>
+#include <chrono>
+#include <numeric>
+
+#include <csignal>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static std::vector<std::future<void>> leaked_futures;
+
+static void RunWithTimeout(std::function<void()> test) {
+    auto future = std::async(std::launch::async, std::move(test));
+
+    if (future.wait_for(std::chrono::seconds(3)) == std::future_status::timeout) {
+        leaked_futures.emplace_back(std::move(future));
+        FAIL() << "Test timed out!";
+    } else {
+        try {
+            future.get();
+        } catch (const std::exception& e) {
+            FAIL() << "Test failed with an exception: " << e.what();
+        }
+    }
+}
+
+TEST(TLS_Test, SharedMemory_ChannelRoundTrip) {
+    if (!SharedMemoryChannel::IsSupported()) {
+        GTEST_SKIP();
+    }
+
+    RunWithTimeout([] {
+        IOContext context;
+
+        auto server = std::make_shared<SharedMemoryChannel>(context.get_executor(), SharedMemorySide::SERVER);
+        auto client = std::make_shared<SharedMemoryChannel>(context.get_executor(), SharedMemorySide::CLIENT);
+
+        ASSERT_TRUE(server->Create());
+        ASSERT_TRUE(client->Open(server->GetName()));
+        server->Unlink();
+
+        server->Start();
+        client->Start();
+
+        std::vector<uint32_t> sent(3 * SHARED_MEMORY_RING_SIZE / sizeof(uint32_t));
+        std::iota(sent.begin(), sent.end(), 0);
+        std::vector<uint32_t> received(sent.size());
+
+        asio::co_spawn(context, [&]() -> asio::awaitable<void> {
+            co_await asio::async_write(client->GetStream(MultiplexedStream::FILE), asio::buffer(sent), asio::use_awaitable);
+        }, asio::detached);
+
+        asio::co_spawn(context, [&]() -> asio::awaitable<void> {
+            co_await asio::async_read(server->GetStream(MultiplexedStream::FILE), asio::buffer(received), asio::use_awaitable);
+        }, asio::detached);
+
+        context.run();
+
+        ASSERT_EQ(sent, received);
+    });
+}
+
+TEST(TLS_Test, SharedMemory_SelectedForLocalPeer) {
+    if (!SharedMemoryChannel::IsSupported()) {
+        GTEST_SKIP();
+    }
+
+    RunWithTimeout([] {
+        const std::filesystem::path certificatePath = "./certificates/";
+        if (!TLS::CertificateManager::IsCertificateValid(certificatePath)) {
+            TLS::CertificateManager::GenerateCertificate(certificatePath);
+        }
+
+        IOContext context;
+        auto workGuard = asio::make_work_guard(context);
+        std::thread contextThread([&context]() { context.run(); });
+
+        moodycamel::ConcurrentQueue<std::unique_ptr<PackageIn<P2P::MessageType>>> serverQueue;
+        moodycamel::ConcurrentQueue<std::unique_ptr<PackageIn<P2P::MessageType>>> clientQueue;
+
+        const auto server = TLSConnection<P2P::MessageType>::Create(context, TLSConnection<P2P::MessageType>::CreateSSLContext(certificatePath, true), serverQueue);
+        const auto client = TLSConnection<P2P::MessageType>::Create(context, TLSConnection<P2P::MessageType>::CreateSSLContext(certificatePath, false), clientQueue);
+
+        std::atomic<bool> ready{false};
+        server->Seek(asio::ip::make_address("127.0.0.1"), {0, 0}, [&ready]() { ready.store(true); }, []() {});
+
+        while (!ready.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        client->Start(server->GetAddress(), server->GetPorts(), []() {});
+
+        while (client->GetConnectionState() != ConnectionState::CONNECTED || server->GetConnectionState() != ConnectionState::CONNECTED) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        client->Send(Package<P2P::MessageType>::CreateUnique(P2P::MessageType::message, std::string("shared memory")));
+
+        std::unique_ptr<PackageIn<P2P::MessageType>> package;
+        while (!serverQueue.try_dequeue(package)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        const TransportMode clientMode = client->GetTransportMode();
+        const TransportMode serverMode = server->GetTransportMode();
+
+        client->Disconnect();
+        server->Disconnect();
+
+        while (client->GetConnectionState() != ConnectionState::DISCONNECTED || server->GetConnectionState() != ConnectionState::DISCONNECTED) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        workGuard.reset();
+        context.stop();
+        contextThread.join();
+
+        ASSERT_EQ(clientMode, TransportMode::SHARED_MEMORY);
+        ASSERT_EQ(serverMode, TransportMode::SHARED_MEMORY);
+    });
+}
+
+TEST(TLS_Test, SharedMemory_RingRejectsCorruptCounters) {
+    SharedMemoryRingControl control;
+    std::array<char, 64> data{};
+    SharedMemoryRing ring(&control, data.data(), data.size());
+
+    // The peer owns one of the counters and claims more bytes than the ring can hold
+    control.head.store(data.size() + 1);
+
+    std::array<char, 256> buffer{};
+    ASSERT_FALSE(ring.IsConsistent());
+    ASSERT_EQ(ring.Read(buffer.data(), buffer.size()), 0);
+    ASSERT_EQ(ring.Write(buffer.data(), buffer.size()), 0);
+}
+
+TEST(TLS_Test, SharedMemory_DisconnectsWhenPeerIsKilled) {
+    if (!SharedMemoryChannel::IsSupported()) {
+        GTEST_SKIP();
+    }
+
+    RunWithTimeout([] {
+        const std::filesystem::path certificatePath = "./certificates/";
+        if (!TLS::CertificateManager::IsCertificateValid(certificatePath)) {
+            TLS::CertificateManager::GenerateCertificate(certificatePath);
+        }
+
+        int portPipe[2];
+        ASSERT_EQ(::pipe(portPipe), 0);
+
+        // The client lives in a child process so it can be killed without closing its shared memory channel
+        const pid_t child = ::fork();
+        ASSERT_GE(child, 0);
+
+        if (child == 0) {
+            std::array<uint16_t, 2> ports{};
+            if (::read(portPipe[0], ports.data(), sizeof(ports)) != sizeof(ports)) {
+                ::_exit(1);
+            }
+
+            IOContext context;
+            moodycamel::ConcurrentQueue<std::unique_ptr<PackageIn<P2P::MessageType>>> clientQueue;
+            const auto client = TLSConnection<P2P::MessageType>::Create(context, TLSConnection<P2P::MessageType>::CreateSSLContext(certificatePath, false), clientQueue);
+
+            client->Start(asio::ip::make_address("127.0.0.1"), ports, []() {});
+            context.run();
+            ::_exit(0);
+        }
+
+        IOContext context;
+        auto workGuard = asio::make_work_guard(context);
+        std::thread contextThread([&context]() { context.run(); });
+
+        moodycamel::ConcurrentQueue<std::unique_ptr<PackageIn<P2P::MessageType>>> serverQueue;
+        const auto server = TLSConnection<P2P::MessageType>::Create(context, TLSConnection<P2P::MessageType>::CreateSSLContext(certificatePath, true), serverQueue);
+
+        std::atomic<bool> ready{false};
+        server->Seek(asio::ip::make_address("127.0.0.1"), {0, 0}, [&ready]() { ready.store(true); }, []() {});
+
+        while (!ready.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        const std::array<uint16_t, 2> ports = server->GetPorts();
+        ASSERT_EQ(::write(portPipe[1], ports.data(), sizeof(ports)), sizeof(ports));
+
+        while (server->GetConnectionState() != ConnectionState::CONNECTED) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        const TransportMode serverMode = server->GetTransportMode();
+
+        ::kill(child, SIGKILL);
+        ::waitpid(child, nullptr, 0);
+        ::close(portPipe[0]);
+        ::close(portPipe[1]);
+
+        while (server->GetConnectionState() != ConnectionState::DISCONNECTED) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        workGuard.reset();
+        context.stop();
+        contextThread.join();
+
+        ASSERT_EQ(serverMode, TransportMode::SHARED_MEMORY);
+    });
+}
@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+#include <Client.h>
+
+#include <openssl/ssl.h>
+
+#include <thread>
+#include <future>
+#include <chrono>
+
+static std::vector<std::future<void>> leaked_futures;
+
+static void RunWithTimeout(std::function<void()> test) {
+    auto future = std::async(std::launch::async, std::move(test));
+
+    if (future.wait_for(std::chrono::seconds(3)) == std::future_status::timeout) {
+        leaked_futures.emplace_back(std::move(future));
+        FAIL() << "Test timed out!";
+    } else {
+        try {
+            future.get();
+        } catch (const std::exception& e) {
+            FAIL() << "Test failed with an exception: " << e.what();
+        }
+    }
+}
+
+TEST(TLS_Test, TransportNegotiation_FallsBackForPeerWithoutIt) {
+    RunWithTimeout([] {
+        const std::filesystem::path certificatePath = "./certificates/";
+        if (!TLS::CertificateManager::IsCertificateValid(certificatePath)) {
+            TLS::CertificateManager::GenerateCertificate(certificatePath);
+        }
+
+        IOContext context;
+        auto workGuard = asio::make_work_guard(context);
+        std::thread contextThread([&context]() { context.run(); });
+
+        moodycamel::ConcurrentQueue<std::unique_ptr<PackageIn<P2P::MessageType>>> serverQueue;
+        moodycamel::ConcurrentQueue<std::unique_ptr<PackageIn<P2P::MessageType>>> clientQueue;
+
+        // A server context that never selects the transport protocol behaves like a peer that predates the mode byte
+        const std::shared_ptr<SSLContext> serverContext = TLSConnection<P2P::MessageType>::CreateSSLContext(certificatePath, true);
+        SSL_CTX_set_alpn_select_cb(serverContext->native_handle(), nullptr, nullptr);
+
+        const auto server = TLSConnection<P2P::MessageType>::Create(context, serverContext, serverQueue);
+        const auto client = TLSConnection<P2P::MessageType>::Create(context, TLSConnection<P2P::MessageType>::CreateSSLContext(certificatePath, false), clientQueue);
+
+        const bool multiplexing = P2PSettings::IsStreamMultiplexingEnabled();
+        P2PSettings::SetStreamMultiplexingEnabled(true);
+
+        std::atomic<bool> ready{false};
+        server->Seek(asio::ip::make_address("127.0.0.1"), {0, 0}, [&ready]() { ready.store(true); }, []() {});
+
+        while (!ready.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        client->Start(server->GetAddress(), server->GetPorts(), []() {});
+
+        while (client->GetConnectionState() != ConnectionState::CONNECTED || server->GetConnectionState() != ConnectionState::CONNECTED) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        client->Send(Package<P2P::MessageType>::CreateUnique(P2P::MessageType::message, std::string("dual socket")));
+
+        std::unique_ptr<PackageIn<P2P::MessageType>> package;
+        while (!serverQueue.try_dequeue(package)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        std::string message;
+        package->package->GetValue(message);
+
+        const TransportMode clientMode = client->GetTransportMode();
+        const TransportMode serverMode = server->GetTransportMode();
+
+        client->Disconnect();
+        server->Disconnect();
+
+        while (client->GetConnectionState() != ConnectionState::DISCONNECTED || server->GetConnectionState() != ConnectionState::DISCONNECTED) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        workGuard.reset();
+        context.stop();
+        contextThread.join();
+
+        P2PSettings::SetStreamMultiplexingEnabled(multiplexing);
+
+        ASSERT_EQ(message, "dual socket");
+        ASSERT_EQ(clientMode, TransportMode::DUAL_SOCKET);
+        ASSERT_EQ(serverMode, TransportMode::DUAL_SOCKET);
+    });
+}
@@ -0,0 +1,198 @@
+#include <gtest/gtest.h>
+#include <Client.h>
+
+#include <thread>
+#include <future>
+#include <chrono>
+
+#include <fstream>
+
+static std::vector<std::future<void>> leaked_futures;
+
+static void RunWithTimeout(std::function<void()> test) {
+    auto future = std::async(std::launch::async, std::move(test));
+
+    if (future.wait_for(std::chrono::seconds(3)) == std::future_status::timeout) {
+        leaked_futures.emplace_back(std::move(future));
+        FAIL() << "Test timed out!";
+    } else {
+        try {
+            future.get();
+        } catch (const std::exception& e) {
+            FAIL() << "Test failed with an exception: " << e.what();
+        }
+    }
+}
+
+static std::string ReadFile(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+
+static void WriteFile(const std::filesystem::path& path, const std::string& data) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(data.data(), static_cast<std::streamsize>(data.size()));
+}
+
+TEST(UNIX_Test, ClientFileStream) {
+    const std::string data(256 * 1024, 'u');
+
+    std::filesystem::remove("unix_test.txt");
+    std::filesystem::remove("unix_test_result.txt");
+    WriteFile("unix_test.txt", data);
+
+    RunWithTimeout([&data] {
+        std::array<uint16_t, 2> ports{};
+        asio::ip::address address{};
+
+        std::atomic<bool> ready{false};
+        std::atomic<bool> done{false};
+
+        std::thread serverThread([&]() {
+            P2P::Client server;
+            server.SetClientMode(P2P::ClientMode::UNIX_Client);
+
+            server.SeekLocalConnection([&]() {
+                ports = server.GetConnectionPorts();
+                address = server.GetConnectionAddress();
+
+                ready.store(true);
+            });
+
+            while (!done.load()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+
+        P2P::Client client;
+        client.SetClientMode(P2P::ClientMode::UNIX_Client);
+
+        while (!ready.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        ASSERT_TRUE(address.is_loopback());
+        ASSERT_TRUE(std::filesystem::exists(UnixConnection<P2P::MessageType>::GetSocketPath(ports[0])));
+
+        client.Connect(address, ports, [&]() {
+            client.RequestFile("./unix_test.txt", "unix_test_result.txt");
+        });
+
+        while (ReadFile("unix_test_result.txt") != data) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        done.store(true);
+        serverThread.join();
+
+        ASSERT_FALSE(std::filesystem::exists(UnixConnection<P2P::MessageType>::GetSocketPath(ports[0])));
+    });
+}
+
+TEST(UNIX_Test, RangeAndDirectoryPassDescriptors) {
+    std::string data(64 * 1024, '\0');
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = static_cast<char>(i * 31);
+    }
+
+    std::filesystem::remove_all("unix_tree");
+    std::filesystem::remove_all("unix_tree_result");
+    std::filesystem::remove("unix_range.bin");
+    std::filesystem::remove("unix_range_result.bin");
+
+    std::filesystem::create_directories("unix_tree/nested/empty");
+    WriteFile("unix_tree/a.txt", "first");
+    WriteFile("unix_tree/nested/b.bin", data);
+    WriteFile("unix_range.bin", data);
+
+    RunWithTimeout([&data] {
+        IOContext context;
+        auto workGuard = asio::make_work_guard(context);
+        std::thread contextThread([&context]() { context.run(); });
+
+        moodycamel::ConcurrentQueue<std::unique_ptr<PackageIn<P2P::MessageType>>> serverQueue;
+        moodycamel::ConcurrentQueue<std::unique_ptr<PackageIn<P2P::MessageType>>> clientQueue;
+
+        const auto server = UnixConnection<P2P::MessageType>::Create(context, serverQueue);
+        const auto client = UnixConnection<P2P::MessageType>::Create(context, clientQueue);
+
+        std::atomic<bool> ready{false};
+        server->Seek(asio::ip::address_v4::loopback(), {0, 0}, [&ready]() { ready.store(true); }, []() {});
+
+        while (!ready.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        client->Start(server->GetAddress(), server->GetPorts(), []() {});
+
+        while (client->GetConnectionState() != ConnectionState::CONNECTED || server->GetConnectionState() != ConnectionState::CONNECTED) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        std::promise<bool> rangeResult;
+        client->RequestFileRange("unix_range.bin", "unix_range_result.bin", 1000, 5000, FILE_TRANSFER_DEFAULT_WEIGHT, [&rangeResult](const bool succeeded) {
+            rangeResult.set_value(succeeded);
+        });
+        client->RequestDirectory("unix_tree", "unix_tree_result", FILE_TRANSFER_DEFAULT_WEIGHT);
+
+        const bool rangeSucceeded = rangeResult.get_future().get();
+
+        while (ReadFile("unix_tree_result/nested/b.bin") != data || ReadFile("unix_tree_result/a.txt") != "first") {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        client->Disconnect();
+        server->Disconnect();
+
+        workGuard.reset();
+        context.stop();
+        contextThread.join();
+
+        ASSERT_TRUE(rangeSucceeded);
+
+        const std::string range = ReadFile("unix_range_result.bin");
+        ASSERT_EQ(range.size(), data.size());
+        ASSERT_EQ(range.substr(1000, 5000), data.substr(1000, 5000));
+
+        ASSERT_EQ(ReadFile("unix_tree_result/a.txt"), "first");
+        ASSERT_EQ(ReadFile("unix_tree_result/nested/b.bin"), data);
+        ASSERT_TRUE(std::filesystem::is_directory("unix_tree_result/nested/empty"));
+    });
+}
+
+TEST(UNIX_Test, SocketDirectoryMustBePrivate) {
+    const std::filesystem::path root = std::filesystem::absolute("unix_runtime");
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root / "target");
+
+    const char* previous = std::getenv("XDG_RUNTIME_DIR");
+    const std::string saved = previous != nullptr ? previous : "";
+    ::setenv("XDG_RUNTIME_DIR", root.c_str(), 1);
+
+    const std::filesystem::path directory = UnixConnection<P2P::MessageType>::GetSocketDirectory();
+    ASSERT_EQ(directory.parent_path(), root);
+
+    std::filesystem::create_directory(directory);
+    std::filesystem::permissions(directory, std::filesystem::perms::owner_all | std::filesystem::perms::group_read | std::filesystem::perms::others_read);
+    const bool sharedTrusted = UnixConnection<P2P::MessageType>::IsSocketDirectoryTrusted(directory);
+
+    std::filesystem::permissions(directory, std::filesystem::perms::owner_all);
+    const bool privateTrusted = UnixConnection<P2P::MessageType>::IsSocketDirectoryTrusted(directory);
+
+    std::filesystem::remove(directory);
+    std::filesystem::permissions(root / "target", std::filesystem::perms::owner_all);
+    std::filesystem::create_directory_symlink(root / "target", directory);
+    const bool symlinkTrusted = UnixConnection<P2P::MessageType>::IsSocketDirectoryTrusted(directory);
+
+    if (previous != nullptr) {
+        ::setenv("XDG_RUNTIME_DIR", saved.c_str(), 1);
+    } else {
+        ::unsetenv("XDG_RUNTIME_DIR");
+    }
+
+    std::filesystem::remove_all(root);
+
+    ASSERT_FALSE(sharedTrusted);
+    ASSERT_TRUE(privateTrusted);
+    ASSERT_FALSE(symlinkTrusted);
+}
@@ -0,0 +1,128 @@
+#include <benchmark/benchmark.h>
+#include <ContextProvider.h>
+#include <CryptoPreferences.h>
+
+#include <openssl/ssl.h>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+static constexpr size_t BIO_BUFFER_SIZE = 64 * 1024;
+static constexpr size_t BULK_CHUNK_SIZE = 16 * 1024;
+
+struct TLSPair {
+    std::shared_ptr<SSLContext> serverContext;
+    std::shared_ptr<SSLContext> clientContext;
+    SSL* server = nullptr;
+    SSL* client = nullptr;
+
+    TLSPair(const TLS::Credentials& credentials, const TLS::CipherSuite cipherSuite, const TLS::KeyExchangeGroup group) {
+        serverContext = TLS::ContextProvider::CreateContext(credentials, true);
+        clientContext = TLS::ContextProvider::CreateContext(credentials, false);
+
+        if (!TLS::CryptoPreferences::Apply(serverContext->native_handle(), cipherSuite, group) ||
+            !TLS::CryptoPreferences::Apply(clientContext->native_handle(), cipherSuite, group)) {
+            throw std::runtime_error("Could not apply crypto preferences");
+        }
+
+        server = SSL_new(serverContext->native_handle());
+        client = SSL_new(clientContext->native_handle());
+
+        BIO* serverBio = nullptr;
+        BIO* clientBio = nullptr;
+        BIO_new_bio_pair(&serverBio, BIO_BUFFER_SIZE, &clientBio, BIO_BUFFER_SIZE);
+
+        SSL_set_bio(server, serverBio, serverBio);
+        SSL_set_bio(client, clientBio, clientBio);
+        SSL_set_accept_state(server);
+        SSL_set_connect_state(client);
+    }
+
+    ~TLSPair() {
+        SSL_free(client);
+        SSL_free(server);
+    }
+
+    TLSPair(const TLSPair&) = delete;
+    TLSPair& operator=(const TLSPair&) = delete;
+
+    void Handshake() const {
+        bool clientDone = false;
+        bool serverDone = false;
+
+        while (!clientDone || !serverDone) {
+            clientDone = clientDone || SSL_do_handshake(client) == 1;
+            serverDone = serverDone || SSL_do_handshake(server) == 1;
+
+            if ((!clientDone && SSL_get_error(client, -1) == SSL_ERROR_SSL) || (!serverDone && SSL_get_error(server, -1) == SSL_ERROR_SSL)) {
+                throw std::runtime_error("Handshake failed");
+            }
+        }
+    }
+};
+
+static const TLS::Credentials& GetCredentials() {
+    static const std::shared_ptr<const TLS::Credentials> credentials = [] {
+        const std::filesystem::path certificatePath = "./certificates/";
+        if (!TLS::CertificateManager::IsCertificateValid(certificatePath)) {
+            TLS::CertificateManager::GenerateCertificate(certificatePath);
+        }
+
+        return TLS::CertificateManager::LoadCredentials(certificatePath);
+    }();
+
+    return *credentials;
+}
+
+static void BM_Handshake(benchmark::State& state) {
+    const auto cipherSuite = static_cast<TLS::CipherSuite>(state.range(0));
+    const auto group = static_cast<TLS::KeyExchangeGroup>(state.range(1));
+    const TLS::Credentials& credentials = GetCredentials();
+
+    for (auto _ : state) {
+        const TLSPair pair(credentials, cipherSuite, group);
+        pair.Handshake();
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_BulkThroughput(benchmark::State& state) {
+    const auto cipherSuite = static_cast<TLS::CipherSuite>(state.range(0));
+    const TLSPair pair(GetCredentials(), cipherSuite, TLS::KeyExchangeGroup::AUTO);
+    pair.Handshake();
+
+    std::vector<uint8_t> input(BULK_CHUNK_SIZE, 0xAB);
+    std::vector<uint8_t> output(BULK_CHUNK_SIZE);
+
+    for (auto _ : state) {
+        SSL_write(pair.client, input.data(), static_cast<int>(input.size()));
+
+        size_t received = 0;
+        while (received < output.size()) {
+            const int read = SSL_read(pair.server, output.data() + received, static_cast<int>(output.size() - received));
+            if (read <= 0) {
+                state.SkipWithError("SSL_read failed");
+                return;
+            }
+
+            received += static_cast<size_t>(read);
+        }
+
+        benchmark::DoNotOptimize(output.data());
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * BULK_CHUNK_SIZE));
+}
+
+BENCHMARK(BM_Handshake)
+    ->ArgNames({"suite", "group"})
+    ->ArgsProduct({
+        {static_cast<int64_t>(TLS::CipherSuite::AES_GCM), static_cast<int64_t>(TLS::CipherSuite::CHACHA20_POLY1305)},
+        {static_cast<int64_t>(TLS::KeyExchangeGroup::X25519), static_cast<int64_t>(TLS::KeyExchangeGroup::P256)}
+    });
+
+BENCHMARK(BM_BulkThroughput)
+    ->ArgName("suite")
+    ->Arg(static_cast<int64_t>(TLS::CipherSuite::AES_GCM))
+    ->Arg(static_cast<int64_t>(TLS::CipherSuite::CHACHA20_POLY1305));
@@ -0,0 +1,45 @@
+#include <gtest/gtest.h>
+#include <BandwidthLimiter.h>
+
+using namespace std::chrono_literals;
+
+TEST(BandwidthLimiterTest, UnlimitedBucketNeverDelays) {
+    TokenBucket bucket;
+    EXPECT_EQ(bucket.Consume(1024 * 1024 * 1024), TokenBucket::Clock::duration::zero());
+}
+
+TEST(BandwidthLimiterTest, BucketDelaysBeyondBurst) {
+    TokenBucket bucket;
+    bucket.SetRate(100'000, 100'000);
+    const auto start = TokenBucket::Clock::now();
+
+    EXPECT_EQ(bucket.Consume(100'000, true, start + 1s), TokenBucket::Clock::duration::zero());
+    EXPECT_EQ(bucket.Consume(50'000, true, start + 1s), 500ms);
+    EXPECT_EQ(bucket.Consume(50'000, true, start + 2s), TokenBucket::Clock::duration::zero());
+}
+
+TEST(BandwidthLimiterTest, ChildrenShareParentBudget) {
+    auto parent = std::make_shared<TokenBucket>();
+    parent->SetRate(100'000, 100'000);
+    const auto start = TokenBucket::Clock::now();
+
+    TokenBucket bulk(parent);
+    TokenBucket interactive(parent);
+
+    EXPECT_EQ(bulk.Consume(100'000, true, start + 1s), TokenBucket::Clock::duration::zero());
+    EXPECT_EQ(interactive.Consume(10'000, false, start + 1s), TokenBucket::Clock::duration::zero());
+    EXPECT_EQ(bulk.Consume(10'000, true, start + 1s), 200ms);
+}
+
+TEST(BandwidthLimiterTest, RatesChangeAtRuntime) {
+    BandwidthLimiter limiter;
+    EXPECT_EQ(limiter.Acquire(TrafficClass::FILE, 10 * 1024 * 1024), TokenBucket::Clock::duration::zero());
+
+    limiter.SetRate(TrafficClass::FILE, 1024 * 1024);
+    EXPECT_EQ(limiter.GetRate(TrafficClass::FILE), 1024u * 1024);
+    EXPECT_GT(limiter.Acquire(TrafficClass::FILE, 4 * 1024 * 1024), 2s);
+    EXPECT_EQ(limiter.Acquire(TrafficClass::MESSAGE, 1024), TokenBucket::Clock::duration::zero());
+
+    limiter.SetRate(TrafficClass::FILE, 0);
+    EXPECT_EQ(limiter.Acquire(TrafficClass::FILE, 10 * 1024 * 1024), TokenBucket::Clock::duration::zero());
+}
@@ -0,0 +1,167 @@
+#include <gtest/gtest.h>
+#include <BlobTransfer.h>
+
+#include <numeric>
+
+namespace {
+    enum class TestMessage : PackageTypeInt {
+        BLOB
+    };
+
+    std::shared_ptr<const std::vector<char>> MakeBlob(const size_t size) {
+        auto data = std::make_shared<std::vector<char>>(size);
+        std::iota(data->begin(), data->end(), 0);
+        return data;
+    }
+
+    OutgoingBlob MakeOutgoing(const size_t blobID, const std::shared_ptr<const std::vector<char>>& data) {
+        return {blobID, static_cast<PackageTypeInt>(TestMessage::BLOB), 0, data->data(), data->size(), data};
+    }
+}
+
+TEST(BlobTransferTest, FragmentsStayWithinPackageLimit) {
+    const auto data = MakeBlob(5 * BLOB_FRAGMENT_MAX_DATA_SIZE + 17);
+    OutgoingBlob blob = MakeOutgoing(1, data);
+    size_t fragments = 0;
+
+    while (!blob.IsFinished()) {
+        const std::unique_ptr<Package<TestMessage>> fragment = blob.NextFragment<TestMessage>();
+        EXPECT_LE(fragment->GetHeader().size, MAX_NON_FILE_PACKAGE_SIZE);
+        EXPECT_NE(fragment->GetHeader().flags & PackageFlag::BLOB_FRAGMENT, 0);
+        ++fragments;
+    }
+
+    EXPECT_EQ(fragments, 6u);
+}
+
+TEST(BlobTransferTest, ReassemblesLargePackage) {
+    const std::string message(200 * 1024, 'm');
+    std::unique_ptr<Package<TestMessage>> package = Package<TestMessage>::CreateUnique(TestMessage::BLOB, std::string(message));
+    package->GetHeader().flags = static_cast<uint8_t>(PackageFlag::FILE_REQUEST);
+
+    const std::unique_ptr<OutgoingBlob> blob = OutgoingBlob::FromPackage(3, std::move(package));
+    BlobAssembler<TestMessage> assembler;
+    std::unique_ptr<Package<TestMessage>> completed;
+
+    while (!blob->IsFinished()) {
+        ASSERT_EQ(completed, nullptr);
+        ASSERT_TRUE(assembler.Receive(*blob->NextFragment<TestMessage>(), completed));
+    }
+
+    ASSERT_NE(completed, nullptr);
+    EXPECT_EQ(completed->GetHeader().flags, static_cast<uint8_t>(PackageFlag::FILE_REQUEST));
+    EXPECT_EQ(assembler.GetIncomingCount(), 0u);
+
+    std::string result;
+    completed->GetValue(result);
+    EXPECT_EQ(result, message);
+}
+
+TEST(BlobTransferTest, DeliversIntoCallerBufferAndStreams) {
+    const auto data = MakeBlob(300 * 1024);
+    std::vector<char> destination(data->size());
+    std::vector<char> streamed;
+    bool completedBuffer = false;
+    bool completedStream = false;
+
+    BlobAssembler<TestMessage> assembler;
+    assembler.SetHandler(TestMessage::BLOB, {
+        [&](size_t, const FileSizeInt size) { return size == destination.size() ? destination.data() : nullptr; },
+        [&](size_t, const FileSizeInt offset, const char* bytes, const size_t size) {
+            EXPECT_EQ(offset, streamed.size());
+            streamed.insert(streamed.end(), bytes, bytes + size);
+            return true;
+        },
+        [&](const size_t blobID, FileSizeInt, const bool completed) { (blobID == 1 ? completedBuffer : completedStream) = completed; }
+    });
+
+    const auto smaller = MakeBlob(100 * 1024);
+    OutgoingBlob first = MakeOutgoing(1, data);
+    OutgoingBlob second = MakeOutgoing(2, smaller);
+    std::unique_ptr<Package<TestMessage>> completed;
+
+    while (!first.IsFinished() || !second.IsFinished()) {
+        if (!first.IsFinished()) {
+            ASSERT_TRUE(assembler.Receive(*first.NextFragment<TestMessage>(), completed));
+        }
+
+        if (!second.IsFinished()) {
+            ASSERT_TRUE(assembler.Receive(*second.NextFragment<TestMessage>(), completed));
+        }
+
+        EXPECT_EQ(completed, nullptr);
+    }
+
+    EXPECT_TRUE(completedBuffer);
+    EXPECT_TRUE(completedStream);
+    EXPECT_EQ(destination, *data);
+    EXPECT_EQ(streamed, *smaller);
+}
+
+TEST(BlobTransferTest, RejectsOutOfOrderFragments) {
+    const auto data = MakeBlob(3 * BLOB_FRAGMENT_MAX_DATA_SIZE);
+    OutgoingBlob blob = MakeOutgoing(7, data);
+    BlobAssembler<TestMessage> assembler;
+    std::unique_ptr<Package<TestMessage>> completed;
+
+    const std::unique_ptr<Package<TestMessage>> first = blob.NextFragment<TestMessage>();
+    const std::unique_ptr<Package<TestMessage>> second = blob.NextFragment<TestMessage>();
+
+    EXPECT_FALSE(assembler.Receive(*second, completed));
+    ASSERT_TRUE(assembler.Receive(*first, completed));
+    EXPECT_FALSE(assembler.Receive(*first, completed));
+}
+
+TEST(BlobTransferTest, CapsBytesBufferedForReassembly) {
+    const auto data = MakeBlob(MAX_BLOB_ASSEMBLY_SIZE / 2 + BLOB_FRAGMENT_MAX_DATA_SIZE);
+
+    BlobAssembler<TestMessage> assembler;
+    std::unique_ptr<Package<TestMessage>> completed;
+
+    OutgoingBlob first = MakeOutgoing(1, data);
+    OutgoingBlob second = MakeOutgoing(2, data);
+
+    ASSERT_TRUE(assembler.Receive(*first.NextFragment<TestMessage>(), completed));
+    EXPECT_EQ(assembler.GetAssemblySize(), BLOB_FRAGMENT_MAX_DATA_SIZE);
+
+    bool rejected = false;
+    while (!rejected && !first.IsFinished()) {
+        rejected = !assembler.Receive(*first.NextFragment<TestMessage>(), completed) || !assembler.Receive(*second.NextFragment<TestMessage>(), completed);
+    }
+
+    EXPECT_TRUE(rejected);
+    EXPECT_LE(assembler.GetAssemblySize(), MAX_BLOB_ASSEMBLY_SIZE);
+
+    assembler.Abort();
+    EXPECT_EQ(assembler.GetAssemblySize(), 0u);
+
+    OutgoingBlob retry = MakeOutgoing(3, data);
+    while (!retry.IsFinished()) {
+        ASSERT_TRUE(assembler.Receive(*retry.NextFragment<TestMessage>(), completed));
+    }
+
+    ASSERT_NE(completed, nullptr);
+    EXPECT_EQ(assembler.GetAssemblySize(), 0u);
+}
+
+TEST(BlobTransferTest, OversizedBlobNeedsHandler) {
+    const auto data = MakeBlob(BLOB_FRAGMENT_MAX_DATA_SIZE);
+
+    BlobAssembler<TestMessage> assembler;
+    std::unique_ptr<Package<TestMessage>> completed;
+
+    OutgoingBlob claimed(1, static_cast<PackageTypeInt>(TestMessage::BLOB), 0, data->data(), MAX_BLOB_PACKAGE_SIZE + 1, data);
+    EXPECT_FALSE(assembler.Receive(*claimed.NextFragment<TestMessage>(), completed));
+    EXPECT_EQ(assembler.GetAssemblySize(), 0u);
+
+    FileSizeInt consumed = 0;
+    assembler.SetHandler(TestMessage::BLOB, {nullptr, [&](size_t, FileSizeInt, const char*, const size_t size) {
+        consumed += size;
+        return true;
+    }, nullptr});
+
+    OutgoingBlob streamed(2, static_cast<PackageTypeInt>(TestMessage::BLOB), 0, data->data(), MAX_BLOB_PACKAGE_SIZE + 1, data);
+    EXPECT_TRUE(assembler.Receive(*streamed.NextFragment<TestMessage>(), completed));
+    EXPECT_EQ(consumed, BLOB_FRAGMENT_MAX_DATA_SIZE);
+    EXPECT_EQ(assembler.GetAssemblySize(), 0u);
+}
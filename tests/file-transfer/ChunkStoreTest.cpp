@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+#include <FileTransfer.h>
+#include <Settings.h>
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <set>
+
+static std::string CreateRandomData(const size_t size, const uint32_t seed) {
+    std::mt19937 generator(seed);
+    std::string data(size, '\0');
+
+    for (char& byte : data) {
+        byte = static_cast<char>(generator());
+    }
+
+    return data;
+}
+
+static void WriteFile(const std::filesystem::path& path, const std::string& data) {
+    std::ofstream(path, std::ios::binary).write(data.data(), static_cast<std::streamsize>(data.size()));
+}
+
+static std::string ReadFile(const std::filesystem::path& path) {
+    std::ifstream stream(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()};
+}
+
+static std::set<ChunkHash> ChunkData(const std::string& data) {
+    std::set<ChunkHash> hashes;
+    for (size_t position = 0; position < data.size();) {
+        const size_t size = ContentDefinedChunker::FindBoundary(data.data() + position, data.size() - position);
+        EXPECT_LE(size, CHUNK_STORE_MAX_CHUNK_SIZE);
+
+        hashes.insert(ChunkStore::ComputeHash(data.data() + position, size));
+        position += size;
+    }
+
+    return hashes;
+}
+
+TEST(ChunkStoreTest, BoundariesSurviveInsertions) {
+    const std::string original = CreateRandomData(8 * 1024 * 1024, 1);
+    std::string shifted = original;
+    shifted.insert(1000, "inserted bytes");
+
+    const std::set<ChunkHash> originalChunks = ChunkData(original);
+    const std::set<ChunkHash> shiftedChunks = ChunkData(shifted);
+
+    size_t shared = 0;
+    for (const ChunkHash& hash : shiftedChunks) {
+        shared += originalChunks.contains(hash);
+    }
+
+    EXPECT_GE(shared + 2, originalChunks.size());
+    EXPECT_GT(originalChunks.size(), 8 * 1024 * 1024 / CHUNK_STORE_MAX_CHUNK_SIZE);
+}
+
+TEST(ChunkStoreTest, TransfersOnlyMissingChunks) {
+    std::filesystem::remove_all("chunk_store_test");
+    P2PSettings::SetChunkStoreDirectory("chunk_store_test");
+
+    const std::string basis = CreateRandomData(6 * 1024 * 1024, 2);
+    std::string related = CreateRandomData(512 * 1024, 3) + basis.substr(2 * 1024 * 1024) + basis.substr(0, 1024 * 1024);
+
+    WriteFile("chunk_basis.bin", basis);
+    WriteFile("chunk_related.bin", related);
+    ASSERT_TRUE(ChunkStore::Import("chunk_basis.bin"));
+
+    const std::vector<uint8_t> manifest = ChunkStore::ComputeManifest("chunk_related.bin");
+    const std::vector<uint8_t> missing = ChunkStore::FindMissing(manifest);
+    EXPECT_EQ(manifest.size() % CHUNK_STORE_HASH_SIZE, 0u);
+    EXPECT_LT(missing.size(), manifest.size() / 2);
+
+    ChunkedFileSource source(0, FILE_TRANSFER_DEFAULT_WEIGHT, "chunk_related.bin", ChunkStore::Subtract(manifest, missing));
+    ASSERT_TRUE(source.Open());
+
+    std::filesystem::remove("chunk_result.bin");
+    ChunkedFileSink sink("chunk_result.bin", source.GetTotalSize());
+    ASSERT_TRUE(sink.Open());
+
+    FileSizeInt sent = 0;
+    std::vector<char> buffer;
+
+    while (!source.IsFinished()) {
+        ASSERT_TRUE(source.Read());
+        buffer = source.GetChunk();
+        sent += buffer.size();
+
+        ASSERT_LE(buffer.size(), FILE_CHUNK_MAX_SIZE);
+        ASSERT_TRUE(sink.Write(buffer, buffer.size()));
+    }
+
+    ASSERT_TRUE(sink.Finish(source.Finish()));
+    EXPECT_TRUE(sink.IsVerified());
+
+    EXPECT_EQ(ReadFile("chunk_result.bin"), related);
+    EXPECT_LT(sent, related.size() / 4);
+
+    std::filesystem::remove_all("chunk_store_test");
+    P2PSettings::SetChunkStoreDirectory(".chunk-store");
+}
+
+TEST(ChunkStoreTest, DigestMismatchKeepsPreviousFile) {
+    std::filesystem::remove_all("chunk_store_test");
+    P2PSettings::SetChunkStoreDirectory("chunk_store_test");
+
+    const std::string data = CreateRandomData(1024 * 1024, 4);
+    WriteFile("chunk_mismatch.bin", data);
+    WriteFile("chunk_mismatch_result.bin", "previous");
+
+    const std::vector<uint8_t> manifest = ChunkStore::ComputeManifest("chunk_mismatch.bin");
+    ChunkedFileSource source(0, FILE_TRANSFER_DEFAULT_WEIGHT, "chunk_mismatch.bin", ChunkStore::Subtract(manifest, ChunkStore::FindMissing(manifest)));
+    ASSERT_TRUE(source.Open());
+
+    ChunkedFileSink sink("chunk_mismatch_result.bin", source.GetTotalSize());
+    ASSERT_TRUE(sink.Open());
+
+    std::vector<char> buffer;
+    while (!source.IsFinished()) {
+        ASSERT_TRUE(source.Read());
+        buffer = source.GetChunk();
+        ASSERT_TRUE(sink.Write(buffer, buffer.size()));
+    }
+
+    HashDigest digest = source.Finish();
+    digest[0] ^= 0xFF;
+
+    ASSERT_TRUE(sink.Finish(digest));
+    EXPECT_FALSE(sink.IsVerified());
+    EXPECT_EQ(ReadFile("chunk_mismatch_result.bin"), "previous");
+
+    std::filesystem::remove_all("chunk_store_test");
+    P2PSettings::SetChunkStoreDirectory(".chunk-store");
+}
+
+TEST(ChunkStoreTest, ManifestListsOnlyTheFilesChunks) {
+    std::filesystem::remove_all("chunk_store_test");
+    P2PSettings::SetChunkStoreDirectory("chunk_store_test");
+
+    const std::string stored = CreateRandomData(2 * 1024 * 1024, 5);
+    const std::string requested = CreateRandomData(1024 * 1024, 6);
+
+    WriteFile("chunk_stored.bin", stored);
+    WriteFile("chunk_requested.bin", requested);
+    ASSERT_TRUE(ChunkStore::Import("chunk_stored.bin"));
+
+    const std::vector<uint8_t> manifest = ChunkStore::ComputeManifest("chunk_requested.bin");
+    EXPECT_EQ(manifest.size(), ChunkData(requested).size() * CHUNK_STORE_HASH_SIZE);
+    EXPECT_EQ(ChunkStore::FindMissing(manifest), manifest);
+    EXPECT_TRUE(ChunkStore::Subtract(manifest, manifest).empty());
+
+    const std::vector<uint8_t> limited = ChunkStore::ComputeManifest("chunk_requested.bin", 2);
+    EXPECT_EQ(limited.size(), 2 * CHUNK_STORE_HASH_SIZE);
+
+    std::filesystem::remove_all("chunk_store_test");
+    P2PSettings::SetChunkStoreDirectory(".chunk-store");
+}
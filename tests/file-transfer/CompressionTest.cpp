@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include <Compression.h>
+#include <Package.h>
+
+#include <random>
+#include <string>
+
+namespace {
+    enum class TestMessage : PackageTypeInt {
+        TEXT
+    };
+
+    std::vector<char> MakeText(const size_t size) {
+        const std::string line = "The quick brown fox jumps over the lazy dog 0123456789\n";
+        std::vector<char> text;
+        text.reserve(size);
+
+        while (text.size() < size) {
+            text.push_back(line[text.size() % line.size()]);
+        }
+
+        return text;
+    }
+
+    std::vector<char> MakeRandom(const size_t size) {
+        std::mt19937 generator(42);
+        std::uniform_int_distribution<int> distribution(0, 255);
+        std::vector<char> data(size);
+
+        for (char& byte : data) {
+            byte = static_cast<char>(distribution(generator));
+        }
+
+        return data;
+    }
+}
+
+class CompressionRoundTripTest : public testing::TestWithParam<CompressionAlgorithm> {};
+
+TEST_P(CompressionRoundTripTest, TextSurvivesRoundTrip) {
+    const std::vector<char> text = MakeText(256 * 1024);
+    std::vector<char> compressed;
+    std::vector<char> decompressed;
+
+    ASSERT_TRUE(Compression::Compress(GetParam(), text.data(), text.size(), compressed));
+    EXPECT_LT(compressed.size(), text.size() / 4);
+
+    CompressionAlgorithm algorithm;
+    uint32_t originalSize;
+    ASSERT_TRUE(Compression::ReadHeader(compressed.data(), compressed.size(), algorithm, originalSize));
+    EXPECT_EQ(algorithm, GetParam());
+    EXPECT_EQ(originalSize, text.size());
+
+    ASSERT_TRUE(Compression::Decompress(compressed.data(), compressed.size(), decompressed, text.size()));
+    EXPECT_EQ(decompressed, text);
+}
+
+INSTANTIATE_TEST_SUITE_P(Algorithms, CompressionRoundTripTest, testing::Values(CompressionAlgorithm::LZ4, CompressionAlgorithm::ZSTD));
+
+TEST(CompressionTest, HighEntropyDataIsSentRaw) {
+    const std::vector<char> random = MakeRandom(64 * 1024);
+    std::vector<char> compressed;
+
+    EXPECT_GT(Compression::EstimateEntropy(random.data(), random.size()), COMPRESSION_MAX_ENTROPY);
+    EXPECT_FALSE(Compression::IsWorthCompressing(random.data(), random.size()));
+    EXPECT_FALSE(Compression::Compress(CompressionAlgorithm::LZ4, random.data(), random.size(), compressed));
+}
+
+TEST(CompressionTest, NegotiationFallsBackToCommonAlgorithm) {
+    const uint8_t lz4Only = 1 << static_cast<uint8_t>(CompressionAlgorithm::LZ4);
+
+    EXPECT_EQ(Compression::Negotiate(CompressionAlgorithm::NONE, Compression::GetSupportedAlgorithms()), CompressionAlgorithm::NONE);
+    EXPECT_EQ(Compression::Negotiate(CompressionAlgorithm::ZSTD, Compression::GetSupportedAlgorithms()), CompressionAlgorithm::ZSTD);
+    EXPECT_EQ(Compression::Negotiate(CompressionAlgorithm::ZSTD, lz4Only), CompressionAlgorithm::LZ4);
+    EXPECT_EQ(Compression::Negotiate(CompressionAlgorithm::LZ4, 0), CompressionAlgorithm::NONE);
+}
+
+TEST(CompressionTest, CorruptedPayloadIsRejected) {
+    const std::vector<char> text = MakeText(64 * 1024);
+    std::vector<char> compressed;
+    std::vector<char> decompressed;
+
+    ASSERT_TRUE(Compression::Compress(CompressionAlgorithm::ZSTD, text.data(), text.size(), compressed));
+    compressed.resize(compressed.size() / 2);
+
+    EXPECT_FALSE(Compression::Decompress(compressed.data(), compressed.size(), decompressed, text.size()));
+    EXPECT_FALSE(Compression::Decompress(compressed.data(), compressed.size(), decompressed, text.size() - 1));
+}
+
+TEST(CompressionTest, PackageBodySurvivesRoundTrip) {
+    const std::string message(4096, 'a');
+    const std::unique_ptr<Package<TestMessage>> package = Package<TestMessage>::CreateUnique(TestMessage::TEXT, std::string(message));
+
+    const std::unique_ptr<Package<TestMessage>> compressed = package->Compress(CompressionAlgorithm::LZ4);
+    ASSERT_NE(compressed, nullptr);
+    EXPECT_NE(compressed->GetHeader().flags & static_cast<uint8_t>(PackageFlag::COMPRESSED), 0);
+    EXPECT_LT(compressed->GetHeader().size, package->GetHeader().size);
+
+    const std::unique_ptr<Package<TestMessage>> decompressed = compressed->Decompress();
+    ASSERT_NE(decompressed, nullptr);
+    EXPECT_EQ(decompressed->GetHeader().flags & static_cast<uint8_t>(PackageFlag::COMPRESSED), 0);
+    EXPECT_EQ(decompressed->GetHeader().size, package->GetHeader().size);
+
+    std::string result;
+    decompressed->GetValue(result);
+    EXPECT_EQ(result, message);
+}
@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+#include <DeltaSync.h>
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+static std::string CreateRandomData(const size_t size, const uint32_t seed) {
+    std::mt19937 random(seed);
+    std::string data(size, '\0');
+
+    for (auto& byte : data) {
+        byte = static_cast<char>(random());
+    }
+
+    return data;
+}
+
+static void WriteFile(const std::filesystem::path& path, const std::string& data) {
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    stream.write(data.data(), static_cast<std::streamsize>(data.size()));
+}
+
+static std::string ReadFile(const std::filesystem::path& path) {
+    std::ifstream stream(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()};
+}
+
+struct DeltaResult {
+    size_t literalBytes{0};
+    size_t copiedBlocks{0};
+};
+
+static DeltaResult Synchronize(const std::string& basis, const std::string& source) {
+    WriteFile("delta_basis.bin", basis);
+    WriteFile("delta_source.bin", source);
+
+    DeltaSignature signature;
+    EXPECT_TRUE(DeltaSync::ComputeSignature("delta_basis.bin", signature));
+    const PackageSizeInt blockSize = signature.blockSize;
+
+    DeltaEncoder encoder(std::move(signature));
+    EXPECT_TRUE(encoder.Open("delta_source.bin"));
+
+    DeltaPatcher patcher("delta_basis.bin", blockSize);
+    EXPECT_TRUE(patcher.Open());
+
+    DeltaResult result;
+    std::vector<char> instructions;
+    bool finished = false;
+
+    while (encoder.Next(instructions)) {
+        size_t offset = 0;
+        while (offset < instructions.size()) {
+            const auto [instruction, value] = DeltaSync::ReadInstruction(instructions.data() + offset);
+            offset += DELTA_INSTRUCTION_HEADER_SIZE;
+
+            if (instruction == DeltaInstruction::COPY) {
+                EXPECT_TRUE(patcher.ApplyCopy(value));
+                ++result.copiedBlocks;
+            } else if (instruction == DeltaInstruction::LITERAL) {
+                EXPECT_LE(value, DELTA_MAX_LITERAL_SIZE);
+                EXPECT_TRUE(patcher.ApplyLiteral(instructions.data() + offset, value));
+                offset += value;
+                result.literalBytes += value;
+            } else {
+                finished = true;
+            }
+        }
+    }
+
+    EXPECT_TRUE(finished);
+    EXPECT_EQ(patcher.GetWrittenSize(), source.size());
+    EXPECT_TRUE(patcher.Commit());
+    EXPECT_EQ(ReadFile("delta_basis.bin"), source);
+
+    return result;
+}
+
+TEST(DeltaSyncTest, RollingChecksumMatchesReset) {
+    const std::string data = CreateRandomData(4096, 1);
+    constexpr size_t window = 1024;
+
+    RollingChecksum rolling;
+    rolling.Reset(data.data(), window);
+
+    for (size_t i = 1; i + window <= data.size(); ++i) {
+        rolling.Roll(static_cast<uint8_t>(data[i - 1]), static_cast<uint8_t>(data[i + window - 1]));
+
+        RollingChecksum fresh;
+        fresh.Reset(data.data() + i, window);
+        ASSERT_EQ(rolling.GetValue(), fresh.GetValue());
+    }
+}
+
+TEST(DeltaSyncTest, IdenticalFileSendsOnlyTail) {
+    const std::string data = CreateRandomData(1024 * 1024 + 333, 2);
+    const DeltaResult result = Synchronize(data, data);
+
+    EXPECT_LT(result.literalBytes, DeltaSync::GetBlockSize(data.size()));
+    EXPECT_GT(result.copiedBlocks, 0u);
+}
+
+TEST(DeltaSyncTest, InsertedBytesAreRealigned) {
+    const std::string basis = CreateRandomData(2 * 1024 * 1024, 3);
+    std::string source = basis;
+    source.insert(700 * 1024 + 17, "inserted bytes that shift everything after them");
+    source.erase(1500 * 1024, 100);
+
+    const DeltaResult result = Synchronize(basis, source);
+
+    EXPECT_LT(result.literalBytes, 8 * DeltaSync::GetBlockSize(basis.size()));
+}
+
+TEST(DeltaSyncTest, UnrelatedFileIsSentAsLiterals) {
+    const std::string basis = CreateRandomData(256 * 1024, 4);
+    const std::string source = CreateRandomData(300 * 1024, 5);
+
+    const DeltaResult result = Synchronize(basis, source);
+
+    EXPECT_EQ(result.copiedBlocks, 0u);
+    EXPECT_EQ(result.literalBytes, source.size());
+}
+
+TEST(DeltaSyncTest, CopyOutOfRangeIsRejected) {
+    WriteFile("delta_basis.bin", CreateRandomData(DELTA_MIN_BLOCK_SIZE * 2, 6));
+
+    DeltaPatcher patcher("delta_basis.bin", DELTA_MIN_BLOCK_SIZE);
+    ASSERT_TRUE(patcher.Open());
+    EXPECT_TRUE(patcher.ApplyCopy(1));
+    EXPECT_FALSE(patcher.ApplyCopy(2));
+    patcher.Abort();
+}
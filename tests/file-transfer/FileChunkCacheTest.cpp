@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+#include <FileTransfer.h>
+
+#include <filesystem>
+#include <fstream>
+
+static void WriteFile(const std::filesystem::path& path, const std::string& data) {
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    stream.write(data.data(), static_cast<std::streamsize>(data.size()));
+}
+
+static std::string Serve(const std::filesystem::path& path, HashDigest& digest, const PackageSizeInt chunkSize = FILE_BUFFER_SIZE) {
+    RangeFileSource source(0, FILE_TRANSFER_DEFAULT_WEIGHT, path, 0, 0);
+    EXPECT_TRUE(source.Open());
+    source.SetChunkSize(chunkSize);
+
+    std::string data;
+    while (!source.IsFinished()) {
+        EXPECT_TRUE(source.Read());
+        data.append(source.GetChunk().begin(), source.GetChunk().end());
+        source.Release();
+    }
+
+    digest = source.Finish();
+    return data;
+}
+
+static std::shared_ptr<const std::vector<char>> CreateChunk(const size_t size) {
+    return std::make_shared<const std::vector<char>>(size);
+}
+
+TEST(FileChunkCacheTest, RepeatedRequestsAreServedFromCache) {
+    FileChunkCache::Clear();
+    const std::string content(3 * FILE_BUFFER_SIZE + 99, 'x');
+    WriteFile("cache_source.bin", content);
+
+    HashDigest firstDigest{};
+    HashDigest secondDigest{};
+    EXPECT_EQ(Serve("cache_source.bin", firstDigest), content);
+    EXPECT_EQ(Serve("cache_source.bin", secondDigest), content);
+    EXPECT_EQ(firstDigest, secondDigest);
+
+    const FileChunkCacheStats stats = FileChunkCache::GetStats();
+    EXPECT_EQ(stats.misses, 4u);
+    EXPECT_EQ(stats.hits, 4u);
+    EXPECT_EQ(stats.bytesSaved, content.size());
+    EXPECT_DOUBLE_EQ(stats.GetHitRate(), 0.5);
+}
+
+TEST(FileChunkCacheTest, DifferentChunkSizesShareCachedBlocks) {
+    FileChunkCache::Clear();
+    std::string content(4 * FILE_CHUNK_CACHE_BLOCK_SIZE + 321, '\0');
+    for (size_t i = 0; i < content.size(); ++i) {
+        content[i] = static_cast<char>(i * 131 % 251);
+    }
+
+    WriteFile("cache_blocks.bin", content);
+
+    HashDigest firstDigest{};
+    HashDigest secondDigest{};
+    HashDigest thirdDigest{};
+    EXPECT_EQ(Serve("cache_blocks.bin", firstDigest, FILE_BUFFER_SIZE), content);
+    EXPECT_EQ(Serve("cache_blocks.bin", secondDigest, 3 * FILE_BUFFER_SIZE / 4), content);
+    EXPECT_EQ(Serve("cache_blocks.bin", thirdDigest, FILE_CHUNK_MAX_SIZE), content);
+
+    EXPECT_EQ(firstDigest, secondDigest);
+    EXPECT_EQ(firstDigest, thirdDigest);
+
+    const FileChunkCacheStats stats = FileChunkCache::GetStats();
+    EXPECT_EQ(stats.misses, 5u);
+    EXPECT_EQ(stats.size, content.size());
+}
+
+TEST(FileChunkCacheTest, ModifiedFileIsNotServedStale) {
+    FileChunkCache::Clear();
+    WriteFile("cache_modified.bin", std::string(FILE_BUFFER_SIZE, 'a'));
+
+    HashDigest digest{};
+    EXPECT_EQ(Serve("cache_modified.bin", digest), std::string(FILE_BUFFER_SIZE, 'a'));
+
+    const std::string updated(FILE_BUFFER_SIZE + 1, 'b');
+    WriteFile("cache_modified.bin", updated);
+
+    EXPECT_EQ(Serve("cache_modified.bin", digest), updated);
+    EXPECT_EQ(FileChunkCache::GetStats().hits, 0u);
+}
+
+TEST(FileChunkCacheTest, EvictsLeastRecentlyUsedChunks) {
+    FileChunkCache::Clear();
+    const size_t previousCapacity = FileChunkCache::GetCapacity();
+    FileChunkCache::SetCapacity(2 * FILE_BUFFER_SIZE);
+
+    const FileChunkKey first{"a", 1, 10, 0};
+    const FileChunkKey second{"b", 1, 10, 0};
+    const FileChunkKey third{"c", 1, 10, 0};
+
+    FileChunkCache::Insert(first, CreateChunk(FILE_BUFFER_SIZE));
+    FileChunkCache::Insert(second, CreateChunk(FILE_BUFFER_SIZE));
+    EXPECT_NE(FileChunkCache::Find(first), nullptr);
+
+    FileChunkCache::Insert(third, CreateChunk(FILE_BUFFER_SIZE));
+
+    EXPECT_NE(FileChunkCache::Find(first), nullptr);
+    EXPECT_EQ(FileChunkCache::Find(second), nullptr);
+    EXPECT_NE(FileChunkCache::Find(third), nullptr);
+    EXPECT_EQ(FileChunkCache::GetStats().size, 2 * FILE_BUFFER_SIZE);
+
+    FileChunkCache::SetCapacity(previousCapacity);
+}
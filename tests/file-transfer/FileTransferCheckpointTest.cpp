@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+#include <FileTransferCheckpoint.h>
+
+#include <filesystem>
+
+static void RemoveCheckpointFiles(const std::filesystem::path& path) {
+    std::filesystem::remove(path);
+    std::filesystem::remove(FileTransferCheckpoint::GetSidecarPath(path));
+}
+
+TEST(FileTransferCheckpointTest, FreshCheckpointIsNotStarted) {
+    RemoveCheckpointFiles("checkpoint_fresh.bin");
+
+    const auto checkpoint = FileTransferCheckpoint::Acquire("checkpoint_fresh.bin");
+
+    EXPECT_FALSE(checkpoint->IsStarted());
+    EXPECT_FALSE(checkpoint->IsComplete());
+    EXPECT_TRUE(checkpoint->GetMissingRanges().empty());
+}
+
+TEST(FileTransferCheckpointTest, MissingRangesMergeAdjacentChunks) {
+    RemoveCheckpointFiles("checkpoint_ranges.bin");
+
+    const auto checkpoint = FileTransferCheckpoint::Acquire("checkpoint_ranges.bin");
+    constexpr FileSizeInt totalSize = 4 * FILE_CHECKPOINT_CHUNK_SIZE + 100;
+
+    checkpoint->Reset(totalSize);
+    checkpoint->MarkReceived(FILE_CHECKPOINT_CHUNK_SIZE, FILE_CHECKPOINT_CHUNK_SIZE);
+
+    const auto ranges = checkpoint->GetMissingRanges();
+    ASSERT_EQ(ranges.size(), 2u);
+    EXPECT_EQ(ranges[0].first, 0u);
+    EXPECT_EQ(ranges[0].second, FILE_CHECKPOINT_CHUNK_SIZE);
+    EXPECT_EQ(ranges[1].first, 2 * FILE_CHECKPOINT_CHUNK_SIZE);
+    EXPECT_EQ(ranges[1].second, 2 * FILE_CHECKPOINT_CHUNK_SIZE + 100);
+}
+
+TEST(FileTransferCheckpointTest, PartialChunksAreNotMarked) {
+    RemoveCheckpointFiles("checkpoint_partial.bin");
+
+    const auto checkpoint = FileTransferCheckpoint::Acquire("checkpoint_partial.bin");
+    checkpoint->Reset(2 * FILE_CHECKPOINT_CHUNK_SIZE);
+    checkpoint->MarkReceived(0, FILE_CHECKPOINT_CHUNK_SIZE + FILE_CHECKPOINT_CHUNK_SIZE / 2);
+
+    const auto ranges = checkpoint->GetMissingRanges();
+    ASSERT_EQ(ranges.size(), 1u);
+    EXPECT_EQ(ranges[0].first, FILE_CHECKPOINT_CHUNK_SIZE);
+    EXPECT_EQ(ranges[0].second, FILE_CHECKPOINT_CHUNK_SIZE);
+
+    checkpoint->MarkReceived(0, 2 * FILE_CHECKPOINT_CHUNK_SIZE);
+    EXPECT_TRUE(checkpoint->IsComplete());
+}
+
+TEST(FileTransferCheckpointTest, SaveAndReload) {
+    RemoveCheckpointFiles("checkpoint_reload.bin");
+
+    {
+        const auto checkpoint = FileTransferCheckpoint::Acquire("checkpoint_reload.bin");
+        checkpoint->Reset(3 * FILE_CHECKPOINT_CHUNK_SIZE);
+        checkpoint->MarkReceived(0, FILE_CHECKPOINT_CHUNK_SIZE);
+        ASSERT_TRUE(checkpoint->Save());
+    }
+
+    ASSERT_TRUE(std::filesystem::exists(FileTransferCheckpoint::GetSidecarPath("checkpoint_reload.bin")));
+
+    const auto checkpoint = FileTransferCheckpoint::Acquire("checkpoint_reload.bin");
+    EXPECT_TRUE(checkpoint->IsStarted());
+    EXPECT_EQ(checkpoint->GetTotalSize(), 3 * FILE_CHECKPOINT_CHUNK_SIZE);
+
+    const auto ranges = checkpoint->GetMissingRanges();
+    ASSERT_EQ(ranges.size(), 1u);
+    EXPECT_EQ(ranges[0].first, FILE_CHECKPOINT_CHUNK_SIZE);
+    EXPECT_EQ(ranges[0].second, 2 * FILE_CHECKPOINT_CHUNK_SIZE);
+
+    checkpoint->Remove();
+    EXPECT_FALSE(std::filesystem::exists(FileTransferCheckpoint::GetSidecarPath("checkpoint_reload.bin")));
+}
+
+TEST(FileTransferCheckpointTest, MarkMissingClearsRange) {
+    RemoveCheckpointFiles("checkpoint_missing.bin");
+
+    const auto checkpoint = FileTransferCheckpoint::Acquire("checkpoint_missing.bin");
+    checkpoint->Reset(3 * FILE_CHECKPOINT_CHUNK_SIZE);
+    checkpoint->MarkReceived(0, 3 * FILE_CHECKPOINT_CHUNK_SIZE);
+    ASSERT_TRUE(checkpoint->IsComplete());
+
+    checkpoint->MarkMissing(FILE_CHECKPOINT_CHUNK_SIZE, 1);
+
+    const auto ranges = checkpoint->GetMissingRanges();
+    ASSERT_EQ(ranges.size(), 1u);
+    EXPECT_EQ(ranges[0].first, FILE_CHECKPOINT_CHUNK_SIZE);
+    EXPECT_EQ(ranges[0].second, FILE_CHECKPOINT_CHUNK_SIZE);
+}
+
+TEST(FileTransferCheckpointTest, AcquireSharesInstance) {
+    RemoveCheckpointFiles("checkpoint_shared.bin");
+
+    const auto first = FileTransferCheckpoint::Acquire("checkpoint_shared.bin");
+    const auto second = FileTransferCheckpoint::Acquire("./checkpoint_shared.bin");
+
+    EXPECT_EQ(first.get(), second.get());
+}
+
+TEST(FileTransferCheckpointTest, RangesBeyondFourGiB) {
+    RemoveCheckpointFiles("checkpoint_large.bin");
+
+    constexpr FileSizeInt totalSize = 10ull * 1024 * 1024 * 1024 + 7;
+    constexpr FileSizeInt missingOffset = 6ull * 1024 * 1024 * 1024;
+
+    {
+        const auto checkpoint = FileTransferCheckpoint::Acquire("checkpoint_large.bin");
+        checkpoint->Reset(totalSize);
+        checkpoint->MarkReceived(0, missingOffset);
+        checkpoint->MarkReceived(missingOffset + FILE_CHECKPOINT_CHUNK_SIZE, totalSize - missingOffset - FILE_CHECKPOINT_CHUNK_SIZE);
+        ASSERT_TRUE(checkpoint->Save());
+    }
+
+    const auto checkpoint = FileTransferCheckpoint::Acquire("checkpoint_large.bin");
+    EXPECT_EQ(checkpoint->GetTotalSize(), totalSize);
+
+    const auto ranges = checkpoint->GetMissingRanges();
+    ASSERT_EQ(ranges.size(), 1u);
+    EXPECT_EQ(ranges[0].first, missingOffset);
+    EXPECT_EQ(ranges[0].second, FILE_CHECKPOINT_CHUNK_SIZE);
+
+    checkpoint->Remove();
+}
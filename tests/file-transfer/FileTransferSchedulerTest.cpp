@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+#include <FileTransferScheduler.h>
+
+#include <filesystem>
+#include <fstream>
+#include <map>
+
+static std::unique_ptr<FileTransferSource> CreateSource(const size_t requestID, const size_t size, const uint8_t weight = FILE_TRANSFER_DEFAULT_WEIGHT) {
+    const std::filesystem::path path = "scheduler_" + std::to_string(requestID) + ".bin";
+    {
+        std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+        const std::string data(size, static_cast<char>(requestID));
+        stream.write(data.data(), static_cast<std::streamsize>(data.size()));
+    }
+
+    auto source = std::make_unique<RangeFileSource>(requestID, weight, path, 0, 0);
+    EXPECT_TRUE(source->Open());
+    return source;
+}
+
+static std::vector<size_t> Drain(FileTransferScheduler& scheduler) {
+    std::vector<size_t> order;
+
+    while (FileTransferSource* source = scheduler.Next()) {
+        EXPECT_TRUE(source->Read());
+        order.push_back(source->GetRequestID());
+
+        scheduler.Charge(source, static_cast<PackageSizeInt>(source->GetChunk().size()));
+        source->Release();
+
+        if (source->IsFinished()) {
+            scheduler.Remove(source);
+        }
+    }
+
+    return order;
+}
+
+TEST(FileTransferSchedulerTest, RoundRobinInterleavesTransfers) {
+    FileTransferScheduler scheduler(FileSchedulingPolicy::ROUND_ROBIN);
+    scheduler.Add(CreateSource(1, 3 * FILE_BUFFER_SIZE));
+    scheduler.Add(CreateSource(2, FILE_BUFFER_SIZE));
+    scheduler.Add(CreateSource(3, 2 * FILE_BUFFER_SIZE));
+
+    EXPECT_EQ(Drain(scheduler), (std::vector<size_t>{1, 2, 3, 1, 3, 1}));
+    EXPECT_TRUE(scheduler.IsEmpty());
+}
+
+TEST(FileTransferSchedulerTest, ShortestRemainingFirstFinishesSmallTransfers) {
+    FileTransferScheduler scheduler(FileSchedulingPolicy::SHORTEST_REMAINING_FIRST);
+    scheduler.Add(CreateSource(1, 4 * FILE_BUFFER_SIZE));
+    scheduler.Add(CreateSource(2, 2048));
+    scheduler.Add(CreateSource(3, FILE_BUFFER_SIZE + 1));
+
+    EXPECT_EQ(Drain(scheduler), (std::vector<size_t>{2, 3, 3, 1, 1, 1, 1}));
+}
+
+TEST(FileTransferSchedulerTest, WeightedSharesBandwidthProportionally) {
+    FileTransferScheduler scheduler(FileSchedulingPolicy::WEIGHTED);
+    scheduler.Add(CreateSource(1, 40 * FILE_BUFFER_SIZE, 3));
+    scheduler.Add(CreateSource(2, 40 * FILE_BUFFER_SIZE, 1));
+
+    std::map<size_t, size_t> chunks;
+    for (size_t i = 0; i < 20; ++i) {
+        FileTransferSource* source = scheduler.Next();
+        ASSERT_NE(source, nullptr);
+        ASSERT_TRUE(source->Read());
+
+        ++chunks[source->GetRequestID()];
+        scheduler.Charge(source, static_cast<PackageSizeInt>(source->GetChunk().size()));
+        source->Release();
+    }
+
+    EXPECT_EQ(chunks[1], 15u);
+    EXPECT_EQ(chunks[2], 5u);
+}
+
+TEST(FileTransferSchedulerTest, LateTransferDoesNotStarveOthers) {
+    FileTransferScheduler scheduler(FileSchedulingPolicy::WEIGHTED);
+    scheduler.Add(CreateSource(1, 10 * FILE_BUFFER_SIZE));
+
+    for (size_t i = 0; i < 5; ++i) {
+        FileTransferSource* source = scheduler.Next();
+        ASSERT_TRUE(source->Read());
+        scheduler.Charge(source, static_cast<PackageSizeInt>(source->GetChunk().size()));
+        source->Release();
+    }
+
+    scheduler.Add(CreateSource(2, 10 * FILE_BUFFER_SIZE));
+
+    std::vector<size_t> order;
+    for (size_t i = 0; i < 4; ++i) {
+        FileTransferSource* source = scheduler.Next();
+        ASSERT_TRUE(source->Read());
+        order.push_back(source->GetRequestID());
+        scheduler.Charge(source, static_cast<PackageSizeInt>(source->GetChunk().size()));
+        source->Release();
+    }
+
+    EXPECT_EQ(std::count(order.begin(), order.end(), 1u), 2);
+    EXPECT_EQ(std::count(order.begin(), order.end(), 2u), 2);
+}
+
+TEST(FileTransferSchedulerTest, RangeSourceReadsBeyondFourGiB) {
+    constexpr FileSizeInt fileSize = 5ull * 1024 * 1024 * 1024;
+    constexpr FileSizeInt offset = fileSize - FILE_BUFFER_SIZE;
+    const std::string marker = "end of a very large file";
+
+    {
+        std::ofstream stream("scheduler_large.bin", std::ios::binary | std::ios::trunc);
+    }
+
+    std::filesystem::resize_file("scheduler_large.bin", fileSize);
+    {
+        std::fstream stream("scheduler_large.bin", std::ios::binary | std::ios::in | std::ios::out);
+        stream.seekp(static_cast<std::streamoff>(fileSize - marker.size()));
+        stream.write(marker.data(), static_cast<std::streamsize>(marker.size()));
+    }
+
+    RangeFileSource source(0, FILE_TRANSFER_DEFAULT_WEIGHT, "scheduler_large.bin", offset, 0);
+    ASSERT_TRUE(source.Open());
+    EXPECT_EQ(source.GetTotalSize(), fileSize);
+    EXPECT_EQ(source.GetSize(), FILE_BUFFER_SIZE);
+    EXPECT_LE(source.GetRemainingSize(), FILE_BUFFER_SIZE);
+
+    ASSERT_TRUE(source.Read());
+    EXPECT_TRUE(source.IsFinished());
+
+    const std::vector<char>& chunk = source.GetChunk();
+    EXPECT_EQ(std::string(chunk.end() - static_cast<std::ptrdiff_t>(marker.size()), chunk.end()), marker);
+
+    std::filesystem::remove("scheduler_large.bin");
+}
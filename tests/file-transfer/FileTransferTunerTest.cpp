@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+#include <FileTransfer.h>
+#include <FileTransferTuner.h>
+#include <Settings.h>
+
+using namespace std::chrono_literals;
+
+static FileTransferTuning Tune(const uint64_t bytesPerSecond, const std::chrono::microseconds roundTripTime) {
+    FileTransferTuner tuner(FileTransferDirection::SEND);
+    tuner.RecordRoundTripTime(roundTripTime);
+    tuner.RecordTransfer(FILE_TUNING_SAMPLE_SIZE, std::chrono::microseconds(FILE_TUNING_SAMPLE_SIZE * 1'000'000ull / bytesPerSecond));
+
+    EXPECT_TRUE(tuner.IsUpdateDue());
+    tuner.Update();
+    return tuner.GetTuning();
+}
+
+TEST(FileTransferTunerTest, KeepsDefaultsUntilEnoughSamples) {
+    FileTransferTuner tuner(FileTransferDirection::RECEIVE);
+    tuner.RecordRoundTripTime(1ms);
+    tuner.RecordTransfer(FILE_TUNING_SAMPLE_SIZE / 2, 1ms);
+
+    EXPECT_FALSE(tuner.IsUpdateDue());
+    EXPECT_FALSE(tuner.Update());
+    EXPECT_EQ(tuner.GetChunkSize(), FILE_BUFFER_SIZE);
+    EXPECT_EQ(tuner.GetTuning().socketBufferSize, 0u);
+}
+
+TEST(FileTransferTunerTest, SizesFollowBandwidthDelayProduct) {
+    const FileTransferTuning lan = Tune(100'000'000, 200us);
+    EXPECT_NEAR(static_cast<double>(lan.bandwidth), 100'000'000.0, 1000.0);
+    EXPECT_EQ(lan.chunkSize, 16u * 1024);
+    EXPECT_EQ(lan.socketBufferSize, 256u * 1024);
+
+    const FileTransferTuning wan = Tune(12'500'000, 80ms);
+    EXPECT_EQ(wan.chunkSize, FILE_CHUNK_MAX_SIZE);
+    EXPECT_EQ(wan.socketBufferSize, 2'000'000u);
+}
+
+TEST(FileTransferTunerTest, RespectsConfiguredBounds) {
+    P2PSettings::SetFileChunkSizeBounds(64 * 1024, 128 * 1024);
+    P2PSettings::SetSocketBufferSizeBounds(512 * 1024, 1024 * 1024);
+
+    const FileTransferTuning lan = Tune(100'000'000, 200us);
+    EXPECT_EQ(lan.chunkSize, 64u * 1024);
+    EXPECT_EQ(lan.socketBufferSize, 512u * 1024);
+
+    const FileTransferTuning wan = Tune(12'500'000, 80ms);
+    EXPECT_EQ(wan.chunkSize, 128u * 1024);
+    EXPECT_EQ(wan.socketBufferSize, 1024u * 1024);
+
+    P2PSettings::SetFileChunkSizeBounds(16 * 1024, FILE_CHUNK_MAX_SIZE);
+    P2PSettings::SetSocketBufferSizeBounds(256 * 1024, 16 * 1024 * 1024);
+}
+
+TEST(FileTransferTunerTest, DeliveryRateOverridesWriteCompletionTime) {
+    FileTransferTuner tuner(FileTransferDirection::SEND);
+    tuner.RecordRoundTripTime(80ms);
+    tuner.RecordTransfer(FILE_TUNING_SAMPLE_SIZE, 1ms);
+    tuner.RecordDeliveryRate(12'500'000);
+
+    ASSERT_TRUE(tuner.Update());
+    EXPECT_EQ(tuner.GetTuning().bandwidth, 12'500'000u);
+    EXPECT_EQ(tuner.GetTuning().socketBufferSize, 2'000'000u);
+}
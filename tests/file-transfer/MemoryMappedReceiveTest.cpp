@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include <FileTransfer.h>
+#include <Settings.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sys/stat.h>
+
+static std::string CreateRandomData(const size_t size, const uint32_t seed) {
+    std::mt19937 random(seed);
+    std::string data(size, '\0');
+
+    for (auto& byte : data) {
+        byte = static_cast<char>(random());
+    }
+
+    return data;
+}
+
+static std::string ReadFile(const std::filesystem::path& path) {
+    std::ifstream stream(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()};
+}
+
+static HashDigest Digest(const std::string& data) {
+    PipelinedHasher hasher;
+    hasher.Update(data.data(), data.size());
+    return hasher.Finish();
+}
+
+TEST(MemoryMappedReceiveTest, ReceivesDirectlyIntoMapping) {
+    if (!MemoryMappedFile::IsSupported()) {
+        GTEST_SKIP();
+    }
+
+    std::filesystem::remove("mapped_receive.bin");
+    const std::string data = CreateRandomData(3 * FILE_CHUNK_MAX_SIZE + 123, 7);
+
+    RangeFileSink sink("mapped_receive.bin", 0, data.size(), data.size());
+    ASSERT_TRUE(sink.Open());
+    ASSERT_TRUE(sink.IsMemoryMapped());
+
+    for (size_t offset = 0; offset < data.size(); offset += FILE_CHUNK_MAX_SIZE) {
+        const size_t size = std::min<size_t>(FILE_CHUNK_MAX_SIZE, data.size() - offset);
+
+        char* destination = sink.Reserve(size);
+        ASSERT_NE(destination, nullptr);
+
+        std::memcpy(destination, data.data() + offset, size);
+        ASSERT_TRUE(sink.Commit(size));
+    }
+
+    EXPECT_EQ(sink.Reserve(1), nullptr);
+    ASSERT_TRUE(sink.Finish(Digest(data)));
+
+    EXPECT_EQ(ReadFile("mapped_receive.bin"), data);
+    EXPECT_FALSE(std::filesystem::exists(FileTransferCheckpoint::GetSidecarPath("mapped_receive.bin")));
+}
+
+TEST(MemoryMappedReceiveTest, BufferedFallbackWritesSameContent) {
+    std::filesystem::remove("buffered_receive.bin");
+    const std::string data = CreateRandomData(2 * FILE_BUFFER_SIZE + 5, 11);
+
+    P2PSettings::SetMemoryMappedReceiveEnabled(false);
+    RangeFileSink sink("buffered_receive.bin", 0, data.size(), data.size());
+    ASSERT_TRUE(sink.Open());
+    P2PSettings::SetMemoryMappedReceiveEnabled(true);
+
+    EXPECT_FALSE(sink.IsMemoryMapped());
+    EXPECT_EQ(sink.Reserve(FILE_BUFFER_SIZE), nullptr);
+
+    std::vector<char> buffer(data.begin(), data.end());
+    ASSERT_TRUE(sink.Write(buffer, data.size()));
+    ASSERT_TRUE(sink.Finish(Digest(data)));
+
+    EXPECT_EQ(ReadFile("buffered_receive.bin"), data);
+}
+
+TEST(MemoryMappedReceiveTest, ReservesReceivedRangeBeforeWriting) {
+    if (!MemoryMappedFile::IsSupported()) {
+        GTEST_SKIP();
+    }
+
+    constexpr FileSizeInt rangeSize = 1024 * 1024;
+    std::filesystem::remove("mapped_reserve.bin");
+    std::filesystem::remove(FileTransferCheckpoint::GetSidecarPath("mapped_reserve.bin"));
+
+    RangeFileSink sink("mapped_reserve.bin", rangeSize, rangeSize, 4 * rangeSize);
+    ASSERT_TRUE(sink.Open());
+    ASSERT_TRUE(sink.IsMemoryMapped());
+
+    struct stat status{};
+    ASSERT_EQ(::stat("mapped_reserve.bin", &status), 0);
+    EXPECT_EQ(static_cast<FileSizeInt>(status.st_size), 4 * rangeSize);
+    EXPECT_GE(static_cast<FileSizeInt>(status.st_blocks) * 512, rangeSize);
+}
@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+#include <PipelinedHasher.h>
+#include <openssl/evp.h>
+
+#include <random>
+#include <string>
+
+static std::string CreateRandomData(const size_t size, const uint32_t seed) {
+    std::mt19937 random(seed);
+    std::string data(size, '\0');
+
+    for (auto& byte : data) {
+        byte = static_cast<char>(random());
+    }
+
+    return data;
+}
+
+static HashDigest ComputeDigest(const std::string& data) {
+    HashDigest digest{};
+    unsigned int digestSize = 0;
+    EVP_Digest(data.data(), data.size(), digest.data(), &digestSize, EVP_sha256(), nullptr);
+    return digest;
+}
+
+TEST(PipelinedHasherTest, EmptyInputMatchesOneShotDigest) {
+    PipelinedHasher hasher;
+    EXPECT_EQ(hasher.Finish(), ComputeDigest(""));
+}
+
+TEST(PipelinedHasherTest, UpdateMatchesOneShotDigest) {
+    const std::string data = CreateRandomData(3 * 1024 * 1024 + 7, 1);
+
+    PipelinedHasher hasher;
+    for (size_t offset = 0; offset < data.size(); offset += 65536) {
+        hasher.Update(data.data() + offset, std::min<size_t>(65536, data.size() - offset));
+    }
+
+    EXPECT_EQ(hasher.Finish(), ComputeDigest(data));
+}
+
+TEST(PipelinedHasherTest, SubmittedBuffersAreRecycled) {
+    const std::string data = CreateRandomData(1024 * 1024, 2);
+    constexpr size_t chunkSize = 4096;
+
+    PipelinedHasher hasher;
+    std::vector<char> buffer = hasher.AcquireBuffer(chunkSize);
+
+    for (size_t offset = 0; offset < data.size(); offset += chunkSize) {
+        const size_t size = std::min(chunkSize, data.size() - offset);
+        std::copy_n(data.data() + offset, size, buffer.data());
+
+        hasher.Submit(std::move(buffer), size);
+        buffer = hasher.AcquireBuffer(chunkSize);
+        ASSERT_EQ(buffer.size(), chunkSize);
+    }
+
+    EXPECT_EQ(hasher.Finish(), ComputeDigest(data));
+}
+
+TEST(PipelinedHasherTest, CorruptedDataChangesDigest) {
+    std::string data = CreateRandomData(256 * 1024, 3);
+    const HashDigest original = ComputeDigest(data);
+    data[1234] ^= 0x01;
+
+    PipelinedHasher hasher;
+    hasher.Update(data.data(), data.size());
+    EXPECT_NE(hasher.Finish(), original);
+}
+
+TEST(PipelinedHasherTest, ConcurrentHashersShareBoundedWorkers) {
+    constexpr size_t hasherCount = 32;
+    constexpr size_t chunkSize = 1024 * 1024;
+
+    std::vector<std::string> data;
+    std::vector<std::unique_ptr<PipelinedHasher>> hashers;
+
+    for (size_t i = 0; i < hasherCount; i++) {
+        data.push_back(CreateRandomData(4 * chunkSize + i, static_cast<uint32_t>(10 + i)));
+        hashers.push_back(std::make_unique<PipelinedHasher>());
+    }
+
+    for (size_t offset = 0; offset < data.front().size(); offset += chunkSize) {
+        for (size_t i = 0; i < hasherCount; i++) {
+            hashers[i]->Update(data[i].data() + offset, std::min(chunkSize, data[i].size() - offset));
+        }
+    }
+
+    for (size_t i = 0; i < hasherCount; i++) {
+        hashers[i]->Update(data[i].data() + data.front().size(), data[i].size() - data.front().size());
+        EXPECT_EQ(hashers[i]->Finish(), ComputeDigest(data[i]));
+    }
+}
+
+TEST(PipelinedHasherTest, DestroyingWithPendingChunksDoesNotBlock) {
+    const std::string data = CreateRandomData(HASH_MAX_PENDING_BYTES, 4);
+
+    for (int i = 0; i < 8; i++) {
+        PipelinedHasher hasher;
+        hasher.Update(data.data(), data.size());
+        hasher.Update(data.data(), data.size());
+    }
+}
+
+TEST(PipelinedHasherTest, AwaitingSpaceAndFinishMatchesOneShotDigest) {
+    const std::string data = CreateRandomData(2 * HASH_MAX_PENDING_BYTES + 11, 5);
+    constexpr size_t chunkSize = 256 * 1024;
+
+    asio::io_context context;
+    PipelinedHasher hasher;
+    HashDigest digest{};
+
+    asio::co_spawn(context, [&]() -> asio::awaitable<void> {
+        for (size_t offset = 0; offset < data.size(); offset += chunkSize) {
+            const size_t size = std::min(chunkSize, data.size() - offset);
+            co_await hasher.CoWaitForSpace(size);
+            hasher.Update(data.data() + offset, size);
+        }
+
+        digest = co_await hasher.CoFinish();
+    }, asio::detached);
+
+    context.run();
+    EXPECT_EQ(digest, ComputeDigest(data));
+}
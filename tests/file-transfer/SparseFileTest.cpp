@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+#include <FileTransfer.h>
+#include <Settings.h>
+
+#include <filesystem>
+#include <fstream>
+
+static constexpr uint64_t SPARSE_TEST_FILE_SIZE = 64 * 1024 * 1024;
+static constexpr uint64_t SPARSE_TEST_EXTENT_SIZE = 1024 * 1024;
+
+static std::string CreateSparseFile(const std::filesystem::path& path) {
+    std::filesystem::remove(path);
+    std::ofstream(path, std::ios::binary).close();
+    std::filesystem::resize_file(path, SPARSE_TEST_FILE_SIZE);
+
+    std::string expected(SPARSE_TEST_FILE_SIZE, '\0');
+    std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+
+    for (const uint64_t offset : {uint64_t{8} * 1024 * 1024, uint64_t{40} * 1024 * 1024}) {
+        const std::string data(SPARSE_TEST_EXTENT_SIZE, static_cast<char>('a' + offset % 26));
+        file.seekp(static_cast<std::streamoff>(offset));
+        file.write(data.data(), static_cast<std::streamsize>(data.size()));
+        expected.replace(offset, data.size(), data);
+    }
+
+    return expected;
+}
+
+static std::string ReadFile(const std::filesystem::path& path) {
+    std::ifstream stream(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()};
+}
+
+TEST(SparseFileTest, HolesAreDerivedFromDataExtents) {
+    const std::vector<FileExtent> holes = SparseFile::GetHoles(0, 100, {{10, 20}, {50, 10}});
+    const std::vector<FileExtent> expected = {{0, 10}, {30, 20}, {60, 40}};
+
+    EXPECT_EQ(holes, expected);
+    EXPECT_TRUE(SparseFile::IsValidExtentList(0, 100, {{10, 20}, {50, 10}}));
+    EXPECT_FALSE(SparseFile::IsValidExtentList(0, 100, {{50, 10}, {10, 20}}));
+    EXPECT_FALSE(SparseFile::IsValidExtentList(0, 100, {{90, 20}}));
+}
+
+class SparseTransferTest : public testing::TestWithParam<bool> {};
+
+TEST_P(SparseTransferTest, SendsOnlyDataExtents) {
+    const std::string expected = CreateSparseFile("sparse_source.bin");
+
+    RangeFileSource source(0, FILE_TRANSFER_DEFAULT_WEIGHT, "sparse_source.bin", 0, 0);
+    ASSERT_TRUE(source.Open());
+
+    if (!source.IsSparse()) {
+        GTEST_SKIP() << "File system does not report holes";
+    }
+
+    EXPECT_LT(source.GetDataSize(), SPARSE_TEST_FILE_SIZE / 4);
+
+    std::filesystem::remove("sparse_destination.bin");
+    std::filesystem::remove(FileTransferCheckpoint::GetSidecarPath("sparse_destination.bin"));
+
+    P2PSettings::SetMemoryMappedReceiveEnabled(GetParam());
+    RangeFileSink sink("sparse_destination.bin", source.GetOffset(), source.GetSize(), source.GetTotalSize());
+    sink.SetDataExtents(source.GetDataExtents());
+    ASSERT_TRUE(sink.Open());
+    P2PSettings::SetMemoryMappedReceiveEnabled(true);
+
+    FileSizeInt sent = 0;
+    std::vector<char> buffer;
+
+    while (!source.IsFinished()) {
+        ASSERT_TRUE(source.Read());
+        buffer = source.GetChunk();
+        sent += buffer.size();
+
+        ASSERT_TRUE(sink.Write(buffer, buffer.size()));
+        source.Release();
+    }
+
+    ASSERT_TRUE(sink.Finish(source.Finish()));
+
+    EXPECT_EQ(sent, source.GetDataSize());
+    EXPECT_EQ(std::filesystem::file_size("sparse_destination.bin"), SPARSE_TEST_FILE_SIZE);
+    EXPECT_EQ(ReadFile("sparse_destination.bin"), expected);
+    EXPECT_FALSE(std::filesystem::exists(FileTransferCheckpoint::GetSidecarPath("sparse_destination.bin")));
+
+    const std::vector<FileExtent> received = SparseFile::GetDataExtents("sparse_destination.bin", 0, SPARSE_TEST_FILE_SIZE);
+    FileSizeInt allocated = 0;
+
+    for (const FileExtent& extent : received) {
+        allocated += extent.size;
+    }
+
+    EXPECT_LT(allocated, SPARSE_TEST_FILE_SIZE / 4);
+}
+
+INSTANTIATE_TEST_SUITE_P(ReceiveModes, SparseTransferTest, testing::Values(true, false));
@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+#include <StreamMultiplexer.h>
+
+#include <future>
+#include <random>
+#include <thread>
+
+using TestMultiplexer = StreamMultiplexer<TCPSocket>;
+
+static std::string CreateRandomData(const size_t size, const uint32_t seed) {
+    std::mt19937 generator(seed);
+    std::string data(size, '\0');
+
+    for (char& byte : data) {
+        byte = static_cast<char>(generator());
+    }
+
+    return data;
+}
+
+class StreamMultiplexerTest : public testing::Test {
+protected:
+    void SetUp() override {
+        TCPAcceptor acceptor(m_context, TCPEndpoint(asio::ip::make_address("127.0.0.1"), 0));
+        m_client.connect(acceptor.local_endpoint());
+        acceptor.accept(m_server);
+
+        m_clientMultiplexer = std::make_shared<TestMultiplexer>(m_client, m_context.get_executor());
+        m_serverMultiplexer = std::make_shared<TestMultiplexer>(m_server, m_context.get_executor());
+        m_clientMultiplexer->Start(nullptr);
+        m_serverMultiplexer->Start(nullptr);
+
+        m_thread = std::thread([this] { m_context.run(); });
+    }
+
+    void TearDown() override {
+        m_clientMultiplexer->Close(asio::error::operation_aborted);
+        m_serverMultiplexer->Close(asio::error::operation_aborted);
+
+        asio::error_code errorCode;
+        m_client.close(errorCode);
+        m_server.close(errorCode);
+
+        m_guard.reset();
+        m_thread.join();
+    }
+
+    std::future<void> Write(const std::shared_ptr<TestMultiplexer>& multiplexer, const MultiplexedStream stream, const std::string& data) {
+        return asio::co_spawn(m_context, multiplexer->Write(stream, asio::buffer(data)), asio::use_future);
+    }
+
+    std::future<void> Read(const std::shared_ptr<TestMultiplexer>& multiplexer, const MultiplexedStream stream, std::string& data) {
+        return asio::co_spawn(m_context, multiplexer->Read(stream, asio::buffer(data)), asio::use_future);
+    }
+
+    IOContext                                           m_context;
+    asio::executor_work_guard<IOContext::executor_type> m_guard{m_context.get_executor()};
+    TCPSocket                                           m_client{m_context};
+    TCPSocket                                           m_server{m_context};
+    std::shared_ptr<TestMultiplexer>                    m_clientMultiplexer;
+    std::shared_ptr<TestMultiplexer>                    m_serverMultiplexer;
+    std::thread                                         m_thread;
+};
+
+TEST_F(StreamMultiplexerTest, KeepsStreamsSeparate) {
+    const std::string file = CreateRandomData(3 * MULTIPLEX_MAX_FRAME_SIZE + 17, 1);
+    const std::string message = CreateRandomData(1000, 2);
+
+    std::future<void> fileWrite = Write(m_clientMultiplexer, MultiplexedStream::FILE, file);
+    std::future<void> messageWrite = Write(m_clientMultiplexer, MultiplexedStream::MESSAGE, message);
+
+    std::string receivedMessage(message.size(), '\0');
+    std::string receivedFile(file.size(), '\0');
+
+    Read(m_serverMultiplexer, MultiplexedStream::MESSAGE, receivedMessage).get();
+    Read(m_serverMultiplexer, MultiplexedStream::FILE, receivedFile).get();
+    fileWrite.get();
+    messageWrite.get();
+
+    EXPECT_EQ(receivedMessage, message);
+    EXPECT_EQ(receivedFile, file);
+}
+
+TEST_F(StreamMultiplexerTest, BlockedStreamDoesNotStallOthers) {
+    const std::string file = CreateRandomData(MULTIPLEX_WINDOW_SIZE + MULTIPLEX_MAX_FRAME_SIZE, 3);
+    std::future<void> fileWrite = Write(m_clientMultiplexer, MultiplexedStream::FILE, file);
+
+    EXPECT_EQ(fileWrite.wait_for(std::chrono::milliseconds(200)), std::future_status::timeout);
+
+    const std::string message = CreateRandomData(100, 4);
+    std::string receivedMessage(message.size(), '\0');
+
+    Write(m_clientMultiplexer, MultiplexedStream::MESSAGE, message).get();
+    Read(m_serverMultiplexer, MultiplexedStream::MESSAGE, receivedMessage).get();
+    EXPECT_EQ(receivedMessage, message);
+
+    std::string receivedFile(file.size(), '\0');
+    Read(m_serverMultiplexer, MultiplexedStream::FILE, receivedFile).get();
+
+    ASSERT_EQ(fileWrite.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    EXPECT_EQ(receivedFile, file);
+}
+
+TEST_F(StreamMultiplexerTest, CloseFailsPendingReads) {
+    std::string received(10, '\0');
+    std::future<void> read = Read(m_serverMultiplexer, MultiplexedStream::MESSAGE, received);
+
+    m_clientMultiplexer->Close(asio::error::operation_aborted);
+    asio::error_code errorCode;
+    m_client.shutdown(TCPSocket::shutdown_both, errorCode);
+
+    ASSERT_EQ(read.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    EXPECT_THROW(read.get(), asio::system_error);
+}
+
+TEST(StreamMultiplexerPriorityTest, MessageFramesOvertakeQueuedFileFrames) {
+    IOContext context;
+    TCPSocket client(context);
+    TCPSocket server(context);
+
+    TCPAcceptor acceptor(context, TCPEndpoint(asio::ip::make_address("127.0.0.1"), 0));
+    client.connect(acceptor.local_endpoint());
+    acceptor.accept(server);
+
+    const auto multiplexer = std::make_shared<TestMultiplexer>(client, context.get_executor());
+    multiplexer->Start(nullptr);
+
+    const std::string file = CreateRandomData(32 * MULTIPLEX_MAX_FRAME_SIZE, 5);
+    const std::string message = CreateRandomData(100, 6);
+
+    // Both writes queue their frames before the writer gets to run
+    asio::co_spawn(context, multiplexer->Write(MultiplexedStream::FILE, asio::buffer(file)), asio::detached);
+    asio::co_spawn(context, multiplexer->Write(MultiplexedStream::MESSAGE, asio::buffer(message)), asio::detached);
+    std::thread thread([&context] { context.run(); });
+
+    MultiplexFrameHeader header{};
+    std::vector<char> payload(MULTIPLEX_MAX_FRAME_SIZE);
+    size_t fileFramesBefore = 0;
+
+    while (true) {
+        asio::read(server, asio::buffer(&header, sizeof(MultiplexFrameHeader)));
+        header.FromBigEndianToNative();
+        asio::read(server, asio::buffer(payload.data(), header.size));
+
+        if (header.stream == static_cast<uint8_t>(MultiplexedStream::MESSAGE)) {
+            break;
+        }
+
+        ++fileFramesBefore;
+    }
+
+    EXPECT_LE(fileFramesBefore, 1u);
+
+    multiplexer->Close(asio::error::operation_aborted);
+    asio::error_code errorCode;
+    client.close(errorCode);
+    server.close(errorCode);
+    thread.join();
+}
@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+#include <SwarmScheduler.h>
+
+#include <algorithm>
+
+static constexpr FileSizeInt SWARM_TEST_PIECE_SIZE = 1024;
+
+TEST(SwarmSchedulerTest, AssignsDisjointPiecesToEveryPeer) {
+    SwarmScheduler scheduler({{0, 10 * SWARM_TEST_PIECE_SIZE + 1}}, SWARM_TEST_PIECE_SIZE);
+    const size_t first = scheduler.AddPeer();
+    const size_t second = scheduler.AddPeer();
+
+    EXPECT_EQ(scheduler.GetPieceCount(), 11u);
+
+    const auto now = SwarmScheduler::Clock::now();
+    std::vector<SwarmAssignment> assignments = scheduler.Assign(now);
+    ASSERT_EQ(assignments.size(), 2 * SWARM_PEER_PIPELINE_DEPTH);
+
+    std::vector<FileSizeInt> offsets;
+    for (const SwarmAssignment& assignment : assignments) {
+        offsets.push_back(assignment.offset);
+    }
+
+    std::ranges::sort(offsets);
+    EXPECT_EQ(std::ranges::adjacent_find(offsets), offsets.end());
+    EXPECT_EQ(std::ranges::count(assignments, first, &SwarmAssignment::peer), SWARM_PEER_PIPELINE_DEPTH);
+    EXPECT_EQ(std::ranges::count(assignments, second, &SwarmAssignment::peer), SWARM_PEER_PIPELINE_DEPTH);
+
+    while (!assignments.empty()) {
+        for (const SwarmAssignment& assignment : assignments) {
+            scheduler.Complete(assignment.peer, assignment.piece, true, now);
+        }
+
+        assignments = scheduler.Assign(now);
+    }
+
+    EXPECT_TRUE(scheduler.IsFinished());
+    EXPECT_EQ(scheduler.GetReceivedSize(), 10 * SWARM_TEST_PIECE_SIZE + 1);
+}
+
+TEST(SwarmSchedulerTest, RequeuesPiecesOfFailedPeer) {
+    SwarmScheduler scheduler({{0, 4 * SWARM_TEST_PIECE_SIZE}}, SWARM_TEST_PIECE_SIZE);
+    const size_t first = scheduler.AddPeer();
+    const size_t second = scheduler.AddPeer();
+    const auto now = SwarmScheduler::Clock::now();
+
+    const std::vector<SwarmAssignment> assignments = scheduler.Assign(now);
+    ASSERT_EQ(assignments.size(), 4u);
+
+    scheduler.RemovePeer(first);
+    EXPECT_TRUE(scheduler.Assign(now).empty());
+
+    for (const SwarmAssignment& assignment : assignments) {
+        scheduler.Complete(assignment.peer, assignment.piece, assignment.peer == second, now);
+    }
+
+    const std::vector<SwarmAssignment> retries = scheduler.Assign(now);
+    ASSERT_EQ(retries.size(), SWARM_PEER_PIPELINE_DEPTH);
+    EXPECT_TRUE(std::ranges::all_of(retries, [second](const SwarmAssignment& retry) { return retry.peer == second; }));
+
+    scheduler.RemovePeer(second);
+    EXPECT_TRUE(scheduler.IsStalled());
+}
+
+TEST(SwarmSchedulerTest, DropsPeerAfterRepeatedIntegrityFailures) {
+    SwarmScheduler scheduler({{0, 16 * SWARM_TEST_PIECE_SIZE}}, SWARM_TEST_PIECE_SIZE);
+    const size_t peer = scheduler.AddPeer();
+    const auto now = SwarmScheduler::Clock::now();
+
+    for (uint32_t failure = 0; failure < SWARM_MAX_PEER_FAILURES; ++failure) {
+        const std::vector<SwarmAssignment> assignments = scheduler.Assign(now);
+        ASSERT_FALSE(assignments.empty());
+        scheduler.Complete(peer, assignments.front().piece, false, now);
+    }
+
+    EXPECT_FALSE(scheduler.IsPeerActive(peer));
+    EXPECT_EQ(scheduler.GetOutstandingCount(), 0u);
+    EXPECT_TRUE(scheduler.IsStalled());
+}
+
+TEST(SwarmSchedulerTest, FastPeerTakesOverSlowPiece) {
+    SwarmScheduler scheduler({{0, 3 * SWARM_TEST_PIECE_SIZE}}, SWARM_TEST_PIECE_SIZE);
+    const size_t slow = scheduler.AddPeer();
+    const size_t fast = scheduler.AddPeer();
+    const auto start = SwarmScheduler::Clock::now();
+
+    const std::vector<SwarmAssignment> assignments = scheduler.Assign(start);
+    ASSERT_EQ(assignments.size(), 3u);
+
+    ASSERT_EQ(assignments[0].peer, slow);
+    ASSERT_EQ(assignments[1].peer, slow);
+    ASSERT_EQ(assignments[2].peer, fast);
+
+    const size_t slowPiece = assignments[1].piece;
+    scheduler.Complete(slow, assignments[0].piece, true, start + std::chrono::milliseconds(10));
+    scheduler.Complete(fast, assignments[2].piece, true, start + std::chrono::milliseconds(10));
+
+    EXPECT_TRUE(scheduler.Assign(start + std::chrono::milliseconds(15)).empty());
+
+    const std::vector<SwarmAssignment> stolen = scheduler.Assign(start + std::chrono::seconds(1));
+    ASSERT_EQ(stolen.size(), 1u);
+    EXPECT_EQ(stolen.front().peer, fast);
+    EXPECT_EQ(stolen.front().piece, slowPiece);
+
+    scheduler.Complete(fast, slowPiece, true, start + std::chrono::seconds(1) + std::chrono::milliseconds(10));
+    EXPECT_TRUE(scheduler.IsFinished());
+
+    scheduler.Complete(slow, slowPiece, true, start + std::chrono::seconds(2));
+    EXPECT_EQ(scheduler.GetReceivedSize(), 3 * SWARM_TEST_PIECE_SIZE);
+    EXPECT_EQ(scheduler.GetOutstandingCount(), 0u);
+}
@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+#include <FileTransfer.h>
+
+#include <boost/endian/conversion.hpp>
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+static std::string CreateRandomData(const size_t size, const uint32_t seed) {
+    std::mt19937 random(seed);
+    std::string data(size, '\0');
+
+    for (auto& byte : data) {
+        byte = static_cast<char>(random());
+    }
+
+    return data;
+}
+
+static void WriteFile(const std::filesystem::path& path, const std::string& data) {
+    std::filesystem::create_directories(path.parent_path());
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    stream.write(data.data(), static_cast<std::streamsize>(data.size()));
+}
+
+static std::string ReadFile(const std::filesystem::path& path) {
+    std::ifstream stream(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()};
+}
+
+static bool Transfer(const std::filesystem::path& source, const std::filesystem::path& destination, const bool corruptDigest = false) {
+    TreeFileSource treeSource(0, FILE_TRANSFER_DEFAULT_WEIGHT, source);
+    EXPECT_TRUE(treeSource.Open());
+
+    TreeFileSink treeSink(destination, treeSource.GetManifestSize(), treeSource.GetContentSize());
+    EXPECT_TRUE(treeSink.Open());
+
+    std::vector<char> buffer;
+    while (!treeSource.IsFinished()) {
+        EXPECT_TRUE(treeSource.Read());
+
+        buffer = treeSource.GetChunk();
+        if (!treeSink.Write(buffer, buffer.size())) {
+            return false;
+        }
+
+        treeSource.Release();
+    }
+
+    HashDigest digest = treeSource.Finish();
+    if (corruptDigest) {
+        digest[0] ^= 0xFF;
+    }
+
+    return treeSink.Finish(digest) && treeSink.IsVerified();
+}
+
+TEST(TreeTransferTest, RecreatesDirectoryTree) {
+    std::filesystem::remove_all("tree_source");
+    std::filesystem::remove_all("tree_destination");
+
+    std::vector<std::pair<std::filesystem::path, std::string>> files;
+    for (uint32_t i = 0; i < 500; ++i) {
+        files.emplace_back(std::filesystem::path("small") / std::to_string(i % 7) / ("file_" + std::to_string(i) + ".txt"), CreateRandomData(i * 13 % 4096, i));
+    }
+
+    files.emplace_back("large/blob.bin", CreateRandomData(3 * TREE_PARALLEL_WRITE_MAX_SIZE + 17, 1000));
+    files.emplace_back("empty.txt", "");
+
+    for (const auto& [path, data] : files) {
+        WriteFile("tree_source" / path, data);
+    }
+
+    std::filesystem::create_directories("tree_source/empty_directory/nested");
+
+    ASSERT_TRUE(Transfer("tree_source", "tree_destination"));
+
+    for (const auto& [path, data] : files) {
+        ASSERT_TRUE(std::filesystem::exists("tree_destination" / path)) << path;
+        ASSERT_EQ(ReadFile("tree_destination" / path), data) << path;
+    }
+
+    EXPECT_TRUE(std::filesystem::is_directory("tree_destination/empty_directory/nested"));
+}
+
+TEST(TreeTransferTest, ManifestCannotEscapeRoot) {
+    std::vector<char> manifest;
+    const std::string path = "../escaped.txt";
+
+    uint32_t entryCount = boost::endian::native_to_big(uint32_t{1});
+    uint16_t pathSize = boost::endian::native_to_big(static_cast<uint16_t>(path.size()));
+    uint64_t size = boost::endian::native_to_big(uint64_t{4});
+
+    manifest.insert(manifest.end(), reinterpret_cast<char*>(&entryCount), reinterpret_cast<char*>(&entryCount) + sizeof(entryCount));
+    manifest.push_back(static_cast<char>(TreeEntryType::FILE));
+    manifest.insert(manifest.end(), reinterpret_cast<char*>(&pathSize), reinterpret_cast<char*>(&pathSize) + sizeof(pathSize));
+    manifest.insert(manifest.end(), path.begin(), path.end());
+    manifest.insert(manifest.end(), reinterpret_cast<char*>(&size), reinterpret_cast<char*>(&size) + sizeof(size));
+
+    TreeFileSink sink("tree_escape", static_cast<PackageSizeInt>(manifest.size()), 4);
+    ASSERT_TRUE(sink.Open());
+    EXPECT_FALSE(sink.Write(manifest, manifest.size()));
+    EXPECT_FALSE(std::filesystem::exists("escaped.txt"));
+}
+
+TEST(TreeTransferTest, DigestMismatchDiscardsReceivedTree) {
+    std::filesystem::remove_all("tree_source");
+    std::filesystem::remove_all("tree_corrupt");
+
+    WriteFile("tree_source/nested/file.bin", CreateRandomData(1024, 1));
+    WriteFile("tree_source/large.bin", CreateRandomData(2 * TREE_PARALLEL_WRITE_MAX_SIZE, 2));
+
+    std::filesystem::create_directories("tree_corrupt");
+    WriteFile("tree_corrupt/unrelated.txt", "kept");
+
+    ASSERT_FALSE(Transfer("tree_source", "tree_corrupt", true));
+
+    EXPECT_FALSE(std::filesystem::exists("tree_corrupt/nested"));
+    EXPECT_FALSE(std::filesystem::exists("tree_corrupt/large.bin"));
+    EXPECT_EQ(ReadFile("tree_corrupt/unrelated.txt"), "kept");
+}
+
+TEST(TreeTransferTest, AbandonedTransferDiscardsPartialTree) {
+    std::filesystem::remove_all("tree_source");
+    std::filesystem::remove_all("tree_abandoned");
+
+    for (uint32_t i = 0; i < 20; ++i) {
+        WriteFile("tree_source/nested/file_" + std::to_string(i) + ".bin", CreateRandomData(1000, i));
+    }
+
+    WriteFile("tree_source/large.bin", CreateRandomData(2 * TREE_PARALLEL_WRITE_MAX_SIZE, 100));
+
+    std::filesystem::create_directories("tree_abandoned");
+    WriteFile("tree_abandoned/unrelated.txt", "kept");
+
+    {
+        TreeFileSource treeSource(0, FILE_TRANSFER_DEFAULT_WEIGHT, "tree_source");
+        ASSERT_TRUE(treeSource.Open());
+        treeSource.SetChunkSize(4096);
+
+        TreeFileSink treeSink("tree_abandoned", treeSource.GetManifestSize(), treeSource.GetContentSize());
+        ASSERT_TRUE(treeSink.Open());
+
+        std::vector<char> buffer;
+        while (treeSource.GetRemainingSize() > treeSource.GetContentSize() / 2) {
+            ASSERT_TRUE(treeSource.Read());
+
+            buffer = treeSource.GetChunk();
+            ASSERT_TRUE(treeSink.Write(buffer, buffer.size()));
+
+            treeSource.Release();
+        }
+    }
+
+    EXPECT_FALSE(std::filesystem::exists("tree_abandoned/nested"));
+    EXPECT_FALSE(std::filesystem::exists("tree_abandoned/large.bin"));
+    EXPECT_EQ(ReadFile("tree_abandoned/unrelated.txt"), "kept");
+}
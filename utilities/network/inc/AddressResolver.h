@@ -14,6 +14,8 @@ public:
     static bool IsAddressPrivate(const asio::ip::address_v4& address);
     static bool IsAddressPrivate(const IPAddress& address);
 
+    static bool IsAddressLocal(const IPAddress& address);
+
     static IPAddress GetPrivateIPv4();
     static IPAddress GetPrivateIPv6();
 };
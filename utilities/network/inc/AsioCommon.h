@@ -8,6 +8,7 @@
 #include <asio/ssl.hpp>
 
 typedef uint32_t PackageSizeInt;
+typedef uint64_t FileSizeInt;
 typedef uint16_t PackageTypeInt;
 
 typedef asio::io_context IOContext;
@@ -24,10 +25,18 @@ typedef asio::ip::udp::endpoint UDPEndpoint;
 typedef asio::ip::udp::resolver UDPResolver;
 typedef asio::ip::udp::socket UDPSocket;
 
+#if defined(__unix__) || defined(__APPLE__)
+typedef asio::local::stream_protocol::socket UnixSocket;
+typedef asio::local::stream_protocol::endpoint UnixEndpoint;
+typedef asio::local::stream_protocol::acceptor UnixAcceptor;
+#endif
+
 constexpr PackageSizeInt MAX_NON_FILE_PACKAGE_SIZE = 1024 * 32;
 constexpr PackageSizeInt MAX_FULL_PACKAGE_SIZE = 1024 * 64;
 constexpr PackageSizeInt MAX_FILE_NAME_SIZE = 255;
 constexpr PackageSizeInt FILE_BUFFER_SIZE = 128 * 1024;
+constexpr PackageSizeInt FILE_CHECKPOINT_CHUNK_SIZE = 1024 * 1024;
+constexpr PackageSizeInt FILE_CHECKPOINT_SAVE_INTERVAL = 8 * FILE_CHECKPOINT_CHUNK_SIZE;
 constexpr uint32_t PACKAGES_WARN_THRESHOLD = 10000;
 constexpr uint16_t SSL_CONNECTION_PORT = 50000;
 constexpr uint16_t SSL_FILE_STREAM_PORT = 50001;
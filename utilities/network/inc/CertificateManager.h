@@ -5,16 +5,36 @@
 #define _CRT_SECURE_NO_WARNINGS
 #endif
 
+#include <chrono>
 #include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+typedef struct x509_st X509;
+typedef struct evp_pkey_st EVP_PKEY;
 
 namespace TLS {
+    struct Credentials {
+        std::shared_ptr<X509>           certificate;
+        std::shared_ptr<EVP_PKEY>       privateKey;
+        std::filesystem::file_time_type certificateWriteTime;
+        std::filesystem::file_time_type privateKeyWriteTime;
+    };
+
     class CertificateManager {
     public:
         static void GenerateCertificate(const std::filesystem::path& path);
-        static bool IsCertificateValid(const std::filesystem::path& path);
+        static bool IsCertificateValid(const std::filesystem::path& path, std::chrono::seconds minimalTimeLeft = std::chrono::minutes(10));
+        static std::shared_ptr<const Credentials> LoadCredentials(const std::filesystem::path& path);
 
     private:
         static std::string GetOpenSSLError();
+        static void CacheCredentials(const std::filesystem::path& path, X509* certificate, EVP_PKEY* privateKey);
+
+        static std::mutex                                                          m_mutex;
+        static std::unordered_map<std::string, std::shared_ptr<const Credentials>> m_credentials;
 
     };
 }
@@ -0,0 +1,58 @@
+#ifndef TLS_CONTEXT_PROVIDER_H
+#define TLS_CONTEXT_PROVIDER_H
+
+#include <AsioCommon.h>
+#include <CertificateManager.h>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#ifndef NO_DISCARD
+#define NO_DISCARD [[nodiscard]]
+#endif
+
+constexpr std::chrono::hours TLS_CERTIFICATE_ROTATION_MARGIN{24};
+constexpr std::chrono::minutes TLS_CERTIFICATE_ROTATION_CHECK_INTERVAL{10};
+constexpr std::chrono::seconds TLS_CONTEXT_RETRY_INTERVAL{1};
+constexpr std::string_view TLS_TRANSPORT_PROTOCOL = "pablo-connect/transport";
+
+namespace TLS {
+    class ContextProvider {
+    public:
+        static void Start(const std::filesystem::path& certificateDirectory = "./certificates/");
+        static void Stop();
+
+        NO_DISCARD static std::shared_ptr<SSLContext> Get(bool isServer);
+
+        // Runs the callback once both contexts exist, right away if they already do; it may run on the provider thread
+        static void OnReady(std::function<void()> callback);
+
+        NO_DISCARD static std::shared_ptr<SSLContext> CreateContext(const std::filesystem::path& certificateDirectory, bool isServer);
+        NO_DISCARD static std::shared_ptr<SSLContext> CreateContext(const Credentials& credentials, bool isServer);
+
+        NO_DISCARD static bool IsTransportNegotiated(const SSL* ssl);
+
+    private:
+        static void Run(const std::stop_token& stopToken);
+        static void Refresh();
+        static void EnableTransportNegotiation(SSLContext& context, bool isServer);
+
+        static std::mutex                  m_mutex;
+        static std::condition_variable_any m_condition;
+        static std::jthread                m_thread;
+        static std::filesystem::path       m_certificateDirectory;
+        static std::shared_ptr<SSLContext> m_serverContext;
+        static std::shared_ptr<SSLContext> m_clientContext;
+        static std::vector<std::function<void()>> m_readyCallbacks;
+
+    };
+}
+
+#endif //TLS_CONTEXT_PROVIDER_H
@@ -0,0 +1,51 @@
+#ifndef TLS_CRYPTO_PREFERENCES_H
+#define TLS_CRYPTO_PREFERENCES_H
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#ifndef NO_DISCARD
+#define NO_DISCARD [[nodiscard]]
+#endif
+
+typedef struct ssl_ctx_st SSL_CTX;
+
+namespace TLS {
+    enum class CipherSuite : uint8_t {
+        AUTO,
+        AES_GCM,
+        CHACHA20_POLY1305
+    };
+
+    enum class KeyExchangeGroup : uint8_t {
+        AUTO,
+        X25519,
+        P256
+    };
+
+    class CryptoPreferences {
+    public:
+        static void SetCipherSuite(CipherSuite cipherSuite);
+        NO_DISCARD static CipherSuite GetCipherSuite();
+
+        static void SetKeyExchangeGroup(KeyExchangeGroup group);
+        NO_DISCARD static KeyExchangeGroup GetKeyExchangeGroup();
+
+        NO_DISCARD static bool HasAESAcceleration();
+
+        NO_DISCARD static std::string GetCipherSuiteList(CipherSuite cipherSuite);
+        NO_DISCARD static std::string GetKeyExchangeGroupList(KeyExchangeGroup group);
+
+        static bool Apply(SSL_CTX* context);
+        static bool Apply(SSL_CTX* context, CipherSuite cipherSuite, KeyExchangeGroup group);
+
+    private:
+        static std::mutex       m_mutex;
+        static CipherSuite      m_cipherSuite;
+        static KeyExchangeGroup m_keyExchangeGroup;
+
+    };
+}
+
+#endif //TLS_CRYPTO_PREFERENCES_H
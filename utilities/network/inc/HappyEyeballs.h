@@ -0,0 +1,29 @@
+#ifndef HAPPY_EYEBALLS_H
+#define HAPPY_EYEBALLS_H
+
+#include <AsioCommon.h>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#ifndef NO_DISCARD
+#define NO_DISCARD [[nodiscard]]
+#endif
+
+constexpr std::chrono::milliseconds HAPPY_EYEBALLS_ATTEMPT_DELAY{250};
+constexpr std::chrono::milliseconds CONNECT_BACKOFF_BASE_DELAY{100};
+constexpr std::chrono::milliseconds CONNECT_BACKOFF_MAX_DELAY{10000};
+
+class HappyEyeballs final {
+public:
+    NO_DISCARD static std::vector<TCPEndpoint> OrderCandidates(const std::vector<IPAddress>& addresses, uint16_t port);
+    static asio::awaitable<void> CoConnect(TCPSocket& socket, std::vector<TCPEndpoint> candidates);
+
+    NO_DISCARD static TCPAcceptor OpenAcceptor(IOContext& context, const TCPEndpoint& endpoint);
+    NO_DISCARD static std::vector<TCPAcceptor> OpenAcceptors(IOContext& context, const std::vector<IPAddress>& addresses, uint16_t port);
+    static asio::awaitable<void> CoAccept(std::vector<TCPAcceptor>& acceptors, TCPSocket& socket);
+
+    NO_DISCARD static std::chrono::milliseconds GetBackoffDelay(uint32_t attempt);
+};
+
+#endif //HAPPY_EYEBALLS_H
@@ -0,0 +1,51 @@
+#ifndef TLS_SESSION_CACHE_H
+#define TLS_SESSION_CACHE_H
+
+#include <AsioCommon.h>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#ifndef NO_DISCARD
+#define NO_DISCARD [[nodiscard]]
+#endif
+
+typedef struct ssl_st SSL;
+typedef struct ssl_session_st SSL_SESSION;
+
+constexpr size_t TLS_SESSION_CACHE_MAX_PEERS = 256;
+constexpr size_t TLS_SESSION_CACHE_TICKETS_PER_PEER = 4;
+constexpr int TLS_SESSION_TICKETS_PER_HANDSHAKE = 2;
+
+namespace TLS {
+    class SessionCache {
+    public:
+        static void EnableClientSessions(SSLContext& context);
+        static void EnableServerTickets(SSLContext& context);
+
+        static void Attach(SSL* ssl, const IPAddress& address);
+        NO_DISCARD static bool IsResumed(SSL* ssl);
+
+        NO_DISCARD static size_t GetTicketCount(const IPAddress& address);
+        static void Clear();
+
+    private:
+        struct PeerSessions {
+            std::deque<SSL_SESSION*>              sessions;
+            std::chrono::steady_clock::time_point lastUsed;
+        };
+
+        static int OnNewSession(SSL* ssl, SSL_SESSION* session);
+        static SSL_SESSION* Take(const std::string& peer);
+        static void Store(const std::string& peer, SSL_SESSION* session);
+        static int GetPeerIndex();
+
+        static std::mutex                                    m_mutex;
+        static std::unordered_map<std::string, PeerSessions> m_peers;
+
+    };
+}
+
+#endif //TLS_SESSION_CACHE_H
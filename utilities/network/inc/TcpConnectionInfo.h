@@ -0,0 +1,20 @@
+#ifndef TCP_CONNECTION_INFO_H
+#define TCP_CONNECTION_INFO_H
+
+#include <chrono>
+#include <cstdint>
+
+#ifndef NO_DISCARD
+#define NO_DISCARD [[nodiscard]]
+#endif
+
+struct TcpConnectionInfo {
+    std::chrono::microseconds roundTripTime{0};
+    uint64_t                  deliveryRate{0};
+    bool                      applicationLimited{false};
+
+    // Kept out of asio's headers: glibc's tcp_info stops short of the delivery rate the kernel reports
+    NO_DISCARD static bool Query(int socket, TcpConnectionInfo& info);
+};
+
+#endif //TCP_CONNECTION_INFO_H
@@ -84,6 +84,28 @@ bool AddressResolver::IsAddressPrivate(const asio::ip::address_v4& address) {
     return false;
 }
 
+bool AddressResolver::IsAddressLocal(const IPAddress& address) {
+    if (address.is_loopback()) {
+        return true;
+    }
+
+    if (address.is_unspecified() || address.is_multicast()) {
+        return false;
+    }
+
+    asio::io_context ioContext;
+    asio::ip::tcp::acceptor acceptor(ioContext);
+    asio::error_code errorCode;
+
+    acceptor.open(address.is_v6() ? asio::ip::tcp::v6() : asio::ip::tcp::v4(), errorCode);
+    if (errorCode) {
+        return false;
+    }
+
+    acceptor.bind(asio::ip::tcp::endpoint(address, 0), errorCode);
+    return !errorCode;
+}
+
 IPAddress AddressResolver::GetPrivateIPv4() {
     try {
         asio::io_context ioContext;
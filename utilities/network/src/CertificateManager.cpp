@@ -10,6 +10,9 @@
 #include <filesystem>
 
 namespace TLS {
+    std::mutex                                                          CertificateManager::m_mutex{};
+    std::unordered_map<std::string, std::shared_ptr<const Credentials>> CertificateManager::m_credentials{};
+
     void CertificateManager::GenerateCertificate(const std::filesystem::path& path) {
         ZoneScoped;
         const std::string keyPath = (path / "privateKey.key").string();
@@ -69,35 +72,87 @@ namespace TLS {
         PEM_write_X509(certfile, cert);
         fclose(certfile);
 
-        X509_free(cert);
-        EVP_PKEY_free(pkey);
+        CacheCredentials(path, cert, pkey);
     }
 
-    bool CertificateManager::IsCertificateValid(const std::filesystem::path &path) {
+    bool CertificateManager::IsCertificateValid(const std::filesystem::path &path, const std::chrono::seconds minimalTimeLeft) {
         ZoneScoped;
-        constexpr int certificateMinimalTimeLeft = 60 * 10;
 
-        const std::string certPath = (path / "certificate.crt").string();
-        FILE* fp = fopen(certPath.c_str(), "r");
-        if (!fp) {
+        const std::shared_ptr<const Credentials> credentials = LoadCredentials(path);
+        if (!credentials) {
             return false;
         }
 
-        X509* cert = PEM_read_X509(fp, nullptr, nullptr, nullptr);
-        fclose(fp);
+        time_t now = time(nullptr);
+        time_t future = now + static_cast<time_t>(minimalTimeLeft.count());
 
-        if (!cert) {
-            return false;
+        return X509_cmp_time(X509_get_notBefore(credentials->certificate.get()), &now) <= 0 &&
+               X509_cmp_time(X509_get_notAfter(credentials->certificate.get()), &future) >= 0;
+    }
+
+    std::shared_ptr<const Credentials> CertificateManager::LoadCredentials(const std::filesystem::path& path) {
+        ZoneScoped;
+        const std::filesystem::path certPath = path / "certificate.crt";
+        const std::filesystem::path keyPath = path / "privateKey.key";
+
+        std::error_code certError;
+        std::error_code keyError;
+        const std::filesystem::file_time_type certWriteTime = std::filesystem::last_write_time(certPath, certError);
+        const std::filesystem::file_time_type keyWriteTime = std::filesystem::last_write_time(keyPath, keyError);
+
+        if (certError || keyError) {
+            return nullptr;
         }
 
-        time_t now = time(nullptr);
-        time_t future = now + certificateMinimalTimeLeft;
+        {
+            std::lock_guard lock(m_mutex);
+            const auto cached = m_credentials.find(path.lexically_normal().string());
+
+            if (cached != m_credentials.end() && cached->second->certificateWriteTime == certWriteTime && cached->second->privateKeyWriteTime == keyWriteTime) {
+                return cached->second;
+            }
+        }
+
+        FILE* certfile = fopen(certPath.string().c_str(), "r");
+        if (!certfile) {
+            return nullptr;
+        }
+
+        X509* cert = PEM_read_X509(certfile, nullptr, nullptr, nullptr);
+        fclose(certfile);
+
+        FILE* keyfile = fopen(keyPath.string().c_str(), "r");
+        EVP_PKEY* pkey = keyfile ? PEM_read_PrivateKey(keyfile, nullptr, nullptr, nullptr) : nullptr;
+
+        if (keyfile) {
+            fclose(keyfile);
+        }
+
+        if (!cert || !pkey) {
+            X509_free(cert);
+            EVP_PKEY_free(pkey);
+            return nullptr;
+        }
+
+        CacheCredentials(path, cert, pkey);
+
+        std::lock_guard lock(m_mutex);
+        return m_credentials[path.lexically_normal().string()];
+    }
+
+    void CertificateManager::CacheCredentials(const std::filesystem::path& path, X509* certificate, EVP_PKEY* privateKey) {
+        ZoneScoped;
+        auto credentials = std::make_shared<Credentials>();
+
+        credentials->certificate = std::shared_ptr<X509>(certificate, X509_free);
+        credentials->privateKey = std::shared_ptr<EVP_PKEY>(privateKey, EVP_PKEY_free);
 
-        const bool valid = (X509_cmp_time(X509_get_notBefore(cert), &now) <= 0 &&
-                            X509_cmp_time(X509_get_notAfter(cert), &future) >= 0);
+        std::error_code errorCode;
+        credentials->certificateWriteTime = std::filesystem::last_write_time(path / "certificate.crt", errorCode);
+        credentials->privateKeyWriteTime = std::filesystem::last_write_time(path / "privateKey.key", errorCode);
 
-        X509_free(cert);
-        return valid;
+        std::lock_guard lock(m_mutex);
+        m_credentials.insert_or_assign(path.lexically_normal().string(), std::move(credentials));
     }
 
 
@@ -0,0 +1,220 @@
+#include <ContextProvider.h>
+#include <CryptoPreferences.h>
+#include <SessionCache.h>
+#include <DebugLog.h>
+#include <tracy/Tracy.hpp>
+
+#include <openssl/ssl.h>
+
+namespace TLS {
+    std::mutex                  ContextProvider::m_mutex{};
+    std::condition_variable_any ContextProvider::m_condition{};
+    std::jthread                ContextProvider::m_thread{};
+    std::filesystem::path       ContextProvider::m_certificateDirectory{"./certificates/"};
+    std::shared_ptr<SSLContext> ContextProvider::m_serverContext{nullptr};
+    std::shared_ptr<SSLContext> ContextProvider::m_clientContext{nullptr};
+    std::vector<std::function<void()>> ContextProvider::m_readyCallbacks{};
+
+    void ContextProvider::Start(const std::filesystem::path& certificateDirectory) {
+        ZoneScoped;
+        {
+            std::lock_guard lock(m_mutex);
+            if (m_thread.joinable()) {
+                return;
+            }
+
+            if (m_certificateDirectory != certificateDirectory) {
+                m_serverContext = nullptr;
+                m_clientContext = nullptr;
+            }
+
+            m_certificateDirectory = certificateDirectory;
+        }
+
+        // The first contexts are built before Start returns, so Get only ever reads what is already there
+        Refresh();
+
+        std::lock_guard lock(m_mutex);
+        if (!m_thread.joinable()) {
+            m_thread = std::jthread(Run);
+        }
+    }
+
+    void ContextProvider::Stop() {
+        ZoneScoped;
+        std::jthread thread;
+
+        {
+            std::lock_guard lock(m_mutex);
+            thread = std::move(m_thread);
+        }
+
+        if (thread.joinable()) {
+            thread.request_stop();
+            thread.join();
+        }
+    }
+
+    std::shared_ptr<SSLContext> ContextProvider::Get(const bool isServer) {
+        ZoneScoped;
+        std::lock_guard lock(m_mutex);
+        std::shared_ptr<SSLContext> context = isServer ? m_serverContext : m_clientContext;
+
+        if (context == nullptr) {
+            Debug::LogError("No TLS context available from {}", m_certificateDirectory.string());
+        }
+
+        return context;
+    }
+
+    void ContextProvider::OnReady(std::function<void()> callback) {
+        {
+            std::lock_guard lock(m_mutex);
+            if (m_serverContext == nullptr || m_clientContext == nullptr) {
+                m_readyCallbacks.push_back(std::move(callback));
+                return;
+            }
+        }
+
+        callback();
+    }
+
+    std::shared_ptr<SSLContext> ContextProvider::CreateContext(const std::filesystem::path& certificateDirectory, const bool isServer) {
+        ZoneScoped;
+        const std::shared_ptr<const Credentials> credentials = CertificateManager::LoadCredentials(certificateDirectory);
+        if (!credentials) {
+            throw asio::system_error(asio::error::not_found);
+        }
+
+        return CreateContext(*credentials, isServer);
+    }
+
+    std::shared_ptr<SSLContext> ContextProvider::CreateContext(const Credentials& credentials, const bool isServer) {
+        ZoneScoped;
+        auto ctx = std::make_shared<SSLContext>(isServer ? SSLContext::tlsv13_server : SSLContext::tlsv13_client);
+
+        ctx->set_options(
+            SSLContext::default_workarounds |
+            SSLContext::no_sslv2 |
+            SSLContext::no_sslv3 |
+            SSLContext::no_tlsv1 |
+            SSLContext::no_tlsv1_1
+        );
+
+        if (SSL_CTX_use_certificate(ctx->native_handle(), credentials.certificate.get()) != 1 || SSL_CTX_use_PrivateKey(ctx->native_handle(), credentials.privateKey.get()) != 1) {
+            throw asio::system_error(asio::error::invalid_argument);
+        }
+        ctx->set_verify_mode(asio::ssl::verify_none);
+        CryptoPreferences::Apply(ctx->native_handle());
+
+        if (isServer) {
+            SessionCache::EnableServerTickets(*ctx);
+        } else {
+            SessionCache::EnableClientSessions(*ctx);
+        }
+
+        EnableTransportNegotiation(*ctx, isServer);
+        return ctx;
+    }
+
+    bool ContextProvider::IsTransportNegotiated(const SSL* ssl) {
+        const unsigned char* protocol = nullptr;
+        unsigned int size = 0;
+
+        SSL_get0_alpn_selected(ssl, &protocol, &size);
+        return std::string_view(reinterpret_cast<const char*>(protocol), size) == TLS_TRANSPORT_PROTOCOL;
+    }
+
+    void ContextProvider::EnableTransportNegotiation(SSLContext& context, const bool isServer) {
+        // Advertised over ALPN so that peers predating the transport mode byte are still spoken to in dual-socket mode
+        if (!isServer) {
+            std::string protocols(1, static_cast<char>(TLS_TRANSPORT_PROTOCOL.size()));
+            protocols += TLS_TRANSPORT_PROTOCOL;
+
+            if (SSL_CTX_set_alpn_protos(context.native_handle(), reinterpret_cast<const unsigned char*>(protocols.data()), static_cast<unsigned int>(protocols.size())) != 0) {
+                Debug::LogError("Could not advertise the transport protocol");
+            }
+
+            return;
+        }
+
+        SSL_CTX_set_alpn_select_cb(context.native_handle(), [](SSL*, const unsigned char** selected, unsigned char* selectedSize, const unsigned char* offered, const unsigned int offeredSize, void*) {
+            for (unsigned int offset = 0; offset < offeredSize; offset += 1 + offered[offset]) {
+                const unsigned char size = offered[offset];
+
+                if (offset + 1 + size <= offeredSize && std::string_view(reinterpret_cast<const char*>(offered + offset + 1), size) == TLS_TRANSPORT_PROTOCOL) {
+                    *selected = offered + offset + 1;
+                    *selectedSize = size;
+                    return SSL_TLSEXT_ERR_OK;
+                }
+            }
+
+            return SSL_TLSEXT_ERR_NOACK;
+        }, nullptr);
+    }
+
+    void ContextProvider::Run(const std::stop_token& stopToken) {
+        while (true) {
+            {
+                // Missing contexts are retried quickly, since connections are waiting on them
+                std::unique_lock lock(m_mutex);
+                const bool hasContexts = m_serverContext != nullptr && m_clientContext != nullptr;
+                const std::chrono::steady_clock::duration interval = hasContexts ? std::chrono::steady_clock::duration(TLS_CERTIFICATE_ROTATION_CHECK_INTERVAL) : TLS_CONTEXT_RETRY_INTERVAL;
+
+                m_condition.wait_for(lock, stopToken, interval, [] { return false; });
+            }
+
+            if (stopToken.stop_requested()) {
+                return;
+            }
+
+            Refresh();
+        }
+    }
+
+    void ContextProvider::Refresh() {
+        ZoneScoped;
+        std::filesystem::path certificateDirectory;
+        bool hasContexts;
+
+        {
+            std::lock_guard lock(m_mutex);
+            certificateDirectory = m_certificateDirectory;
+            hasContexts = m_serverContext != nullptr && m_clientContext != nullptr;
+        }
+
+        std::shared_ptr<SSLContext> serverContext;
+        std::shared_ptr<SSLContext> clientContext;
+
+        try {
+            const bool rotate = !CertificateManager::IsCertificateValid(certificateDirectory, TLS_CERTIFICATE_ROTATION_MARGIN);
+            if (rotate) {
+                CertificateManager::GenerateCertificate(certificateDirectory);
+            }
+
+            if (rotate || !hasContexts) {
+                if (const std::shared_ptr<const Credentials> credentials = CertificateManager::LoadCredentials(certificateDirectory)) {
+                    serverContext = CreateContext(*credentials, true);
+                    clientContext = CreateContext(*credentials, false);
+                }
+            }
+        } catch (const std::exception& error) {
+            Debug::LogError("Could not create TLS contexts ({})", error.what());
+        }
+
+        std::vector<std::function<void()>> readyCallbacks;
+
+        {
+            std::lock_guard lock(m_mutex);
+            if (serverContext != nullptr) {
+                m_serverContext = std::move(serverContext);
+                m_clientContext = std::move(clientContext);
+                readyCallbacks.swap(m_readyCallbacks);
+            }
+        }
+
+        for (const std::function<void()>& callback : readyCallbacks) {
+            callback();
+        }
+    }
+}
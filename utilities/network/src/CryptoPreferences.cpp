@@ -0,0 +1,100 @@
+#include <CryptoPreferences.h>
+#include <DebugLog.h>
+#include <tracy/Tracy.hpp>
+
+#include <openssl/ssl.h>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#elif defined(__linux__) && defined(__aarch64__)
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#endif
+
+namespace TLS {
+    std::mutex       CryptoPreferences::m_mutex{};
+    CipherSuite      CryptoPreferences::m_cipherSuite{CipherSuite::AUTO};
+    KeyExchangeGroup CryptoPreferences::m_keyExchangeGroup{KeyExchangeGroup::AUTO};
+
+    static constexpr char AES_GCM_FIRST[] = "TLS_AES_128_GCM_SHA256:TLS_AES_256_GCM_SHA384:TLS_CHACHA20_POLY1305_SHA256";
+    static constexpr char CHACHA20_POLY1305_FIRST[] = "TLS_CHACHA20_POLY1305_SHA256:TLS_AES_128_GCM_SHA256:TLS_AES_256_GCM_SHA384";
+    static constexpr char X25519_FIRST[] = "X25519:P-256";
+    static constexpr char P256_FIRST[] = "P-256:X25519";
+
+    static bool DetectAESAcceleration() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        int info[4];
+        __cpuid(info, 1);
+        return (info[2] & (1 << 25)) != 0;
+#elif defined(__x86_64__) || defined(__i386__)
+        unsigned int eax, ebx, ecx, edx;
+        return __get_cpuid(1, &eax, &ebx, &ecx, &edx) != 0 && (ecx & bit_AES) != 0;
+#elif defined(__aarch64__) && (defined(__APPLE__) || defined(_WIN32))
+        return true;
+#elif defined(__linux__) && defined(__aarch64__)
+        return (getauxval(AT_HWCAP) & HWCAP_AES) != 0;
+#else
+        return false;
+#endif
+    }
+
+    void CryptoPreferences::SetCipherSuite(const CipherSuite cipherSuite) {
+        std::lock_guard lock(m_mutex);
+        m_cipherSuite = cipherSuite;
+    }
+
+    CipherSuite CryptoPreferences::GetCipherSuite() {
+        std::lock_guard lock(m_mutex);
+        return m_cipherSuite;
+    }
+
+    void CryptoPreferences::SetKeyExchangeGroup(const KeyExchangeGroup group) {
+        std::lock_guard lock(m_mutex);
+        m_keyExchangeGroup = group;
+    }
+
+    KeyExchangeGroup CryptoPreferences::GetKeyExchangeGroup() {
+        std::lock_guard lock(m_mutex);
+        return m_keyExchangeGroup;
+    }
+
+    bool CryptoPreferences::HasAESAcceleration() {
+        static const bool hasAESAcceleration = DetectAESAcceleration();
+        return hasAESAcceleration;
+    }
+
+    std::string CryptoPreferences::GetCipherSuiteList(const CipherSuite cipherSuite) {
+        switch (cipherSuite) {
+            case CipherSuite::AES_GCM:
+                return AES_GCM_FIRST;
+            case CipherSuite::CHACHA20_POLY1305:
+                return CHACHA20_POLY1305_FIRST;
+            default:
+                return HasAESAcceleration() ? AES_GCM_FIRST : CHACHA20_POLY1305_FIRST;
+        }
+    }
+
+    std::string CryptoPreferences::GetKeyExchangeGroupList(const KeyExchangeGroup group) {
+        return group == KeyExchangeGroup::P256 ? P256_FIRST : X25519_FIRST;
+    }
+
+    bool CryptoPreferences::Apply(SSL_CTX* context) {
+        return Apply(context, GetCipherSuite(), GetKeyExchangeGroup());
+    }
+
+    bool CryptoPreferences::Apply(SSL_CTX* context, const CipherSuite cipherSuite, const KeyExchangeGroup group) {
+        ZoneScoped;
+        const std::string cipherSuites = GetCipherSuiteList(cipherSuite);
+        const std::string groups = GetKeyExchangeGroupList(group);
+
+        if (SSL_CTX_set_ciphersuites(context, cipherSuites.c_str()) != 1 || SSL_CTX_set1_groups_list(context, groups.c_str()) != 1) {
+            Debug::LogError("Could not apply TLS crypto preferences ({}, {})", cipherSuites, groups);
+            return false;
+        }
+
+        SSL_CTX_set_options(context, SSL_OP_CIPHER_SERVER_PREFERENCE | SSL_OP_PRIORITIZE_CHACHA);
+        return true;
+    }
+}
@@ -0,0 +1,234 @@
+#include <HappyEyeballs.h>
+#include <DebugLog.h>
+#include <tracy/Tracy.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+
+struct ConnectRace {
+    explicit ConnectRace(const asio::any_io_executor& executor) : timer(executor) { }
+
+    std::mutex                             mutex;
+    asio::steady_timer                     timer;
+    std::vector<std::shared_ptr<TCPSocket>> attempts;
+    std::optional<TCPSocket>               winner;
+    asio::error_code                       lastError;
+    size_t                                 pending{0};
+};
+
+static asio::awaitable<void> CoAttempt(std::shared_ptr<ConnectRace> race, std::shared_ptr<TCPSocket> socket, const TCPEndpoint endpoint) {
+    asio::error_code errorCode;
+    co_await socket->async_connect(endpoint, asio::redirect_error(asio::use_awaitable, errorCode));
+
+    std::lock_guard lock(race->mutex);
+    race->pending--;
+
+    if (!errorCode && !race->winner.has_value()) {
+        race->winner.emplace(std::move(*socket));
+    } else if (errorCode && errorCode != asio::error::operation_aborted) {
+        race->lastError = errorCode;
+    }
+
+    race->timer.cancel();
+}
+
+struct AcceptRace {
+    explicit AcceptRace(const asio::any_io_executor& executor) : timer(executor) { }
+
+    std::mutex                             mutex;
+    asio::steady_timer                     timer;
+    std::optional<TCPSocket>               winner;
+    asio::error_code                       lastError;
+    size_t                                 pending{0};
+};
+
+static asio::awaitable<void> CoAcceptAttempt(std::shared_ptr<AcceptRace> race, TCPAcceptor& acceptor) {
+    TCPSocket socket(acceptor.get_executor());
+    asio::error_code errorCode;
+    co_await acceptor.async_accept(socket, asio::redirect_error(asio::use_awaitable, errorCode));
+
+    std::lock_guard lock(race->mutex);
+    race->pending--;
+
+    if (!errorCode && !race->winner.has_value()) {
+        race->winner.emplace(std::move(socket));
+    } else if (errorCode && errorCode != asio::error::operation_aborted) {
+        race->lastError = errorCode;
+    }
+
+    race->timer.cancel();
+}
+
+std::vector<TCPEndpoint> HappyEyeballs::OrderCandidates(const std::vector<IPAddress>& addresses, const uint16_t port) {
+    std::vector<IPAddress> v6;
+    std::vector<IPAddress> v4;
+
+    for (const IPAddress& address : addresses) {
+        std::vector<IPAddress>& family = address.is_v6() ? v6 : v4;
+        if (!address.is_unspecified() && std::ranges::find(family, address) == family.end()) {
+            family.push_back(address);
+        }
+    }
+
+    std::vector<TCPEndpoint> candidates;
+    candidates.reserve(v6.size() + v4.size());
+
+    for (size_t i = 0; i < std::max(v6.size(), v4.size()); i++) {
+        if (i < v6.size()) {
+            candidates.emplace_back(v6[i], port);
+        }
+
+        if (i < v4.size()) {
+            candidates.emplace_back(v4[i], port);
+        }
+    }
+
+    return candidates;
+}
+
+asio::awaitable<void> HappyEyeballs::CoConnect(TCPSocket& socket, std::vector<TCPEndpoint> candidates) {
+    ZoneScoped;
+    if (candidates.empty()) {
+        throw asio::system_error(asio::error::invalid_argument);
+    }
+
+    const auto race = std::make_shared<ConnectRace>(socket.get_executor());
+    asio::error_code errorCode;
+
+    for (size_t i = 0; i < candidates.size(); i++) {
+        {
+            std::lock_guard lock(race->mutex);
+            if (race->winner.has_value()) {
+                break;
+            }
+
+            race->attempts.push_back(std::make_shared<TCPSocket>(socket.get_executor()));
+            race->pending++;
+        }
+
+        asio::co_spawn(socket.get_executor(), CoAttempt(race, race->attempts.back(), candidates[i]), asio::detached);
+
+        race->timer.expires_after(HAPPY_EYEBALLS_ATTEMPT_DELAY);
+        co_await race->timer.async_wait(asio::redirect_error(asio::use_awaitable, errorCode));
+    }
+
+    while (true) {
+        {
+            std::lock_guard lock(race->mutex);
+            if (race->winner.has_value() || race->pending == 0) {
+                break;
+            }
+        }
+
+        race->timer.expires_after(HAPPY_EYEBALLS_ATTEMPT_DELAY);
+        co_await race->timer.async_wait(asio::redirect_error(asio::use_awaitable, errorCode));
+    }
+
+    std::lock_guard lock(race->mutex);
+
+    for (const std::shared_ptr<TCPSocket>& attempt : race->attempts) {
+        attempt->close(errorCode);
+    }
+
+    if (!race->winner.has_value()) {
+        throw asio::system_error(race->lastError ? race->lastError : asio::error::host_unreachable);
+    }
+
+    socket = std::move(*race->winner);
+}
+
+TCPAcceptor HappyEyeballs::OpenAcceptor(IOContext& context, const TCPEndpoint& endpoint) {
+    TCPAcceptor acceptor(context);
+    acceptor.open(endpoint.protocol());
+    acceptor.set_option(TCPAcceptor::reuse_address(true));
+
+    if (endpoint.address().is_v6() && endpoint.address().is_unspecified()) {
+        acceptor.set_option(asio::ip::v6_only(false));
+    }
+
+    acceptor.bind(endpoint);
+    acceptor.listen();
+    return acceptor;
+}
+
+std::vector<TCPAcceptor> HappyEyeballs::OpenAcceptors(IOContext& context, const std::vector<IPAddress>& addresses, const uint16_t port) {
+    ZoneScoped;
+    if (addresses.empty()) {
+        throw asio::system_error(asio::error::invalid_argument);
+    }
+
+    std::vector<TCPAcceptor> acceptors;
+    acceptors.push_back(OpenAcceptor(context, TCPEndpoint(addresses.front(), port)));
+
+    // Every address listens on the port picked for the first one, so the peer can reach any of them with a single port pair
+    const uint16_t boundPort = acceptors.front().local_endpoint().port();
+
+    for (size_t i = 1; i < addresses.size(); i++) {
+        try {
+            acceptors.push_back(OpenAcceptor(context, TCPEndpoint(addresses[i], boundPort)));
+        } catch (const asio::system_error& error) {
+            Debug::LogError("Could not listen on {}:{} ({})", addresses[i].to_string(), boundPort, error.what());
+        }
+    }
+
+    return acceptors;
+}
+
+asio::awaitable<void> HappyEyeballs::CoAccept(std::vector<TCPAcceptor>& acceptors, TCPSocket& socket) {
+    ZoneScoped;
+    if (acceptors.empty()) {
+        throw asio::system_error(asio::error::invalid_argument);
+    }
+
+    const auto race = std::make_shared<AcceptRace>(socket.get_executor());
+    race->pending = acceptors.size();
+
+    for (TCPAcceptor& acceptor : acceptors) {
+        asio::co_spawn(socket.get_executor(), CoAcceptAttempt(race, acceptor), asio::detached);
+    }
+
+    asio::error_code errorCode;
+    bool cancelled = false;
+
+    while (true) {
+        {
+            std::lock_guard lock(race->mutex);
+            if (race->pending == 0) {
+                break;
+            }
+
+            if (race->winner.has_value() && !cancelled) {
+                for (TCPAcceptor& acceptor : acceptors) {
+                    acceptor.cancel(errorCode);
+                }
+
+                cancelled = true;
+            }
+        }
+
+        // The acceptors belong to the caller, so every attempt has to finish before they can go out of scope
+        race->timer.expires_after(HAPPY_EYEBALLS_ATTEMPT_DELAY);
+        co_await race->timer.async_wait(asio::redirect_error(asio::use_awaitable, errorCode));
+    }
+
+    std::lock_guard lock(race->mutex);
+
+    if (!race->winner.has_value()) {
+        throw asio::system_error(race->lastError ? race->lastError : asio::error::operation_aborted);
+    }
+
+    socket = std::move(*race->winner);
+}
+
+std::chrono::milliseconds HappyEyeballs::GetBackoffDelay(const uint32_t attempt) {
+    static thread_local std::mt19937 generator{std::random_device{}()};
+
+    const uint32_t shift = std::min<uint32_t>(attempt, 16);
+    const auto ceiling = std::min(CONNECT_BACKOFF_BASE_DELAY * (int64_t{1} << shift), CONNECT_BACKOFF_MAX_DELAY);
+
+    std::uniform_int_distribution<int64_t> distribution(ceiling.count() / 2, ceiling.count());
+    return std::chrono::milliseconds(distribution(generator));
+}
@@ -0,0 +1,142 @@
+#include <SessionCache.h>
+#include <tracy/Tracy.hpp>
+
+#include <openssl/ssl.h>
+#include <algorithm>
+#include <ctime>
+#include <memory>
+
+namespace TLS {
+    std::mutex                                                  SessionCache::m_mutex{};
+    std::unordered_map<std::string, SessionCache::PeerSessions> SessionCache::m_peers{};
+
+    static constexpr unsigned char SESSION_ID_CONTEXT[] = "PabloConnect";
+
+    static void FreePeer(void*, void* peer, CRYPTO_EX_DATA*, int, long, void*) {
+        delete static_cast<std::string*>(peer);
+    }
+
+    static bool IsExpired(const SSL_SESSION* session) {
+        return SSL_SESSION_is_resumable(session) != 1 || SSL_SESSION_get_time(session) + SSL_SESSION_get_timeout(session) <= std::time(nullptr);
+    }
+
+    void SessionCache::EnableClientSessions(SSLContext& context) {
+        ZoneScoped;
+        SSL_CTX_set_session_cache_mode(context.native_handle(), SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+        SSL_CTX_sess_set_new_cb(context.native_handle(), OnNewSession);
+    }
+
+    void SessionCache::EnableServerTickets(SSLContext& context) {
+        ZoneScoped;
+        SSL_CTX_set_session_cache_mode(context.native_handle(), SSL_SESS_CACHE_SERVER);
+        SSL_CTX_set_session_id_context(context.native_handle(), SESSION_ID_CONTEXT, sizeof(SESSION_ID_CONTEXT) - 1);
+        SSL_CTX_set_num_tickets(context.native_handle(), TLS_SESSION_TICKETS_PER_HANDSHAKE);
+    }
+
+    void SessionCache::Attach(SSL* ssl, const IPAddress& address) {
+        ZoneScoped;
+        auto peer = std::make_unique<std::string>(address.to_string());
+
+        if (SSL_SESSION* session = Take(*peer)) {
+            SSL_set_session(ssl, session);
+            SSL_SESSION_free(session);
+        }
+
+        delete static_cast<std::string*>(SSL_get_ex_data(ssl, GetPeerIndex()));
+        SSL_set_ex_data(ssl, GetPeerIndex(), peer.release());
+    }
+
+    bool SessionCache::IsResumed(SSL* ssl) {
+        return SSL_session_reused(ssl) == 1;
+    }
+
+    size_t SessionCache::GetTicketCount(const IPAddress& address) {
+        std::lock_guard lock(m_mutex);
+        const auto entry = m_peers.find(address.to_string());
+        return entry == m_peers.end() ? 0 : entry->second.sessions.size();
+    }
+
+    void SessionCache::Clear() {
+        ZoneScoped;
+        std::lock_guard lock(m_mutex);
+
+        for (auto& [peer, entry] : m_peers) {
+            for (SSL_SESSION* session : entry.sessions) {
+                SSL_SESSION_free(session);
+            }
+        }
+
+        m_peers.clear();
+    }
+
+    int SessionCache::OnNewSession(SSL* ssl, SSL_SESSION* session) {
+        ZoneScoped;
+        const auto* peer = static_cast<const std::string*>(SSL_get_ex_data(ssl, GetPeerIndex()));
+
+        if (peer == nullptr || SSL_SESSION_is_resumable(session) != 1) {
+            return 0;
+        }
+
+        Store(*peer, session);
+        return 1;
+    }
+
+    SSL_SESSION* SessionCache::Take(const std::string& peer) {
+        std::lock_guard lock(m_mutex);
+        const auto entry = m_peers.find(peer);
+
+        if (entry == m_peers.end()) {
+            return nullptr;
+        }
+
+        std::deque<SSL_SESSION*>& sessions = entry->second.sessions;
+        SSL_SESSION* session = nullptr;
+
+        while (session == nullptr && !sessions.empty()) {
+            session = sessions.back();
+            sessions.pop_back();
+
+            if (IsExpired(session)) {
+                SSL_SESSION_free(session);
+                session = nullptr;
+            }
+        }
+
+        if (sessions.empty()) {
+            m_peers.erase(entry);
+        } else {
+            entry->second.lastUsed = std::chrono::steady_clock::now();
+        }
+
+        return session;
+    }
+
+    void SessionCache::Store(const std::string& peer, SSL_SESSION* session) {
+        std::lock_guard lock(m_mutex);
+        PeerSessions& entry = m_peers[peer];
+
+        entry.sessions.push_back(session);
+        entry.lastUsed = std::chrono::steady_clock::now();
+
+        while (entry.sessions.size() > TLS_SESSION_CACHE_TICKETS_PER_PEER) {
+            SSL_SESSION_free(entry.sessions.front());
+            entry.sessions.pop_front();
+        }
+
+        if (m_peers.size() <= TLS_SESSION_CACHE_MAX_PEERS) {
+            return;
+        }
+
+        const auto oldest = std::ranges::min_element(m_peers, {}, [](const auto& pair) { return pair.second.lastUsed; });
+        for (SSL_SESSION* expired : oldest->second.sessions) {
+            SSL_SESSION_free(expired);
+        }
+
+        m_peers.erase(oldest);
+    }
+
+    int SessionCache::GetPeerIndex() {
+        static const int index = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, FreePeer);
+        return index;
+    }
+}
@@ -0,0 +1,33 @@
+#include <TcpConnectionInfo.h>
+
+#ifdef __linux__
+#include <linux/tcp.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <cstddef>
+#endif
+
+bool TcpConnectionInfo::Query(const int socket, TcpConnectionInfo& info) {
+#ifdef __linux__
+    tcp_info kernelInfo{};
+    socklen_t size = sizeof(kernelInfo);
+
+    if (::getsockopt(socket, IPPROTO_TCP, TCP_INFO, &kernelInfo, &size) != 0 || kernelInfo.tcpi_rtt == 0) {
+        return false;
+    }
+
+    info.roundTripTime = std::chrono::microseconds(kernelInfo.tcpi_rtt);
+
+    // Kernels older than 4.9 return a shorter structure without the delivery rate
+    if (size >= offsetof(tcp_info, tcpi_delivery_rate) + sizeof(kernelInfo.tcpi_delivery_rate)) {
+        info.deliveryRate = kernelInfo.tcpi_delivery_rate;
+        info.applicationLimited = kernelInfo.tcpi_delivery_rate_app_limited;
+    }
+
+    return true;
+#else
+    static_cast<void>(socket);
+    static_cast<void>(info);
+    return false;
+#endif
+}
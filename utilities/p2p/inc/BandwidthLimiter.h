@@ -0,0 +1,69 @@
+#ifndef P2P_BANDWIDTH_LIMITER_H
+#define P2P_BANDWIDTH_LIMITER_H
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#ifndef NO_DISCARD
+#define NO_DISCARD [[nodiscard]]
+#endif
+
+constexpr uint64_t TOKEN_BUCKET_MIN_BURST_SIZE = 64 * 1024;
+
+enum class TrafficClass : uint8_t {
+    ALL,
+    FILE,
+    MESSAGE
+};
+
+class TokenBucket final {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit TokenBucket(std::shared_ptr<TokenBucket> parent = nullptr);
+
+    TokenBucket(const TokenBucket&) = delete;
+    TokenBucket& operator=(const TokenBucket&) = delete;
+
+    void SetRate(uint64_t bytesPerSecond, uint64_t burstSize = 0);
+
+    NO_DISCARD Clock::duration Consume(uint64_t size, bool waitForParents = true, Clock::time_point now = Clock::now());
+    NO_DISCARD uint64_t GetRate() const;
+    NO_DISCARD uint64_t GetBurstSize() const;
+
+private:
+    NO_DISCARD Clock::duration Charge(uint64_t size, Clock::time_point now);
+
+    std::shared_ptr<TokenBucket> m_parent;
+    mutable std::mutex           m_mutex;
+    uint64_t                     m_rate{0};
+    uint64_t                     m_burstSize{0};
+    double                       m_tokens{0.0};
+    Clock::time_point            m_lastRefill{Clock::now()};
+};
+
+class BandwidthLimiter final {
+public:
+    BandwidthLimiter();
+
+    static void SetGlobalRate(uint64_t bytesPerSecond, uint64_t burstSize = 0);
+    NO_DISCARD static uint64_t GetGlobalRate();
+
+    void SetRate(TrafficClass trafficClass, uint64_t bytesPerSecond, uint64_t burstSize = 0);
+    NO_DISCARD uint64_t GetRate(TrafficClass trafficClass) const;
+
+    NO_DISCARD TokenBucket::Clock::duration Acquire(TrafficClass trafficClass, uint64_t size);
+
+private:
+    NO_DISCARD TokenBucket& GetBucket(TrafficClass trafficClass) const;
+
+    static std::shared_ptr<TokenBucket> s_globalBucket;
+
+    std::shared_ptr<TokenBucket> m_connectionBucket;
+    std::shared_ptr<TokenBucket> m_fileBucket;
+    std::shared_ptr<TokenBucket> m_messageBucket;
+};
+
+#endif //P2P_BANDWIDTH_LIMITER_H
@@ -0,0 +1,260 @@
+#ifndef P2P_BLOB_TRANSFER_H
+#define P2P_BLOB_TRANSFER_H
+
+#include <AsioCommon.h>
+#include <DebugLog.h>
+#include <Package.h>
+#include <boost/endian/conversion.hpp>
+#include <tracy/Tracy.hpp>
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#ifndef NO_DISCARD
+#define NO_DISCARD [[nodiscard]]
+#endif
+
+// Blobs without a buffer or stream handler are reassembled in memory, bounded per connection; larger payloads
+// need a handler that supplies a buffer or consumes fragments as they arrive
+constexpr FileSizeInt MAX_BLOB_ASSEMBLY_SIZE = 8 * 1024 * 1024;
+constexpr FileSizeInt MAX_BLOB_PACKAGE_SIZE = MAX_BLOB_ASSEMBLY_SIZE;
+constexpr size_t MAX_INCOMING_BLOBS = 16;
+constexpr uint8_t BLOB_TRANSPORT_FLAGS = static_cast<uint8_t>(PackageFlag::COMPRESSION_HELLO) | static_cast<uint8_t>(PackageFlag::COMPRESSED) | static_cast<uint8_t>(PackageFlag::BLOB_FRAGMENT);
+
+struct BlobFragmentHeader {
+    uint64_t blobID{};
+    uint64_t totalSize{};
+    uint64_t offset{};
+    uint8_t  flags{};
+
+    void FromNativeToBigEndian() {
+        boost::endian::native_to_big_inplace(blobID);
+        boost::endian::native_to_big_inplace(totalSize);
+        boost::endian::native_to_big_inplace(offset);
+        boost::endian::native_to_big_inplace(flags);
+    }
+
+    void FromBigEndianToNative() {
+        boost::endian::big_to_native_inplace(blobID);
+        boost::endian::big_to_native_inplace(totalSize);
+        boost::endian::big_to_native_inplace(offset);
+        boost::endian::big_to_native_inplace(flags);
+    }
+};
+
+constexpr PackageSizeInt BLOB_FRAGMENT_MAX_DATA_SIZE = MAX_NON_FILE_PACKAGE_SIZE - sizeof(BlobFragmentHeader);
+
+struct BlobHandler {
+    std::function<char*(size_t blobID, FileSizeInt size)>                                 acquireBuffer;
+    std::function<bool(size_t blobID, FileSizeInt offset, const char* data, size_t size)> consume;
+    std::function<void(size_t blobID, FileSizeInt size, bool completed)>                  complete;
+};
+
+class OutgoingBlob final {
+public:
+    OutgoingBlob(size_t blobID, PackageTypeInt type, uint8_t flags, const char* data, FileSizeInt size, std::shared_ptr<const void> owner);
+
+    template <PackageType T>
+    NO_DISCARD static std::unique_ptr<OutgoingBlob> FromPackage(const size_t blobID, std::unique_ptr<Package<T>> package) {
+        const PackageHeader header = package->GetHeaderCopy();
+        const char* data = reinterpret_cast<const char*>(package->GetRawBody());
+
+        return std::make_unique<OutgoingBlob>(blobID, header.type, header.flags, data, header.size, std::shared_ptr<const void>(std::move(package)));
+    }
+
+    template <PackageType T>
+    NO_DISCARD std::unique_ptr<Package<T>> NextFragment() {
+        ZoneScoped;
+        const auto dataSize = static_cast<PackageSizeInt>(std::min<FileSizeInt>(m_size - m_offset, BLOB_FRAGMENT_MAX_DATA_SIZE));
+        const PackageHeader packageHeader{m_type, static_cast<PackageSizeInt>(sizeof(BlobFragmentHeader) + dataSize), static_cast<uint8_t>(PackageFlag::BLOB_FRAGMENT)};
+
+        BlobFragmentHeader header{m_blobID, m_size, m_offset, m_flags};
+        header.FromNativeToBigEndian();
+
+        auto fragment = std::make_unique<Package<T>>(packageHeader);
+        std::memcpy(fragment->GetRawBody(), &header, sizeof(BlobFragmentHeader));
+        std::memcpy(fragment->GetRawBody() + sizeof(BlobFragmentHeader), m_data + m_offset, dataSize);
+
+        m_offset += dataSize;
+        m_started = true;
+        return fragment;
+    }
+
+    NO_DISCARD size_t GetBlobID() const;
+    NO_DISCARD bool IsFinished() const;
+
+private:
+    size_t                      m_blobID;
+    PackageTypeInt              m_type;
+    uint8_t                     m_flags;
+    const char*                 m_data;
+    FileSizeInt                 m_size;
+    FileSizeInt                 m_offset{0};
+    bool                        m_started{false};
+    std::shared_ptr<const void> m_owner;
+};
+
+template <PackageType T>
+class BlobAssembler final {
+public:
+    BlobAssembler() = default;
+
+    BlobAssembler(const BlobAssembler&) = delete;
+    BlobAssembler& operator=(const BlobAssembler&) = delete;
+
+    ~BlobAssembler() {
+        Abort();
+    }
+
+    void SetHandler(const T type, BlobHandler handler) {
+        std::lock_guard lock(m_handlerMutex);
+        m_handlers.insert_or_assign(static_cast<PackageTypeInt>(type), std::move(handler));
+    }
+
+    void RemoveHandler(const T type) {
+        std::lock_guard lock(m_handlerMutex);
+        m_handlers.erase(static_cast<PackageTypeInt>(type));
+    }
+
+    bool Receive(Package<T>& fragment, std::unique_ptr<Package<T>>& completed) {
+        ZoneScoped;
+        completed = nullptr;
+
+        const PackageHeader packageHeader = fragment.GetHeaderCopy();
+        if (packageHeader.size < sizeof(BlobFragmentHeader)) {
+            Debug::LogError("Blob fragment too small");
+            return false;
+        }
+
+        BlobFragmentHeader header;
+        std::memcpy(&header, fragment.GetRawBody(), sizeof(BlobFragmentHeader));
+        header.FromBigEndianToNative();
+
+        const char*  data     = reinterpret_cast<const char*>(fragment.GetRawBody()) + sizeof(BlobFragmentHeader);
+        const size_t dataSize = packageHeader.size - sizeof(BlobFragmentHeader);
+
+        auto blob = m_blobs.find(header.blobID);
+        if (blob == m_blobs.end()) {
+            if (header.offset != 0 || m_blobs.size() >= MAX_INCOMING_BLOBS) {
+                Debug::LogError("Unexpected blob fragment");
+                return false;
+            }
+
+            IncomingBlob incoming;
+            if (!Begin(header, packageHeader.type, incoming)) {
+                return false;
+            }
+
+            blob = m_blobs.emplace(header.blobID, std::move(incoming)).first;
+        }
+
+        IncomingBlob& incoming = blob->second;
+        if (header.totalSize != incoming.size || header.offset != incoming.received || dataSize > incoming.size - incoming.received) {
+            Debug::LogError("Invalid blob fragment");
+            return false;
+        }
+
+        if (incoming.buffer != nullptr) {
+            std::memcpy(incoming.buffer + incoming.received, data, dataSize);
+        } else if (incoming.handler.consume) {
+            if (!incoming.handler.consume(header.blobID, incoming.received, data, dataSize)) {
+                Debug::LogError("Blob consumer rejected fragment");
+                return false;
+            }
+        } else {
+            if (dataSize > MAX_BLOB_ASSEMBLY_SIZE - m_assemblySize) {
+                Debug::LogError("Too many blob bytes in flight ({} buffered, {} more received)", m_assemblySize, dataSize);
+                return false;
+            }
+
+            incoming.assembled.insert(incoming.assembled.end(), data, data + dataSize);
+            m_assemblySize += dataSize;
+        }
+
+        incoming.received += dataSize;
+        if (incoming.received < incoming.size) {
+            return true;
+        }
+
+        if (incoming.handler.complete) {
+            incoming.handler.complete(header.blobID, incoming.size, true);
+        }
+
+        if (incoming.buffer == nullptr && !incoming.handler.consume) {
+            completed = std::make_unique<Package<T>>(incoming.header);
+            std::memcpy(completed->GetRawBody(), incoming.assembled.data(), incoming.assembled.size());
+            m_assemblySize -= incoming.size;
+        }
+
+        m_blobs.erase(blob);
+        return true;
+    }
+
+    void Abort() {
+        for (auto& [blobID, incoming] : m_blobs) {
+            if (incoming.handler.complete) {
+                incoming.handler.complete(blobID, incoming.received, false);
+            }
+        }
+
+        m_blobs.clear();
+        m_assemblySize = 0;
+    }
+
+    NO_DISCARD size_t GetIncomingCount() const {
+        return m_blobs.size();
+    }
+
+    NO_DISCARD FileSizeInt GetAssemblySize() const {
+        return m_assemblySize;
+    }
+
+private:
+    struct IncomingBlob {
+        BlobHandler       handler;
+        PackageHeader     header{};
+        std::vector<char> assembled;
+        char*             buffer{nullptr};
+        FileSizeInt       size{0};
+        FileSizeInt       received{0};
+    };
+
+    bool Begin(const BlobFragmentHeader& header, const PackageTypeInt type, IncomingBlob& incoming) {
+        incoming.size = header.totalSize;
+
+        {
+            std::lock_guard lock(m_handlerMutex);
+            if (const auto handler = m_handlers.find(type); handler != m_handlers.end()) {
+                incoming.handler = handler->second;
+            }
+        }
+
+        if (incoming.handler.acquireBuffer) {
+            incoming.buffer = incoming.handler.acquireBuffer(header.blobID, header.totalSize);
+        }
+
+        if (incoming.buffer != nullptr || incoming.handler.consume) {
+            return true;
+        }
+
+        if (header.totalSize > MAX_BLOB_PACKAGE_SIZE) {
+            Debug::LogError("Blob too large to reassemble ({} bytes), register a blob handler to receive it", header.totalSize);
+            return false;
+        }
+
+        // The claimed size is not trusted for allocation: the buffer grows with the fragments that actually arrive
+        incoming.header = {type, static_cast<PackageSizeInt>(header.totalSize), static_cast<uint8_t>(header.flags & ~BLOB_TRANSPORT_FLAGS)};
+        return true;
+    }
+
+    std::unordered_map<size_t, IncomingBlob>        m_blobs;
+    std::unordered_map<PackageTypeInt, BlobHandler> m_handlers;
+    std::mutex                                      m_handlerMutex;
+    FileSizeInt                                     m_assemblySize{0};
+};
+
+#endif //P2P_BLOB_TRANSFER_H
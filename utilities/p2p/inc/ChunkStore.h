@@ -0,0 +1,96 @@
+#ifndef P2P_CHUNK_STORE_H
+#define P2P_CHUNK_STORE_H
+
+#include <AsioCommon.h>
+#include <DeltaSync.h>
+#include <PipelinedHasher.h>
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#ifndef NO_DISCARD
+#define NO_DISCARD [[nodiscard]]
+#endif
+
+constexpr PackageSizeInt CHUNK_STORE_MIN_CHUNK_SIZE = 16 * 1024;
+constexpr PackageSizeInt CHUNK_STORE_AVERAGE_CHUNK_SIZE = 64 * 1024;
+constexpr PackageSizeInt CHUNK_STORE_MAX_CHUNK_SIZE = 256 * 1024;
+constexpr PackageSizeInt CHUNK_STORE_HASH_SIZE = DELTA_STRONG_CHECKSUM_SIZE;
+constexpr size_t CHUNK_STORE_MAX_MANIFEST_CHUNKS = 128 * 1024;
+constexpr size_t CHUNK_STORE_MAX_PENDING_MANIFESTS = 16;
+constexpr PackageSizeInt CHUNK_INSTRUCTION_HEADER_SIZE = sizeof(uint8_t) + sizeof(uint32_t);
+
+using ChunkHash = std::array<uint8_t, CHUNK_STORE_HASH_SIZE>;
+
+enum class ChunkInstruction : uint8_t {
+    LITERAL,
+    REFERENCE,
+    END
+};
+
+struct ChunkHashHasher {
+    size_t operator()(const ChunkHash& hash) const noexcept;
+};
+
+class ContentDefinedChunker final {
+public:
+    NO_DISCARD static size_t FindBoundary(const char* data, size_t size);
+};
+
+class ChunkStore final {
+public:
+    NO_DISCARD static ChunkHash ComputeHash(const char* data, size_t size);
+    NO_DISCARD static std::filesystem::path GetChunkPath(const ChunkHash& hash);
+
+    NO_DISCARD static bool Contains(const ChunkHash& hash);
+    static bool Load(const ChunkHash& hash, std::vector<char>& data);
+    static bool Store(const ChunkHash& hash, const char* data, size_t size);
+    static bool Import(const std::filesystem::path& path);
+
+    // A manifest lists the distinct chunk hashes of one file; the receiver answers it with the hashes its store lacks
+    NO_DISCARD static std::vector<uint8_t> ComputeManifest(const std::filesystem::path& path, size_t limit = CHUNK_STORE_MAX_MANIFEST_CHUNKS);
+    NO_DISCARD static std::vector<uint8_t> FindMissing(const std::vector<uint8_t>& manifest);
+    NO_DISCARD static std::vector<uint8_t> Subtract(const std::vector<uint8_t>& manifest, const std::vector<uint8_t>& missing);
+
+    static void WriteInstruction(std::vector<char>& instructions, ChunkInstruction instruction, uint32_t value);
+    NO_DISCARD static std::pair<ChunkInstruction, uint32_t> ReadInstruction(const char* source);
+};
+
+class ChunkEncoder final {
+public:
+    explicit ChunkEncoder(const std::vector<uint8_t>& knownChunks);
+
+    bool Open(const std::filesystem::path& path);
+    bool Next(std::vector<char>& instructions);
+    void SetHasher(PipelinedHasher* hasher);
+
+    NO_DISCARD bool IsFinished() const {
+        return m_finished;
+    }
+
+    NO_DISCARD FileSizeInt GetReadSize() const {
+        return m_readSize;
+    }
+
+    NO_DISCARD FileSizeInt GetReferencedSize() const {
+        return m_referencedSize;
+    }
+
+private:
+    void Fill();
+
+    std::unordered_set<ChunkHash, ChunkHashHasher> m_knownChunks;
+    std::ifstream                                  m_file;
+    std::vector<char>                              m_data;
+    size_t                                         m_position{0};
+    PipelinedHasher*                               m_hasher{nullptr};
+    FileSizeInt                                    m_readSize{0};
+    FileSizeInt                                    m_referencedSize{0};
+    bool                                           m_endOfFile{false};
+    bool                                           m_finished{false};
+};
+
+#endif //P2P_CHUNK_STORE_H
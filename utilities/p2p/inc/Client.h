@@ -6,7 +6,10 @@
 #include <ConnectionParent.h>
 #include <TCPConnection.h>
 #include <TLSConnection.h>
+#include <UnixConnection.h>
+#include <ReliableUDPConnection.h>
 #include <CertificateManager.h>
+#include <ContextProvider.h>
 #include <UniqueFileNamesGenerator.h>
 #include <tracy/Tracy.hpp>
 
@@ -23,7 +26,9 @@ namespace P2P {
 
     enum class ClientMode : uint8_t {
         TCP_Client,
-        TLS_Client
+        TLS_Client,
+        UNIX_Client,
+        RUDP_Client
     };
 
     class Client {
@@ -34,6 +39,7 @@ namespace P2P {
         //void SeekConnection(ConnectionCallbackData callbackData = {nullptr, nullptr});
         void SeekLocalConnection(std::function<void()> connectionSeekCallback = std::function<void()>{}, std::function<void()> callback = std::function<void()>{});
         void Connect(IPAddress address, std::array<uint16_t, 2> ports, std::function<void()> callback = std::function<void()>{});
+        void Connect(std::vector<IPAddress> addresses, std::array<uint16_t, 2> ports, std::function<void()> callback = std::function<void()>{});
         void Disconnect() const;
 
         void Send(std::unique_ptr<Package<MessageType>>&& message) const;
@@ -43,31 +49,41 @@ namespace P2P {
             auto package = Package<MessageType>::CreateUnique(type, std::forward<Args>(args)...);
             Send(std::move(package));
         }
-        void RequestFile(const std::string& requestedFilePath, const std::string& fileName) const;
+        void SendBlob(MessageType type, std::shared_ptr<const std::vector<char>> data) const;
+        void RequestFile(const std::string& requestedFilePath, const std::string& fileName, uint8_t weight = FILE_TRANSFER_DEFAULT_WEIGHT) const;
+        void RequestDirectory(const std::string& requestedDirectoryPath, const std::string& directoryName, uint8_t weight = FILE_TRANSFER_DEFAULT_WEIGHT) const;
 
         void SetClientMode(ClientMode mode);
+        void SetUnreliable(MessageType type, bool unreliable);
 
         NO_DISCARD ClientMode GetClientMode() const;
         NO_DISCARD ConnectionState GetConnectionState() const;
         NO_DISCARD IPAddress GetConnectionAddress() const;
+        NO_DISCARD std::vector<IPAddress> GetConnectionAddresses() const;
         NO_DISCARD std::array<uint16_t, 2> GetConnectionPorts() const;
+        NO_DISCARD std::shared_ptr<ConnectionParent<MessageType>> GetConnection() const;
 
         void AddHandler(MessageType type, std::function<void(std::unique_ptr<PackageIn<MessageType>>)> handler);
 
 
     private:
-        void CreateTLSConnection(bool isServer);
+        bool CreateTLSConnection(bool isServer);
+        asio::awaitable<void> CoCreateTLSConnection(bool isServer, std::function<void()> start, std::function<void()> callback);
         void CreateTCPConnection();
+        void CreateUnixConnection();
+        void CreateReliableUDPConnection();
+        void ConfigureConnection() const;
         void HandleIncomingPackages();
         void DestroyContext();
 
-        IOContext                   m_context;
-        std::shared_ptr<SSLContext> m_sslContext{nullptr};
+        IOContext m_context;
 
         std::shared_ptr<ConnectionParent<MessageType>> m_connection{nullptr};
         moodycamel::ConcurrentQueue<std::unique_ptr<PackageIn<MessageType>>> m_packagesIn;
 
         ClientMode  m_clientMode;
+        std::array<bool, static_cast<size_t>(MessageType::COUNT)> m_unreliableTypes{};
+        std::vector<IPAddress> m_localAddresses;
         bool m_destroyThreads{false};
 
         asio::executor_work_guard<asio::io_context::executor_type> m_contextWorkGuard;
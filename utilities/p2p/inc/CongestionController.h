@@ -0,0 +1,73 @@
+#ifndef P2P_CONGESTION_CONTROLLER_H
+#define P2P_CONGESTION_CONTROLLER_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#ifndef NO_DISCARD
+#define NO_DISCARD [[nodiscard]]
+#endif
+
+constexpr size_t CONGESTION_MAX_DATAGRAM_SIZE = 1200;
+constexpr size_t CONGESTION_INITIAL_WINDOW = 10 * CONGESTION_MAX_DATAGRAM_SIZE;
+constexpr size_t CONGESTION_MIN_WINDOW = 2 * CONGESTION_MAX_DATAGRAM_SIZE;
+
+enum class CongestionControlAlgorithm : uint8_t {
+    NEW_RENO,
+    CUBIC
+};
+
+class CongestionController {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    virtual ~CongestionController() = default;
+
+    NO_DISCARD static std::unique_ptr<CongestionController> Create(CongestionControlAlgorithm algorithm);
+
+    virtual void OnPacketAcked(size_t size, Clock::time_point sentTime, Clock::time_point now) = 0;
+    virtual void OnPacketLost(Clock::time_point sentTime, Clock::time_point now) = 0;
+    virtual void OnRetransmissionTimeout() = 0;
+
+    NO_DISCARD virtual size_t GetCongestionWindow() const = 0;
+    NO_DISCARD virtual CongestionControlAlgorithm GetAlgorithm() const = 0;
+};
+
+class NewRenoController final : public CongestionController {
+public:
+    void OnPacketAcked(size_t size, Clock::time_point sentTime, Clock::time_point now) override;
+    void OnPacketLost(Clock::time_point sentTime, Clock::time_point now) override;
+    void OnRetransmissionTimeout() override;
+
+    NO_DISCARD size_t GetCongestionWindow() const override;
+    NO_DISCARD CongestionControlAlgorithm GetAlgorithm() const override;
+
+private:
+    size_t            m_window{CONGESTION_INITIAL_WINDOW};
+    size_t            m_slowStartThreshold{SIZE_MAX};
+    size_t            m_ackedBytes{0};
+    Clock::time_point m_recoveryStart{};
+};
+
+class CubicController final : public CongestionController {
+public:
+    void OnPacketAcked(size_t size, Clock::time_point sentTime, Clock::time_point now) override;
+    void OnPacketLost(Clock::time_point sentTime, Clock::time_point now) override;
+    void OnRetransmissionTimeout() override;
+
+    NO_DISCARD size_t GetCongestionWindow() const override;
+    NO_DISCARD CongestionControlAlgorithm GetAlgorithm() const override;
+
+private:
+    size_t            m_window{CONGESTION_INITIAL_WINDOW};
+    size_t            m_slowStartThreshold{SIZE_MAX};
+    double            m_maxWindow{0.0};
+    double            m_renoWindow{0.0};
+    double            m_period{0.0};
+    Clock::time_point m_epochStart{};
+    Clock::time_point m_recoveryStart{};
+};
+
+#endif //P2P_CONGESTION_CONTROLLER_H
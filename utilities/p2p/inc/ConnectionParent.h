@@ -2,6 +2,9 @@
 #define P2P_CONNECTION_PARENT_H
 
 #include <AsioCommon.h>
+#include <BandwidthLimiter.h>
+#include <BlobTransfer.h>
+#include <FileTransferTuner.h>
 #include <Package.h>
 #include <tracy/Tracy.hpp>
 
@@ -14,15 +17,29 @@ class ConnectionParent {
 public:
     virtual ~ConnectionParent() = default;
     virtual void Start(IPAddress address, std::array<uint16_t, 2> ports, std::function<void()> callback) = 0;
+    virtual void Start(std::vector<IPAddress> addresses, std::array<uint16_t, 2> ports, std::function<void()> callback) = 0;
     virtual void Seek(IPAddress address, std::array<uint16_t, 2> ports, std::function<void()> connectionSeekCallback, std::function<void()> callback) = 0;
+    virtual void Seek(std::vector<IPAddress> addresses, std::array<uint16_t, 2> ports, std::function<void()> connectionSeekCallback, std::function<void()> callback) = 0;
     NO_DISCARD virtual ConnectionState GetConnectionState() const = 0;
     virtual void Send(std::unique_ptr<Package<T>>&& package) = 0;
-    virtual void RequestFile(const std::string& requestedFilePath, const std::string& fileName) = 0;
+    virtual size_t SendBlob(T type, std::shared_ptr<const std::vector<char>> data) = 0;
+    virtual void SetBlobHandler(T type, BlobHandler handler) = 0;
+    virtual void SetUnreliable(T type, bool unreliable) = 0;
+    virtual void RequestFile(const std::string& requestedFilePath, const std::string& fileName, uint8_t weight) = 0;
+    virtual void RequestFileRange(const std::string& requestedFilePath, const std::string& fileName, FileSizeInt offset, FileSizeInt size, uint8_t weight, std::function<void(bool)> callback) = 0;
+    virtual void RequestDirectory(const std::string& requestedDirectoryPath, const std::string& directoryName, uint8_t weight) = 0;
     virtual void Disconnect() = 0;
     virtual void DestroyContext() = 0;
 
     NO_DISCARD virtual std::array<uint16_t, 2> GetPorts() const = 0;
     NO_DISCARD virtual IPAddress GetAddress() const = 0;
+    NO_DISCARD virtual FileTransferTuning GetFileSendTuning() const = 0;
+    NO_DISCARD virtual FileTransferTuning GetFileReceiveTuning() const = 0;
+
+    virtual void SetSendRate(TrafficClass trafficClass, uint64_t bytesPerSecond, uint64_t burstSize) = 0;
+    NO_DISCARD virtual uint64_t GetSendRate(TrafficClass trafficClass) const = 0;
+    NO_DISCARD virtual CompressionAlgorithm GetCompressionAlgorithm() const = 0;
+    NO_DISCARD virtual bool IsDatagramChannelOpen() const = 0;
 };
 
 template <PackageType T>
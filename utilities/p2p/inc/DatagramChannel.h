@@ -0,0 +1,105 @@
+#ifndef P2P_DATAGRAM_CHANNEL_H
+#define P2P_DATAGRAM_CHANNEL_H
+
+#include <AsioCommon.h>
+#include <Package.h>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#ifndef NO_DISCARD
+#define NO_DISCARD [[nodiscard]]
+#endif
+
+typedef struct ssl_st SSL;
+
+constexpr size_t DATAGRAM_MAX_SIZE = 1200;
+constexpr size_t DATAGRAM_KEY_SIZE = 32;
+constexpr size_t DATAGRAM_TAG_SIZE = 16;
+constexpr size_t DATAGRAM_NONCE_SIZE = 12;
+constexpr size_t DATAGRAM_MAX_IN_FLIGHT = 256;
+
+struct DatagramHeader {
+    uint64_t      sequence{};
+    PackageHeader package{};
+
+    void FromNativeToBigEndian() {
+        boost::endian::native_to_big_inplace(sequence);
+        package.FromNativeToBigEndian();
+    }
+
+    void FromBigEndianToNative() {
+        boost::endian::big_to_native_inplace(sequence);
+        package.FromBigEndianToNative();
+    }
+};
+
+constexpr PackageSizeInt DATAGRAM_MAX_PAYLOAD_SIZE = DATAGRAM_MAX_SIZE - sizeof(DatagramHeader) - DATAGRAM_TAG_SIZE;
+
+typedef std::array<uint8_t, DATAGRAM_KEY_SIZE> DatagramKey;
+
+class DatagramChannel final : public std::enable_shared_from_this<DatagramChannel> {
+public:
+    using ReceiveHandler = std::function<void(const PackageHeader& header, const char* body)>;
+
+    explicit DatagramChannel(IOContext& context);
+
+    DatagramChannel(const DatagramChannel&) = delete;
+    DatagramChannel& operator=(const DatagramChannel&) = delete;
+
+    NO_DISCARD static bool ExportKeys(SSL* ssl, bool isServer, DatagramKey& sendKey, DatagramKey& receiveKey);
+
+    uint16_t Open(const IPAddress& address);
+    void SetKeys(const DatagramKey& sendKey, const DatagramKey& receiveKey);
+    void Start(ReceiveHandler handler);
+    void Connect(const UDPEndpoint& peer);
+    void Close();
+
+    bool Send(const PackageHeader& header, const uint8_t* body);
+
+    void SetUnreliable(PackageTypeInt type, bool unreliable);
+    NO_DISCARD bool IsUnreliable(PackageTypeInt type) const;
+
+    NO_DISCARD bool IsConnected() const {
+        return m_connected.load(std::memory_order_acquire);
+    }
+
+    NO_DISCARD uint16_t GetPort() const {
+        return m_port;
+    }
+
+    NO_DISCARD uint64_t GetDroppedCount() const {
+        return m_dropped.load(std::memory_order_relaxed);
+    }
+
+private:
+    static asio::awaitable<void> CoReceive(std::shared_ptr<DatagramChannel> channel);
+
+    bool Accept(char* datagram, size_t size);
+
+    UDPSocket   m_socket;
+    UDPEndpoint m_peer;
+    uint16_t    m_port{0};
+
+    std::atomic<bool>     m_connected{false};
+    std::atomic<uint64_t> m_sequence{1};
+    std::atomic<size_t>   m_inFlight{0};
+    std::atomic<uint64_t> m_dropped{0};
+
+    std::optional<DatagramKey> m_sendKey;
+    std::optional<DatagramKey> m_receiveKey;
+
+    ReceiveHandler                               m_handler;
+    std::unordered_map<PackageTypeInt, uint64_t> m_lastSequences;
+
+    mutable std::mutex                 m_unreliableMutex;
+    std::unordered_set<PackageTypeInt> m_unreliableTypes;
+};
+
+#endif //P2P_DATAGRAM_CHANNEL_H
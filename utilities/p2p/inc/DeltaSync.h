@@ -0,0 +1,125 @@
+#ifndef P2P_DELTA_SYNC_H
+#define P2P_DELTA_SYNC_H
+
+#include <AsioCommon.h>
+#include <PipelinedHasher.h>
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#ifndef NO_DISCARD
+#define NO_DISCARD [[nodiscard]]
+#endif
+
+constexpr FileSizeInt DELTA_MIN_FILE_SIZE = 64 * 1024;
+constexpr PackageSizeInt DELTA_MIN_BLOCK_SIZE = 2 * 1024;
+constexpr PackageSizeInt DELTA_MAX_BLOCK_SIZE = 128 * 1024;
+constexpr PackageSizeInt DELTA_STRONG_CHECKSUM_SIZE = 16;
+constexpr PackageSizeInt DELTA_INSTRUCTION_HEADER_SIZE = sizeof(uint8_t) + sizeof(uint32_t);
+constexpr PackageSizeInt DELTA_MAX_LITERAL_SIZE = FILE_BUFFER_SIZE;
+
+enum class DeltaInstruction : uint8_t {
+    LITERAL,
+    COPY,
+    END
+};
+
+struct DeltaSignature {
+    PackageSizeInt        blockSize{0};
+    std::vector<uint32_t> weakChecksums;
+    std::vector<uint8_t>  strongChecksums;
+};
+
+class RollingChecksum final {
+public:
+    void Reset(const char* data, size_t size);
+    void Roll(uint8_t outgoing, uint8_t incoming);
+
+    NO_DISCARD uint32_t GetValue() const {
+        return (m_a & 0xFFFF) | (m_b << 16);
+    }
+
+private:
+    uint32_t m_a{0};
+    uint32_t m_b{0};
+    uint32_t m_size{0};
+};
+
+class DeltaSync final {
+public:
+    NO_DISCARD static PackageSizeInt GetBlockSize(FileSizeInt fileSize);
+    static bool ComputeSignature(const std::filesystem::path& path, DeltaSignature& signature);
+    NO_DISCARD static std::array<uint8_t, DELTA_STRONG_CHECKSUM_SIZE> ComputeStrongChecksum(const char* data, size_t size);
+
+    static void WriteInstruction(char* destination, DeltaInstruction instruction, uint32_t value);
+    NO_DISCARD static std::pair<DeltaInstruction, uint32_t> ReadInstruction(const char* source);
+};
+
+class DeltaEncoder final {
+public:
+    explicit DeltaEncoder(DeltaSignature signature);
+
+    bool Open(const std::filesystem::path& path);
+    bool Next(std::vector<char>& instructions);
+    void SetHasher(PipelinedHasher* hasher);
+
+    NO_DISCARD bool IsFinished() const {
+        return m_finished;
+    }
+
+    NO_DISCARD FileSizeInt GetReadSize() const {
+        return m_readSize;
+    }
+
+private:
+    void Fill();
+    NO_DISCARD std::optional<uint32_t> FindBlock() const;
+    void AppendLiteral(std::vector<char>& instructions);
+    static void AppendInstruction(std::vector<char>& instructions, DeltaInstruction instruction, uint32_t value);
+
+    DeltaSignature                                      m_signature;
+    std::unordered_map<uint32_t, std::vector<uint32_t>> m_blocks;
+    std::ifstream                                       m_file;
+    std::vector<char>                                   m_data;
+    size_t                                              m_position{0};
+    size_t                                              m_literalStart{0};
+    RollingChecksum                                     m_checksum;
+    PipelinedHasher*                                    m_hasher{nullptr};
+    FileSizeInt                                         m_readSize{0};
+    bool                                                m_checksumValid{false};
+    bool                                                m_endOfFile{false};
+    bool                                                m_finished{false};
+};
+
+class DeltaPatcher final {
+public:
+    DeltaPatcher(std::filesystem::path basisPath, PackageSizeInt blockSize);
+
+    bool Open();
+    bool ApplyCopy(uint32_t block);
+    bool ApplyLiteral(const char* data, size_t size);
+    bool Commit();
+    void Abort();
+    void SetHasher(PipelinedHasher* hasher);
+
+    NO_DISCARD FileSizeInt GetWrittenSize() const {
+        return m_writtenSize;
+    }
+
+private:
+    std::filesystem::path m_basisPath;
+    std::filesystem::path m_temporaryPath;
+    PackageSizeInt        m_blockSize;
+    uint32_t              m_blockCount{0};
+    std::ifstream         m_basis;
+    std::ofstream         m_output;
+    std::vector<char>     m_blockBuffer;
+    PipelinedHasher*      m_hasher{nullptr};
+    FileSizeInt           m_writtenSize{0};
+};
+
+#endif //P2P_DELTA_SYNC_H
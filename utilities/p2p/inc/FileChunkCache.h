@@ -0,0 +1,83 @@
+#ifndef P2P_FILE_CHUNK_CACHE_H
+#define P2P_FILE_CHUNK_CACHE_H
+
+#include <AsioCommon.h>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#ifndef NO_DISCARD
+#define NO_DISCARD [[nodiscard]]
+#endif
+
+constexpr size_t FILE_CHUNK_CACHE_DEFAULT_CAPACITY = 256 * 1024 * 1024;
+constexpr FileSizeInt FILE_CHUNK_CACHE_BLOCK_SIZE = FILE_BUFFER_SIZE;
+
+// Entries are fixed, aligned blocks of FILE_CHUNK_CACHE_BLOCK_SIZE bytes (shorter only at the end of the file), so
+// peers with different chunk sizes share them; offset is always a multiple of the block size
+struct FileChunkKey {
+    std::string path;
+    int64_t     modificationTime{};
+    FileSizeInt fileSize{};
+    FileSizeInt offset{};
+
+    bool operator==(const FileChunkKey& other) const = default;
+};
+
+struct FileChunkKeyHash {
+    size_t operator()(const FileChunkKey& key) const;
+};
+
+struct FileChunkCacheStats {
+    uint64_t hits{0};
+    uint64_t misses{0};
+    uint64_t bytesSaved{0};
+    size_t   size{0};
+    size_t   capacity{0};
+
+    NO_DISCARD double GetHitRate() const {
+        const uint64_t lookups = hits + misses;
+        return lookups == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(lookups);
+    }
+};
+
+class FileChunkCache final {
+public:
+    using Chunk = std::shared_ptr<const std::vector<char>>;
+
+    NO_DISCARD static Chunk Find(const FileChunkKey& key);
+    static void Insert(const FileChunkKey& key, Chunk chunk);
+
+    static void SetCapacity(size_t capacity);
+    NO_DISCARD static size_t GetCapacity();
+    NO_DISCARD static bool IsEnabled();
+
+    NO_DISCARD static FileChunkCacheStats GetStats();
+    static void Clear();
+
+private:
+    struct Entry {
+        FileChunkKey key;
+        Chunk        chunk;
+    };
+
+    using EntryList = std::list<Entry>;
+    using EntryIndex = std::unordered_map<FileChunkKey, EntryList::iterator, FileChunkKeyHash>;
+
+    static void Evict(size_t capacity);
+
+    static std::mutex s_mutex;
+    static EntryList  s_entries;
+    static EntryIndex s_index;
+    static size_t     s_size;
+    static size_t     s_capacity;
+    static uint64_t   s_hits;
+    static uint64_t   s_misses;
+    static uint64_t   s_bytesSaved;
+};
+
+#endif //P2P_FILE_CHUNK_CACHE_H
@@ -0,0 +1,12 @@
+#ifndef P2P_FILE_SCHEDULING_POLICY_H
+#define P2P_FILE_SCHEDULING_POLICY_H
+
+#include <cstdint>
+
+enum class FileSchedulingPolicy : uint8_t {
+    ROUND_ROBIN,
+    SHORTEST_REMAINING_FIRST,
+    WEIGHTED
+};
+
+#endif //P2P_FILE_SCHEDULING_POLICY_H
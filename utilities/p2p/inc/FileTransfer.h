@@ -0,0 +1,401 @@
+#ifndef P2P_FILE_TRANSFER_H
+#define P2P_FILE_TRANSFER_H
+
+#include <AsioCommon.h>
+#include <ChunkStore.h>
+#include <Compression.h>
+#include <DeltaSync.h>
+#include <FileChunkCache.h>
+#include <FileTransferCheckpoint.h>
+#include <MemoryMappedFile.h>
+#include <ParallelFileWriter.h>
+#include <PipelinedHasher.h>
+#include <SparseFile.h>
+#include <boost/endian/conversion.hpp>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+#ifndef NO_DISCARD
+#define NO_DISCARD [[nodiscard]]
+#endif
+
+constexpr PackageSizeInt FILE_CHUNK_MAX_SIZE = 4 * FILE_BUFFER_SIZE;
+constexpr uint8_t FILE_TRANSFER_DEFAULT_WEIGHT = 16;
+constexpr PackageSizeInt TREE_MANIFEST_MAX_SIZE = 64 * 1024 * 1024;
+constexpr PackageSizeInt TREE_PARALLEL_WRITE_MAX_SIZE = 1024 * 1024;
+constexpr FileSizeInt FILE_MMAP_WINDOW_SIZE = 64 * 1024 * 1024;
+
+enum class TreeEntryType : uint8_t {
+    FILE,
+    DIRECTORY
+};
+
+enum class FileChunkFlag : uint8_t {
+    NONE       = 0,
+    END        = 1 << 0,
+    COMPRESSED = 1 << 1
+};
+
+struct FileChunkHeader {
+    uint64_t requestID{};
+    uint32_t size{};
+    uint8_t  flags{};
+
+    void FromNativeToBigEndian() {
+        boost::endian::native_to_big_inplace(requestID);
+        boost::endian::native_to_big_inplace(size);
+        boost::endian::native_to_big_inplace(flags);
+    }
+
+    void FromBigEndianToNative() {
+        boost::endian::big_to_native_inplace(requestID);
+        boost::endian::big_to_native_inplace(size);
+        boost::endian::big_to_native_inplace(flags);
+    }
+};
+
+class FileTransferSource {
+public:
+    FileTransferSource(size_t requestID, uint8_t weight);
+    virtual ~FileTransferSource() = default;
+
+    FileTransferSource(const FileTransferSource&) = delete;
+    FileTransferSource& operator=(const FileTransferSource&) = delete;
+
+    virtual bool Open() = 0;
+    virtual bool Read() = 0;
+    virtual void Release();
+
+    void SetChunkSize(PackageSizeInt chunkSize);
+
+    NO_DISCARD virtual bool IsFinished() const = 0;
+    NO_DISCARD virtual FileSizeInt GetRemainingSize() const = 0;
+
+    NO_DISCARD HashDigest Finish();
+
+    asio::awaitable<void> CoWaitReadable();
+    asio::awaitable<HashDigest> CoFinish();
+
+    NO_DISCARD const std::vector<char>& GetChunk() const {
+        return m_sharedChunk != nullptr ? *m_sharedChunk : m_chunk;
+    }
+
+    NO_DISCARD size_t GetRequestID() const {
+        return m_requestID;
+    }
+
+    NO_DISCARD uint8_t GetWeight() const {
+        return m_weight;
+    }
+
+protected:
+    size_t                m_requestID;
+    uint8_t               m_weight;
+    PackageSizeInt        m_chunkSize{FILE_BUFFER_SIZE};
+    std::vector<char>     m_chunk;
+    FileChunkCache::Chunk m_sharedChunk;
+    PipelinedHasher       m_hasher;
+};
+
+class RangeFileSource final : public FileTransferSource {
+public:
+    RangeFileSource(size_t requestID, uint8_t weight, std::filesystem::path filePath, FileSizeInt offset, FileSizeInt size);
+
+    bool Open() override;
+    bool Read() override;
+    void Release() override;
+
+    NO_DISCARD bool IsFinished() const override;
+    NO_DISCARD FileSizeInt GetRemainingSize() const override;
+
+    NO_DISCARD FileSizeInt GetOffset() const {
+        return m_offset;
+    }
+
+    NO_DISCARD FileSizeInt GetSize() const {
+        return m_size;
+    }
+
+    NO_DISCARD FileSizeInt GetTotalSize() const {
+        return m_totalSize;
+    }
+
+    NO_DISCARD FileSizeInt GetDataSize() const {
+        return m_dataSize;
+    }
+
+    NO_DISCARD const std::vector<FileExtent>& GetDataExtents() const {
+        return m_extents;
+    }
+
+    NO_DISCARD bool IsSparse() const;
+
+private:
+    bool ReadCached(FileSizeInt position, PackageSizeInt size);
+    FileChunkCache::Chunk LoadBlock(FileSizeInt offset);
+    void Advance(PackageSizeInt size);
+
+    std::filesystem::path   m_filePath;
+    std::ifstream           m_file;
+    FileChunkKey            m_cacheKey;
+    FileChunkCache::Chunk   m_block;
+    std::vector<FileExtent> m_extents;
+    size_t                  m_extentIndex{0};
+    FileSizeInt             m_extentRead{0};
+    FileSizeInt             m_offset;
+    FileSizeInt             m_size;
+    FileSizeInt             m_dataSize{0};
+    FileSizeInt             m_totalSize{0};
+    FileSizeInt             m_sent{0};
+    bool                    m_cacheEnabled{false};
+    bool                    m_seekRequired{true};
+};
+
+class DeltaFileSource final : public FileTransferSource {
+public:
+    DeltaFileSource(size_t requestID, uint8_t weight, std::filesystem::path filePath, DeltaSignature signature);
+
+    bool Open() override;
+    bool Read() override;
+
+    NO_DISCARD bool IsFinished() const override;
+    NO_DISCARD FileSizeInt GetRemainingSize() const override;
+
+    NO_DISCARD PackageSizeInt GetBlockSize() const {
+        return m_blockSize;
+    }
+
+    NO_DISCARD FileSizeInt GetTotalSize() const {
+        return m_totalSize;
+    }
+
+private:
+    std::filesystem::path m_filePath;
+    PackageSizeInt        m_blockSize;
+    FileSizeInt           m_totalSize{0};
+    DeltaEncoder          m_encoder;
+};
+
+class ChunkedFileSource final : public FileTransferSource {
+public:
+    ChunkedFileSource(size_t requestID, uint8_t weight, std::filesystem::path filePath, const std::vector<uint8_t>& knownChunks);
+
+    bool Open() override;
+    bool Read() override;
+
+    NO_DISCARD bool IsFinished() const override;
+    NO_DISCARD FileSizeInt GetRemainingSize() const override;
+
+    NO_DISCARD FileSizeInt GetTotalSize() const {
+        return m_totalSize;
+    }
+
+private:
+    std::filesystem::path m_filePath;
+    FileSizeInt           m_totalSize{0};
+    ChunkEncoder          m_encoder;
+};
+
+class TreeFileSource final : public FileTransferSource {
+public:
+    TreeFileSource(size_t requestID, uint8_t weight, std::filesystem::path rootPath);
+
+    bool Open() override;
+    bool Read() override;
+    void Release() override;
+
+    NO_DISCARD bool IsFinished() const override;
+    NO_DISCARD FileSizeInt GetRemainingSize() const override;
+
+    NO_DISCARD PackageSizeInt GetManifestSize() const {
+        return static_cast<PackageSizeInt>(m_manifest.size());
+    }
+
+    NO_DISCARD FileSizeInt GetContentSize() const {
+        return m_contentSize;
+    }
+
+private:
+    struct Entry {
+        std::filesystem::path path;
+        FileSizeInt           size;
+    };
+
+    std::filesystem::path m_rootPath;
+    std::vector<char>     m_manifest;
+    std::vector<Entry>    m_files;
+    size_t                m_fileIndex{0};
+    std::ifstream         m_file;
+    FileSizeInt           m_fileRemaining{0};
+    FileSizeInt           m_contentSize{0};
+    FileSizeInt           m_sent{0};
+};
+
+class FileTransferSink {
+public:
+    virtual ~FileTransferSink() = default;
+
+    virtual bool Open() = 0;
+    virtual bool Write(std::vector<char>& buffer, size_t size) = 0;
+    virtual bool Finish(const HashDigest& digest) = 0;
+
+    NO_DISCARD virtual char* Reserve(size_t size);
+    virtual bool Commit(size_t size);
+
+    NO_DISCARD virtual bool IsVerified() const;
+
+    // Awaited by the receive loop so that Reserve, Write and Finish find the hasher ready instead of blocking on it
+    virtual asio::awaitable<void> CoWaitWritable(size_t size);
+    virtual asio::awaitable<bool> CoWrite(std::vector<char>& buffer, size_t size);
+    virtual asio::awaitable<bool> CoFinish(const HashDigest& digest);
+
+    bool WriteCompressed(const std::vector<char>& buffer, size_t size, std::vector<char>& decompressedBuffer);
+    asio::awaitable<bool> CoWriteCompressed(const std::vector<char>& buffer, size_t size, std::vector<char>& decompressedBuffer);
+
+protected:
+    PipelinedHasher m_hasher;
+};
+
+class RangeFileSink final : public FileTransferSink {
+public:
+    RangeFileSink(std::filesystem::path filePath, FileSizeInt offset, FileSizeInt size, FileSizeInt totalSize);
+    ~RangeFileSink() override;
+
+    bool Open() override;
+    bool Write(std::vector<char>& buffer, size_t size) override;
+    bool Finish(const HashDigest& digest) override;
+
+    NO_DISCARD char* Reserve(size_t size) override;
+    bool Commit(size_t size) override;
+
+    NO_DISCARD bool IsVerified() const override;
+
+    asio::awaitable<void> CoWaitWritable(size_t size) override;
+
+    void SetDataExtents(std::vector<FileExtent> extents);
+
+    NO_DISCARD bool IsMemoryMapped() const {
+        return m_mapped.IsOpen();
+    }
+
+private:
+    void SaveCheckpoint();
+    void Advance(size_t size);
+
+    NO_DISCARD bool FitsExtent(size_t size) const;
+    NO_DISCARD FileSizeInt GetPosition() const;
+    NO_DISCARD FileSizeInt GetCompletedSpan() const;
+
+    std::filesystem::path                   m_filePath;
+    std::shared_ptr<FileTransferCheckpoint> m_checkpoint;
+    std::fstream                            m_file;
+    MemoryMappedFile                        m_mapped;
+    std::vector<FileExtent>                 m_extents;
+    size_t                                  m_extentIndex{0};
+    FileSizeInt                             m_extentReceived{0};
+    char*                                   m_reserved{nullptr};
+    FileSizeInt                             m_offset;
+    FileSizeInt                             m_size;
+    FileSizeInt                             m_dataSize{0};
+    FileSizeInt                             m_totalSize;
+    FileSizeInt                             m_received{0};
+    FileSizeInt                             m_lastCheckpoint{0};
+    bool                                    m_sparse{false};
+    bool                                    m_seekRequired{true};
+    bool                                    m_finished{false};
+    bool                                    m_verified{false};
+};
+
+class DeltaFileSink final : public FileTransferSink {
+public:
+    DeltaFileSink(std::filesystem::path filePath, PackageSizeInt blockSize, FileSizeInt totalSize);
+    ~DeltaFileSink() override;
+
+    bool Open() override;
+    bool Write(std::vector<char>& buffer, size_t size) override;
+    bool Finish(const HashDigest& digest) override;
+
+    NO_DISCARD bool IsVerified() const override;
+
+private:
+    std::filesystem::path m_filePath;
+    FileSizeInt           m_totalSize;
+    DeltaPatcher          m_patcher;
+    bool                  m_ended{false};
+    bool                  m_finished{false};
+    bool                  m_verified{false};
+};
+
+class ChunkedFileSink final : public FileTransferSink {
+public:
+    ChunkedFileSink(std::filesystem::path filePath, FileSizeInt totalSize);
+    ~ChunkedFileSink() override;
+
+    bool Open() override;
+    bool Write(std::vector<char>& buffer, size_t size) override;
+    bool Finish(const HashDigest& digest) override;
+
+    NO_DISCARD bool IsVerified() const override;
+
+    asio::awaitable<bool> CoWrite(std::vector<char>& buffer, size_t size) override;
+
+private:
+    bool Append(const char* data, size_t size);
+    void Abort();
+
+    std::filesystem::path m_filePath;
+    std::filesystem::path m_temporaryPath;
+    FileSizeInt           m_totalSize;
+    FileSizeInt           m_writtenSize{0};
+    std::ofstream         m_output;
+    std::vector<char>     m_chunk;
+    bool                  m_ended{false};
+    bool                  m_finished{false};
+    bool                  m_verified{false};
+};
+
+class TreeFileSink final : public FileTransferSink {
+public:
+    TreeFileSink(std::filesystem::path rootPath, PackageSizeInt manifestSize, FileSizeInt contentSize);
+    ~TreeFileSink() override;
+
+    bool Open() override;
+    bool Write(std::vector<char>& buffer, size_t size) override;
+    bool Finish(const HashDigest& digest) override;
+
+    NO_DISCARD bool IsVerified() const override;
+
+    asio::awaitable<void> CoWaitWritable(size_t size) override;
+    asio::awaitable<bool> CoFinish(const HashDigest& digest) override;
+
+private:
+    struct Entry {
+        std::filesystem::path path;
+        FileSizeInt           size;
+    };
+
+    bool ParseManifest();
+    bool ConsumeContent(const char* data, size_t size);
+    bool CompleteFile();
+    bool OpenNextFile();
+    void Discard();
+
+    std::filesystem::path              m_rootPath;
+    PackageSizeInt                     m_manifestSize;
+    FileSizeInt                        m_contentSize;
+    std::vector<char>                  m_manifest;
+    std::vector<Entry>                 m_files;
+    std::vector<std::filesystem::path> m_createdDirectories;
+    size_t                             m_fileIndex{0};
+    FileSizeInt                        m_fileRemaining{0};
+    std::vector<char>                  m_smallFile;
+    std::ofstream                      m_largeFile;
+    ParallelFileWriter                 m_writer;
+    bool                               m_manifestParsed{false};
+    bool                               m_verified{false};
+    bool                               m_discarded{false};
+};
+
+#endif //P2P_FILE_TRANSFER_H
@@ -0,0 +1,61 @@
+#ifndef P2P_FILE_TRANSFER_CHECKPOINT_H
+#define P2P_FILE_TRANSFER_CHECKPOINT_H
+
+#include <AsioCommon.h>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#ifndef NO_DISCARD
+#define NO_DISCARD [[nodiscard]]
+#endif
+
+class FileTransferCheckpoint final {
+public:
+    explicit FileTransferCheckpoint(std::filesystem::path filePath);
+
+    FileTransferCheckpoint(const FileTransferCheckpoint&) = delete;
+    FileTransferCheckpoint& operator=(const FileTransferCheckpoint&) = delete;
+
+    NO_DISCARD static std::shared_ptr<FileTransferCheckpoint> Acquire(const std::filesystem::path& filePath);
+    NO_DISCARD static std::filesystem::path GetSidecarPath(const std::filesystem::path& filePath);
+
+    void Reset(FileSizeInt totalSize);
+    void MarkReceived(FileSizeInt offset, FileSizeInt size);
+    void MarkMissing(FileSizeInt offset, FileSizeInt size);
+
+    NO_DISCARD std::vector<std::pair<FileSizeInt, FileSizeInt>> GetMissingRanges() const;
+    NO_DISCARD FileSizeInt GetTotalSize() const;
+    NO_DISCARD bool IsStarted() const;
+    NO_DISCARD bool IsComplete() const;
+
+    bool Save() const;
+    void Remove();
+
+    void Hold();
+    void Release();
+
+private:
+    bool Load();
+
+    NO_DISCARD size_t GetChunkCount() const;
+    NO_DISCARD bool IsChunkReceived(size_t chunk) const;
+    NO_DISCARD bool IsEveryChunkReceived() const;
+    void SetChunkReceived(size_t chunk, bool received);
+    void Clear();
+
+    static std::mutex                                                             s_registryMutex;
+    static std::unordered_map<std::string, std::weak_ptr<FileTransferCheckpoint>> s_registry;
+
+    mutable std::mutex    m_mutex;
+    std::filesystem::path m_filePath;
+    FileSizeInt           m_totalSize{0};
+    bool                  m_started{false};
+    std::vector<uint8_t>  m_receivedChunks;
+    size_t                m_holds{0};
+};
+
+#endif //P2P_FILE_TRANSFER_CHECKPOINT_H
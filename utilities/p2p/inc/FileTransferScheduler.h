@@ -0,0 +1,43 @@
+#ifndef P2P_FILE_TRANSFER_SCHEDULER_H
+#define P2P_FILE_TRANSFER_SCHEDULER_H
+
+#include <FileSchedulingPolicy.h>
+#include <FileTransfer.h>
+#include <memory>
+#include <vector>
+
+#ifndef NO_DISCARD
+#define NO_DISCARD [[nodiscard]]
+#endif
+
+class FileTransferScheduler final {
+public:
+    explicit FileTransferScheduler(FileSchedulingPolicy policy = FileSchedulingPolicy::ROUND_ROBIN);
+
+    void SetPolicy(FileSchedulingPolicy policy);
+    void Add(std::unique_ptr<FileTransferSource> source);
+    void Remove(const FileTransferSource* source);
+    void Charge(const FileTransferSource* source, PackageSizeInt size);
+
+    NO_DISCARD FileTransferSource* Next();
+    NO_DISCARD FileSchedulingPolicy GetPolicy() const;
+    NO_DISCARD size_t GetSize() const;
+    NO_DISCARD bool IsEmpty() const;
+
+private:
+    struct Entry {
+        std::unique_ptr<FileTransferSource> source;
+        uint64_t                            pass{0};
+    };
+
+    NO_DISCARD std::vector<Entry>::iterator Find(const FileTransferSource* source);
+    NO_DISCARD uint64_t GetMinimumPass() const;
+
+    static constexpr uint64_t STRIDE = 1 << 16;
+
+    FileSchedulingPolicy m_policy;
+    std::vector<Entry>   m_entries;
+    size_t               m_cursor{0};
+};
+
+#endif //P2P_FILE_TRANSFER_SCHEDULER_H
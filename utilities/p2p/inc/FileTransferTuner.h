@@ -0,0 +1,53 @@
+#ifndef P2P_FILE_TRANSFER_TUNER_H
+#define P2P_FILE_TRANSFER_TUNER_H
+
+#include <AsioCommon.h>
+#include <chrono>
+#include <mutex>
+
+#ifndef NO_DISCARD
+#define NO_DISCARD [[nodiscard]]
+#endif
+
+constexpr size_t FILE_TUNING_SAMPLE_SIZE = 4 * 1024 * 1024;
+
+enum class FileTransferDirection : uint8_t {
+    SEND,
+    RECEIVE
+};
+
+struct FileTransferTuning {
+    PackageSizeInt            chunkSize{FILE_BUFFER_SIZE};
+    PackageSizeInt            socketBufferSize{0};
+    uint64_t                  bandwidth{0};
+    std::chrono::microseconds roundTripTime{0};
+};
+
+class FileTransferTuner final {
+public:
+    explicit FileTransferTuner(FileTransferDirection direction);
+
+    FileTransferTuner(const FileTransferTuner&) = delete;
+    FileTransferTuner& operator=(const FileTransferTuner&) = delete;
+
+    void RecordTransfer(size_t size, std::chrono::steady_clock::duration elapsed);
+    void RecordRoundTripTime(std::chrono::microseconds roundTripTime);
+    void RecordDeliveryRate(uint64_t bytesPerSecond);
+
+    bool Update();
+    void Tune(TCPSocket::lowest_layer_type& socket);
+
+    NO_DISCARD bool IsUpdateDue() const;
+    NO_DISCARD PackageSizeInt GetChunkSize() const;
+    NO_DISCARD FileTransferTuning GetTuning() const;
+
+private:
+    FileTransferDirection               m_direction;
+    mutable std::mutex                  m_mutex;
+    FileTransferTuning                  m_tuning;
+    size_t                              m_sampleSize{0};
+    std::chrono::steady_clock::duration m_sampleTime{0};
+    uint64_t                            m_deliveryRate{0};
+};
+
+#endif //P2P_FILE_TRANSFER_TUNER_H
@@ -9,6 +9,7 @@
 #include <type_traits>
 #include <string>
 #include <AsioCommon.h>
+#include <Compression.h>
 #include <boost/endian/conversion.hpp>
 #include <tracy/Tracy.hpp>
 #include <fmt/ostream.h>
@@ -16,7 +17,25 @@
 enum class PackageFlag : uint8_t {
     NONE               = 0,
     FILE_REQUEST       = 1 << 1,
-    FILE_RECEIVE_INFO  = 1 << 2
+    FILE_RECEIVE_INFO  = 1 << 2,
+    COMPRESSION_HELLO  = 1 << 3,
+    COMPRESSED         = 1 << 4,
+    BLOB_FRAGMENT      = 1 << 5,
+    DATAGRAM_HELLO     = 1 << 6,
+    CHUNK_MANIFEST     = 1 << 7
+};
+
+constexpr PackageSizeInt MAX_DECOMPRESSED_PACKAGE_SIZE = MAX_NON_FILE_PACKAGE_SIZE;
+
+enum class FileRequestKind : uint8_t {
+    RANGE,
+    DELTA,
+    TREE,
+    CHUNKED
+};
+
+enum class FileDigestAlgorithm : uint8_t {
+    SHA256
 };
 
 inline uint8_t operator&(uint8_t l, PackageFlag r) {
@@ -116,6 +135,32 @@ public:
         return m_rawBody;
     }
 
+    NO_DISCARD std::unique_ptr<Package> Compress(const CompressionAlgorithm algorithm) const {
+        ZoneScoped;
+        std::vector<char> compressed;
+
+        if (!Compression::Compress(algorithm, reinterpret_cast<const char*>(m_rawBody), m_header.size, compressed)) {
+            return nullptr;
+        }
+
+        auto package = std::make_unique<Package>(PackageHeader{m_header.type, static_cast<PackageSizeInt>(compressed.size()), static_cast<uint8_t>(m_header.flags | PackageFlag::COMPRESSED)});
+        std::memcpy(package->m_rawBody, compressed.data(), compressed.size());
+        return package;
+    }
+
+    NO_DISCARD std::unique_ptr<Package> Decompress() const {
+        ZoneScoped;
+        std::vector<char> decompressed;
+
+        if (!Compression::Decompress(reinterpret_cast<const char*>(m_rawBody), m_header.size, decompressed, MAX_DECOMPRESSED_PACKAGE_SIZE)) {
+            return nullptr;
+        }
+
+        auto package = std::make_unique<Package>(PackageHeader{m_header.type, static_cast<PackageSizeInt>(decompressed.size()), static_cast<uint8_t>(m_header.flags & ~static_cast<uint8_t>(PackageFlag::COMPRESSED))});
+        std::memcpy(package->m_rawBody, decompressed.data(), decompressed.size());
+        return package;
+    }
+
     template <StdLayoutOrVecOrString T0>
     NO_DISCARD T0 GetValue() {
         ZoneScoped;
@@ -0,0 +1,322 @@
+#ifndef P2P_RELIABLE_DATAGRAM_TRANSPORT_H
+#define P2P_RELIABLE_DATAGRAM_TRANSPORT_H
+
+#include <AsioCommon.h>
+#include <AwaitableFlag.h>
+#include <CongestionController.h>
+#include <StreamMultiplexer.h>
+#include <boost/endian/conversion.hpp>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <vector>
+
+#ifndef NO_DISCARD
+#define NO_DISCARD [[nodiscard]]
+#endif
+
+constexpr size_t   RELIABLE_DATAGRAM_MAX_SIZE = CONGESTION_MAX_DATAGRAM_SIZE;
+constexpr size_t   RELIABLE_STREAM_BUFFER_SIZE = 4 * 1024 * 1024;
+constexpr uint64_t RELIABLE_STREAM_WINDOW = 4 * 1024 * 1024;
+constexpr uint64_t RELIABLE_STREAM_WINDOW_UPDATE_THRESHOLD = RELIABLE_STREAM_WINDOW / 4;
+constexpr size_t   RELIABLE_MAX_ACK_RANGES = 32;
+constexpr uint32_t RELIABLE_ACK_FREQUENCY = 2;
+constexpr uint64_t RELIABLE_PACKET_THRESHOLD = 3;
+constexpr size_t   RELIABLE_PACING_BURST = 10;
+constexpr std::chrono::milliseconds RELIABLE_MAX_ACK_DELAY{5};
+constexpr std::chrono::milliseconds RELIABLE_INITIAL_RTT{100};
+constexpr std::chrono::milliseconds RELIABLE_HANDSHAKE_INTERVAL{100};
+constexpr std::chrono::milliseconds RELIABLE_HANDSHAKE_MAX_INTERVAL{1000};
+constexpr std::chrono::seconds      RELIABLE_HANDSHAKE_TIMEOUT{5};
+constexpr std::chrono::seconds      RELIABLE_KEEPALIVE_INTERVAL{5};
+constexpr std::chrono::seconds      RELIABLE_IDLE_TIMEOUT{30};
+
+enum class ReliablePacketType : uint8_t {
+    HELLO,
+    HELLO_ACK,
+    DATA,
+    ACK,
+    PING,
+    CLOSE,
+    BLOCKED
+};
+
+struct ReliablePacketHeader {
+    uint64_t packetNumber{};
+    uint64_t offset{};
+    uint32_t connectionID{};
+    uint16_t size{};
+    uint8_t  type{};
+    uint8_t  stream{};
+
+    void FromNativeToBigEndian() {
+        boost::endian::native_to_big_inplace(packetNumber);
+        boost::endian::native_to_big_inplace(offset);
+        boost::endian::native_to_big_inplace(connectionID);
+        boost::endian::native_to_big_inplace(size);
+    }
+
+    void FromBigEndianToNative() {
+        boost::endian::big_to_native_inplace(packetNumber);
+        boost::endian::big_to_native_inplace(offset);
+        boost::endian::big_to_native_inplace(connectionID);
+        boost::endian::big_to_native_inplace(size);
+    }
+};
+
+struct ReliableAckHeader {
+    uint32_t ackDelay{};
+    uint16_t rangeCount{};
+    uint16_t streamCount{};
+
+    void FromNativeToBigEndian() {
+        boost::endian::native_to_big_inplace(ackDelay);
+        boost::endian::native_to_big_inplace(rangeCount);
+        boost::endian::native_to_big_inplace(streamCount);
+    }
+
+    void FromBigEndianToNative() {
+        boost::endian::big_to_native_inplace(ackDelay);
+        boost::endian::big_to_native_inplace(rangeCount);
+        boost::endian::big_to_native_inplace(streamCount);
+    }
+};
+
+constexpr size_t RELIABLE_MAX_PAYLOAD_SIZE = RELIABLE_DATAGRAM_MAX_SIZE - sizeof(ReliablePacketHeader);
+
+struct DatagramImpairment {
+    double                    lossRate{0.0};
+    std::chrono::microseconds latency{0};
+    std::chrono::microseconds jitter{0};
+};
+
+struct ReliableTransportStats {
+    std::chrono::microseconds roundTripTime{0};
+    size_t                    congestionWindow{0};
+    size_t                    bytesInFlight{0};
+    uint64_t                  packetsSent{0};
+    uint64_t                  packetsLost{0};
+};
+
+class ReliableDatagramTransport final : public std::enable_shared_from_this<ReliableDatagramTransport> {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    class Stream {
+    public:
+        using executor_type = asio::any_io_executor;
+
+        Stream(ReliableDatagramTransport& transport, const size_t index) : m_transport(transport), m_index(index) { }
+
+        NO_DISCARD executor_type get_executor() const {
+            return m_transport.m_executor;
+        }
+
+        template <typename MutableBufferSequence, typename CompletionToken>
+        auto async_read_some(const MutableBufferSequence& buffers, CompletionToken&& token) {
+            return AsyncTransfer<false>(buffers, std::forward<CompletionToken>(token));
+        }
+
+        template <typename ConstBufferSequence, typename CompletionToken>
+        auto async_write_some(const ConstBufferSequence& buffers, CompletionToken&& token) {
+            return AsyncTransfer<true>(buffers, std::forward<CompletionToken>(token));
+        }
+
+    private:
+        template <bool IsWrite, typename BufferSequence, typename CompletionToken>
+        auto AsyncTransfer(const BufferSequence& buffers, CompletionToken&& token) {
+            return asio::async_compose<CompletionToken, void(asio::error_code, size_t)>(
+                [this, buffers, initiating = true](auto& self) mutable {
+                    const bool initial = std::exchange(initiating, false);
+                    size_t transferred = 0;
+
+                    for (auto buffer = asio::buffer_sequence_begin(buffers); buffer != asio::buffer_sequence_end(buffers); ++buffer) {
+                        size_t size;
+                        if constexpr (IsWrite) {
+                            size = m_transport.Write(m_index, buffer->data(), buffer->size());
+                        } else {
+                            size = m_transport.Read(m_index, buffer->data(), buffer->size());
+                        }
+
+                        transferred += size;
+
+                        if (size < buffer->size()) {
+                            break;
+                        }
+                    }
+
+                    asio::error_code errorCode;
+                    if (transferred == 0 && asio::buffer_size(buffers) > 0) {
+                        if (!m_transport.IsClosed()) {
+                            m_transport.Park(m_index, IsWrite, [self = std::move(self)]() mutable { self(); });
+                            return;
+                        }
+
+                        errorCode = IsWrite ? asio::error_code(asio::error::broken_pipe) : asio::error_code(asio::error::eof);
+                    }
+
+                    if (initial) {
+                        asio::post(m_transport.m_executor, [self = std::move(self), errorCode, transferred]() mutable { self.complete(errorCode, transferred); });
+                    } else {
+                        self.complete(errorCode, transferred);
+                    }
+                }, token, m_transport.m_executor);
+        }
+
+        ReliableDatagramTransport& m_transport;
+        size_t                     m_index;
+    };
+
+    explicit ReliableDatagramTransport(asio::any_io_executor executor, size_t streamCount = static_cast<size_t>(MultiplexedStream::COUNT));
+
+    ReliableDatagramTransport(const ReliableDatagramTransport&) = delete;
+    ReliableDatagramTransport& operator=(const ReliableDatagramTransport&) = delete;
+
+    uint16_t Bind(const UDPEndpoint& endpoint);
+    asio::awaitable<void> Accept();
+    asio::awaitable<void> Connect(const UDPEndpoint& peer);
+    void Close();
+
+    void SetImpairment(const DatagramImpairment& impairment);
+    void SetCongestionController(std::unique_ptr<CongestionController> controller);
+
+    NO_DISCARD bool IsOpen() const;
+    NO_DISCARD bool IsClosed() const;
+    NO_DISCARD UDPEndpoint GetPeer() const;
+    NO_DISCARD std::chrono::microseconds GetRoundTripTime() const;
+    NO_DISCARD ReliableTransportStats GetStats() const;
+    NO_DISCARD Stream& GetStream(MultiplexedStream stream);
+
+private:
+    enum class State : uint8_t {
+        IDLE,
+        LISTENING,
+        CONNECTING,
+        ESTABLISHED,
+        CLOSED
+    };
+
+    struct SendStream {
+        std::deque<char>                        buffer;
+        uint64_t                                ackedOffset{0};
+        uint64_t                                sentOffset{0};
+        uint64_t                                peerLimit{RELIABLE_STREAM_WINDOW};
+        std::map<uint64_t, uint64_t>            ackedRanges;
+        std::deque<std::pair<uint64_t, size_t>> retransmissions;
+        std::move_only_function<void()>         waiter;
+    };
+
+    struct ReceiveStream {
+        std::deque<char>                        readable;
+        uint64_t                                receivedOffset{0};
+        uint64_t                                consumedOffset{0};
+        uint64_t                                advertisedLimit{RELIABLE_STREAM_WINDOW};
+        std::map<uint64_t, std::vector<char>>   segments;
+        std::move_only_function<void()>         waiter;
+    };
+
+    struct SentPacket {
+        Clock::time_point sentTime;
+        uint64_t          offset;
+        uint16_t          payloadSize;
+        uint16_t          size;
+        uint8_t           stream;
+    };
+
+    static void InsertRange(std::map<uint64_t, uint64_t>& ranges, uint64_t begin, uint64_t end);
+
+    size_t Read(size_t index, void* destination, size_t size);
+    size_t Write(size_t index, const void* source, size_t size);
+    void Park(size_t index, bool isWrite, std::move_only_function<void()> waiter);
+
+    void Start();
+    void Wake();
+    void Shutdown(const asio::error_code& errorCode, bool notifyPeer);
+    void CloseSocket();
+
+    static asio::awaitable<void> CoReceive(std::shared_ptr<ReliableDatagramTransport> transport);
+    static asio::awaitable<void> CoSend(std::shared_ptr<ReliableDatagramTransport> transport);
+    asio::awaitable<void> CoSendDatagram(std::shared_ptr<std::vector<char>> datagram);
+
+    void ProcessPacket(const ReliablePacketHeader& header, const char* payload, const UDPEndpoint& sender, Clock::time_point now);
+    void RecordPacket(uint64_t packetNumber, Clock::time_point now);
+    void ProcessData(const ReliablePacketHeader& header, const char* payload);
+    void ProcessAck(const char* payload, size_t size, Clock::time_point now);
+    void MarkAcked(SendStream& stream, uint64_t offset, size_t size);
+    void DeclareLost(const SentPacket& packet, Clock::time_point now);
+    void DetectLosses(Clock::time_point now);
+    void UpdateRoundTripTime(Clock::duration latest, Clock::duration ackDelay);
+    bool HandleTimers(Clock::time_point now);
+
+    bool BuildPacket(std::vector<char>& datagram, Clock::time_point now, Clock::time_point& deadline);
+    void BuildControl(std::vector<char>& datagram, ReliablePacketType type);
+    void BuildAck(std::vector<char>& datagram, Clock::time_point now);
+    bool BuildData(std::vector<char>& datagram, Clock::time_point now);
+
+    NO_DISCARD Clock::duration GetProbeTimeout() const;
+    NO_DISCARD bool IsFlowControlBlocked() const;
+    void Resume(std::move_only_function<void()>& waiter) const;
+
+    asio::any_io_executor m_executor;
+    size_t                m_streamCount;
+    UDPSocket             m_socket;
+    asio::steady_timer    m_sendTimer;
+    AwaitableFlag         m_establishedFlag;
+    std::atomic<bool>     m_wakePending{false};
+
+    mutable std::mutex m_mutex;
+    State              m_state{State::IDLE};
+    asio::error_code   m_errorCode;
+    UDPEndpoint        m_peer;
+    uint32_t           m_connectionID{0};
+    bool               m_helloAckPending{false};
+
+    std::vector<Stream>        m_streams;
+    std::vector<SendStream>    m_sendStreams;
+    std::vector<ReceiveStream> m_receiveStreams;
+    size_t                     m_nextStream{0};
+
+    uint64_t                       m_nextPacketNumber{1};
+    std::map<uint64_t, SentPacket> m_sentPackets;
+    size_t                         m_bytesInFlight{0};
+    uint64_t                       m_largestAcked{0};
+    uint32_t                       m_probeCount{0};
+    uint32_t                       m_ptoCount{0};
+    Clock::time_point              m_lastAckElicitingTime{};
+    Clock::time_point              m_lossTime{Clock::time_point::max()};
+    Clock::time_point              m_nextBlockedTime{};
+    uint32_t                       m_blockedCount{0};
+
+    std::map<uint64_t, uint64_t> m_receivedPackets;
+    uint64_t                     m_largestReceived{0};
+    Clock::time_point            m_largestReceivedTime{};
+    uint32_t                     m_unackedCount{0};
+    bool                         m_ackPending{false};
+    Clock::time_point            m_ackDeadline{Clock::time_point::max()};
+
+    Clock::duration m_smoothedRoundTripTime{RELIABLE_INITIAL_RTT};
+    Clock::duration m_roundTripTimeVariance{RELIABLE_INITIAL_RTT / 2};
+    Clock::duration m_minRoundTripTime{Clock::duration::max()};
+    Clock::duration m_latestRoundTripTime{Clock::duration::zero()};
+    bool            m_hasRoundTripTime{false};
+
+    std::unique_ptr<CongestionController> m_congestionController;
+    Clock::time_point                     m_nextSendTime{};
+    Clock::time_point                     m_lastSendTime{};
+    Clock::time_point                     m_lastReceiveTime{};
+    Clock::time_point                     m_handshakeDeadline{};
+    Clock::time_point                     m_nextHelloTime{};
+    Clock::duration                       m_helloInterval{RELIABLE_HANDSHAKE_INTERVAL};
+
+    DatagramImpairment m_impairment;
+    std::mt19937_64    m_random{std::random_device{}()};
+    uint64_t           m_packetsSent{0};
+    uint64_t           m_packetsLost{0};
+};
+
+#endif //P2P_RELIABLE_DATAGRAM_TRANSPORT_H
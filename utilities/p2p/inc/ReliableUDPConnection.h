@@ -0,0 +1,1098 @@
+#ifndef P2P_RELIABLE_UDP_CONNECTION_H
+#define P2P_RELIABLE_UDP_CONNECTION_H
+
+#include <AwaitableFlag.h>
+#include <ConnectionParent.h>
+#include <Settings.h>
+#include <concurrentqueue.h>
+#include <ConcurrentUnorderedMap.h>
+#include <FileTransfer.h>
+#include <FileTransferScheduler.h>
+#include <HappyEyeballs.h>
+#include <ReliableDatagramTransport.h>
+#include <array>
+#include <deque>
+#include <unordered_map>
+
+template <PackageType T>
+class ReliableUDPConnection final : public ConnectionParent<T>, public std::enable_shared_from_this<ReliableUDPConnection<T>> {
+public:
+    ReliableUDPConnection() = delete;
+    ReliableUDPConnection(IOContext& sharedContext, moodycamel::ConcurrentQueue<std::unique_ptr<PackageIn<T>>>& sharedMessageQueue) :
+        m_context(sharedContext), m_transport(std::make_shared<ReliableDatagramTransport>(sharedContext.get_executor())),
+        m_sendMessageAwaitableFlag(sharedContext.get_executor()), m_sendFileAwaitableFlag(sharedContext.get_executor()),
+        m_receiveFileAwaitableFlag(sharedContext.get_executor()), m_fileRateTimer(sharedContext), m_messageRateTimer(sharedContext),
+        m_connectionState(ConnectionState::DISCONNECTED), m_inQueue(sharedMessageQueue), m_ports({0, 0}) { }
+
+    NO_DISCARD static std::shared_ptr<ReliableUDPConnection<T>> Create(IOContext& sharedContext, moodycamel::ConcurrentQueue<std::unique_ptr<PackageIn<T>>>& sharedMessageQueue) {
+        return std::make_shared<ReliableUDPConnection<T>>(sharedContext, sharedMessageQueue);
+    }
+
+    void Start(const IPAddress address, const std::array<uint16_t, 2> ports, const std::function<void()> callback) override {
+        Start(std::vector{address}, ports, callback);
+    }
+
+    void Start(std::vector<IPAddress> addresses, const std::array<uint16_t, 2> ports, const std::function<void()> callback) override {
+        ZoneScoped;
+        if (GetConnectionState() != ConnectionState::DISCONNECTED) {
+            Debug::LogError("Connection already started");
+            return;
+        }
+
+        if (addresses.empty()) {
+            Debug::LogError("No address to connect to");
+            return;
+        }
+
+        m_address = addresses.front();
+        m_candidates = std::move(addresses);
+        m_ports = ports;
+
+        std::shared_ptr<ReliableUDPConnection<T>> connection = this->shared_from_this();
+        asio::co_spawn(m_context, CoStart(connection, callback), asio::detached);
+    }
+
+    void Seek(std::vector<IPAddress> addresses, const std::array<uint16_t, 2> ports, const std::function<void()> connectionSeekCallback, const std::function<void()> callback) override {
+        if (addresses.empty()) {
+            Debug::LogError("No address to listen on");
+            return;
+        }
+
+        // Both streams share one datagram socket, which can only be bound to a single address
+        Seek(addresses.front(), ports, connectionSeekCallback, callback);
+    }
+
+    void Seek(const IPAddress address, const std::array<uint16_t, 2> ports, const std::function<void()> connectionSeekCallback, const std::function<void()> callback) override {
+        ZoneScoped;
+        if (GetConnectionState() != ConnectionState::DISCONNECTED) {
+            Debug::LogError("Connection already started");
+            return;
+        }
+
+        m_address = address;
+        m_ports = ports;
+
+        std::shared_ptr<ReliableUDPConnection<T>> connection = this->shared_from_this();
+        asio::co_spawn(m_context, CoSeek(connection, connectionSeekCallback, callback), asio::detached);
+    }
+
+    NO_DISCARD ConnectionState GetConnectionState() const override {
+        ZoneScoped;
+        return m_connectionState.load(std::memory_order_acquire);
+    }
+
+    void Send(std::unique_ptr<Package<T>>&& package) override {
+        ZoneScoped;
+        static thread_local moodycamel::ProducerToken token(m_outQueue);
+
+        m_outQueue.enqueue(token, std::move(package));
+        m_sendMessageAwaitableFlag.Signal();
+    }
+
+    size_t SendBlob(const T type, std::shared_ptr<const std::vector<char>> data) override {
+        ZoneScoped;
+        const size_t blobID = m_blobCurrentID.fetch_add(1);
+        const char* bytes = data->data();
+        const auto size = static_cast<FileSizeInt>(data->size());
+
+        m_outBlobQueue.enqueue(std::make_unique<OutgoingBlob>(blobID, static_cast<PackageTypeInt>(type), 0, bytes, size, std::move(data)));
+        m_sendMessageAwaitableFlag.Signal();
+        return blobID;
+    }
+
+    void SetBlobHandler(const T type, BlobHandler handler) override {
+        m_blobAssembler.SetHandler(type, std::move(handler));
+    }
+
+    void SetUnreliable(const T, const bool) override { }
+
+    void RequestFile(const std::string& requestedFilePath, const std::string& fileName, const uint8_t weight) override {
+        ZoneScoped;
+
+        const std::filesystem::path filePath = P2PSettings::GetFileDownloadDirectory() / fileName;
+        const std::shared_ptr<FileTransferCheckpoint> checkpoint = FileTransferCheckpoint::Acquire(filePath);
+        const bool resuming = checkpoint->IsStarted() && !checkpoint->IsComplete();
+
+        if (!resuming && P2PSettings::IsDeltaSyncEnabled() && std::filesystem::exists(filePath) && std::filesystem::file_size(filePath) >= DELTA_MIN_FILE_SIZE) {
+            std::shared_ptr<ReliableUDPConnection<T>> connection = this->shared_from_this();
+            asio::co_spawn(m_context, CoRequestDelta(connection, requestedFilePath, fileName, weight), asio::detached);
+            return;
+        }
+
+        RequestFileContent(requestedFilePath, fileName, weight, resuming ? checkpoint : nullptr);
+    }
+
+    void RequestFileRange(const std::string& requestedFilePath, const std::string& fileName, const FileSizeInt offset, const FileSizeInt size, const uint8_t weight, std::function<void(bool)> callback) override {
+        ZoneScoped;
+        size_t requestID = m_fileCurrentID.fetch_add(1);
+        m_fileNameMap.InsertOrAssign(requestID, std::string(fileName));
+
+        if (callback) {
+            {
+                std::lock_guard lock(m_fileCallbackMutex);
+                m_fileCallbacks.insert_or_assign(requestID, std::move(callback));
+            }
+
+            if (GetConnectionState() != ConnectionState::CONNECTED) {
+                CompleteFileRequest(requestID, false);
+                return;
+            }
+        }
+
+        std::unique_ptr<Package<T>> package = Package<T>::CreateUnique(static_cast<T>(0), std::move(requestID), static_cast<uint8_t>(FileRequestKind::RANGE), std::string(requestedFilePath), uint8_t{weight}, FileSizeInt{offset}, FileSizeInt{size});
+        package->GetHeader().flags = static_cast<uint8_t>(PackageFlag::FILE_REQUEST);
+        Send(std::move(package));
+    }
+
+    void RequestDirectory(const std::string& requestedDirectoryPath, const std::string& directoryName, const uint8_t weight) override {
+        ZoneScoped;
+        size_t requestID = m_fileCurrentID.fetch_add(1);
+        m_fileNameMap.InsertOrAssign(requestID, std::string(directoryName));
+
+        std::unique_ptr<Package<T>> package = Package<T>::CreateUnique(static_cast<T>(0), std::move(requestID), static_cast<uint8_t>(FileRequestKind::TREE), std::string(requestedDirectoryPath), uint8_t{weight});
+        package->GetHeader().flags = static_cast<uint8_t>(PackageFlag::FILE_REQUEST);
+        Send(std::move(package));
+    }
+
+    void Disconnect() override {
+        ZoneScoped;
+        const std::shared_ptr<ReliableDatagramTransport> transport = GetTransport();
+        if (!transport->IsOpen() && GetConnectionState() == ConnectionState::DISCONNECTED) {
+            transport->Close();
+            SetConnectionState(ConnectionState::DISCONNECTED);
+            m_context.stop();
+            return;
+        }
+
+        transport->Close();
+
+        SetConnectionState(ConnectionState::DISCONNECTED);
+
+        m_receiveFileAwaitableFlag.Signal();
+        m_sendMessageAwaitableFlag.Signal();
+        m_sendFileAwaitableFlag.Signal();
+
+        m_fileRateTimer.cancel();
+        m_messageRateTimer.cancel();
+    }
+
+    void DestroyContext() override {
+        ZoneScoped;
+        const std::shared_ptr<ReliableDatagramTransport> transport = GetTransport();
+        if (!transport->IsOpen() && GetConnectionState() == ConnectionState::DISCONNECTED) {
+            transport->Close();
+            SetConnectionState(ConnectionState::DISCONNECTED);
+            m_context.stop();
+            return;
+        }
+
+        transport->Close();
+
+        SetConnectionState(ConnectionState::DISCONNECTED);
+
+        m_receiveFileAwaitableFlag.Signal();
+        m_sendMessageAwaitableFlag.Signal();
+        m_sendFileAwaitableFlag.Signal();
+
+        m_fileRateTimer.cancel();
+        m_messageRateTimer.cancel();
+
+        m_context.stop();
+    }
+
+    NO_DISCARD IPAddress GetAddress() const override {
+        return m_address;
+    }
+
+    NO_DISCARD std::array<uint16_t, 2> GetPorts() const override {
+        return m_ports;
+    }
+
+    NO_DISCARD FileTransferTuning GetFileSendTuning() const override {
+        return m_sendTuner.GetTuning();
+    }
+
+    NO_DISCARD FileTransferTuning GetFileReceiveTuning() const override {
+        return m_receiveTuner.GetTuning();
+    }
+
+    void SetSendRate(const TrafficClass trafficClass, const uint64_t bytesPerSecond, const uint64_t burstSize) override {
+        m_bandwidthLimiter.SetRate(trafficClass, bytesPerSecond, burstSize);
+    }
+
+    NO_DISCARD uint64_t GetSendRate(const TrafficClass trafficClass) const override {
+        return m_bandwidthLimiter.GetRate(trafficClass);
+    }
+
+    NO_DISCARD CompressionAlgorithm GetCompressionAlgorithm() const override {
+        return m_compressionAlgorithm.load(std::memory_order_acquire);
+    }
+
+    NO_DISCARD bool IsDatagramChannelOpen() const override {
+        return false;
+    }
+
+    void SetImpairment(const DatagramImpairment& impairment) {
+        {
+            std::lock_guard lock(m_transportMutex);
+            m_impairment = impairment;
+        }
+
+        GetTransport()->SetImpairment(impairment);
+    }
+
+    NO_DISCARD ReliableTransportStats GetTransportStats() const {
+        return GetTransport()->GetStats();
+    }
+
+private:
+    // Signing the existing copy reads all of it, so it runs on the blocking-work pool and the request goes out once it is done
+    static asio::awaitable<void> CoRequestDelta(std::shared_ptr<ReliableUDPConnection<T>> connection, const std::string requestedFilePath, const std::string fileName, const uint8_t weight) {
+        const std::filesystem::path filePath = P2PSettings::GetFileDownloadDirectory() / fileName;
+        DeltaSignature signature;
+
+        if (!co_await CoRunBlockingWork([&] { return DeltaSync::ComputeSignature(filePath, signature); })) {
+            connection->RequestFileContent(requestedFilePath, fileName, weight, nullptr);
+            co_return;
+        }
+
+        size_t requestID = connection->m_fileCurrentID.fetch_add(1);
+        connection->m_fileNameMap.InsertOrAssign(requestID, std::string(fileName));
+
+        std::unique_ptr<Package<T>> package = Package<T>::CreateUnique(static_cast<T>(0), std::move(requestID), static_cast<uint8_t>(FileRequestKind::DELTA), std::string(requestedFilePath), uint8_t{weight},
+            PackageSizeInt{signature.blockSize}, std::move(signature.weakChecksums), std::move(signature.strongChecksums));
+        package->GetHeader().flags = static_cast<uint8_t>(PackageFlag::FILE_REQUEST);
+        connection->Send(std::move(package));
+    }
+
+    // The sender offers the chunk hashes of the requested file and the receiver answers with those its store lacks, so
+    // neither side reveals the rest of its store; chunking and store lookups run on the blocking-work pool
+    static asio::awaitable<void> CoExchangeChunkManifest(std::shared_ptr<ReliableUDPConnection<T>> connection, std::unique_ptr<Package<T>> package) {
+        size_t      requestID;
+        std::string path;
+        uint8_t     weight;
+
+        package->GetValue(requestID);
+        package->GetValue(path);
+        package->GetValue(weight);
+
+        if ((package->GetHeader().flags & PackageFlag::FILE_REQUEST) != 0) {
+            std::vector<uint8_t> manifest = co_await CoRunBlockingWork([&] { return ChunkStore::ComputeManifest(path); });
+
+            if (connection->m_chunkManifests.Size() < CHUNK_STORE_MAX_PENDING_MANIFESTS) {
+                connection->m_chunkManifests.InsertOrAssign(requestID, manifest);
+            } else {
+                Debug::LogError("Too many pending chunk manifests, sending the file without references");
+            }
+
+            std::unique_ptr<Package<T>> reply = Package<T>::CreateUnique(static_cast<T>(0), std::move(requestID), std::move(path), uint8_t{weight}, std::move(manifest));
+            reply->GetHeader().flags = PackageFlag::CHUNK_MANIFEST | PackageFlag::FILE_RECEIVE_INFO;
+            connection->Send(std::move(reply));
+            co_return;
+        }
+
+        std::vector<uint8_t> manifest;
+        package->GetValue(manifest);
+
+        if (!connection->m_fileNameMap.Contains(requestID)) {
+            Debug::LogError("File ID do not exist");
+            co_return;
+        }
+
+        std::vector<uint8_t> missing = co_await CoRunBlockingWork([&] { return ChunkStore::FindMissing(manifest); });
+
+        std::unique_ptr<Package<T>> request = Package<T>::CreateUnique(static_cast<T>(0), std::move(requestID), static_cast<uint8_t>(FileRequestKind::CHUNKED), std::move(path), uint8_t{weight},
+            std::move(missing));
+        request->GetHeader().flags = static_cast<uint8_t>(PackageFlag::FILE_REQUEST);
+        connection->Send(std::move(request));
+    }
+
+    void RequestFileContent(const std::string& requestedFilePath, const std::string& fileName, const uint8_t weight, const std::shared_ptr<FileTransferCheckpoint>& resumedCheckpoint) {
+        ZoneScoped;
+        const bool resuming = resumedCheckpoint != nullptr;
+
+        if (!resuming && P2PSettings::IsChunkStoreEnabled()) {
+            size_t requestID = m_fileCurrentID.fetch_add(1);
+            m_fileNameMap.InsertOrAssign(requestID, std::string(fileName));
+
+            std::unique_ptr<Package<T>> package = Package<T>::CreateUnique(static_cast<T>(0), std::move(requestID), std::string(requestedFilePath), uint8_t{weight});
+            package->GetHeader().flags = PackageFlag::CHUNK_MANIFEST | PackageFlag::FILE_REQUEST;
+            Send(std::move(package));
+            return;
+        }
+
+        std::vector<std::pair<FileSizeInt, FileSizeInt>> ranges = {{0, 0}};
+
+        if (resuming) {
+            ranges = resumedCheckpoint->GetMissingRanges();
+        }
+
+        for (const auto& [offset, size] : ranges) {
+            RequestFileRange(requestedFilePath, fileName, offset, size, weight, nullptr);
+        }
+    }
+
+    NO_DISCARD std::shared_ptr<ReliableDatagramTransport> GetTransport() const {
+        std::lock_guard lock(m_transportMutex);
+        return m_transport;
+    }
+
+    NO_DISCARD std::shared_ptr<ReliableDatagramTransport> ResetTransport() {
+        std::lock_guard lock(m_transportMutex);
+        m_transport = std::make_shared<ReliableDatagramTransport>(m_context.get_executor());
+        m_transport->SetImpairment(m_impairment);
+        return m_transport;
+    }
+
+    NO_DISCARD ReliableDatagramTransport::Stream& GetStream(const MultiplexedStream stream) const {
+        return GetTransport()->GetStream(stream);
+    }
+
+    static void Run(const std::shared_ptr<ReliableUDPConnection<T>>& connection, const std::function<void()>& callback) {
+        const UDPEndpoint peer = connection->GetTransport()->GetPeer();
+
+        Debug::Log("Accepted reliable UDP connection to {}:{}", peer.address().to_string(), std::to_string(peer.port()));
+
+        connection->SetConnectionState(ConnectionState::CONNECTED);
+        connection->SendCompressionHello();
+
+        asio::co_spawn(connection->m_context, CoReceiveMessage(connection), asio::detached);
+        asio::co_spawn(connection->m_context, CoReceiveFile(connection), asio::detached);
+        asio::co_spawn(connection->m_context, CoSendFile(connection), asio::detached);
+        asio::co_spawn(connection->m_context, CoSendMessage(connection), asio::detached);
+
+        callback();
+    }
+
+    static asio::awaitable<void> CoStart(std::shared_ptr<ReliableUDPConnection<T>> connection, const std::function<void()> callback) {
+        asio::steady_timer backoffTimer(connection->m_context);
+
+        for (uint32_t attempt = 0;; attempt++) {
+            bool retry = false;
+
+            try {
+                connection->SetConnectionState(ConnectionState::CONNECTING);
+
+                const std::shared_ptr<ReliableDatagramTransport> transport = attempt == 0 ? connection->GetTransport() : connection->ResetTransport();
+                const std::vector<TCPEndpoint> candidates = HappyEyeballs::OrderCandidates(connection->m_candidates, connection->m_ports[0]);
+                const TCPEndpoint& candidate = candidates[attempt % candidates.size()];
+
+                co_await transport->Connect(UDPEndpoint(candidate.address(), candidate.port()));
+                connection->m_address = candidate.address();
+
+                Run(connection, callback);
+            } catch (const std::system_error& error) {
+                const asio::error_code errorCode = error.code();
+
+                if (errorCode == asio::error::timed_out || errorCode == asio::error::connection_refused || errorCode == asio::error::host_unreachable || errorCode == asio::error::network_unreachable) {
+                    retry = connection->GetConnectionState() == ConnectionState::CONNECTING;
+                } else {
+                    Debug::LogError(errorCode.message());
+                    connection->Disconnect();
+                }
+            }
+
+            if (!retry) {
+                break;
+            }
+
+            asio::error_code errorCode;
+            backoffTimer.expires_after(HappyEyeballs::GetBackoffDelay(attempt));
+            co_await backoffTimer.async_wait(asio::redirect_error(asio::use_awaitable, errorCode));
+        }
+    }
+
+    static asio::awaitable<void> CoSeek(std::shared_ptr<ReliableUDPConnection<T>> connection, const std::function<void()> connectionSeekCallback, const std::function<void()> callback) {
+        try {
+            connection->SetConnectionState(ConnectionState::CONNECTING);
+
+            const std::shared_ptr<ReliableDatagramTransport> transport = connection->GetTransport();
+            const uint16_t port = transport->Bind(UDPEndpoint(connection->m_address, connection->m_ports[0]));
+
+            connection->m_ports = {port, port};
+            connectionSeekCallback();
+
+            co_await transport->Accept();
+            Run(connection, callback);
+        } catch (const std::system_error& error) {
+            Debug::LogError(error.what());
+            connection->Disconnect();
+        }
+    }
+
+    static asio::awaitable<void> CoReceiveMessage(std::shared_ptr<ReliableUDPConnection<T>> connection) {
+        try {
+            PackageHeader header{};
+            moodycamel::ProducerToken inQueueToken(connection->m_inQueue);
+
+            while (connection->GetConnectionState() == ConnectionState::CONNECTED) {
+                asio::mutable_buffer headerBuffer(&header, sizeof(PackageHeader));
+                co_await asio::async_read(connection->GetStream(MultiplexedStream::MESSAGE), headerBuffer, asio::use_awaitable);
+
+                header.FromBigEndianToNative();
+
+                if (header.size > MAX_NON_FILE_PACKAGE_SIZE) {
+                    Debug::LogError("Package too large");
+                    connection->Disconnect();
+                    co_return;
+                }
+
+                std::unique_ptr<Package<T>> package = std::make_unique<Package<T>>(header);
+                asio::mutable_buffer packageBuffer(package->GetRawBody(), header.size);
+
+                co_await asio::async_read(connection->GetStream(MultiplexedStream::MESSAGE), packageBuffer, asio::use_awaitable);
+
+                if ((header.flags & PackageFlag::COMPRESSED) != 0) {
+                    package = co_await CoRunCompressionWork(header.size, [&package] { return package->Decompress(); });
+
+                    if (package == nullptr) {
+                        Debug::LogError("Could not decompress package");
+                        connection->Disconnect();
+                        co_return;
+                    }
+
+                    header = package->GetHeader();
+                }
+
+                if ((header.flags & PackageFlag::COMPRESSION_HELLO) != 0) {
+                    uint8_t peerSupportedAlgorithms;
+                    package->GetValue(peerSupportedAlgorithms);
+
+                    connection->m_compressionAlgorithm.store(Compression::Negotiate(P2PSettings::GetCompressionAlgorithm(), peerSupportedAlgorithms), std::memory_order_release);
+                    continue;
+                }
+
+                if ((header.flags & PackageFlag::BLOB_FRAGMENT) != 0) {
+                    std::unique_ptr<Package<T>> completed;
+
+                    if (!connection->m_blobAssembler.Receive(*package, completed)) {
+                        connection->m_blobAssembler.Abort();
+                        connection->Disconnect();
+                        co_return;
+                    }
+
+                    if (completed == nullptr) {
+                        continue;
+                    }
+
+                    package = std::move(completed);
+                    header = package->GetHeader();
+                }
+
+                if ((header.flags & PackageFlag::CHUNK_MANIFEST) != 0) {
+                    asio::co_spawn(connection->m_context, CoExchangeChunkManifest(connection, std::move(package)), asio::detached);
+                    continue;
+                }
+
+                if ((header.flags & PackageFlag::FILE_RECEIVE_INFO) != 0) {
+                    connection->m_fileInfoQueue.push_back(std::move(package));
+                    connection->m_receiveFileAwaitableFlag.Signal();
+                    continue;
+                }
+
+                if ((header.flags & PackageFlag::FILE_REQUEST) != 0) {
+                    connection->m_fileRequestQueue.push_back(std::move(package));
+                    connection->m_sendFileAwaitableFlag.Signal();
+                    continue;
+                }
+
+                std::unique_ptr<PackageIn<T>> packageIn = std::make_unique<PackageIn<T>>();
+                packageIn->package = std::move(package);
+                packageIn->connection = connection;
+
+                connection->m_inQueue.enqueue(inQueueToken, std::move(packageIn));
+            }
+        } catch (const std::system_error& error) {
+            const asio::error_code errorCode = error.code();
+
+            if (errorCode == asio::error::eof || errorCode == asio::error::connection_reset || errorCode == asio::error::operation_aborted || errorCode == asio::error::connection_aborted || errorCode == asio::error::broken_pipe)  {
+                Debug::Log("Connection closed cleanly by peer.");
+            } else if (connection->GetConnectionState() == ConnectionState::CONNECTED) {
+                Debug::LogError(errorCode.message());
+            }
+
+            connection->m_blobAssembler.Abort();
+            connection->Disconnect();
+            co_return;
+        }
+    }
+
+    static asio::awaitable<void> CoReceiveFile(std::shared_ptr<ReliableUDPConnection<T>> connection) {
+        try {
+            if (connection->GetConnectionState() != ConnectionState::CONNECTED) co_return;
+
+            std::unordered_map<size_t, std::unique_ptr<FileTransferSink>> transfers;
+            std::vector<char> dataBuffer(FILE_BUFFER_SIZE);
+            std::vector<char> decompressedBuffer;
+            FileChunkHeader   header{};
+
+            while (connection->GetConnectionState() == ConnectionState::CONNECTED) {
+                co_await asio::async_read(connection->GetStream(MultiplexedStream::FILE), asio::buffer(&header, sizeof(FileChunkHeader)), asio::use_awaitable);
+                header.FromBigEndianToNative();
+
+                auto transfer = transfers.find(header.requestID);
+
+                while (transfer == transfers.end() && connection->GetConnectionState() == ConnectionState::CONNECTED) {
+                    if (connection->m_fileInfoQueue.empty()) {
+                        connection->m_receiveFileAwaitableFlag.Reset();
+                        co_await connection->m_receiveFileAwaitableFlag.Wait();
+                        continue;
+                    }
+
+                    std::unique_ptr<Package<T>> package = std::move(connection->m_fileInfoQueue.front());
+                    connection->m_fileInfoQueue.pop_front();
+
+                    size_t requestID;
+                    std::unique_ptr<FileTransferSink> sink = CreateFileSink(connection, *package, requestID);
+
+                    if (sink == nullptr) {
+                        connection->Disconnect();
+                        co_return;
+                    }
+
+                    transfers.insert_or_assign(requestID, std::move(sink));
+                    transfer = transfers.find(header.requestID);
+                }
+
+                if (transfer == transfers.end()) {
+                    co_return;
+                }
+
+                if (header.size > FILE_CHUNK_MAX_SIZE) {
+                    Debug::LogError("File chunk too large");
+                    connection->Disconnect();
+                    co_return;
+                }
+
+                const bool isEnd = (header.flags & static_cast<uint8_t>(FileChunkFlag::END)) != 0;
+                const bool isCompressed = (header.flags & static_cast<uint8_t>(FileChunkFlag::COMPRESSED)) != 0;
+
+                if (!isEnd && !isCompressed) {
+                    co_await transfer->second->CoWaitWritable(header.size);
+                }
+
+                const auto readStart = std::chrono::steady_clock::now();
+
+                if (char* destination = isEnd || isCompressed ? nullptr : transfer->second->Reserve(header.size)) {
+                    co_await asio::async_read(connection->GetStream(MultiplexedStream::FILE), asio::buffer(destination, header.size), asio::use_awaitable);
+                    RecordFileRead(connection, header.size, readStart);
+
+                    if (!transfer->second->Commit(header.size)) {
+                        connection->Disconnect();
+                        co_return;
+                    }
+
+                    continue;
+                }
+
+                if (dataBuffer.size() < header.size) {
+                    dataBuffer.resize(header.size);
+                }
+
+                co_await asio::async_read(connection->GetStream(MultiplexedStream::FILE), asio::buffer(dataBuffer.data(), header.size), asio::use_awaitable);
+                RecordFileRead(connection, header.size, readStart);
+
+                bool processed;
+                if (isEnd) {
+                    HashDigest digest{};
+                    processed = header.size == digest.size();
+
+                    if (processed) {
+                        std::copy_n(dataBuffer.data(), digest.size(), digest.begin());
+                        processed = co_await transfer->second->CoFinish(digest);
+                    }
+
+                    connection->CompleteFileRequest(header.requestID, processed && transfer->second->IsVerified());
+                    transfers.erase(transfer);
+                } else if (isCompressed) {
+                    processed = co_await transfer->second->CoWriteCompressed(dataBuffer, header.size, decompressedBuffer);
+                } else {
+                    processed = co_await transfer->second->CoWrite(dataBuffer, header.size);
+                }
+
+                if (!processed) {
+                    connection->Disconnect();
+                    co_return;
+                }
+            }
+        } catch (const std::system_error& error) {
+            const asio::error_code errorCode = error.code();
+
+            if (errorCode == asio::error::eof || errorCode == asio::error::connection_reset || errorCode == asio::error::operation_aborted || errorCode == asio::error::connection_aborted || errorCode == asio::error::broken_pipe)  {
+                Debug::Log("Connection closed cleanly by peer.");
+            } else if (connection->GetConnectionState() == ConnectionState::CONNECTED) {
+                Debug::LogError(errorCode.message());
+            }
+
+            connection->Disconnect();
+            co_return;
+        }
+    }
+
+    static void RecordFileRead(const std::shared_ptr<ReliableUDPConnection<T>>& connection, const size_t size, const std::chrono::steady_clock::time_point readStart) {
+        connection->m_receiveTuner.RecordTransfer(size, std::chrono::steady_clock::now() - readStart);
+
+        if (connection->m_receiveTuner.IsUpdateDue()) {
+            connection->m_receiveTuner.RecordRoundTripTime(connection->GetTransport()->GetRoundTripTime());
+            connection->m_receiveTuner.Update();
+        }
+    }
+
+    static std::unique_ptr<FileTransferSink> CreateFileSink(std::shared_ptr<ReliableUDPConnection<T>> connection, Package<T>& package, size_t& requestID) {
+        ZoneScoped;
+        uint8_t kind;
+        uint8_t digestAlgorithm;
+
+        package.GetValue(requestID);
+        package.GetValue(kind);
+        package.GetValue(digestAlgorithm);
+
+        if (!connection->m_fileNameMap.Contains(requestID)) {
+            Debug::LogError("File ID do not exist");
+            return nullptr;
+        }
+
+        if (digestAlgorithm != static_cast<uint8_t>(FileDigestAlgorithm::SHA256)) {
+            Debug::LogError("Unsupported file digest algorithm");
+            return nullptr;
+        }
+
+        const std::filesystem::path filePath = P2PSettings::GetFileDownloadDirectory() / connection->m_fileNameMap.Get(requestID).value();
+        connection->m_fileNameMap.Erase(requestID);
+
+        std::unique_ptr<FileTransferSink> sink;
+
+        if (kind == static_cast<uint8_t>(FileRequestKind::DELTA)) {
+            PackageSizeInt blockSize;
+            FileSizeInt    totalSize;
+
+            package.GetValue(blockSize);
+            package.GetValue(totalSize);
+
+            sink = std::make_unique<DeltaFileSink>(filePath, blockSize, totalSize);
+        } else if (kind == static_cast<uint8_t>(FileRequestKind::CHUNKED)) {
+            FileSizeInt totalSize;
+            package.GetValue(totalSize);
+
+            sink = std::make_unique<ChunkedFileSink>(filePath, totalSize);
+        } else if (kind == static_cast<uint8_t>(FileRequestKind::TREE)) {
+            PackageSizeInt manifestSize;
+            FileSizeInt    contentSize;
+
+            package.GetValue(manifestSize);
+            package.GetValue(contentSize);
+
+            sink = std::make_unique<TreeFileSink>(filePath, manifestSize, contentSize);
+        } else {
+            FileSizeInt offset;
+            FileSizeInt size;
+            FileSizeInt totalSize;
+
+            uint8_t                  sparse;
+            std::vector<FileSizeInt> extents;
+
+            package.GetValue(offset);
+            package.GetValue(size);
+            package.GetValue(totalSize);
+            package.GetValue(sparse);
+            package.GetValue(extents);
+
+            auto rangeSink = std::make_unique<RangeFileSink>(filePath, offset, size, totalSize);
+
+            if (sparse != 0) {
+                if (extents.size() % 2 != 0) {
+                    Debug::LogError("Invalid sparse extent list");
+                    return nullptr;
+                }
+
+                std::vector<FileExtent> dataExtents;
+                dataExtents.reserve(extents.size() / 2);
+
+                for (size_t i = 0; i < extents.size(); i += 2) {
+                    dataExtents.push_back({extents[i], extents[i + 1]});
+                }
+
+                rangeSink->SetDataExtents(std::move(dataExtents));
+            }
+
+            sink = std::move(rangeSink);
+        }
+
+        if (!sink->Open()) {
+            return nullptr;
+        }
+
+        return sink;
+    }
+
+    static asio::awaitable<void> CoSendMessage(std::shared_ptr<ReliableUDPConnection<T>> connection) {
+        try {
+            moodycamel::ConsumerToken outQueueToken(connection->m_outQueue);
+            std::deque<std::unique_ptr<OutgoingBlob>> blobs;
+
+            if (connection->GetConnectionState() != ConnectionState::CONNECTED) co_return;
+            co_await connection->m_sendMessageAwaitableFlag.Wait();
+
+            while (connection->GetConnectionState() == ConnectionState::CONNECTED) {
+                std::unique_ptr<Package<T>> package;
+
+                if (connection->m_outQueue.try_dequeue(outQueueToken, package)) {
+                    if (package->GetHeader().size > MAX_NON_FILE_PACKAGE_SIZE) {
+                        blobs.push_back(OutgoingBlob::FromPackage(connection->m_blobCurrentID.fetch_add(1), std::move(package)));
+                        continue;
+                    }
+                } else if (std::unique_ptr<OutgoingBlob> blob; connection->m_outBlobQueue.try_dequeue(blob)) {
+                    blobs.push_back(std::move(blob));
+                    continue;
+                } else if (!blobs.empty()) {
+                    std::unique_ptr<OutgoingBlob> blob = std::move(blobs.front());
+                    blobs.pop_front();
+                    package = blob->NextFragment<T>();
+
+                    if (!blob->IsFinished()) {
+                        blobs.push_back(std::move(blob));
+                    }
+                } else {
+                    connection->m_sendMessageAwaitableFlag.Reset();
+                    co_await connection->m_sendMessageAwaitableFlag.Wait();
+                    continue;
+                }
+
+                co_await CoWritePackage(connection, std::move(package));
+            }
+        } catch (const std::system_error& error) {
+            if (connection->GetConnectionState() == ConnectionState::CONNECTED && error.code() != asio::error::operation_aborted && error.code() != asio::error::connection_aborted) {
+                Debug::LogError(error.what());
+            }
+
+            connection->Disconnect();
+            co_return;
+        }
+    }
+
+    static asio::awaitable<void> CoWritePackage(std::shared_ptr<ReliableUDPConnection<T>> connection, std::unique_ptr<Package<T>> package) {
+        const CompressionAlgorithm algorithm = connection->m_compressionAlgorithm.load(std::memory_order_acquire);
+
+        if (algorithm != CompressionAlgorithm::NONE && package->GetHeader().size >= COMPRESSION_MIN_SIZE) {
+            if (std::unique_ptr<Package<T>> compressed = co_await CoRunCompressionWork(package->GetHeader().size, [&package, algorithm] { return package->Compress(algorithm); })) {
+                package = std::move(compressed);
+            }
+        }
+
+        PackageHeader header = package->GetHeader();
+
+        std::vector<asio::const_buffer> buffers = {
+            asio::const_buffer(&header, sizeof(header)),
+            asio::const_buffer(package->GetRawBody(), header.size)
+        };
+
+        header.FromNativeToBigEndian();
+
+        co_await CoThrottle(connection, connection->m_messageRateTimer, TrafficClass::MESSAGE, sizeof(header) + package->GetHeader().size);
+        co_await asio::async_write(connection->GetStream(MultiplexedStream::MESSAGE), buffers, asio::use_awaitable);
+    }
+
+    static asio::awaitable<void> CoThrottle(std::shared_ptr<ReliableUDPConnection<T>> connection, asio::steady_timer& timer, const TrafficClass trafficClass, const size_t size) {
+        const TokenBucket::Clock::duration delay = connection->m_bandwidthLimiter.Acquire(trafficClass, size);
+        if (delay <= TokenBucket::Clock::duration::zero()) {
+            co_return;
+        }
+
+        timer.expires_after(delay);
+        co_await timer.async_wait(asio::use_awaitable);
+    }
+
+    static asio::awaitable<void> CoSendFile(std::shared_ptr<ReliableUDPConnection<T>> connection) {
+        try {
+            if (connection->GetConnectionState() != ConnectionState::CONNECTED) co_return;
+
+            FileTransferScheduler scheduler(P2PSettings::GetFileSchedulingPolicy());
+            std::vector<char>     compressedChunk;
+
+            co_await connection->m_sendFileAwaitableFlag.Wait();
+
+            while (connection->GetConnectionState() == ConnectionState::CONNECTED) {
+                while (!connection->m_fileRequestQueue.empty()) {
+                    std::unique_ptr<Package<T>> package = std::move(connection->m_fileRequestQueue.front());
+                    connection->m_fileRequestQueue.pop_front();
+
+                    std::unique_ptr<FileTransferSource> source = CreateFileSource(connection, *package);
+
+                    if (source == nullptr) {
+                        connection->Disconnect();
+                        co_return;
+                    }
+
+                    scheduler.Add(std::move(source));
+                }
+
+                if (scheduler.IsEmpty()) {
+                    connection->m_sendFileAwaitableFlag.Reset();
+                    co_await connection->m_sendFileAwaitableFlag.Wait();
+                    continue;
+                }
+
+                scheduler.SetPolicy(P2PSettings::GetFileSchedulingPolicy());
+                FileTransferSource* source = scheduler.Next();
+
+                if (!source->IsFinished()) {
+                    source->SetChunkSize(connection->m_sendTuner.GetChunkSize());
+                    co_await source->CoWaitReadable();
+
+                    if (!source->Read()) {
+                        connection->Disconnect();
+                        co_return;
+                    }
+
+                    const std::vector<char>& chunk = source->GetChunk();
+                    const CompressionAlgorithm algorithm = connection->m_compressionAlgorithm.load(std::memory_order_acquire);
+                    const bool isCompressed = algorithm != CompressionAlgorithm::NONE && co_await CoRunCompressionWork(chunk.size(), [&] {
+                        return Compression::Compress(algorithm, chunk.data(), chunk.size(), compressedChunk);
+                    });
+
+                    const std::vector<char>& payload = isCompressed ? compressedChunk : chunk;
+                    FileChunkHeader header{source->GetRequestID(), static_cast<uint32_t>(payload.size()), static_cast<uint8_t>(isCompressed ? FileChunkFlag::COMPRESSED : FileChunkFlag::NONE)};
+                    header.FromNativeToBigEndian();
+
+                    const std::array<asio::const_buffer, 2> buffers = {
+                        asio::buffer(&header, sizeof(FileChunkHeader)),
+                        asio::buffer(payload)
+                    };
+
+                    co_await CoThrottle(connection, connection->m_fileRateTimer, TrafficClass::FILE, sizeof(FileChunkHeader) + payload.size());
+
+                    const auto writeStart = std::chrono::steady_clock::now();
+                    co_await asio::async_write(connection->GetStream(MultiplexedStream::FILE), buffers, asio::use_awaitable);
+                    connection->m_sendTuner.RecordTransfer(payload.size(), std::chrono::steady_clock::now() - writeStart);
+
+                    if (connection->m_sendTuner.IsUpdateDue()) {
+                        connection->m_sendTuner.RecordRoundTripTime(connection->GetTransport()->GetRoundTripTime());
+                        connection->m_sendTuner.Update();
+                    }
+
+                    scheduler.Charge(source, static_cast<PackageSizeInt>(payload.size()));
+                    source->Release();
+                }
+
+                if (source->IsFinished()) {
+                    const HashDigest digest = co_await source->CoFinish();
+                    FileChunkHeader header{source->GetRequestID(), static_cast<uint32_t>(digest.size()), static_cast<uint8_t>(FileChunkFlag::END)};
+                    header.FromNativeToBigEndian();
+
+                    const std::array<asio::const_buffer, 2> buffers = {
+                        asio::buffer(&header, sizeof(FileChunkHeader)),
+                        asio::buffer(digest)
+                    };
+
+                    scheduler.Remove(source);
+                    co_await asio::async_write(connection->GetStream(MultiplexedStream::FILE), buffers, asio::use_awaitable);
+                }
+            }
+        } catch (const std::system_error& error) {
+            if (connection->GetConnectionState() == ConnectionState::CONNECTED && error.code() != asio::error::operation_aborted && error.code() != asio::error::connection_aborted) {
+                Debug::LogError(error.what());
+            }
+
+            connection->Disconnect();
+            co_return;
+        }
+    }
+
+    static std::unique_ptr<FileTransferSource> CreateFileSource(std::shared_ptr<ReliableUDPConnection<T>> connection, Package<T>& package) {
+        ZoneScoped;
+        size_t      requestID;
+        uint8_t     kind;
+        std::string path;
+        uint8_t     weight;
+
+        package.GetValue(requestID);
+        package.GetValue(kind);
+        package.GetValue(path);
+        package.GetValue(weight);
+
+        std::filesystem::path filePath(path);
+
+        if (!std::filesystem::exists(filePath)) {
+            Debug::LogError("File path doesnt exist");
+            return nullptr;
+        }
+
+        std::unique_ptr<Package<T>> fileInfo;
+
+        if (kind == static_cast<uint8_t>(FileRequestKind::DELTA)) {
+            DeltaSignature signature;
+
+            package.GetValue(signature.blockSize);
+            package.GetValue(signature.weakChecksums);
+            package.GetValue(signature.strongChecksums);
+
+            auto source = std::make_unique<DeltaFileSource>(requestID, weight, std::move(filePath), std::move(signature));
+            if (!source->Open()) {
+                return nullptr;
+            }
+
+            fileInfo = Package<T>::CreateUnique(static_cast<T>(0), size_t{requestID}, static_cast<uint8_t>(FileRequestKind::DELTA), static_cast<uint8_t>(FileDigestAlgorithm::SHA256),
+                PackageSizeInt{source->GetBlockSize()}, FileSizeInt{source->GetTotalSize()});
+            fileInfo->GetHeader().flags = static_cast<uint8_t>(PackageFlag::FILE_RECEIVE_INFO);
+            connection->Send(std::move(fileInfo));
+
+            return source;
+        }
+
+        if (kind == static_cast<uint8_t>(FileRequestKind::CHUNKED)) {
+            std::vector<uint8_t> missingChunks;
+            package.GetValue(missingChunks);
+
+            // Only chunks this side offered and the receiver did not ask for may be sent as references
+            const std::vector<uint8_t> manifest = connection->m_chunkManifests.Get(requestID).value_or(std::vector<uint8_t>{});
+            connection->m_chunkManifests.Erase(requestID);
+
+            auto source = std::make_unique<ChunkedFileSource>(requestID, weight, std::move(filePath), ChunkStore::Subtract(manifest, missingChunks));
+            if (!source->Open()) {
+                return nullptr;
+            }
+
+            fileInfo = Package<T>::CreateUnique(static_cast<T>(0), size_t{requestID}, static_cast<uint8_t>(FileRequestKind::CHUNKED), static_cast<uint8_t>(FileDigestAlgorithm::SHA256),
+                FileSizeInt{source->GetTotalSize()});
+            fileInfo->GetHeader().flags = static_cast<uint8_t>(PackageFlag::FILE_RECEIVE_INFO);
+            connection->Send(std::move(fileInfo));
+
+            return source;
+        }
+
+        if (kind == static_cast<uint8_t>(FileRequestKind::TREE)) {
+            if (!std::filesystem::is_directory(filePath)) {
+                Debug::LogError("Requested path is not a directory");
+                return nullptr;
+            }
+
+            auto source = std::make_unique<TreeFileSource>(requestID, weight, std::move(filePath));
+            if (!source->Open()) {
+                return nullptr;
+            }
+
+            fileInfo = Package<T>::CreateUnique(static_cast<T>(0), size_t{requestID}, static_cast<uint8_t>(FileRequestKind::TREE), static_cast<uint8_t>(FileDigestAlgorithm::SHA256),
+                PackageSizeInt{source->GetManifestSize()}, FileSizeInt{source->GetContentSize()});
+            fileInfo->GetHeader().flags = static_cast<uint8_t>(PackageFlag::FILE_RECEIVE_INFO);
+            connection->Send(std::move(fileInfo));
+
+            return source;
+        }
+
+        FileSizeInt offset;
+        FileSizeInt size;
+
+        package.GetValue(offset);
+        package.GetValue(size);
+
+        auto source = std::make_unique<RangeFileSource>(requestID, weight, std::move(filePath), offset, size);
+        if (!source->Open()) {
+            return nullptr;
+        }
+
+        std::vector<FileSizeInt> extents;
+        if (source->IsSparse()) {
+            for (const FileExtent& extent : source->GetDataExtents()) {
+                extents.push_back(extent.offset);
+                extents.push_back(extent.size);
+            }
+        }
+
+        fileInfo = Package<T>::CreateUnique(static_cast<T>(0), size_t{requestID}, static_cast<uint8_t>(FileRequestKind::RANGE), static_cast<uint8_t>(FileDigestAlgorithm::SHA256),
+            FileSizeInt{source->GetOffset()}, FileSizeInt{source->GetSize()}, FileSizeInt{source->GetTotalSize()}, uint8_t{source->IsSparse()}, std::move(extents));
+        fileInfo->GetHeader().flags = static_cast<uint8_t>(PackageFlag::FILE_RECEIVE_INFO);
+        connection->Send(std::move(fileInfo));
+
+        return source;
+    }
+
+    void SendCompressionHello() {
+        std::unique_ptr<Package<T>> hello = Package<T>::CreateUnique(static_cast<T>(0), uint8_t{Compression::GetSupportedAlgorithms()});
+        hello->GetHeader().flags = static_cast<uint8_t>(PackageFlag::COMPRESSION_HELLO);
+        Send(std::move(hello));
+    }
+
+    void SetConnectionState(const ConnectionState state) {
+        ZoneScoped;
+        m_connectionState.store(state, std::memory_order_release);
+
+        if (state == ConnectionState::DISCONNECTED) {
+            FailFileRequests();
+        }
+    }
+
+    void CompleteFileRequest(const size_t requestID, const bool succeeded) {
+        std::function<void(bool)> callback;
+
+        {
+            std::lock_guard lock(m_fileCallbackMutex);
+            const auto entry = m_fileCallbacks.find(requestID);
+            if (entry == m_fileCallbacks.end()) {
+                return;
+            }
+
+            callback = std::move(entry->second);
+            m_fileCallbacks.erase(entry);
+        }
+
+        callback(succeeded);
+    }
+
+    void FailFileRequests() {
+        std::unordered_map<size_t, std::function<void(bool)>> callbacks;
+
+        {
+            std::lock_guard lock(m_fileCallbackMutex);
+            callbacks.swap(m_fileCallbacks);
+        }
+
+        for (auto& [requestID, callback] : callbacks) {
+            callback(false);
+        }
+    }
+
+    IOContext& m_context;
+
+    std::shared_ptr<ReliableDatagramTransport> m_transport;
+    DatagramImpairment                         m_impairment;
+    mutable std::mutex                         m_transportMutex;
+
+    AwaitableFlag m_sendMessageAwaitableFlag;
+    AwaitableFlag m_sendFileAwaitableFlag;
+    AwaitableFlag m_receiveFileAwaitableFlag;
+
+    BandwidthLimiter   m_bandwidthLimiter;
+    asio::steady_timer m_fileRateTimer;
+    asio::steady_timer m_messageRateTimer;
+
+    std::atomic<ConnectionState> m_connectionState;
+
+    moodycamel::ConcurrentQueue<std::unique_ptr<Package<T>>>    m_outQueue;
+    moodycamel::ConcurrentQueue<std::unique_ptr<OutgoingBlob>>  m_outBlobQueue;
+    moodycamel::ConcurrentQueue<std::unique_ptr<PackageIn<T>>>& m_inQueue;
+
+    std::deque<std::unique_ptr<Package<T>>> m_fileRequestQueue;
+    std::deque<std::unique_ptr<Package<T>>> m_fileInfoQueue;
+
+    ConcurrentUnorderedMap<size_t, std::string> m_fileNameMap;
+    std::atomic<size_t>                         m_fileCurrentID{0};
+
+    ConcurrentUnorderedMap<size_t, std::vector<uint8_t>> m_chunkManifests;
+
+    std::unordered_map<size_t, std::function<void(bool)>> m_fileCallbacks;
+    std::mutex                                            m_fileCallbackMutex;
+
+    std::atomic<CompressionAlgorithm> m_compressionAlgorithm{CompressionAlgorithm::NONE};
+
+    BlobAssembler<T>    m_blobAssembler;
+    std::atomic<size_t> m_blobCurrentID{0};
+
+    FileTransferTuner m_sendTuner{FileTransferDirection::SEND};
+    FileTransferTuner m_receiveTuner{FileTransferDirection::RECEIVE};
+
+    IPAddress               m_address;
+    std::vector<IPAddress>  m_candidates;
+    std::array<uint16_t, 2> m_ports;
+};
+
+#endif //P2P_RELIABLE_UDP_CONNECTION_H
\ No newline at end of file
@@ -1,17 +1,70 @@
 #ifndef P2P_SETTINGS_H
 #define P2P_SETTINGS_H
 
+#include <AsioCommon.h>
+#include <Compression.h>
+#include <CongestionController.h>
+#include <FileSchedulingPolicy.h>
 #include <filesystem>
 #include <mutex>
+#include <utility>
 
 class P2PSettings {
 public:
     static void SetFileDownloadDirectory(const std::filesystem::path& directory);
     static std::filesystem::path GetFileDownloadDirectory();
 
+    static void SetDeltaSyncEnabled(bool enabled);
+    static bool IsDeltaSyncEnabled();
+
+    static void SetChunkStoreEnabled(bool enabled);
+    static bool IsChunkStoreEnabled();
+
+    static void SetChunkStoreDirectory(const std::filesystem::path& directory);
+    static std::filesystem::path GetChunkStoreDirectory();
+
+    static void SetFileSchedulingPolicy(FileSchedulingPolicy policy);
+    static FileSchedulingPolicy GetFileSchedulingPolicy();
+
+    static void SetMemoryMappedReceiveEnabled(bool enabled);
+    static bool IsMemoryMappedReceiveEnabled();
+
+    static void SetFileChunkSizeBounds(PackageSizeInt minSize, PackageSizeInt maxSize);
+    static std::pair<PackageSizeInt, PackageSizeInt> GetFileChunkSizeBounds();
+
+    static void SetSocketBufferSizeBounds(PackageSizeInt minSize, PackageSizeInt maxSize);
+    static std::pair<PackageSizeInt, PackageSizeInt> GetSocketBufferSizeBounds();
+
+    static void SetCompressionAlgorithm(CompressionAlgorithm algorithm);
+    static CompressionAlgorithm GetCompressionAlgorithm();
+
+    static void SetStreamMultiplexingEnabled(bool enabled);
+    static bool IsStreamMultiplexingEnabled();
+
+    static void SetSharedMemoryEnabled(bool enabled);
+    static bool IsSharedMemoryEnabled();
+
+    static void SetDatagramChannelEnabled(bool enabled);
+    static bool IsDatagramChannelEnabled();
+
+    static void SetCongestionControlAlgorithm(CongestionControlAlgorithm algorithm);
+    static CongestionControlAlgorithm GetCongestionControlAlgorithm();
+
 private:
-    static std::mutex            m_mutex;
-    static std::filesystem::path m_fileDownloadDirectory;
+    static std::mutex                                m_mutex;
+    static std::filesystem::path                     m_fileDownloadDirectory;
+    static bool                                      m_deltaSyncEnabled;
+    static bool                                      m_chunkStoreEnabled;
+    static std::filesystem::path                     m_chunkStoreDirectory;
+    static FileSchedulingPolicy                      m_fileSchedulingPolicy;
+    static bool                                      m_memoryMappedReceiveEnabled;
+    static std::pair<PackageSizeInt, PackageSizeInt> m_fileChunkSizeBounds;
+    static std::pair<PackageSizeInt, PackageSizeInt> m_socketBufferSizeBounds;
+    static CompressionAlgorithm                      m_compressionAlgorithm;
+    static bool                                      m_streamMultiplexingEnabled;
+    static bool                                      m_sharedMemoryEnabled;
+    static bool                                      m_datagramChannelEnabled;
+    static CongestionControlAlgorithm                m_congestionControlAlgorithm;
 
 };
 
@@ -0,0 +1,141 @@
+#ifndef P2P_SHARED_MEMORY_CHANNEL_H
+#define P2P_SHARED_MEMORY_CHANNEL_H
+
+#include <AsioCommon.h>
+#include <SharedMemoryRegion.h>
+#include <SharedMemoryRing.h>
+#include <StreamMultiplexer.h>
+#include <array>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef NO_DISCARD
+#define NO_DISCARD [[nodiscard]]
+#endif
+
+constexpr size_t SHARED_MEMORY_RING_SIZE = 2 * 1024 * 1024;
+constexpr size_t SHARED_MEMORY_NAME_SIZE = 64;
+constexpr uint32_t SHARED_MEMORY_SPIN_COUNT = 4096;
+
+enum class SharedMemorySide : uint8_t {
+    SERVER,
+    CLIENT
+};
+
+class SharedMemoryChannel final {
+public:
+    class Stream {
+    public:
+        using executor_type = asio::any_io_executor;
+
+        Stream(SharedMemoryChannel& channel, const size_t index) : m_channel(channel), m_index(index) { }
+
+        NO_DISCARD executor_type get_executor() const {
+            return m_channel.m_executor;
+        }
+
+        template <typename MutableBufferSequence, typename CompletionToken>
+        auto async_read_some(const MutableBufferSequence& buffers, CompletionToken&& token) {
+            return AsyncTransfer<false>(buffers, std::forward<CompletionToken>(token));
+        }
+
+        template <typename ConstBufferSequence, typename CompletionToken>
+        auto async_write_some(const ConstBufferSequence& buffers, CompletionToken&& token) {
+            return AsyncTransfer<true>(buffers, std::forward<CompletionToken>(token));
+        }
+
+    private:
+        template <bool IsWrite, typename BufferSequence, typename CompletionToken>
+        auto AsyncTransfer(const BufferSequence& buffers, CompletionToken&& token) {
+            return asio::async_compose<CompletionToken, void(asio::error_code, size_t)>(
+                [this, buffers, initiating = true](auto& self) mutable {
+                    const bool initial = std::exchange(initiating, false);
+                    size_t transferred = 0;
+
+                    for (auto buffer = asio::buffer_sequence_begin(buffers); buffer != asio::buffer_sequence_end(buffers); ++buffer) {
+                        size_t size;
+                        if constexpr (IsWrite) {
+                            size = m_channel.Write(m_index, buffer->data(), buffer->size());
+                        } else {
+                            size = m_channel.Read(m_index, buffer->data(), buffer->size());
+                        }
+
+                        transferred += size;
+
+                        if (size < buffer->size()) {
+                            break;
+                        }
+                    }
+
+                    asio::error_code errorCode;
+                    if (transferred == 0 && asio::buffer_size(buffers) > 0) {
+                        if (!m_channel.IsClosed()) {
+                            m_channel.Park(m_index, IsWrite, [self = std::move(self)]() mutable { self(); });
+                            return;
+                        }
+
+                        errorCode = IsWrite ? asio::error_code(asio::error::broken_pipe) : asio::error_code(asio::error::eof);
+                    }
+
+                    if (initial) {
+                        asio::post(m_channel.m_executor, [self = std::move(self), errorCode, transferred]() mutable { self.complete(errorCode, transferred); });
+                    } else {
+                        self.complete(errorCode, transferred);
+                    }
+                }, token, m_channel.m_executor);
+        }
+
+        SharedMemoryChannel& m_channel;
+        size_t               m_index;
+    };
+
+    SharedMemoryChannel(asio::any_io_executor executor, SharedMemorySide side, size_t streamCount = static_cast<size_t>(MultiplexedStream::COUNT));
+    ~SharedMemoryChannel();
+
+    SharedMemoryChannel(const SharedMemoryChannel&) = delete;
+    SharedMemoryChannel& operator=(const SharedMemoryChannel&) = delete;
+
+    NO_DISCARD static bool IsSupported();
+
+    bool Create();
+    bool Open(const std::string& name);
+    void Unlink();
+    void Start();
+    void Close();
+
+    NO_DISCARD bool IsClosed() const;
+    NO_DISCARD const std::string& GetName() const;
+    NO_DISCARD Stream& GetStream(MultiplexedStream stream);
+
+private:
+    struct Layout;
+
+    NO_DISCARD static size_t GetRegionSize(size_t streamCount);
+    void Attach();
+    bool CheckConsistency();
+
+    size_t Read(size_t index, void* destination, size_t size);
+    size_t Write(size_t index, const void* source, size_t size);
+    void Park(size_t index, bool isWrite, std::move_only_function<void()> waiter);
+    void Run(const std::stop_token& stopToken);
+
+    asio::any_io_executor m_executor;
+    SharedMemorySide      m_side;
+    size_t                m_streamCount;
+    SharedMemoryRegion    m_region;
+    Layout*               m_layout{nullptr};
+
+    std::vector<SharedMemoryRing>                           m_inRings;
+    std::vector<SharedMemoryRing>                           m_outRings;
+    std::vector<Stream>                                     m_streams;
+    std::vector<std::array<std::move_only_function<void()>, 2>> m_waiters;
+
+    mutable std::mutex m_mutex;
+    std::jthread       m_thread;
+};
+
+#endif //P2P_SHARED_MEMORY_CHANNEL_H
@@ -0,0 +1,333 @@
+#ifndef P2P_STREAM_MULTIPLEXER_H
+#define P2P_STREAM_MULTIPLEXER_H
+
+#include <AsioCommon.h>
+#include <tracy/Tracy.hpp>
+#include <boost/endian/conversion.hpp>
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#ifndef NO_DISCARD
+#define NO_DISCARD [[nodiscard]]
+#endif
+
+constexpr PackageSizeInt MULTIPLEX_MAX_FRAME_SIZE = 64 * 1024;
+constexpr PackageSizeInt MULTIPLEX_WINDOW_SIZE = 4 * 1024 * 1024;
+constexpr PackageSizeInt MULTIPLEX_WINDOW_UPDATE_THRESHOLD = MULTIPLEX_WINDOW_SIZE / 4;
+constexpr PackageSizeInt MULTIPLEX_WRITE_BATCH_SIZE = MULTIPLEX_MAX_FRAME_SIZE;
+
+enum class MultiplexedStream : uint8_t {
+    MESSAGE,
+    FILE,
+    COUNT
+};
+
+enum class TransportMode : uint8_t {
+    DUAL_SOCKET,
+    MULTIPLEXED,
+    SHARED_MEMORY
+};
+
+enum class MultiplexFrameType : uint8_t {
+    DATA,
+    WINDOW_UPDATE
+};
+
+struct MultiplexFrameHeader {
+    uint32_t size{};
+    uint8_t  stream{};
+    uint8_t  type{};
+
+    void FromNativeToBigEndian() {
+        boost::endian::native_to_big_inplace(size);
+    }
+
+    void FromBigEndianToNative() {
+        boost::endian::big_to_native_inplace(size);
+    }
+};
+
+template <typename Stream>
+class StreamMultiplexer final : public std::enable_shared_from_this<StreamMultiplexer<Stream>> {
+public:
+    StreamMultiplexer(Stream& stream, asio::any_io_executor executor, const size_t streamCount = static_cast<size_t>(MultiplexedStream::COUNT))
+        : m_stream(stream), m_executor(std::move(executor)), m_streams(streamCount) {}
+
+    StreamMultiplexer(const StreamMultiplexer&) = delete;
+    StreamMultiplexer& operator=(const StreamMultiplexer&) = delete;
+
+    void Start(std::shared_ptr<void> owner) {
+        ZoneScoped;
+        std::shared_ptr<StreamMultiplexer> multiplexer = this->shared_from_this();
+        asio::co_spawn(m_executor, CoReadFrames(multiplexer, owner), asio::detached);
+        asio::co_spawn(m_executor, CoWriteFrames(multiplexer, std::move(owner)), asio::detached);
+    }
+
+    void Close(const asio::error_code& errorCode) {
+        ZoneScoped;
+        std::lock_guard lock(m_mutex);
+        if (m_closed) {
+            return;
+        }
+
+        m_closed = true;
+        m_errorCode = errorCode;
+
+        for (StreamState& state : m_streams) {
+            Wake(state.dataWaiter);
+            Wake(state.creditWaiter);
+        }
+
+        Wake(m_frameWaiter);
+    }
+
+    NO_DISCARD bool IsClosed() const {
+        std::lock_guard lock(m_mutex);
+        return m_closed;
+    }
+
+    asio::awaitable<void> Read(const MultiplexedStream stream, const asio::mutable_buffer buffer) {
+        StreamState& state = m_streams[static_cast<size_t>(stream)];
+        auto* destination = static_cast<char*>(buffer.data());
+        size_t remaining = buffer.size();
+
+        while (remaining > 0) {
+            {
+                std::lock_guard lock(m_mutex);
+                const size_t available = state.data.size() - state.readOffset;
+
+                if (available > 0) {
+                    const size_t size = std::min(available, remaining);
+                    std::memcpy(destination, state.data.data() + state.readOffset, size);
+
+                    destination += size;
+                    remaining -= size;
+                    Consume(stream, state, size);
+                    continue;
+                }
+
+                if (m_closed) {
+                    throw asio::system_error(m_errorCode);
+                }
+            }
+
+            co_await CoWait(state.dataWaiter, [&state, this] { return m_closed || state.readOffset < state.data.size(); });
+        }
+    }
+
+    template <typename ConstBufferSequence>
+    asio::awaitable<void> Write(const MultiplexedStream stream, const ConstBufferSequence buffers) {
+        StreamState& state = m_streams[static_cast<size_t>(stream)];
+
+        for (auto buffer = asio::buffer_sequence_begin(buffers); buffer != asio::buffer_sequence_end(buffers); ++buffer) {
+            const auto* source = static_cast<const char*>(buffer->data());
+            size_t remaining = buffer->size();
+
+            while (remaining > 0) {
+                {
+                    std::lock_guard lock(m_mutex);
+                    if (m_closed) {
+                        throw asio::system_error(m_errorCode);
+                    }
+
+                    if (state.sendCredit > 0) {
+                        const size_t size = std::min({remaining, state.sendCredit, static_cast<size_t>(MULTIPLEX_MAX_FRAME_SIZE)});
+                        QueueFrame(stream, MultiplexFrameType::DATA, static_cast<uint32_t>(size), source, size);
+
+                        state.sendCredit -= size;
+                        source += size;
+                        remaining -= size;
+                        continue;
+                    }
+                }
+
+                co_await CoWait(state.creditWaiter, [&state, this] { return m_closed || state.sendCredit > 0; });
+            }
+        }
+    }
+
+private:
+    struct StreamState {
+        std::deque<std::vector<char>> frames;
+        std::vector<char>             data;
+        size_t                        readOffset{0};
+        size_t                        consumedSize{0};
+        size_t                        sendCredit{MULTIPLEX_WINDOW_SIZE};
+        std::function<void()>         dataWaiter;
+        std::function<void()>         creditWaiter;
+    };
+
+    template <typename Predicate>
+    asio::awaitable<void> CoWait(std::function<void()>& waiter, Predicate ready) {
+        co_await asio::async_initiate<decltype(asio::use_awaitable), void()>([this, &waiter, ready](auto handler) {
+            const auto executor = asio::get_associated_executor(handler, m_executor);
+            auto resume = std::make_shared<decltype(handler)>(std::move(handler));
+
+            std::lock_guard lock(m_mutex);
+            waiter = [executor, resume] { asio::post(executor, std::move(*resume)); };
+
+            if (ready()) {
+                Wake(waiter);
+            }
+        }, asio::use_awaitable);
+    }
+
+    static void Wake(std::function<void()>& waiter) {
+        if (!waiter) {
+            return;
+        }
+
+        const std::function<void()> resume = std::move(waiter);
+        waiter = nullptr;
+        resume();
+    }
+
+    void Consume(const MultiplexedStream stream, StreamState& state, const size_t size) {
+        state.readOffset += size;
+        state.consumedSize += size;
+
+        if (state.readOffset == state.data.size()) {
+            state.data.clear();
+            state.readOffset = 0;
+        }
+
+        if (state.consumedSize >= MULTIPLEX_WINDOW_UPDATE_THRESHOLD) {
+            QueueFrame(stream, MultiplexFrameType::WINDOW_UPDATE, static_cast<uint32_t>(state.consumedSize), nullptr, 0);
+            state.consumedSize = 0;
+        }
+    }
+
+    // Window updates go out ahead of all data so the peer's credit is never stuck behind a backlog
+    void QueueFrame(const MultiplexedStream stream, const MultiplexFrameType type, const uint32_t value, const char* payload, const size_t size) {
+        MultiplexFrameHeader header{value, static_cast<uint8_t>(stream), static_cast<uint8_t>(type)};
+        header.FromNativeToBigEndian();
+
+        std::vector<char> frame(sizeof(MultiplexFrameHeader) + size);
+        std::memcpy(frame.data(), &header, sizeof(MultiplexFrameHeader));
+
+        if (size > 0) {
+            std::memcpy(frame.data() + sizeof(MultiplexFrameHeader), payload, size);
+        }
+
+        std::deque<std::vector<char>>& frames = type == MultiplexFrameType::WINDOW_UPDATE ? m_controlFrames : m_streams[static_cast<size_t>(stream)].frames;
+        frames.push_back(std::move(frame));
+        Wake(m_frameWaiter);
+    }
+
+    // Lower streams are drained first and a batch stops after about one frame, so MESSAGE frames overtake queued FILE frames
+    void TakeFrames(std::vector<std::vector<char>>& batch) {
+        size_t batchSize = 0;
+
+        const auto take = [&batch, &batchSize](std::deque<std::vector<char>>& frames) {
+            while (!frames.empty() && batchSize < MULTIPLEX_WRITE_BATCH_SIZE) {
+                batchSize += frames.front().size();
+                batch.push_back(std::move(frames.front()));
+                frames.pop_front();
+            }
+        };
+
+        take(m_controlFrames);
+        for (StreamState& state : m_streams) {
+            take(state.frames);
+        }
+    }
+
+    NO_DISCARD bool HasQueuedFrames() const {
+        return !m_controlFrames.empty() || std::ranges::any_of(m_streams, [](const StreamState& state) { return !state.frames.empty(); });
+    }
+
+    static asio::awaitable<void> CoReadFrames(std::shared_ptr<StreamMultiplexer> multiplexer, [[maybe_unused]] std::shared_ptr<void> owner) {
+        try {
+            MultiplexFrameHeader header{};
+            std::vector<char>    payload(MULTIPLEX_MAX_FRAME_SIZE);
+
+            while (!multiplexer->IsClosed()) {
+                co_await asio::async_read(multiplexer->m_stream, asio::buffer(&header, sizeof(MultiplexFrameHeader)), asio::use_awaitable);
+                header.FromBigEndianToNative();
+
+                if (header.stream >= multiplexer->m_streams.size()) {
+                    throw asio::system_error(asio::error::invalid_argument);
+                }
+
+                StreamState& state = multiplexer->m_streams[header.stream];
+
+                if (header.type == static_cast<uint8_t>(MultiplexFrameType::WINDOW_UPDATE)) {
+                    std::lock_guard lock(multiplexer->m_mutex);
+                    state.sendCredit += header.size;
+                    Wake(state.creditWaiter);
+                    continue;
+                }
+
+                if (header.type != static_cast<uint8_t>(MultiplexFrameType::DATA) || header.size > MULTIPLEX_MAX_FRAME_SIZE) {
+                    throw asio::system_error(asio::error::message_size);
+                }
+
+                co_await asio::async_read(multiplexer->m_stream, asio::buffer(payload.data(), header.size), asio::use_awaitable);
+
+                std::lock_guard lock(multiplexer->m_mutex);
+                if (state.data.size() - state.readOffset + header.size > MULTIPLEX_WINDOW_SIZE) {
+                    throw asio::system_error(asio::error::no_buffer_space);
+                }
+
+                if (state.readOffset > 0 && state.readOffset >= state.data.size() - state.readOffset) {
+                    state.data.erase(state.data.begin(), state.data.begin() + static_cast<std::ptrdiff_t>(state.readOffset));
+                    state.readOffset = 0;
+                }
+
+                state.data.insert(state.data.end(), payload.data(), payload.data() + header.size);
+                Wake(state.dataWaiter);
+            }
+        } catch (const asio::system_error& error) {
+            multiplexer->Close(error.code());
+        }
+    }
+
+    static asio::awaitable<void> CoWriteFrames(std::shared_ptr<StreamMultiplexer> multiplexer, [[maybe_unused]] std::shared_ptr<void> owner) {
+        try {
+            std::vector<std::vector<char>> frames;
+            std::vector<asio::const_buffer> buffers;
+
+            while (true) {
+                {
+                    std::lock_guard lock(multiplexer->m_mutex);
+                    if (multiplexer->m_closed) {
+                        co_return;
+                    }
+
+                    frames.clear();
+                    multiplexer->TakeFrames(frames);
+                }
+
+                if (frames.empty()) {
+                    co_await multiplexer->CoWait(multiplexer->m_frameWaiter, [&multiplexer] { return multiplexer->m_closed || multiplexer->HasQueuedFrames(); });
+                    continue;
+                }
+
+                buffers.clear();
+                for (const std::vector<char>& frame : frames) {
+                    buffers.push_back(asio::buffer(frame));
+                }
+
+                co_await asio::async_write(multiplexer->m_stream, buffers, asio::use_awaitable);
+            }
+        } catch (const asio::system_error& error) {
+            multiplexer->Close(error.code());
+        }
+    }
+
+    Stream&                       m_stream;
+    asio::any_io_executor         m_executor;
+    mutable std::mutex            m_mutex;
+    std::vector<StreamState>      m_streams;
+    std::deque<std::vector<char>> m_controlFrames;
+    std::function<void()>         m_frameWaiter;
+    asio::error_code              m_errorCode;
+    bool                          m_closed{false};
+};
+
+#endif //P2P_STREAM_MULTIPLEXER_H
@@ -0,0 +1,255 @@
+#ifndef P2P_SWARM_DOWNLOAD_H
+#define P2P_SWARM_DOWNLOAD_H
+
+#include <BlockingWork.h>
+#include <ConnectionParent.h>
+#include <DebugLog.h>
+#include <FileTransfer.h>
+#include <FileTransferCheckpoint.h>
+#include <PipelinedHasher.h>
+#include <Settings.h>
+#include <SwarmScheduler.h>
+#include <tracy/Tracy.hpp>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#ifndef NO_DISCARD
+#define NO_DISCARD [[nodiscard]]
+#endif
+
+constexpr std::chrono::milliseconds SWARM_REBALANCE_INTERVAL{250};
+
+template <PackageType T>
+class SwarmDownload final : public std::enable_shared_from_this<SwarmDownload<T>> {
+public:
+    SwarmDownload(IOContext& context, std::string requestedFilePath, std::string fileName, const FileSizeInt totalSize, const std::optional<HashDigest> expectedDigest = std::nullopt, const uint8_t weight = FILE_TRANSFER_DEFAULT_WEIGHT)
+        : m_rebalanceTimer(context), m_requestedFilePath(std::move(requestedFilePath)), m_fileName(std::move(fileName)), m_filePath(P2PSettings::GetFileDownloadDirectory() / m_fileName),
+          m_totalSize(totalSize), m_expectedDigest(expectedDigest), m_weight(weight) {}
+
+    SwarmDownload(const SwarmDownload&) = delete;
+    SwarmDownload& operator=(const SwarmDownload&) = delete;
+
+    void AddPeer(std::shared_ptr<ConnectionParent<T>> connection) {
+        {
+            std::lock_guard lock(m_mutex);
+            m_peers.push_back(std::move(connection));
+
+            if (!m_scheduler.has_value()) {
+                return;
+            }
+
+            static_cast<void>(m_scheduler->AddPeer());
+        }
+
+        Schedule();
+    }
+
+    bool Start(std::function<void(bool)> callback) {
+        ZoneScoped;
+        const std::shared_ptr<FileTransferCheckpoint> checkpoint = FileTransferCheckpoint::Acquire(m_filePath);
+
+        if (!checkpoint->IsStarted() || checkpoint->GetTotalSize() != m_totalSize || !std::filesystem::exists(m_filePath)) {
+            std::error_code errorCode;
+            std::filesystem::create_directories(m_filePath.parent_path(), errorCode);
+            std::ofstream(m_filePath, std::ios::binary | std::ios::trunc).close();
+            std::filesystem::resize_file(m_filePath, m_totalSize, errorCode);
+
+            if (errorCode) {
+                Debug::LogError("Could not create {}: {}", m_filePath.string(), errorCode.message());
+                return false;
+            }
+
+            checkpoint->Reset(m_totalSize);
+            checkpoint->Save();
+        }
+
+        checkpoint->Hold();
+
+        {
+            std::lock_guard lock(m_mutex);
+            m_callback = std::move(callback);
+            m_checkpoint = checkpoint;
+            m_scheduler.emplace(checkpoint->GetMissingRanges());
+
+            for (size_t peer = 0; peer < m_peers.size(); ++peer) {
+                static_cast<void>(m_scheduler->AddPeer());
+            }
+        }
+
+        Schedule();
+        ArmRebalanceTimer();
+        return true;
+    }
+
+    NO_DISCARD bool IsFinished() const {
+        std::lock_guard lock(m_mutex);
+        return m_finished;
+    }
+
+    NO_DISCARD FileSizeInt GetReceivedSize() const {
+        std::lock_guard lock(m_mutex);
+        return m_scheduler.has_value() ? m_scheduler->GetReceivedSize() : 0;
+    }
+
+    NO_DISCARD FileSizeInt GetPeerReceivedSize(const size_t peer) const {
+        std::lock_guard lock(m_mutex);
+        return m_scheduler.has_value() ? m_scheduler->GetPeerReceivedSize(peer) : 0;
+    }
+
+private:
+    struct Request {
+        std::shared_ptr<ConnectionParent<T>> connection;
+        SwarmAssignment                      assignment;
+    };
+
+    void Schedule() {
+        ZoneScoped;
+        std::vector<Request> requests;
+        bool finished = false;
+        bool stalled = false;
+        bool released = false;
+
+        {
+            std::lock_guard lock(m_mutex);
+            if (!m_scheduler.has_value() || m_released) {
+                return;
+            }
+
+            for (size_t peer = 0; peer < m_peers.size(); ++peer) {
+                if (m_scheduler->IsPeerActive(peer) && m_peers[peer]->GetConnectionState() != ConnectionState::CONNECTED) {
+                    m_scheduler->RemovePeer(peer);
+                }
+            }
+
+            if (!m_finished) {
+                finished = m_scheduler->IsFinished();
+                stalled = m_scheduler->IsStalled();
+                m_finished = finished || stalled;
+            }
+
+            if (!m_finished) {
+                for (const SwarmAssignment& assignment : m_scheduler->Assign(SwarmScheduler::Clock::now())) {
+                    requests.push_back({m_peers[assignment.peer], assignment});
+                }
+            }
+
+            released = m_finished && m_scheduler->GetOutstandingCount() == 0;
+            m_released = released;
+        }
+
+        if (stalled) {
+            Debug::LogError("No peers left to download {}", m_fileName);
+            Finish(false);
+        } else if (finished) {
+            VerifyAndFinish();
+        }
+
+        if (released) {
+            m_checkpoint->Release();
+        }
+
+        for (Request& request : requests) {
+            const SwarmAssignment assignment = request.assignment;
+            request.connection->RequestFileRange(m_requestedFilePath, m_fileName, assignment.offset, assignment.size, m_weight,
+                [download = this->shared_from_this(), assignment](const bool verified) {
+                    download->OnPieceCompleted(assignment, verified);
+                });
+        }
+    }
+
+    void ArmRebalanceTimer() {
+        m_rebalanceTimer.expires_after(SWARM_REBALANCE_INTERVAL);
+        m_rebalanceTimer.async_wait([download = this->weak_from_this()](const asio::error_code& errorCode) {
+            const std::shared_ptr<SwarmDownload> self = download.lock();
+            if (errorCode || self == nullptr || self->IsFinished()) {
+                return;
+            }
+
+            self->Schedule();
+            self->ArmRebalanceTimer();
+        });
+    }
+
+    void OnPieceCompleted(const SwarmAssignment& assignment, const bool verified) {
+        {
+            std::lock_guard lock(m_mutex);
+            m_scheduler->Complete(assignment.peer, assignment.piece, verified, SwarmScheduler::Clock::now());
+        }
+
+        Schedule();
+    }
+
+    void VerifyAndFinish() {
+        if (!m_expectedDigest.has_value()) {
+            Finish(true);
+            return;
+        }
+
+        // Hashing the whole file would stall the io thread, so it runs on the worker pool and the result is posted back
+        asio::post(BlockingWork::GetPool(), [download = this->shared_from_this(), executor = m_rebalanceTimer.get_executor()] {
+            const bool verified = download->Verify();
+            asio::post(executor, [download, verified] {
+                download->Finish(verified);
+            });
+        });
+    }
+
+    bool Verify() const {
+        ZoneScoped;
+        if (!m_expectedDigest.has_value()) {
+            return true;
+        }
+
+        std::ifstream file(m_filePath, std::ios::binary);
+        std::vector<char> buffer(FILE_BUFFER_SIZE);
+        PipelinedHasher hasher;
+
+        while (file.read(buffer.data(), static_cast<std::streamsize>(buffer.size())) || file.gcount() > 0) {
+            hasher.Update(buffer.data(), static_cast<size_t>(file.gcount()));
+        }
+
+        if (hasher.Finish() != m_expectedDigest.value()) {
+            Debug::LogError("Content hash mismatch for swarm download {}", m_fileName);
+            return false;
+        }
+
+        return true;
+    }
+
+    void Finish(const bool succeeded) {
+        std::function<void(bool)> callback;
+
+        {
+            std::lock_guard lock(m_mutex);
+            callback = std::move(m_callback);
+            m_callback = nullptr;
+        }
+
+        if (callback) {
+            callback(succeeded);
+        }
+    }
+
+    asio::steady_timer                                m_rebalanceTimer;
+    std::string                                       m_requestedFilePath;
+    std::string                                       m_fileName;
+    std::filesystem::path                             m_filePath;
+    FileSizeInt                                       m_totalSize;
+    std::optional<HashDigest>                         m_expectedDigest;
+    uint8_t                                           m_weight;
+    mutable std::mutex                                m_mutex;
+    std::vector<std::shared_ptr<ConnectionParent<T>>> m_peers;
+    std::optional<SwarmScheduler>                     m_scheduler;
+    std::shared_ptr<FileTransferCheckpoint>           m_checkpoint;
+    std::function<void(bool)>                         m_callback;
+    bool                                              m_finished{false};
+    bool                                              m_released{false};
+};
+
+#endif //P2P_SWARM_DOWNLOAD_H
@@ -0,0 +1,86 @@
+#ifndef P2P_SWARM_SCHEDULER_H
+#define P2P_SWARM_SCHEDULER_H
+
+#include <AsioCommon.h>
+#include <chrono>
+#include <utility>
+#include <vector>
+
+#ifndef NO_DISCARD
+#define NO_DISCARD [[nodiscard]]
+#endif
+
+constexpr FileSizeInt SWARM_PIECE_SIZE = 4 * FILE_CHECKPOINT_CHUNK_SIZE;
+constexpr size_t SWARM_PEER_PIPELINE_DEPTH = 2;
+constexpr uint32_t SWARM_MAX_PEER_FAILURES = 3;
+constexpr uint32_t SWARM_SLOW_PEER_FACTOR = 3;
+
+struct SwarmAssignment {
+    size_t      peer;
+    size_t      piece;
+    FileSizeInt offset;
+    FileSizeInt size;
+};
+
+class SwarmScheduler final {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    SwarmScheduler(const std::vector<std::pair<FileSizeInt, FileSizeInt>>& missingRanges, FileSizeInt pieceSize = SWARM_PIECE_SIZE);
+
+    size_t AddPeer();
+    void RemovePeer(size_t peer);
+
+    NO_DISCARD std::vector<SwarmAssignment> Assign(Clock::time_point now);
+    void Complete(size_t peer, size_t piece, bool verified, Clock::time_point now);
+
+    NO_DISCARD bool IsFinished() const;
+    NO_DISCARD bool IsStalled() const;
+    NO_DISCARD bool IsPeerActive(size_t peer) const;
+    NO_DISCARD uint64_t GetPeerBandwidth(size_t peer) const;
+    NO_DISCARD FileSizeInt GetPeerReceivedSize(size_t peer) const;
+    NO_DISCARD FileSizeInt GetReceivedSize() const;
+    NO_DISCARD size_t GetOutstandingCount() const;
+    NO_DISCARD size_t GetPieceCount() const;
+
+private:
+    enum class PieceState : uint8_t {
+        MISSING,
+        REQUESTED,
+        RECEIVED
+    };
+
+    struct Owner {
+        size_t            peer;
+        Clock::time_point requested;
+    };
+
+    struct Piece {
+        FileSizeInt        offset;
+        FileSizeInt        size;
+        PieceState         state{PieceState::MISSING};
+        std::vector<Owner> owners;
+    };
+
+    struct Peer {
+        bool            active{true};
+        size_t          outstanding{0};
+        uint32_t        failures{0};
+        FileSizeInt     received{0};
+        Clock::duration busyTime{0};
+    };
+
+    NO_DISCARD size_t FindMissingPiece();
+    NO_DISCARD size_t FindSlowPiece(size_t peer, Clock::time_point now) const;
+    void ReleasePiece(Piece& piece, size_t peer);
+
+    static constexpr size_t NO_PIECE = static_cast<size_t>(-1);
+
+    std::vector<Piece> m_pieces;
+    std::vector<Peer>  m_peers;
+    size_t             m_cursor{0};
+    size_t             m_remaining{0};
+    FileSizeInt        m_received{0};
+};
+
+#endif //P2P_SWARM_SCHEDULER_H
@@ -1,11 +1,21 @@
 #ifndef P2P_TLS_CONNECTION_H
 #define P2P_TLS_CONNECTION_H
 
+#include <AddressResolver.h>
 #include <AwaitableFlag.h>
 #include <ConnectionParent.h>
+#include <ContextProvider.h>
+#include <DatagramChannel.h>
+#include <HappyEyeballs.h>
+#include <SessionCache.h>
+#include <SharedMemoryChannel.h>
+#include <FileTransfer.h>
+#include <FileTransferScheduler.h>
 #include <Settings.h>
+#include <StreamMultiplexer.h>
 #include <concurrentqueue.h>
 #include <deque>
+#include <unordered_map>
 #include <utility>
 
 template <PackageType T>
@@ -14,29 +24,13 @@ public:
     TLSConnection() = delete;
     TLSConnection(IOContext& sharedContext, std::shared_ptr<SSLContext> sharedSSLContext, moodycamel::ConcurrentQueue<std::unique_ptr<PackageIn<T>>>& sharedMessageQueue)
         : m_context(sharedContext), m_sslContext(std::move(sharedSSLContext)), m_socket(m_context, *m_sslContext), m_fileStreamSocket(m_context, *m_sslContext), m_resolver(m_context),
+          m_datagramChannel(std::make_shared<DatagramChannel>(m_context)),
           m_sendMessageAwaitableFlag(m_context.get_executor()), m_sendFileAwaitableFlag(m_context.get_executor()), m_receiveFileAwaitableFlag(m_context.get_executor()),
-          m_inQueue(sharedMessageQueue), m_ports({0, 0})
+          m_fileRateTimer(m_context), m_messageRateTimer(m_context), m_inQueue(sharedMessageQueue), m_ports({0, 0})
     { }
 
     NO_DISCARD static std::shared_ptr<SSLContext> CreateSSLContext(const std::filesystem::path& path, const bool isServer) {
-        ZoneScoped;
-        auto ctx = std::make_shared<SSLContext>(isServer ? SSLContext::tlsv13_server : SSLContext::tlsv13_client);
-        const std::string keyPath = (path / "privateKey.key").string();
-        const std::string certPath = (path / "certificate.crt").string();
-
-        ctx->set_options(
-            SSLContext::default_workarounds |
-            SSLContext::no_sslv2 |
-            SSLContext::no_sslv3 |
-            SSLContext::no_tlsv1 |
-            SSLContext::no_tlsv1_1
-        );
-
-        ctx->use_certificate_chain_file(certPath);
-        ctx->use_private_key_file(keyPath, SSLContext::pem);
-        ctx->set_verify_mode(asio::ssl::verify_none);
-
-        return ctx;
+        return TLS::ContextProvider::CreateContext(path, isServer);
     }
 
     NO_DISCARD static std::shared_ptr<TLSConnection<T>> Create(IOContext& sharedContext, std::shared_ptr<SSLContext> sharedSSLContext, moodycamel::ConcurrentQueue<std::unique_ptr<PackageIn<T>>>& sharedMessageQueue) {
@@ -44,13 +38,23 @@ public:
     }
 
     void Start(const IPAddress address, const std::array<uint16_t, 2> ports, const std::function<void()> callback) override {
+        Start(std::vector{address}, ports, callback);
+    }
+
+    void Start(std::vector<IPAddress> addresses, const std::array<uint16_t, 2> ports, const std::function<void()> callback) override {
         ZoneScoped;
         if (GetConnectionState() != ConnectionState::DISCONNECTED) {
             Debug::LogError("Connection already started");
             return;
         }
 
-        m_address = address;
+        if (addresses.empty()) {
+            Debug::LogError("No address to connect to");
+            return;
+        }
+
+        m_address = addresses.front();
+        m_candidates = std::move(addresses);
         m_ports = ports;
 
         std::shared_ptr<TLSConnection<T>> connection = this->shared_from_this();
@@ -58,13 +62,23 @@ public:
     }
 
     void Seek(const IPAddress address, const std::array<uint16_t, 2> ports, const std::function<void()> connectionSeekCallback, const std::function<void()> callback) override {
+        Seek(std::vector{address}, ports, connectionSeekCallback, callback);
+    }
+
+    void Seek(std::vector<IPAddress> addresses, const std::array<uint16_t, 2> ports, const std::function<void()> connectionSeekCallback, const std::function<void()> callback) override {
         ZoneScoped;
         if (GetConnectionState() != ConnectionState::DISCONNECTED) {
             Debug::LogError("Connection already started");
             return;
         }
 
-        m_address = address;
+        if (addresses.empty()) {
+            Debug::LogError("No address to listen on");
+            return;
+        }
+
+        m_address = addresses.front();
+        m_candidates = std::move(addresses);
         m_ports = ports;
 
         std::shared_ptr<TLSConnection<T>> connection = this->shared_from_this();
@@ -78,19 +92,79 @@ public:
 
     void Send(std::unique_ptr<Package<T>>&& package) override {
         ZoneScoped;
+        if (m_datagramChannel->IsUnreliable(package->GetHeader().type) && m_datagramChannel->Send(package->GetHeader(), package->GetRawBody())) {
+            return;
+        }
+
         static thread_local moodycamel::ProducerToken token(m_outQueue);
 
         m_outQueue.enqueue(token, std::move(package));
         m_sendMessageAwaitableFlag.Signal();
     }
 
-    void RequestFile(const std::string& requestedFilePath, const std::string& fileName) override {
+    size_t SendBlob(const T type, std::shared_ptr<const std::vector<char>> data) override {
+        ZoneScoped;
+        const size_t blobID = m_blobCurrentID.fetch_add(1);
+        const char* bytes = data->data();
+        const auto size = static_cast<FileSizeInt>(data->size());
+
+        m_outBlobQueue.enqueue(std::make_unique<OutgoingBlob>(blobID, static_cast<PackageTypeInt>(type), 0, bytes, size, std::move(data)));
+        m_sendMessageAwaitableFlag.Signal();
+        return blobID;
+    }
+
+    void SetBlobHandler(const T type, BlobHandler handler) override {
+        m_blobAssembler.SetHandler(type, std::move(handler));
+    }
+
+    void SetUnreliable(const T type, const bool unreliable) override {
+        m_datagramChannel->SetUnreliable(static_cast<PackageTypeInt>(type), unreliable);
+    }
+
+    void RequestFile(const std::string& requestedFilePath, const std::string& fileName, const uint8_t weight) override {
         ZoneScoped;
 
+        const std::filesystem::path filePath = P2PSettings::GetFileDownloadDirectory() / fileName;
+        const std::shared_ptr<FileTransferCheckpoint> checkpoint = FileTransferCheckpoint::Acquire(filePath);
+        const bool resuming = checkpoint->IsStarted() && !checkpoint->IsComplete();
+
+        if (!resuming && P2PSettings::IsDeltaSyncEnabled() && std::filesystem::exists(filePath) && std::filesystem::file_size(filePath) >= DELTA_MIN_FILE_SIZE) {
+            std::shared_ptr<TLSConnection<T>> connection = this->shared_from_this();
+            asio::co_spawn(m_context, CoRequestDelta(connection, requestedFilePath, fileName, weight), asio::detached);
+            return;
+        }
+
+        RequestFileContent(requestedFilePath, fileName, weight, resuming ? checkpoint : nullptr);
+    }
+
+    void RequestFileRange(const std::string& requestedFilePath, const std::string& fileName, const FileSizeInt offset, const FileSizeInt size, const uint8_t weight, std::function<void(bool)> callback) override {
+        ZoneScoped;
         size_t requestID = m_fileCurrentID.fetch_add(1);
         m_fileNameMap.InsertOrAssign(requestID, std::string(fileName));
 
-        std::unique_ptr<Package<T>> package = Package<T>::CreateUnique(static_cast<T>(0), std::move(requestID), std::string(requestedFilePath));
+        if (callback) {
+            {
+                std::lock_guard lock(m_fileCallbackMutex);
+                m_fileCallbacks.insert_or_assign(requestID, std::move(callback));
+            }
+
+            if (GetConnectionState() != ConnectionState::CONNECTED) {
+                CompleteFileRequest(requestID, false);
+                return;
+            }
+        }
+
+        std::unique_ptr<Package<T>> package = Package<T>::CreateUnique(static_cast<T>(0), std::move(requestID), static_cast<uint8_t>(FileRequestKind::RANGE), std::string(requestedFilePath), uint8_t{weight}, FileSizeInt{offset}, FileSizeInt{size});
+        package->GetHeader().flags = static_cast<uint8_t>(PackageFlag::FILE_REQUEST);
+        Send(std::move(package));
+    }
+
+    void RequestDirectory(const std::string& requestedDirectoryPath, const std::string& directoryName, const uint8_t weight) override {
+        ZoneScoped;
+        size_t requestID = m_fileCurrentID.fetch_add(1);
+        m_fileNameMap.InsertOrAssign(requestID, std::string(directoryName));
+
+        std::unique_ptr<Package<T>> package = Package<T>::CreateUnique(static_cast<T>(0), std::move(requestID), static_cast<uint8_t>(FileRequestKind::TREE), std::string(requestedDirectoryPath), uint8_t{weight});
         package->GetHeader().flags = static_cast<uint8_t>(PackageFlag::FILE_REQUEST);
         Send(std::move(package));
     }
@@ -115,26 +189,200 @@ public:
         return m_ports;
     }
 
+    NO_DISCARD FileTransferTuning GetFileSendTuning() const override {
+        return m_sendTuner.GetTuning();
+    }
+
+    NO_DISCARD FileTransferTuning GetFileReceiveTuning() const override {
+        return m_receiveTuner.GetTuning();
+    }
+
+    void SetSendRate(const TrafficClass trafficClass, const uint64_t bytesPerSecond, const uint64_t burstSize) override {
+        m_bandwidthLimiter.SetRate(trafficClass, bytesPerSecond, burstSize);
+    }
+
+    NO_DISCARD uint64_t GetSendRate(const TrafficClass trafficClass) const override {
+        return m_bandwidthLimiter.GetRate(trafficClass);
+    }
+
+    NO_DISCARD CompressionAlgorithm GetCompressionAlgorithm() const override {
+        return m_compressionAlgorithm.load(std::memory_order_acquire);
+    }
+
+    NO_DISCARD bool IsDatagramChannelOpen() const override {
+        return m_datagramChannel->IsConnected();
+    }
+
+    NO_DISCARD TransportMode GetTransportMode() const {
+        return m_transportMode;
+    }
+
+    NO_DISCARD bool IsSessionResumed() {
+        return TLS::SessionCache::IsResumed(m_socket.native_handle());
+    }
+
 private:
+    // Signing the existing copy reads all of it, so it runs on the blocking-work pool and the request goes out once it is done
+    static asio::awaitable<void> CoRequestDelta(std::shared_ptr<TLSConnection<T>> connection, const std::string requestedFilePath, const std::string fileName, const uint8_t weight) {
+        const std::filesystem::path filePath = P2PSettings::GetFileDownloadDirectory() / fileName;
+        DeltaSignature signature;
+
+        if (!co_await CoRunBlockingWork([&] { return DeltaSync::ComputeSignature(filePath, signature); })) {
+            connection->RequestFileContent(requestedFilePath, fileName, weight, nullptr);
+            co_return;
+        }
+
+        size_t requestID = connection->m_fileCurrentID.fetch_add(1);
+        connection->m_fileNameMap.InsertOrAssign(requestID, std::string(fileName));
+
+        std::unique_ptr<Package<T>> package = Package<T>::CreateUnique(static_cast<T>(0), std::move(requestID), static_cast<uint8_t>(FileRequestKind::DELTA), std::string(requestedFilePath), uint8_t{weight},
+            PackageSizeInt{signature.blockSize}, std::move(signature.weakChecksums), std::move(signature.strongChecksums));
+        package->GetHeader().flags = static_cast<uint8_t>(PackageFlag::FILE_REQUEST);
+        connection->Send(std::move(package));
+    }
+
+    // The sender offers the chunk hashes of the requested file and the receiver answers with those its store lacks, so
+    // neither side reveals the rest of its store; chunking and store lookups run on the blocking-work pool
+    static asio::awaitable<void> CoExchangeChunkManifest(std::shared_ptr<TLSConnection<T>> connection, std::unique_ptr<Package<T>> package) {
+        size_t      requestID;
+        std::string path;
+        uint8_t     weight;
+
+        package->GetValue(requestID);
+        package->GetValue(path);
+        package->GetValue(weight);
+
+        if ((package->GetHeader().flags & PackageFlag::FILE_REQUEST) != 0) {
+            std::vector<uint8_t> manifest = co_await CoRunBlockingWork([&] { return ChunkStore::ComputeManifest(path); });
+
+            if (connection->m_chunkManifests.Size() < CHUNK_STORE_MAX_PENDING_MANIFESTS) {
+                connection->m_chunkManifests.InsertOrAssign(requestID, manifest);
+            } else {
+                Debug::LogError("Too many pending chunk manifests, sending the file without references");
+            }
+
+            std::unique_ptr<Package<T>> reply = Package<T>::CreateUnique(static_cast<T>(0), std::move(requestID), std::move(path), uint8_t{weight}, std::move(manifest));
+            reply->GetHeader().flags = PackageFlag::CHUNK_MANIFEST | PackageFlag::FILE_RECEIVE_INFO;
+            connection->Send(std::move(reply));
+            co_return;
+        }
+
+        std::vector<uint8_t> manifest;
+        package->GetValue(manifest);
+
+        if (!connection->m_fileNameMap.Contains(requestID)) {
+            Debug::LogError("File ID do not exist");
+            co_return;
+        }
+
+        std::vector<uint8_t> missing = co_await CoRunBlockingWork([&] { return ChunkStore::FindMissing(manifest); });
+
+        std::unique_ptr<Package<T>> request = Package<T>::CreateUnique(static_cast<T>(0), std::move(requestID), static_cast<uint8_t>(FileRequestKind::CHUNKED), std::move(path), uint8_t{weight},
+            std::move(missing));
+        request->GetHeader().flags = static_cast<uint8_t>(PackageFlag::FILE_REQUEST);
+        connection->Send(std::move(request));
+    }
+
+    void RequestFileContent(const std::string& requestedFilePath, const std::string& fileName, const uint8_t weight, const std::shared_ptr<FileTransferCheckpoint>& resumedCheckpoint) {
+        ZoneScoped;
+        const bool resuming = resumedCheckpoint != nullptr;
+
+        if (!resuming && P2PSettings::IsChunkStoreEnabled()) {
+            size_t requestID = m_fileCurrentID.fetch_add(1);
+            m_fileNameMap.InsertOrAssign(requestID, std::string(fileName));
+
+            std::unique_ptr<Package<T>> package = Package<T>::CreateUnique(static_cast<T>(0), std::move(requestID), std::string(requestedFilePath), uint8_t{weight});
+            package->GetHeader().flags = PackageFlag::CHUNK_MANIFEST | PackageFlag::FILE_REQUEST;
+            Send(std::move(package));
+            return;
+        }
+
+        std::vector<std::pair<FileSizeInt, FileSizeInt>> ranges = {{0, 0}};
+
+        if (resuming) {
+            ranges = resumedCheckpoint->GetMissingRanges();
+        }
+
+        for (const auto& [offset, size] : ranges) {
+            RequestFileRange(requestedFilePath, fileName, offset, size, weight, nullptr);
+        }
+    }
+
+    struct PendingStream {
+        explicit PendingStream(const asio::any_io_executor& executor) : ready(executor) { }
+
+        AwaitableFlag      ready;
+        std::exception_ptr error;
+        std::atomic<bool>  aborted{false};
+    };
+
+    static asio::awaitable<void> CoConnectStream([[maybe_unused]] std::shared_ptr<TLSConnection<T>> connection, SSLSocket& socket, std::vector<TCPEndpoint> endpoints, std::shared_ptr<PendingStream> pending) {
+        co_await HappyEyeballs::CoConnect(socket.next_layer(), std::move(endpoints));
+
+        if (pending != nullptr && pending->aborted.load()) {
+            throw asio::system_error(asio::error::operation_aborted);
+        }
+
+        TLS::SessionCache::Attach(socket.native_handle(), socket.next_layer().remote_endpoint().address());
+        co_await socket.async_handshake(SSLStreamBase::client, asio::use_awaitable);
+    }
+
     static asio::awaitable<void> CoStart(std::shared_ptr<TLSConnection<T>> connection, const std::function<void()> callback) {
         try {
             connection->SetConnectionState(ConnectionState::CONNECTING);
 
-            std::initializer_list<TCPEndpoint> connectionEndpoints = {TCPEndpoint(connection->m_address, connection->m_ports[0])};
-            std::initializer_list<TCPEndpoint> fileStreamEndpoints = {TCPEndpoint(connection->m_address, connection->m_ports[1])};
+            const bool sharedMemory = P2PSettings::IsSharedMemoryEnabled() && SharedMemoryChannel::IsSupported() && std::ranges::any_of(connection->m_candidates, AddressResolver::IsAddressLocal);
+            TransportMode mode = P2PSettings::IsStreamMultiplexingEnabled() || sharedMemory ? TransportMode::MULTIPLEXED : TransportMode::DUAL_SOCKET;
+            const auto fileStream = std::make_shared<PendingStream>(connection->m_context.get_executor());
+
+            if (mode == TransportMode::DUAL_SOCKET) {
+                asio::co_spawn(connection->m_context, CoConnectStream(connection, connection->m_fileStreamSocket, HappyEyeballs::OrderCandidates(connection->m_candidates, connection->m_ports[1]), fileStream),
+                    [fileStream](const std::exception_ptr& error) {
+                        fileStream->error = error;
+                        fileStream->ready.Signal();
+                    });
+            } else {
+                fileStream->ready.Signal();
+            }
 
-            co_await asio::async_connect(connection->m_socket.lowest_layer(), connectionEndpoints, asio::use_awaitable);
-            co_await connection->m_socket.async_handshake(SSLStreamBase::client, asio::use_awaitable);
-            co_await asio::async_connect(connection->m_fileStreamSocket.lowest_layer(), fileStreamEndpoints, asio::use_awaitable);
-            co_await connection->m_fileStreamSocket.async_handshake(SSLStreamBase::client, asio::use_awaitable);
+            try {
+                co_await CoConnectStream(connection, connection->m_socket, HappyEyeballs::OrderCandidates(connection->m_candidates, connection->m_ports[0]), nullptr);
 
-            Debug::Log("Accepted TLS connection to {}:{}, {}:{}",
-                  connection->m_socket.lowest_layer().remote_endpoint().address().to_string(),
-                  connection->m_socket.lowest_layer().remote_endpoint().port(),
-                  connection->m_fileStreamSocket.lowest_layer().remote_endpoint().address().to_string(),
-                  connection->m_fileStreamSocket.lowest_layer().remote_endpoint().port());
+                if (!TLS::ContextProvider::IsTransportNegotiated(connection->m_socket.native_handle())) {
+                    // The peer predates the transport mode byte and always expects a second socket for files
+                    if (mode != TransportMode::DUAL_SOCKET) {
+                        co_await CoConnectStream(connection, connection->m_fileStreamSocket, HappyEyeballs::OrderCandidates(connection->m_candidates, connection->m_ports[1]), nullptr);
+                    }
 
+                    mode = TransportMode::DUAL_SOCKET;
+                } else {
+                    if (sharedMemory && AddressResolver::IsAddressLocal(connection->m_socket.next_layer().remote_endpoint().address())) {
+                        mode = TransportMode::SHARED_MEMORY;
+                    }
+
+                    co_await asio::async_write(connection->m_socket, asio::buffer(&mode, sizeof(mode)), asio::use_awaitable);
+                }
+            } catch (...) {
+                asio::error_code errorCode;
+                fileStream->aborted.store(true);
+                connection->m_fileStreamSocket.lowest_layer().close(errorCode);
+                throw;
+            }
+
+            co_await fileStream->ready.Wait();
+            if (fileStream->error) {
+                std::rethrow_exception(fileStream->error);
+            }
+
+            if (mode == TransportMode::SHARED_MEMORY) {
+                mode = co_await CoOpenSharedMemory(connection);
+            }
+
+            connection->m_address = connection->m_socket.next_layer().remote_endpoint().address();
+            connection->StartTransport(mode);
             connection->SetConnectionState(ConnectionState::CONNECTED);
+            connection->SendCompressionHello();
+            connection->OpenDatagramChannel(false);
 
             asio::co_spawn(connection->m_context, CoReceiveMessage(connection), asio::detached);
             asio::co_spawn(connection->m_context, CoReceiveFile(connection), asio::detached);
@@ -153,29 +401,39 @@ private:
         try {
             connection->SetConnectionState(ConnectionState::CONNECTING);
 
-            std::initializer_list<TCPEndpoint> connectionEndpoints = {TCPEndpoint(connection->m_address, connection->m_ports[0])};
-            std::initializer_list<TCPEndpoint> fileStreamEndpoints = {TCPEndpoint(connection->m_address, connection->m_ports[1])};
+            std::vector<TCPAcceptor> connectionAcceptors = HappyEyeballs::OpenAcceptors(connection->m_context, connection->m_candidates, connection->m_ports[0]);
+            std::vector<TCPAcceptor> fileStreamAcceptors = HappyEyeballs::OpenAcceptors(connection->m_context, connection->m_candidates, connection->m_ports[1]);
 
-            TCPAcceptor connectionAcceptor(connection->m_context, *connectionEndpoints.begin());
-            TCPAcceptor fileStreamAcceptor(connection->m_context, *fileStreamEndpoints.begin());
-
-            connection->m_address = connectionAcceptor.local_endpoint().address();
-            connection->m_ports   = {connectionAcceptor.local_endpoint().port(), fileStreamAcceptor.local_endpoint().port()};
+            connection->m_address = connectionAcceptors.front().local_endpoint().address();
+            connection->m_ports   = {connectionAcceptors.front().local_endpoint().port(), fileStreamAcceptors.front().local_endpoint().port()};
 
             connectionSeekCallback();
 
-            co_await connectionAcceptor.async_accept(connection->m_socket.lowest_layer(), asio::use_awaitable);
+            co_await HappyEyeballs::CoAccept(connectionAcceptors, connection->m_socket.next_layer());
             co_await connection->m_socket.async_handshake(SSLStreamBase::server, asio::use_awaitable);
-            co_await fileStreamAcceptor.async_accept(connection->m_fileStreamSocket.lowest_layer(), asio::use_awaitable);
-            co_await connection->m_fileStreamSocket.async_handshake(SSLStreamBase::server, asio::use_awaitable);
 
-            Debug::Log("Accepted TLS connection to {}:{}, {}:{}",
-                  connection->m_socket.lowest_layer().remote_endpoint().address().to_string(),
-                  connection->m_socket.lowest_layer().remote_endpoint().port(),
-                  connection->m_fileStreamSocket.lowest_layer().remote_endpoint().address().to_string(),
-                  connection->m_fileStreamSocket.lowest_layer().remote_endpoint().port());
+            TransportMode mode = TransportMode::DUAL_SOCKET;
+            if (TLS::ContextProvider::IsTransportNegotiated(connection->m_socket.native_handle())) {
+                co_await asio::async_read(connection->m_socket, asio::buffer(&mode, sizeof(mode)), asio::use_awaitable);
+            }
+
+            if (mode == TransportMode::SHARED_MEMORY) {
+                mode = co_await CoAcceptSharedMemory(connection);
+            }
+
+            if (mode == TransportMode::DUAL_SOCKET) {
+                co_await HappyEyeballs::CoAccept(fileStreamAcceptors, connection->m_fileStreamSocket.next_layer());
+                co_await connection->m_fileStreamSocket.async_handshake(SSLStreamBase::server, asio::use_awaitable);
+            } else if (mode != TransportMode::MULTIPLEXED && mode != TransportMode::SHARED_MEMORY) {
+                Debug::LogError("Unknown transport mode");
+                connection->Disconnect();
+                co_return;
+            }
 
+            connection->StartTransport(mode);
             connection->SetConnectionState(ConnectionState::CONNECTED);
+            connection->SendCompressionHello();
+            connection->OpenDatagramChannel(true);
 
             asio::co_spawn(connection->m_context, CoReceiveMessage(connection), asio::detached);
             asio::co_spawn(connection->m_context, CoReceiveFile(connection), asio::detached);
@@ -190,6 +448,60 @@ private:
         }
     }
 
+    static asio::awaitable<TransportMode> CoAcceptSharedMemory(std::shared_ptr<TLSConnection<T>> connection) {
+        auto channel = std::make_shared<SharedMemoryChannel>(connection->m_context.get_executor(), SharedMemorySide::SERVER);
+        std::array<char, SHARED_MEMORY_NAME_SIZE> name{};
+
+        // An empty name declines the offer and the client stays on the multiplexed socket
+        if (P2PSettings::IsSharedMemoryEnabled() && SharedMemoryChannel::IsSupported() && channel->Create()) {
+            channel->GetName().copy(name.data(), SHARED_MEMORY_NAME_SIZE - 1);
+        }
+
+        co_await asio::async_write(connection->m_socket, asio::buffer(name), asio::use_awaitable);
+
+        uint8_t accepted = 0;
+        co_await asio::async_read(connection->m_socket, asio::buffer(&accepted, sizeof(accepted)), asio::use_awaitable);
+        channel->Unlink();
+
+        if (accepted == 0 || name[0] == '\0') {
+            co_return TransportMode::MULTIPLEXED;
+        }
+
+        connection->m_sharedMemory = std::move(channel);
+        co_return TransportMode::SHARED_MEMORY;
+    }
+
+    static asio::awaitable<void> CoWatchSocket(std::shared_ptr<TLSConnection<T>> connection) {
+        // Shared memory cannot tell when the peer dies, but the kernel closes its TLS socket, which carries nothing else in this mode
+        std::array<char, 64> buffer{};
+        asio::error_code errorCode;
+
+        while (!errorCode) {
+            co_await connection->m_socket.async_read_some(asio::buffer(buffer), asio::redirect_error(asio::use_awaitable, errorCode));
+        }
+
+        connection->m_sharedMemory->Close();
+        connection->Disconnect();
+    }
+
+    static asio::awaitable<TransportMode> CoOpenSharedMemory(std::shared_ptr<TLSConnection<T>> connection) {
+        std::array<char, SHARED_MEMORY_NAME_SIZE> name{};
+        co_await asio::async_read(connection->m_socket, asio::buffer(name), asio::use_awaitable);
+        name.back() = '\0';
+
+        auto channel = std::make_shared<SharedMemoryChannel>(connection->m_context.get_executor(), SharedMemorySide::CLIENT);
+        const uint8_t accepted = name[0] != '\0' && channel->Open(name.data()) ? 1 : 0;
+
+        co_await asio::async_write(connection->m_socket, asio::buffer(&accepted, sizeof(accepted)), asio::use_awaitable);
+
+        if (accepted == 0) {
+            co_return TransportMode::MULTIPLEXED;
+        }
+
+        connection->m_sharedMemory = std::move(channel);
+        co_return TransportMode::SHARED_MEMORY;
+    }
+
     static asio::awaitable<void> CoCloseSocket(SSLSocket& socket) {
         if (!socket.lowest_layer().is_open()) {
             co_return;
@@ -236,6 +548,16 @@ private:
 
         connection->SetConnectionState(ConnectionState::DISCONNECTING);
 
+        if (connection->m_multiplexer != nullptr) {
+            connection->m_multiplexer->Close(asio::error::operation_aborted);
+        }
+
+        if (connection->m_sharedMemory != nullptr) {
+            connection->m_sharedMemory->Close();
+        }
+
+        connection->m_datagramChannel->Close();
+
         co_await connection->CoCloseSocket(connection->m_socket);
         co_await connection->CoCloseSocket(connection->m_fileStreamSocket);
 
@@ -244,6 +566,9 @@ private:
         connection->m_sendMessageAwaitableFlag.Signal();
         connection->m_sendFileAwaitableFlag.Signal();
 
+        connection->m_fileRateTimer.cancel();
+        connection->m_messageRateTimer.cancel();
+
         connection->m_context.stop();
     }
 
@@ -259,6 +584,16 @@ private:
 
         connection->SetConnectionState(ConnectionState::DISCONNECTING);
 
+        if (connection->m_multiplexer != nullptr) {
+            connection->m_multiplexer->Close(asio::error::operation_aborted);
+        }
+
+        if (connection->m_sharedMemory != nullptr) {
+            connection->m_sharedMemory->Close();
+        }
+
+        connection->m_datagramChannel->Close();
+
         co_await connection->CoCloseSocket(connection->m_socket);
         co_await connection->CoCloseSocket(connection->m_fileStreamSocket);
 
@@ -266,6 +601,9 @@ private:
         connection->m_receiveFileAwaitableFlag.Signal();
         connection->m_sendMessageAwaitableFlag.Signal();
         connection->m_sendFileAwaitableFlag.Signal();
+
+        connection->m_fileRateTimer.cancel();
+        connection->m_messageRateTimer.cancel();
     }
 
     static asio::awaitable<void> CoReceiveMessage(std::shared_ptr<TLSConnection<T>> connection) {
@@ -275,14 +613,70 @@ private:
 
             while (connection->GetConnectionState() == ConnectionState::CONNECTED) {
                 asio::mutable_buffer headerBuffer(&header, sizeof(PackageHeader));
-                co_await asio::async_read(connection->m_socket, headerBuffer, asio::use_awaitable);
+                co_await CoReadStream(connection, MultiplexedStream::MESSAGE, headerBuffer);
 
                 header.FromBigEndianToNative();
 
+                if (header.size > MAX_NON_FILE_PACKAGE_SIZE) {
+                    Debug::LogError("Package too large");
+                    connection->Disconnect();
+                    co_return;
+                }
+
                 std::unique_ptr<Package<T>> package = std::make_unique<Package<T>>(header);
                 asio::mutable_buffer packageBuffer(package->GetRawBody(), header.size);
 
-                co_await asio::async_read(connection->m_socket, packageBuffer, asio::use_awaitable);
+                co_await CoReadStream(connection, MultiplexedStream::MESSAGE, packageBuffer);
+
+                if ((header.flags & PackageFlag::COMPRESSED) != 0) {
+                    package = co_await CoRunCompressionWork(header.size, [&package] { return package->Decompress(); });
+
+                    if (package == nullptr) {
+                        Debug::LogError("Could not decompress package");
+                        connection->Disconnect();
+                        co_return;
+                    }
+
+                    header = package->GetHeader();
+                }
+
+                if ((header.flags & PackageFlag::COMPRESSION_HELLO) != 0) {
+                    uint8_t peerSupportedAlgorithms;
+                    package->GetValue(peerSupportedAlgorithms);
+
+                    connection->m_compressionAlgorithm.store(Compression::Negotiate(P2PSettings::GetCompressionAlgorithm(), peerSupportedAlgorithms), std::memory_order_release);
+                    continue;
+                }
+
+                if ((header.flags & PackageFlag::DATAGRAM_HELLO) != 0) {
+                    uint16_t port;
+                    package->GetValue(port);
+
+                    connection->m_datagramChannel->Connect(UDPEndpoint(connection->m_socket.lowest_layer().remote_endpoint().address(), port));
+                    continue;
+                }
+
+                if ((header.flags & PackageFlag::BLOB_FRAGMENT) != 0) {
+                    std::unique_ptr<Package<T>> completed;
+
+                    if (!connection->m_blobAssembler.Receive(*package, completed)) {
+                        connection->m_blobAssembler.Abort();
+                        connection->Disconnect();
+                        co_return;
+                    }
+
+                    if (completed == nullptr) {
+                        continue;
+                    }
+
+                    package = std::move(completed);
+                    header = package->GetHeader();
+                }
+
+                if ((header.flags & PackageFlag::CHUNK_MANIFEST) != 0) {
+                    asio::co_spawn(connection->m_context, CoExchangeChunkManifest(connection, std::move(package)), asio::detached);
+                    continue;
+                }
 
                 if ((header.flags & PackageFlag::FILE_RECEIVE_INFO) != 0) {
                     connection->m_fileInfoQueue.push_back(std::move(package));
@@ -309,6 +703,7 @@ private:
                 Debug::LogError(errorCode.message());
             }
 
+            connection->m_blobAssembler.Abort();
             connection->Disconnect();
             co_return;
         }
@@ -318,48 +713,98 @@ private:
         try {
             if (connection->GetConnectionState() != ConnectionState::CONNECTED) co_return;
 
+            std::unordered_map<size_t, std::unique_ptr<FileTransferSink>> transfers;
             std::vector<char> dataBuffer(FILE_BUFFER_SIZE);
-            co_await connection->m_receiveFileAwaitableFlag.Wait();
+            std::vector<char> decompressedBuffer;
+            FileChunkHeader   header{};
 
             while (connection->GetConnectionState() == ConnectionState::CONNECTED) {
-                if (!connection->m_fileInfoQueue.empty()) {
+                co_await CoReadStream(connection, MultiplexedStream::FILE, asio::buffer(&header, sizeof(FileChunkHeader)));
+                header.FromBigEndianToNative();
+
+                auto transfer = transfers.find(header.requestID);
+
+                while (transfer == transfers.end() && connection->GetConnectionState() == ConnectionState::CONNECTED) {
+                    if (connection->m_fileInfoQueue.empty()) {
+                        connection->m_receiveFileAwaitableFlag.Reset();
+                        co_await connection->m_receiveFileAwaitableFlag.Wait();
+                        continue;
+                    }
+
                     std::unique_ptr<Package<T>> package = std::move(connection->m_fileInfoQueue.front());
                     connection->m_fileInfoQueue.pop_front();
 
                     size_t requestID;
-                    PackageSizeInt size;
+                    std::unique_ptr<FileTransferSink> sink = CreateFileSink(connection, *package, requestID);
 
-                    package->GetValue(requestID);
-                    package->GetValue(size);
-
-                    if (!connection->m_fileNameMap.Contains(requestID)) {
-                        Debug::LogError("File ID do not exist");
+                    if (sink == nullptr) {
                         connection->Disconnect();
                         co_return;
                     }
 
-                    std::string filename = connection->m_fileNameMap.Get(requestID).value();
-                    std::ofstream fileStream(P2PSettings::GetFileDownloadDirectory() / filename, std::ios::binary | std::ios::trunc);
+                    transfers.insert_or_assign(requestID, std::move(sink));
+                    transfer = transfers.find(header.requestID);
+                }
+
+                if (transfer == transfers.end()) {
+                    co_return;
+                }
+
+                if (header.size > FILE_CHUNK_MAX_SIZE) {
+                    Debug::LogError("File chunk too large");
+                    connection->Disconnect();
+                    co_return;
+                }
+
+                const bool isEnd = (header.flags & static_cast<uint8_t>(FileChunkFlag::END)) != 0;
+                const bool isCompressed = (header.flags & static_cast<uint8_t>(FileChunkFlag::COMPRESSED)) != 0;
+
+                if (!isEnd && !isCompressed) {
+                    co_await transfer->second->CoWaitWritable(header.size);
+                }
 
-                    if (!fileStream.is_open()) {
-                        Debug::LogError("Could not open file");
+                const auto readStart = std::chrono::steady_clock::now();
+
+                if (char* destination = isEnd || isCompressed ? nullptr : transfer->second->Reserve(header.size)) {
+                    co_await CoReadStream(connection, MultiplexedStream::FILE, asio::buffer(destination, header.size));
+                    RecordFileRead(connection, header.size, readStart);
+
+                    if (!transfer->second->Commit(header.size)) {
                         connection->Disconnect();
                         co_return;
                     }
 
-                    while (size > 0) {
-                        const PackageSizeInt readSize = std::min(size, FILE_BUFFER_SIZE);
-                        size -= readSize;
+                    continue;
+                }
+
+                if (dataBuffer.size() < header.size) {
+                    dataBuffer.resize(header.size);
+                }
+
+                co_await CoReadStream(connection, MultiplexedStream::FILE, asio::buffer(dataBuffer.data(), header.size));
+                RecordFileRead(connection, header.size, readStart);
 
-                        asio::mutable_buffer buffer(dataBuffer.data(), readSize);
-                        co_await asio::async_read(connection->m_fileStreamSocket, buffer, asio::use_awaitable);
-                        fileStream.write(dataBuffer.data(), readSize);
+                bool processed;
+                if (isEnd) {
+                    HashDigest digest{};
+                    processed = header.size == digest.size();
+
+                    if (processed) {
+                        std::copy_n(dataBuffer.data(), digest.size(), digest.begin());
+                        processed = co_await transfer->second->CoFinish(digest);
                     }
 
-                    fileStream.close();
+                    connection->CompleteFileRequest(header.requestID, processed && transfer->second->IsVerified());
+                    transfers.erase(transfer);
+                } else if (isCompressed) {
+                    processed = co_await transfer->second->CoWriteCompressed(dataBuffer, header.size, decompressedBuffer);
                 } else {
-                    connection->m_receiveFileAwaitableFlag.Reset();
-                    co_await connection->m_receiveFileAwaitableFlag.Wait();
+                    processed = co_await transfer->second->CoWrite(dataBuffer, header.size);
+                }
+
+                if (!processed) {
+                    connection->Disconnect();
+                    co_return;
                 }
             }
         } catch (const asio::error_code& errorCode) {
@@ -374,28 +819,166 @@ private:
         }
     }
 
+    static asio::awaitable<void> CoReadStream(const std::shared_ptr<TLSConnection<T>>& connection, const MultiplexedStream stream, const asio::mutable_buffer buffer) {
+        if (connection->m_sharedMemory != nullptr) {
+            co_await asio::async_read(connection->m_sharedMemory->GetStream(stream), buffer, asio::use_awaitable);
+            co_return;
+        }
+
+        if (connection->m_multiplexer != nullptr) {
+            co_await connection->m_multiplexer->Read(stream, buffer);
+            co_return;
+        }
+
+        SSLSocket& socket = stream == MultiplexedStream::MESSAGE ? connection->m_socket : connection->m_fileStreamSocket;
+        co_await asio::async_read(socket, buffer, asio::use_awaitable);
+    }
+
+    template <typename ConstBufferSequence>
+    static asio::awaitable<void> CoWriteStream(const std::shared_ptr<TLSConnection<T>>& connection, const MultiplexedStream stream, const ConstBufferSequence& buffers) {
+        if (connection->m_sharedMemory != nullptr) {
+            co_await asio::async_write(connection->m_sharedMemory->GetStream(stream), buffers, asio::use_awaitable);
+            co_return;
+        }
+
+        if (connection->m_multiplexer != nullptr) {
+            co_await connection->m_multiplexer->Write(stream, buffers);
+            co_return;
+        }
+
+        SSLSocket& socket = stream == MultiplexedStream::MESSAGE ? connection->m_socket : connection->m_fileStreamSocket;
+        co_await asio::async_write(socket, buffers, asio::use_awaitable);
+    }
+
+    static void RecordFileRead(const std::shared_ptr<TLSConnection<T>>& connection, const size_t size, const std::chrono::steady_clock::time_point readStart) {
+        connection->m_receiveTuner.RecordTransfer(size, std::chrono::steady_clock::now() - readStart);
+
+        if (connection->m_receiveTuner.IsUpdateDue()) {
+            connection->m_receiveTuner.Tune(connection->GetFileStreamSocket().lowest_layer());
+        }
+    }
+
+    static std::unique_ptr<FileTransferSink> CreateFileSink(std::shared_ptr<TLSConnection<T>> connection, Package<T>& package, size_t& requestID) {
+        ZoneScoped;
+        uint8_t kind;
+        uint8_t digestAlgorithm;
+
+        package.GetValue(requestID);
+        package.GetValue(kind);
+        package.GetValue(digestAlgorithm);
+
+        if (!connection->m_fileNameMap.Contains(requestID)) {
+            Debug::LogError("File ID do not exist");
+            return nullptr;
+        }
+
+        if (digestAlgorithm != static_cast<uint8_t>(FileDigestAlgorithm::SHA256)) {
+            Debug::LogError("Unsupported file digest algorithm");
+            return nullptr;
+        }
+
+        const std::filesystem::path filePath = P2PSettings::GetFileDownloadDirectory() / connection->m_fileNameMap.Get(requestID).value();
+        connection->m_fileNameMap.Erase(requestID);
+
+        std::unique_ptr<FileTransferSink> sink;
+
+        if (kind == static_cast<uint8_t>(FileRequestKind::DELTA)) {
+            PackageSizeInt blockSize;
+            FileSizeInt    totalSize;
+
+            package.GetValue(blockSize);
+            package.GetValue(totalSize);
+
+            sink = std::make_unique<DeltaFileSink>(filePath, blockSize, totalSize);
+        } else if (kind == static_cast<uint8_t>(FileRequestKind::CHUNKED)) {
+            FileSizeInt totalSize;
+            package.GetValue(totalSize);
+
+            sink = std::make_unique<ChunkedFileSink>(filePath, totalSize);
+        } else if (kind == static_cast<uint8_t>(FileRequestKind::TREE)) {
+            PackageSizeInt manifestSize;
+            FileSizeInt    contentSize;
+
+            package.GetValue(manifestSize);
+            package.GetValue(contentSize);
+
+            sink = std::make_unique<TreeFileSink>(filePath, manifestSize, contentSize);
+        } else {
+            FileSizeInt offset;
+            FileSizeInt size;
+            FileSizeInt totalSize;
+
+            uint8_t                  sparse;
+            std::vector<FileSizeInt> extents;
+
+            package.GetValue(offset);
+            package.GetValue(size);
+            package.GetValue(totalSize);
+            package.GetValue(sparse);
+            package.GetValue(extents);
+
+            auto rangeSink = std::make_unique<RangeFileSink>(filePath, offset, size, totalSize);
+
+            if (sparse != 0) {
+                if (extents.size() % 2 != 0) {
+                    Debug::LogError("Invalid sparse extent list");
+                    return nullptr;
+                }
+
+                std::vector<FileExtent> dataExtents;
+                dataExtents.reserve(extents.size() / 2);
+
+                for (size_t i = 0; i < extents.size(); i += 2) {
+                    dataExtents.push_back({extents[i], extents[i + 1]});
+                }
+
+                rangeSink->SetDataExtents(std::move(dataExtents));
+            }
+
+            sink = std::move(rangeSink);
+        }
+
+        if (!sink->Open()) {
+            return nullptr;
+        }
+
+        return sink;
+    }
+
     static asio::awaitable<void> CoSendMessage(std::shared_ptr<TLSConnection<T>> connection) {
         try {
             moodycamel::ConsumerToken outQueueToken(connection->m_outQueue);
+            std::deque<std::unique_ptr<OutgoingBlob>> blobs;
 
             if (connection->GetConnectionState() != ConnectionState::CONNECTED) co_return;
             co_await connection->m_sendMessageAwaitableFlag.Wait();
 
             while (connection->GetConnectionState() == ConnectionState::CONNECTED) {
-                if (std::unique_ptr<Package<T>> package; connection->m_outQueue.try_dequeue(outQueueToken, package)) {
-                    PackageHeader header = package->GetHeader();
+                std::unique_ptr<Package<T>> package;
 
-                    std::vector<asio::const_buffer> buffers = {
-                        asio::const_buffer(&header, sizeof(header)),
-                        asio::const_buffer(package->GetRawBody(), header.size)
-                    };
+                if (connection->m_outQueue.try_dequeue(outQueueToken, package)) {
+                    if (package->GetHeader().size > MAX_NON_FILE_PACKAGE_SIZE) {
+                        blobs.push_back(OutgoingBlob::FromPackage(connection->m_blobCurrentID.fetch_add(1), std::move(package)));
+                        continue;
+                    }
+                } else if (std::unique_ptr<OutgoingBlob> blob; connection->m_outBlobQueue.try_dequeue(blob)) {
+                    blobs.push_back(std::move(blob));
+                    continue;
+                } else if (!blobs.empty()) {
+                    std::unique_ptr<OutgoingBlob> blob = std::move(blobs.front());
+                    blobs.pop_front();
+                    package = blob->NextFragment<T>();
 
-                    header.FromNativeToBigEndian();
-                    co_await asio::async_write(connection->m_socket, buffers, asio::use_awaitable);
+                    if (!blob->IsFinished()) {
+                        blobs.push_back(std::move(blob));
+                    }
                 } else {
                     connection->m_sendMessageAwaitableFlag.Reset();
                     co_await connection->m_sendMessageAwaitableFlag.Wait();
+                    continue;
                 }
+
+                co_await CoWritePackage(connection, std::move(package));
             }
         } catch (const std::system_error& error) {
             if (connection->GetConnectionState() == ConnectionState::CONNECTED) {
@@ -407,60 +990,121 @@ private:
         }
     }
 
+    static asio::awaitable<void> CoWritePackage(std::shared_ptr<TLSConnection<T>> connection, std::unique_ptr<Package<T>> package) {
+        const CompressionAlgorithm algorithm = connection->m_compressionAlgorithm.load(std::memory_order_acquire);
+
+        if (algorithm != CompressionAlgorithm::NONE && package->GetHeader().size >= COMPRESSION_MIN_SIZE) {
+            if (std::unique_ptr<Package<T>> compressed = co_await CoRunCompressionWork(package->GetHeader().size, [&package, algorithm] { return package->Compress(algorithm); })) {
+                package = std::move(compressed);
+            }
+        }
+
+        PackageHeader header = package->GetHeader();
+
+        std::vector<asio::const_buffer> buffers = {
+            asio::const_buffer(&header, sizeof(header)),
+            asio::const_buffer(package->GetRawBody(), header.size)
+        };
+
+        header.FromNativeToBigEndian();
+
+        co_await CoThrottle(connection, connection->m_messageRateTimer, TrafficClass::MESSAGE, sizeof(header) + package->GetHeader().size);
+        co_await CoWriteStream(connection, MultiplexedStream::MESSAGE, buffers);
+    }
+
+    static asio::awaitable<void> CoThrottle(std::shared_ptr<TLSConnection<T>> connection, asio::steady_timer& timer, const TrafficClass trafficClass, const size_t size) {
+        const TokenBucket::Clock::duration delay = connection->m_bandwidthLimiter.Acquire(trafficClass, size);
+        if (delay <= TokenBucket::Clock::duration::zero()) {
+            co_return;
+        }
+
+        timer.expires_after(delay);
+        co_await timer.async_wait(asio::use_awaitable);
+    }
+
     static asio::awaitable<void> CoSendFile(std::shared_ptr<TLSConnection<T>> connection) {
         try {
             if (connection->GetConnectionState() != ConnectionState::CONNECTED) co_return;
-            std::vector<char> fileBuffer(FILE_BUFFER_SIZE);
+
+            FileTransferScheduler scheduler(P2PSettings::GetFileSchedulingPolicy());
+            std::vector<char>     compressedChunk;
 
             co_await connection->m_sendFileAwaitableFlag.Wait();
 
             while (connection->GetConnectionState() == ConnectionState::CONNECTED) {
-                if (!connection->m_fileRequestQueue.empty()) {
+                while (!connection->m_fileRequestQueue.empty()) {
                     std::unique_ptr<Package<T>> package = std::move(connection->m_fileRequestQueue.front());
                     connection->m_fileRequestQueue.pop_front();
 
-                    size_t      requestID;
-                    std::string path;
-
-                    package->GetValue(requestID);
-                    package->GetValue(path);
+                    std::unique_ptr<FileTransferSource> source = CreateFileSource(connection, *package);
 
-                    std::filesystem::path filePath(path);
-
-                    if (!std::filesystem::exists(filePath)) {
-                        Debug::LogError("File path doesnt exist");
+                    if (source == nullptr) {
                         connection->Disconnect();
                         co_return;
                     }
 
-                    std::ifstream fileStream(filePath, std::ios::binary | std::ios::in);
-                    if (!fileStream.is_open()) {
-                        Debug::LogError("Could not open file");
+                    scheduler.Add(std::move(source));
+                }
+
+                if (scheduler.IsEmpty()) {
+                    connection->m_sendFileAwaitableFlag.Reset();
+                    co_await connection->m_sendFileAwaitableFlag.Wait();
+                    continue;
+                }
+
+                scheduler.SetPolicy(P2PSettings::GetFileSchedulingPolicy());
+                FileTransferSource* source = scheduler.Next();
+
+                if (!source->IsFinished()) {
+                    source->SetChunkSize(connection->m_sendTuner.GetChunkSize());
+                    co_await source->CoWaitReadable();
+
+                    if (!source->Read()) {
                         connection->Disconnect();
                         co_return;
                     }
 
-                    PackageSizeInt size = std::filesystem::file_size(filePath);
-                    {
-                        std::unique_ptr<Package<T>> fileInfo = Package<T>::CreateUnique(static_cast<T>(0), size_t{requestID}, PackageSizeInt{size});
-                        fileInfo->GetHeader().flags = static_cast<uint8_t>(PackageFlag::FILE_RECEIVE_INFO);
-                        connection->Send(std::move(fileInfo));
-                    }
+                    const std::vector<char>& chunk = source->GetChunk();
+                    const CompressionAlgorithm algorithm = connection->m_compressionAlgorithm.load(std::memory_order_acquire);
+                    const bool isCompressed = algorithm != CompressionAlgorithm::NONE && co_await CoRunCompressionWork(chunk.size(), [&] {
+                        return Compression::Compress(algorithm, chunk.data(), chunk.size(), compressedChunk);
+                    });
+
+                    const std::vector<char>& payload = isCompressed ? compressedChunk : chunk;
+                    FileChunkHeader header{source->GetRequestID(), static_cast<uint32_t>(payload.size()), static_cast<uint8_t>(isCompressed ? FileChunkFlag::COMPRESSED : FileChunkFlag::NONE)};
+                    header.FromNativeToBigEndian();
+
+                    const std::array<asio::const_buffer, 2> buffers = {
+                        asio::buffer(&header, sizeof(FileChunkHeader)),
+                        asio::buffer(payload)
+                    };
 
-                    while (size > 0) {
-                        const PackageSizeInt readSize = std::min(size, FILE_BUFFER_SIZE);
-                        size -= readSize;
+                    co_await CoThrottle(connection, connection->m_fileRateTimer, TrafficClass::FILE, sizeof(FileChunkHeader) + payload.size());
 
-                        fileStream.read(fileBuffer.data(), readSize);
+                    const auto writeStart = std::chrono::steady_clock::now();
+                    co_await CoWriteStream(connection, MultiplexedStream::FILE, buffers);
+                    connection->m_sendTuner.RecordTransfer(payload.size(), std::chrono::steady_clock::now() - writeStart);
 
-                        asio::const_buffer buffer(fileBuffer.data(), readSize);
-                        co_await asio::async_write(connection->m_fileStreamSocket, buffer, asio::use_awaitable);
+                    if (connection->m_sendTuner.IsUpdateDue()) {
+                        connection->m_sendTuner.Tune(connection->GetFileStreamSocket().lowest_layer());
                     }
 
-                    fileStream.close();
-                } else {
-                    connection->m_sendFileAwaitableFlag.Reset();
-                    co_await connection->m_sendFileAwaitableFlag.Wait();
+                    scheduler.Charge(source, static_cast<PackageSizeInt>(payload.size()));
+                    source->Release();
+                }
+
+                if (source->IsFinished()) {
+                    const HashDigest digest = co_await source->CoFinish();
+                    FileChunkHeader header{source->GetRequestID(), static_cast<uint32_t>(digest.size()), static_cast<uint8_t>(FileChunkFlag::END)};
+                    header.FromNativeToBigEndian();
+
+                    const std::array<asio::const_buffer, 2> buffers = {
+                        asio::buffer(&header, sizeof(FileChunkHeader)),
+                        asio::buffer(digest)
+                    };
+
+                    scheduler.Remove(source);
+                    co_await CoWriteStream(connection, MultiplexedStream::FILE, buffers);
                 }
             }
         } catch (const std::system_error& error) {
@@ -473,9 +1117,221 @@ private:
         }
     }
 
+    static std::unique_ptr<FileTransferSource> CreateFileSource(std::shared_ptr<TLSConnection<T>> connection, Package<T>& package) {
+        ZoneScoped;
+        size_t      requestID;
+        uint8_t     kind;
+        std::string path;
+        uint8_t     weight;
+
+        package.GetValue(requestID);
+        package.GetValue(kind);
+        package.GetValue(path);
+        package.GetValue(weight);
+
+        std::filesystem::path filePath(path);
+
+        if (!std::filesystem::exists(filePath)) {
+            Debug::LogError("File path doesnt exist");
+            return nullptr;
+        }
+
+        std::unique_ptr<Package<T>> fileInfo;
+
+        if (kind == static_cast<uint8_t>(FileRequestKind::DELTA)) {
+            DeltaSignature signature;
+
+            package.GetValue(signature.blockSize);
+            package.GetValue(signature.weakChecksums);
+            package.GetValue(signature.strongChecksums);
+
+            auto source = std::make_unique<DeltaFileSource>(requestID, weight, std::move(filePath), std::move(signature));
+            if (!source->Open()) {
+                return nullptr;
+            }
+
+            fileInfo = Package<T>::CreateUnique(static_cast<T>(0), size_t{requestID}, static_cast<uint8_t>(FileRequestKind::DELTA), static_cast<uint8_t>(FileDigestAlgorithm::SHA256),
+                PackageSizeInt{source->GetBlockSize()}, FileSizeInt{source->GetTotalSize()});
+            fileInfo->GetHeader().flags = static_cast<uint8_t>(PackageFlag::FILE_RECEIVE_INFO);
+            connection->Send(std::move(fileInfo));
+
+            return source;
+        }
+
+        if (kind == static_cast<uint8_t>(FileRequestKind::CHUNKED)) {
+            std::vector<uint8_t> missingChunks;
+            package.GetValue(missingChunks);
+
+            // Only chunks this side offered and the receiver did not ask for may be sent as references
+            const std::vector<uint8_t> manifest = connection->m_chunkManifests.Get(requestID).value_or(std::vector<uint8_t>{});
+            connection->m_chunkManifests.Erase(requestID);
+
+            auto source = std::make_unique<ChunkedFileSource>(requestID, weight, std::move(filePath), ChunkStore::Subtract(manifest, missingChunks));
+            if (!source->Open()) {
+                return nullptr;
+            }
+
+            fileInfo = Package<T>::CreateUnique(static_cast<T>(0), size_t{requestID}, static_cast<uint8_t>(FileRequestKind::CHUNKED), static_cast<uint8_t>(FileDigestAlgorithm::SHA256),
+                FileSizeInt{source->GetTotalSize()});
+            fileInfo->GetHeader().flags = static_cast<uint8_t>(PackageFlag::FILE_RECEIVE_INFO);
+            connection->Send(std::move(fileInfo));
+
+            return source;
+        }
+
+        if (kind == static_cast<uint8_t>(FileRequestKind::TREE)) {
+            if (!std::filesystem::is_directory(filePath)) {
+                Debug::LogError("Requested path is not a directory");
+                return nullptr;
+            }
+
+            auto source = std::make_unique<TreeFileSource>(requestID, weight, std::move(filePath));
+            if (!source->Open()) {
+                return nullptr;
+            }
+
+            fileInfo = Package<T>::CreateUnique(static_cast<T>(0), size_t{requestID}, static_cast<uint8_t>(FileRequestKind::TREE), static_cast<uint8_t>(FileDigestAlgorithm::SHA256),
+                PackageSizeInt{source->GetManifestSize()}, FileSizeInt{source->GetContentSize()});
+            fileInfo->GetHeader().flags = static_cast<uint8_t>(PackageFlag::FILE_RECEIVE_INFO);
+            connection->Send(std::move(fileInfo));
+
+            return source;
+        }
+
+        FileSizeInt offset;
+        FileSizeInt size;
+
+        package.GetValue(offset);
+        package.GetValue(size);
+
+        auto source = std::make_unique<RangeFileSource>(requestID, weight, std::move(filePath), offset, size);
+        if (!source->Open()) {
+            return nullptr;
+        }
+
+        std::vector<FileSizeInt> extents;
+        if (source->IsSparse()) {
+            for (const FileExtent& extent : source->GetDataExtents()) {
+                extents.push_back(extent.offset);
+                extents.push_back(extent.size);
+            }
+        }
+
+        fileInfo = Package<T>::CreateUnique(static_cast<T>(0), size_t{requestID}, static_cast<uint8_t>(FileRequestKind::RANGE), static_cast<uint8_t>(FileDigestAlgorithm::SHA256),
+            FileSizeInt{source->GetOffset()}, FileSizeInt{source->GetSize()}, FileSizeInt{source->GetTotalSize()}, uint8_t{source->IsSparse()}, std::move(extents));
+        fileInfo->GetHeader().flags = static_cast<uint8_t>(PackageFlag::FILE_RECEIVE_INFO);
+        connection->Send(std::move(fileInfo));
+
+        return source;
+    }
+
+    void StartTransport(const TransportMode mode) {
+        ZoneScoped;
+        m_transportMode = mode;
+
+        if (mode == TransportMode::MULTIPLEXED) {
+            m_multiplexer = std::make_shared<StreamMultiplexer<SSLSocket>>(m_socket, m_context.get_executor());
+            m_multiplexer->Start(this->shared_from_this());
+        } else if (mode == TransportMode::SHARED_MEMORY) {
+            m_sharedMemory->Start();
+            asio::co_spawn(m_context, CoWatchSocket(this->shared_from_this()), asio::detached);
+        }
+
+        const TCPEndpoint endpoint = m_socket.lowest_layer().remote_endpoint();
+        const char* transport = mode == TransportMode::SHARED_MEMORY ? "shared memory" : mode == TransportMode::MULTIPLEXED ? "multiplexed" : "dual socket";
+        Debug::Log("Accepted TLS connection to {}:{} ({}, {})", endpoint.address().to_string(), endpoint.port(), transport,
+            TLS::SessionCache::IsResumed(m_socket.native_handle()) ? "resumed" : "full handshake");
+    }
+
+    SSLSocket& GetFileStreamSocket() {
+        return m_multiplexer != nullptr || m_sharedMemory != nullptr ? m_socket : m_fileStreamSocket;
+    }
+
+    void SendCompressionHello() {
+        std::unique_ptr<Package<T>> hello = Package<T>::CreateUnique(static_cast<T>(0), uint8_t{Compression::GetSupportedAlgorithms()});
+        hello->GetHeader().flags = static_cast<uint8_t>(PackageFlag::COMPRESSION_HELLO);
+        Send(std::move(hello));
+    }
+
+    void OpenDatagramChannel(const bool isServer) {
+        ZoneScoped;
+        if (!P2PSettings::IsDatagramChannelEnabled()) {
+            return;
+        }
+
+        DatagramKey sendKey;
+        DatagramKey receiveKey;
+
+        if (!DatagramChannel::ExportKeys(m_socket.native_handle(), isServer, sendKey, receiveKey)) {
+            Debug::LogError("Could not derive datagram keys");
+            return;
+        }
+
+        const uint16_t port = m_datagramChannel->Open(m_socket.lowest_layer().local_endpoint().address());
+        if (port == 0) {
+            return;
+        }
+
+        m_datagramChannel->SetKeys(sendKey, receiveKey);
+
+        std::weak_ptr<TLSConnection<T>> weakConnection = this->weak_from_this();
+        m_datagramChannel->Start([weakConnection](const PackageHeader& header, const char* body) {
+            if (const std::shared_ptr<TLSConnection<T>> connection = weakConnection.lock()) {
+                connection->ReceiveDatagram(header, body);
+            }
+        });
+
+        std::unique_ptr<Package<T>> hello = Package<T>::CreateUnique(static_cast<T>(0), uint16_t{port});
+        hello->GetHeader().flags = static_cast<uint8_t>(PackageFlag::DATAGRAM_HELLO);
+        Send(std::move(hello));
+    }
+
+    void ReceiveDatagram(const PackageHeader& header, const char* body) {
+        std::unique_ptr<PackageIn<T>> packageIn = std::make_unique<PackageIn<T>>();
+        packageIn->package = std::make_unique<Package<T>>(header);
+        packageIn->connection = this->shared_from_this();
+
+        std::memcpy(packageIn->package->GetRawBody(), body, header.size);
+        m_inQueue.enqueue(std::move(packageIn));
+    }
+
     void SetConnectionState(const ConnectionState state) {
         ZoneScoped;
         m_connectionState.store(state, std::memory_order_release);
+
+        if (state == ConnectionState::DISCONNECTED) {
+            FailFileRequests();
+        }
+    }
+
+    void CompleteFileRequest(const size_t requestID, const bool succeeded) {
+        std::function<void(bool)> callback;
+
+        {
+            std::lock_guard lock(m_fileCallbackMutex);
+            const auto entry = m_fileCallbacks.find(requestID);
+            if (entry == m_fileCallbacks.end()) {
+                return;
+            }
+
+            callback = std::move(entry->second);
+            m_fileCallbacks.erase(entry);
+        }
+
+        callback(succeeded);
+    }
+
+    void FailFileRequests() {
+        std::unordered_map<size_t, std::function<void(bool)>> callbacks;
+
+        {
+            std::lock_guard lock(m_fileCallbackMutex);
+            callbacks.swap(m_fileCallbacks);
+        }
+
+        for (auto& [requestID, callback] : callbacks) {
+            callback(false);
+        }
     }
 
     IOContext&                  m_context;
@@ -484,13 +1340,24 @@ private:
     SSLSocket                   m_fileStreamSocket;
     TCPResolver                 m_resolver;
 
+    std::shared_ptr<DatagramChannel> m_datagramChannel;
+
+    std::shared_ptr<StreamMultiplexer<SSLSocket>> m_multiplexer;
+    std::shared_ptr<SharedMemoryChannel>          m_sharedMemory;
+    TransportMode                                 m_transportMode{TransportMode::DUAL_SOCKET};
+
     AwaitableFlag m_sendMessageAwaitableFlag;
     AwaitableFlag m_sendFileAwaitableFlag;
     AwaitableFlag m_receiveFileAwaitableFlag;
 
+    BandwidthLimiter   m_bandwidthLimiter;
+    asio::steady_timer m_fileRateTimer;
+    asio::steady_timer m_messageRateTimer;
+
     std::atomic<ConnectionState> m_connectionState;
 
     moodycamel::ConcurrentQueue<std::unique_ptr<Package<T>>>    m_outQueue;
+    moodycamel::ConcurrentQueue<std::unique_ptr<OutgoingBlob>>  m_outBlobQueue;
     moodycamel::ConcurrentQueue<std::unique_ptr<PackageIn<T>>>& m_inQueue;
 
     std::deque<std::unique_ptr<Package<T>>> m_fileRequestQueue;
@@ -500,7 +1367,21 @@ private:
     ConcurrentUnorderedMap<size_t, std::string> m_fileNameMap;
     std::atomic<size_t>                         m_fileCurrentID{0};
 
+    ConcurrentUnorderedMap<size_t, std::vector<uint8_t>> m_chunkManifests;
+
+    std::unordered_map<size_t, std::function<void(bool)>> m_fileCallbacks;
+    std::mutex                                            m_fileCallbackMutex;
+
+    std::atomic<CompressionAlgorithm> m_compressionAlgorithm{CompressionAlgorithm::NONE};
+
+    BlobAssembler<T>    m_blobAssembler;
+    std::atomic<size_t> m_blobCurrentID{0};
+
+    FileTransferTuner m_sendTuner{FileTransferDirection::SEND};
+    FileTransferTuner m_receiveTuner{FileTransferDirection::RECEIVE};
+
     IPAddress               m_address;
+    std::vector<IPAddress>  m_candidates;
     std::array<uint16_t, 2> m_ports;
 };
 
@@ -0,0 +1,894 @@
+#ifndef P2P_UNIX_CONNECTION_H
+#define P2P_UNIX_CONNECTION_H
+
+#include <AwaitableFlag.h>
+#include <BlockingWork.h>
+#include <ConnectionParent.h>
+#include <FileDescriptor.h>
+#include <Settings.h>
+#include <concurrentqueue.h>
+#include <ConcurrentUnorderedMap.h>
+#include <FileTransfer.h>
+#include <HappyEyeballs.h>
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <deque>
+#include <limits>
+#include <random>
+#include <unordered_map>
+
+#if FILE_DESCRIPTOR_PASSING_SUPPORTED
+#include <cstdlib>
+#include <sys/stat.h>
+#include <unistd.h>
+
+constexpr size_t UNIX_SOCKET_BIND_ATTEMPTS = 64;
+
+template <PackageType T>
+class UnixConnection final : public ConnectionParent<T>, public std::enable_shared_from_this<UnixConnection<T>> {
+public:
+    UnixConnection() = delete;
+    UnixConnection(IOContext& sharedContext, moodycamel::ConcurrentQueue<std::unique_ptr<PackageIn<T>>>& sharedMessageQueue) :
+        m_context(sharedContext), m_socket(sharedContext), m_fileStreamSocket(sharedContext),
+        m_sendMessageAwaitableFlag(sharedContext.get_executor()), m_sendFileAwaitableFlag(sharedContext.get_executor()), m_messageRateTimer(sharedContext),
+        m_connectionState(ConnectionState::DISCONNECTED), m_inQueue(sharedMessageQueue), m_ports({0, 0}) { }
+
+    NO_DISCARD static std::shared_ptr<UnixConnection<T>> Create(IOContext& sharedContext, moodycamel::ConcurrentQueue<std::unique_ptr<PackageIn<T>>>& sharedMessageQueue) {
+        return std::make_shared<UnixConnection<T>>(sharedContext, sharedMessageQueue);
+    }
+
+    NO_DISCARD static std::filesystem::path GetSocketDirectory() {
+        if (const char* runtimeDirectory = std::getenv("XDG_RUNTIME_DIR"); runtimeDirectory != nullptr && runtimeDirectory[0] != '\0') {
+            return std::filesystem::path(runtimeDirectory) / "pablo-connect";
+        }
+
+        return std::filesystem::temp_directory_path() / ("pablo-connect-" + std::to_string(::getuid()));
+    }
+
+    // A shared temp directory lets other users pre-create or redirect the socket directory, so only a private one is trusted
+    NO_DISCARD static bool IsSocketDirectoryTrusted(const std::filesystem::path& directory) {
+        struct stat status{};
+        if (::lstat(directory.c_str(), &status) != 0) {
+            return false;
+        }
+
+        return S_ISDIR(status.st_mode) && status.st_uid == ::getuid() && (status.st_mode & 07777) == 0700;
+    }
+
+    NO_DISCARD static std::filesystem::path GetSocketPath(const uint16_t id) {
+        return GetSocketDirectory() / (std::to_string(id) + ".sock");
+    }
+
+    void Start(const IPAddress address, const std::array<uint16_t, 2> ports, const std::function<void()> callback) override {
+        Start(std::vector{address}, ports, callback);
+    }
+
+    void Start(std::vector<IPAddress> addresses, const std::array<uint16_t, 2> ports, const std::function<void()> callback) override {
+        ZoneScoped;
+        if (GetConnectionState() != ConnectionState::DISCONNECTED) {
+            Debug::LogError("Connection already started");
+            return;
+        }
+
+        m_address = addresses.empty() ? IPAddress(asio::ip::address_v4::loopback()) : addresses.front();
+        m_ports = ports;
+
+        std::shared_ptr<UnixConnection<T>> connection = this->shared_from_this();
+        asio::co_spawn(m_context, CoStart(connection, callback), asio::detached);
+    }
+
+    void Seek(std::vector<IPAddress> addresses, const std::array<uint16_t, 2> ports, const std::function<void()> connectionSeekCallback, const std::function<void()> callback) override {
+        Seek(addresses.empty() ? IPAddress(asio::ip::address_v4::loopback()) : addresses.front(), ports, connectionSeekCallback, callback);
+    }
+
+    void Seek(const IPAddress address, const std::array<uint16_t, 2> ports, const std::function<void()> connectionSeekCallback, const std::function<void()> callback) override {
+        ZoneScoped;
+        if (GetConnectionState() != ConnectionState::DISCONNECTED) {
+            Debug::LogError("Connection already started");
+            return;
+        }
+
+        m_address = address;
+        m_ports = ports;
+
+        std::shared_ptr<UnixConnection<T>> connection = this->shared_from_this();
+        asio::co_spawn(m_context, CoSeek(connection, connectionSeekCallback, callback), asio::detached);
+    }
+
+    NO_DISCARD ConnectionState GetConnectionState() const override {
+        ZoneScoped;
+        return m_connectionState.load(std::memory_order_acquire);
+    }
+
+    void Send(std::unique_ptr<Package<T>>&& package) override {
+        ZoneScoped;
+        static thread_local moodycamel::ProducerToken token(m_outQueue);
+
+        m_outQueue.enqueue(token, std::move(package));
+        m_sendMessageAwaitableFlag.Signal();
+    }
+
+    size_t SendBlob(const T type, std::shared_ptr<const std::vector<char>> data) override {
+        ZoneScoped;
+        const size_t blobID = m_blobCurrentID.fetch_add(1);
+        const char* bytes = data->data();
+        const auto size = static_cast<FileSizeInt>(data->size());
+
+        m_outBlobQueue.enqueue(std::make_unique<OutgoingBlob>(blobID, static_cast<PackageTypeInt>(type), 0, bytes, size, std::move(data)));
+        m_sendMessageAwaitableFlag.Signal();
+        return blobID;
+    }
+
+    void SetBlobHandler(const T type, BlobHandler handler) override {
+        m_blobAssembler.SetHandler(type, std::move(handler));
+    }
+
+    void SetUnreliable(const T, const bool) override { }
+
+    void RequestFile(const std::string& requestedFilePath, const std::string& fileName, const uint8_t weight) override {
+        RequestFileRange(requestedFilePath, fileName, 0, 0, weight, nullptr);
+    }
+
+    void RequestFileRange(const std::string& requestedFilePath, const std::string& fileName, const FileSizeInt offset, const FileSizeInt size, const uint8_t weight, std::function<void(bool)> callback) override {
+        ZoneScoped;
+        size_t requestID = m_fileCurrentID.fetch_add(1);
+        m_fileNameMap.InsertOrAssign(requestID, std::string(fileName));
+
+        if (callback) {
+            {
+                std::lock_guard lock(m_fileCallbackMutex);
+                m_fileCallbacks.insert_or_assign(requestID, std::move(callback));
+            }
+
+            if (GetConnectionState() != ConnectionState::CONNECTED) {
+                CompleteFileRequest(requestID, false);
+                return;
+            }
+        }
+
+        std::unique_ptr<Package<T>> package = Package<T>::CreateUnique(static_cast<T>(0), std::move(requestID), static_cast<uint8_t>(FileRequestKind::RANGE), std::string(requestedFilePath), uint8_t{weight}, FileSizeInt{offset}, FileSizeInt{size});
+        package->GetHeader().flags = static_cast<uint8_t>(PackageFlag::FILE_REQUEST);
+        Send(std::move(package));
+    }
+
+    void RequestDirectory(const std::string& requestedDirectoryPath, const std::string& directoryName, const uint8_t weight) override {
+        ZoneScoped;
+        size_t requestID = m_fileCurrentID.fetch_add(1);
+        m_fileNameMap.InsertOrAssign(requestID, std::string(directoryName));
+
+        std::unique_ptr<Package<T>> package = Package<T>::CreateUnique(static_cast<T>(0), std::move(requestID), static_cast<uint8_t>(FileRequestKind::TREE), std::string(requestedDirectoryPath), uint8_t{weight});
+        package->GetHeader().flags = static_cast<uint8_t>(PackageFlag::FILE_REQUEST);
+        Send(std::move(package));
+    }
+
+    void Disconnect() override {
+        ZoneScoped;
+        RemoveSocketFiles();
+
+        if (!m_socket.is_open() && !m_fileStreamSocket.is_open()) {
+            SetConnectionState(ConnectionState::DISCONNECTED);
+            m_context.stop();
+            return;
+        }
+
+        CloseSocket(m_socket);
+        CloseSocket(m_fileStreamSocket);
+
+        SetConnectionState(ConnectionState::DISCONNECTED);
+
+        m_sendMessageAwaitableFlag.Signal();
+        m_sendFileAwaitableFlag.Signal();
+
+        m_messageRateTimer.cancel();
+    }
+
+    void DestroyContext() override {
+        ZoneScoped;
+        RemoveSocketFiles();
+
+        if (!m_socket.is_open() && !m_fileStreamSocket.is_open()) {
+            SetConnectionState(ConnectionState::DISCONNECTED);
+            m_context.stop();
+            return;
+        }
+
+        CloseSocket(m_socket);
+        CloseSocket(m_fileStreamSocket);
+
+        SetConnectionState(ConnectionState::DISCONNECTED);
+
+        m_sendMessageAwaitableFlag.Signal();
+        m_sendFileAwaitableFlag.Signal();
+
+        m_messageRateTimer.cancel();
+
+        m_context.stop();
+    }
+
+    NO_DISCARD IPAddress GetAddress() const override {
+        return m_address;
+    }
+
+    NO_DISCARD std::array<uint16_t, 2> GetPorts() const override {
+        return m_ports;
+    }
+
+    NO_DISCARD FileTransferTuning GetFileSendTuning() const override {
+        return {};
+    }
+
+    NO_DISCARD FileTransferTuning GetFileReceiveTuning() const override {
+        return {};
+    }
+
+    void SetSendRate(const TrafficClass trafficClass, const uint64_t bytesPerSecond, const uint64_t burstSize) override {
+        m_bandwidthLimiter.SetRate(trafficClass, bytesPerSecond, burstSize);
+    }
+
+    NO_DISCARD uint64_t GetSendRate(const TrafficClass trafficClass) const override {
+        return m_bandwidthLimiter.GetRate(trafficClass);
+    }
+
+    NO_DISCARD CompressionAlgorithm GetCompressionAlgorithm() const override {
+        return CompressionAlgorithm::NONE;
+    }
+
+    NO_DISCARD bool IsDatagramChannelOpen() const override {
+        return false;
+    }
+
+private:
+    static void CloseSocket(UnixSocket& socket) {
+        if (!socket.is_open()) {
+            return;
+        }
+
+        asio::error_code ec;
+        socket.close(ec);
+        if (ec && ec != asio::error::bad_descriptor && ec != asio::error::not_socket && ec != asio::error::connection_reset && ec != asio::error::not_connected) {
+            Debug::LogError("Close error: " + ec.message());
+        }
+    }
+
+    static bool IsStale(IOContext& context, const std::filesystem::path& path) {
+        if (!std::filesystem::exists(path)) {
+            return false;
+        }
+
+        UnixSocket probe(context);
+        asio::error_code errorCode;
+        probe.connect(UnixEndpoint(path.string()), errorCode);
+
+        return errorCode == asio::error::connection_refused;
+    }
+
+    static UnixAcceptor OpenAcceptor(IOContext& context, uint16_t& id) {
+        ZoneScoped;
+        const std::filesystem::path directory = GetSocketDirectory();
+
+        if (::mkdir(directory.c_str(), 0700) == 0) {
+            ::chmod(directory.c_str(), 0700);
+        } else if (errno != EEXIST) {
+            throw asio::system_error(asio::error_code(errno, asio::error::get_system_category()));
+        }
+
+        if (!IsSocketDirectoryTrusted(directory)) {
+            Debug::LogError("Socket directory {} is not a private directory owned by this user", directory.string());
+            throw asio::system_error(asio::error::access_denied);
+        }
+
+        static thread_local std::mt19937 generator{std::random_device{}()};
+        std::uniform_int_distribution<uint32_t> distribution(1, std::numeric_limits<uint16_t>::max());
+
+        for (size_t attempt = 0; attempt < UNIX_SOCKET_BIND_ATTEMPTS; attempt++) {
+            const auto candidate = id != 0 ? id : static_cast<uint16_t>(distribution(generator));
+            const std::filesystem::path path = GetSocketPath(candidate);
+
+            if (IsStale(context, path)) {
+                std::error_code removeError;
+                std::filesystem::remove(path, removeError);
+            }
+
+            UnixAcceptor acceptor(context);
+            asio::error_code errorCode;
+
+            acceptor.open(UnixEndpoint().protocol());
+            acceptor.bind(UnixEndpoint(path.string()), errorCode);
+
+            if (errorCode == asio::error::address_in_use && id == 0) {
+                continue;
+            }
+
+            if (errorCode) {
+                throw asio::system_error(errorCode);
+            }
+
+            acceptor.listen(asio::socket_base::max_listen_connections);
+            id = candidate;
+            return acceptor;
+        }
+
+        throw asio::system_error(asio::error::address_in_use);
+    }
+
+    void RemoveSocketFiles() {
+        for (const std::filesystem::path& path : std::exchange(m_socketPaths, {})) {
+            std::error_code errorCode;
+            std::filesystem::remove(path, errorCode);
+        }
+    }
+
+    static void Run(const std::shared_ptr<UnixConnection<T>>& connection, const std::function<void()>& callback) {
+        Debug::Log("Accepted Unix connection on {}, {}", GetSocketPath(connection->m_ports[0]).string(), GetSocketPath(connection->m_ports[1]).string());
+
+        connection->SetConnectionState(ConnectionState::CONNECTED);
+
+        asio::co_spawn(connection->m_context, CoReceiveMessage(connection), asio::detached);
+        asio::co_spawn(connection->m_context, CoReceiveFile(connection), asio::detached);
+        asio::co_spawn(connection->m_context, CoSendFile(connection), asio::detached);
+        asio::co_spawn(connection->m_context, CoSendMessage(connection), asio::detached);
+
+        callback();
+    }
+
+    static asio::awaitable<void> CoStart(std::shared_ptr<UnixConnection<T>> connection, const std::function<void()> callback) {
+        asio::steady_timer backoffTimer(connection->m_context);
+
+        for (uint32_t attempt = 0;; attempt++) {
+            bool retry = false;
+
+            try {
+                connection->SetConnectionState(ConnectionState::CONNECTING);
+
+                co_await connection->m_socket.async_connect(UnixEndpoint(GetSocketPath(connection->m_ports[0]).string()), asio::use_awaitable);
+                co_await connection->m_fileStreamSocket.async_connect(UnixEndpoint(GetSocketPath(connection->m_ports[1]).string()), asio::use_awaitable);
+
+                Run(connection, callback);
+            } catch (const std::system_error& error) {
+                const asio::error_code errorCode = error.code();
+
+                if (errorCode == asio::error::connection_refused || errorCode.value() == ENOENT) {
+                    CloseSocket(connection->m_socket);
+                    CloseSocket(connection->m_fileStreamSocket);
+                    retry = true;
+                } else {
+                    Debug::LogError(errorCode.message());
+                    connection->Disconnect();
+                }
+            }
+
+            if (!retry) {
+                break;
+            }
+
+            asio::error_code errorCode;
+            backoffTimer.expires_after(HappyEyeballs::GetBackoffDelay(attempt));
+            co_await backoffTimer.async_wait(asio::redirect_error(asio::use_awaitable, errorCode));
+        }
+    }
+
+    static asio::awaitable<void> CoSeek(std::shared_ptr<UnixConnection<T>> connection, const std::function<void()> connectionSeekCallback, const std::function<void()> callback) {
+        try {
+            connection->SetConnectionState(ConnectionState::CONNECTING);
+
+            UnixAcceptor connectionAcceptor = OpenAcceptor(connection->m_context, connection->m_ports[0]);
+            connection->m_socketPaths.push_back(GetSocketPath(connection->m_ports[0]));
+
+            UnixAcceptor fileStreamAcceptor = OpenAcceptor(connection->m_context, connection->m_ports[1]);
+            connection->m_socketPaths.push_back(GetSocketPath(connection->m_ports[1]));
+
+            connectionSeekCallback();
+
+            co_await connectionAcceptor.async_accept(connection->m_socket, asio::use_awaitable);
+            co_await fileStreamAcceptor.async_accept(connection->m_fileStreamSocket, asio::use_awaitable);
+
+            connection->RemoveSocketFiles();
+            Run(connection, callback);
+        } catch (const std::system_error& error) {
+            Debug::LogError(error.what());
+            connection->Disconnect();
+        }
+    }
+
+    static asio::awaitable<void> CoReceiveMessage(std::shared_ptr<UnixConnection<T>> connection) {
+        try {
+            PackageHeader header{};
+            moodycamel::ProducerToken inQueueToken(connection->m_inQueue);
+
+            while (connection->GetConnectionState() == ConnectionState::CONNECTED) {
+                asio::mutable_buffer headerBuffer(&header, sizeof(PackageHeader));
+                co_await asio::async_read(connection->m_socket, headerBuffer, asio::use_awaitable);
+
+                header.FromBigEndianToNative();
+
+                if (header.size > MAX_NON_FILE_PACKAGE_SIZE) {
+                    Debug::LogError("Package too large");
+                    connection->Disconnect();
+                    co_return;
+                }
+
+                std::unique_ptr<Package<T>> package = std::make_unique<Package<T>>(header);
+                asio::mutable_buffer packageBuffer(package->GetRawBody(), header.size);
+
+                co_await asio::async_read(connection->m_socket, packageBuffer, asio::use_awaitable);
+
+                if ((header.flags & PackageFlag::BLOB_FRAGMENT) != 0) {
+                    std::unique_ptr<Package<T>> completed;
+
+                    if (!connection->m_blobAssembler.Receive(*package, completed)) {
+                        connection->m_blobAssembler.Abort();
+                        connection->Disconnect();
+                        co_return;
+                    }
+
+                    if (completed == nullptr) {
+                        continue;
+                    }
+
+                    package = std::move(completed);
+                    header = package->GetHeader();
+                }
+
+                if ((header.flags & PackageFlag::FILE_REQUEST) != 0) {
+                    connection->m_fileRequestQueue.push_back(std::move(package));
+                    connection->m_sendFileAwaitableFlag.Signal();
+                    continue;
+                }
+
+                std::unique_ptr<PackageIn<T>> packageIn = std::make_unique<PackageIn<T>>();
+                packageIn->package = std::move(package);
+                packageIn->connection = connection;
+
+                connection->m_inQueue.enqueue(inQueueToken, std::move(packageIn));
+            }
+        } catch (const std::system_error& error) {
+            const asio::error_code errorCode = error.code();
+
+            if (errorCode == asio::error::eof || errorCode == asio::error::connection_reset || errorCode == asio::error::operation_aborted || errorCode == asio::error::connection_aborted || errorCode == asio::error::broken_pipe) {
+                Debug::Log("Connection closed cleanly by peer.");
+            } else if (connection->GetConnectionState() == ConnectionState::CONNECTED) {
+                Debug::LogError(errorCode.message());
+            }
+
+            connection->m_blobAssembler.Abort();
+            connection->Disconnect();
+            co_return;
+        }
+    }
+
+    static asio::awaitable<void> CoSendMessage(std::shared_ptr<UnixConnection<T>> connection) {
+        try {
+            moodycamel::ConsumerToken outQueueToken(connection->m_outQueue);
+            std::deque<std::unique_ptr<OutgoingBlob>> blobs;
+
+            if (connection->GetConnectionState() != ConnectionState::CONNECTED) co_return;
+            co_await connection->m_sendMessageAwaitableFlag.Wait();
+
+            while (connection->GetConnectionState() == ConnectionState::CONNECTED) {
+                std::unique_ptr<Package<T>> package;
+
+                if (connection->m_outQueue.try_dequeue(outQueueToken, package)) {
+                    if (package->GetHeader().size > MAX_NON_FILE_PACKAGE_SIZE) {
+                        blobs.push_back(OutgoingBlob::FromPackage(connection->m_blobCurrentID.fetch_add(1), std::move(package)));
+                        continue;
+                    }
+                } else if (std::unique_ptr<OutgoingBlob> blob; connection->m_outBlobQueue.try_dequeue(blob)) {
+                    blobs.push_back(std::move(blob));
+                    continue;
+                } else if (!blobs.empty()) {
+                    std::unique_ptr<OutgoingBlob> blob = std::move(blobs.front());
+                    blobs.pop_front();
+                    package = blob->NextFragment<T>();
+
+                    if (!blob->IsFinished()) {
+                        blobs.push_back(std::move(blob));
+                    }
+                } else {
+                    connection->m_sendMessageAwaitableFlag.Reset();
+                    co_await connection->m_sendMessageAwaitableFlag.Wait();
+                    continue;
+                }
+
+                PackageHeader header = package->GetHeader();
+
+                std::vector<asio::const_buffer> buffers = {
+                    asio::const_buffer(&header, sizeof(header)),
+                    asio::const_buffer(package->GetRawBody(), header.size)
+                };
+
+                header.FromNativeToBigEndian();
+
+                co_await CoThrottle(connection, sizeof(header) + package->GetHeader().size);
+                co_await asio::async_write(connection->m_socket, buffers, asio::use_awaitable);
+            }
+        } catch (const std::system_error& error) {
+            if (connection->GetConnectionState() == ConnectionState::CONNECTED && error.code() != asio::error::operation_aborted && error.code() != asio::error::connection_aborted) {
+                Debug::LogError(error.what());
+            }
+
+            connection->Disconnect();
+            co_return;
+        }
+    }
+
+    static asio::awaitable<void> CoThrottle(std::shared_ptr<UnixConnection<T>> connection, const size_t size) {
+        const TokenBucket::Clock::duration delay = connection->m_bandwidthLimiter.Acquire(TrafficClass::MESSAGE, size);
+        if (delay <= TokenBucket::Clock::duration::zero()) {
+            co_return;
+        }
+
+        connection->m_messageRateTimer.expires_after(delay);
+        co_await connection->m_messageRateTimer.async_wait(asio::use_awaitable);
+    }
+
+    static asio::awaitable<void> CoSendDescriptor(std::shared_ptr<UnixConnection<T>> connection, std::unique_ptr<Package<T>> package, const FileDescriptor& descriptor) {
+        UnixSocket& socket = connection->m_fileStreamSocket;
+        PackageHeader header = package->GetHeader();
+        header.FromNativeToBigEndian();
+
+        int64_t sent = -1;
+        while (sent < 0) {
+            co_await socket.async_wait(UnixSocket::wait_write, asio::use_awaitable);
+            sent = FileDescriptor::Send(socket.native_handle(), &header, sizeof(header), descriptor.Get());
+
+            if (sent < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                throw asio::system_error(asio::error_code(errno, asio::error::get_system_category()));
+            }
+        }
+
+        const std::array<asio::const_buffer, 2> buffers = {
+            asio::buffer(reinterpret_cast<const char*>(&header) + sent, sizeof(header) - sent),
+            asio::buffer(package->GetRawBody(), package->GetHeader().size)
+        };
+
+        co_await asio::async_write(socket, buffers, asio::use_awaitable);
+    }
+
+    static asio::awaitable<std::unique_ptr<Package<T>>> CoReceiveDescriptor(std::shared_ptr<UnixConnection<T>> connection, FileDescriptor& descriptor) {
+        UnixSocket& socket = connection->m_fileStreamSocket;
+        PackageHeader header{};
+
+        int64_t received = -1;
+        while (received < 0) {
+            co_await socket.async_wait(UnixSocket::wait_read, asio::use_awaitable);
+            received = FileDescriptor::Receive(socket.native_handle(), &header, sizeof(header), descriptor);
+
+            if (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                throw asio::system_error(asio::error_code(errno, asio::error::get_system_category()));
+            }
+        }
+
+        if (received == 0) {
+            throw asio::system_error(asio::error::eof);
+        }
+
+        co_await asio::async_read(socket, asio::buffer(reinterpret_cast<char*>(&header) + received, sizeof(header) - received), asio::use_awaitable);
+        header.FromBigEndianToNative();
+
+        if (header.size > MAX_NON_FILE_PACKAGE_SIZE) {
+            Debug::LogError("Package too large");
+            co_return nullptr;
+        }
+
+        auto package = std::make_unique<Package<T>>(header);
+        co_await asio::async_read(socket, asio::buffer(package->GetRawBody(), header.size), asio::use_awaitable);
+
+        co_return package;
+    }
+
+    static asio::awaitable<void> CoSendFile(std::shared_ptr<UnixConnection<T>> connection) {
+        try {
+            if (connection->GetConnectionState() != ConnectionState::CONNECTED) co_return;
+            co_await connection->m_sendFileAwaitableFlag.Wait();
+
+            while (connection->GetConnectionState() == ConnectionState::CONNECTED) {
+                if (connection->m_fileRequestQueue.empty()) {
+                    connection->m_sendFileAwaitableFlag.Reset();
+                    co_await connection->m_sendFileAwaitableFlag.Wait();
+                    continue;
+                }
+
+                std::unique_ptr<Package<T>> package = std::move(connection->m_fileRequestQueue.front());
+                connection->m_fileRequestQueue.pop_front();
+
+                if (!co_await CoSendFileDescriptors(connection, *package)) {
+                    connection->Disconnect();
+                    co_return;
+                }
+            }
+        } catch (const std::system_error& error) {
+            if (connection->GetConnectionState() == ConnectionState::CONNECTED && error.code() != asio::error::operation_aborted && error.code() != asio::error::connection_aborted) {
+                Debug::LogError(error.what());
+            }
+
+            connection->Disconnect();
+            co_return;
+        }
+    }
+
+    static asio::awaitable<bool> CoSendFileDescriptors(std::shared_ptr<UnixConnection<T>> connection, Package<T>& package) {
+        ZoneScoped;
+        size_t      requestID;
+        uint8_t     kind;
+        std::string path;
+        uint8_t     weight;
+
+        package.GetValue(requestID);
+        package.GetValue(kind);
+        package.GetValue(path);
+        package.GetValue(weight);
+
+        const std::filesystem::path filePath(path);
+
+        if (kind == static_cast<uint8_t>(FileRequestKind::TREE)) {
+            if (!std::filesystem::is_directory(filePath)) {
+                Debug::LogError("Requested path is not a directory");
+                co_return false;
+            }
+
+            std::vector<std::filesystem::directory_entry> entries;
+            std::error_code errorCode;
+
+            for (auto iterator = std::filesystem::recursive_directory_iterator(filePath, errorCode); !errorCode && iterator != std::filesystem::recursive_directory_iterator(); iterator.increment(errorCode)) {
+                if (iterator->is_directory() || iterator->is_regular_file()) {
+                    entries.push_back(*iterator);
+                }
+            }
+
+            if (errorCode) {
+                Debug::LogError("Could not list directory {} ({})", filePath.string(), errorCode.message());
+                co_return false;
+            }
+
+            co_await CoSendTreeEntry(connection, requestID, TreeEntryType::DIRECTORY, std::string(), entries.empty(), FileDescriptor());
+
+            for (size_t i = 0; i < entries.size(); i++) {
+                const std::string relativePath = entries[i].path().lexically_relative(filePath).generic_string();
+                const bool isLast = i + 1 == entries.size();
+
+                if (entries[i].is_directory()) {
+                    co_await CoSendTreeEntry(connection, requestID, TreeEntryType::DIRECTORY, relativePath, isLast, FileDescriptor());
+                    continue;
+                }
+
+                FileDescriptor descriptor = FileDescriptor::OpenRead(entries[i].path());
+                if (!descriptor.IsOpen()) {
+                    Debug::LogError("Could not open file {}", entries[i].path().string());
+                    co_return false;
+                }
+
+                co_await CoSendTreeEntry(connection, requestID, TreeEntryType::FILE, relativePath, isLast, descriptor);
+            }
+
+            co_return true;
+        }
+
+        if (kind != static_cast<uint8_t>(FileRequestKind::RANGE)) {
+            Debug::LogError("Unsupported file request kind");
+            co_return false;
+        }
+
+        FileSizeInt offset;
+        FileSizeInt size;
+
+        package.GetValue(offset);
+        package.GetValue(size);
+
+        FileDescriptor descriptor = FileDescriptor::OpenRead(filePath);
+        if (!descriptor.IsOpen()) {
+            Debug::LogError("File path doesnt exist");
+            co_return false;
+        }
+
+        const FileSizeInt totalSize = descriptor.GetSize();
+        if (offset > totalSize) {
+            Debug::LogError("Requested range out of file bounds");
+            co_return false;
+        }
+
+        if (size == 0 || size > totalSize - offset) {
+            size = totalSize - offset;
+        }
+
+        std::unique_ptr<Package<T>> fileInfo = Package<T>::CreateUnique(static_cast<T>(0), size_t{requestID}, static_cast<uint8_t>(FileRequestKind::RANGE),
+            FileSizeInt{offset}, FileSizeInt{size}, FileSizeInt{totalSize});
+        fileInfo->GetHeader().flags = static_cast<uint8_t>(PackageFlag::FILE_RECEIVE_INFO);
+
+        co_await CoSendDescriptor(connection, std::move(fileInfo), descriptor);
+        co_return true;
+    }
+
+    static asio::awaitable<void> CoSendTreeEntry(std::shared_ptr<UnixConnection<T>> connection, const size_t requestID, const TreeEntryType type, std::string relativePath, const bool isLast, const FileDescriptor& descriptor) {
+        std::unique_ptr<Package<T>> entry = Package<T>::CreateUnique(static_cast<T>(0), size_t{requestID}, static_cast<uint8_t>(FileRequestKind::TREE),
+            static_cast<uint8_t>(type), std::move(relativePath), uint8_t{isLast});
+        entry->GetHeader().flags = static_cast<uint8_t>(PackageFlag::FILE_RECEIVE_INFO);
+
+        co_await CoSendDescriptor(connection, std::move(entry), descriptor);
+    }
+
+    static asio::awaitable<void> CoReceiveFile(std::shared_ptr<UnixConnection<T>> connection) {
+        try {
+            if (connection->GetConnectionState() != ConnectionState::CONNECTED) co_return;
+
+            while (connection->GetConnectionState() == ConnectionState::CONNECTED) {
+                FileDescriptor descriptor;
+                std::unique_ptr<Package<T>> package = co_await CoReceiveDescriptor(connection, descriptor);
+
+                if (package == nullptr || !co_await CoStoreFile(connection, *package, descriptor)) {
+                    connection->Disconnect();
+                    co_return;
+                }
+            }
+        } catch (const std::system_error& error) {
+            const asio::error_code errorCode = error.code();
+
+            if (errorCode == asio::error::eof || errorCode == asio::error::connection_reset || errorCode == asio::error::operation_aborted || errorCode == asio::error::connection_aborted || errorCode == asio::error::broken_pipe) {
+                Debug::Log("Connection closed cleanly by peer.");
+            } else if (connection->GetConnectionState() == ConnectionState::CONNECTED) {
+                Debug::LogError(errorCode.message());
+            }
+
+            connection->Disconnect();
+            co_return;
+        }
+    }
+
+    static asio::awaitable<bool> CoStoreFile(std::shared_ptr<UnixConnection<T>> connection, Package<T>& package, const FileDescriptor& descriptor) {
+        ZoneScoped;
+        size_t  requestID;
+        uint8_t kind;
+
+        package.GetValue(requestID);
+        package.GetValue(kind);
+
+        if (!connection->m_fileNameMap.Contains(requestID)) {
+            Debug::LogError("File ID do not exist");
+            co_return false;
+        }
+
+        const std::filesystem::path filePath = P2PSettings::GetFileDownloadDirectory() / connection->m_fileNameMap.Get(requestID).value();
+
+        if (kind == static_cast<uint8_t>(FileRequestKind::TREE)) {
+            uint8_t     type;
+            std::string relativePath;
+            uint8_t     isLast;
+
+            package.GetValue(type);
+            package.GetValue(relativePath);
+            package.GetValue(isLast);
+
+            if (isLast != 0) {
+                connection->m_fileNameMap.Erase(requestID);
+            }
+
+            const std::filesystem::path relative(relativePath);
+            if (relative.is_absolute() || std::ranges::any_of(relative, [](const std::filesystem::path& part) { return part == ".."; })) {
+                Debug::LogError("Invalid tree entry path");
+                co_return false;
+            }
+
+            const std::filesystem::path entryPath = relativePath.empty() ? filePath : filePath / relative;
+
+            if (type == static_cast<uint8_t>(TreeEntryType::DIRECTORY)) {
+                std::error_code errorCode;
+                std::filesystem::create_directories(entryPath, errorCode);
+                co_return !errorCode;
+            }
+
+            if (!descriptor.IsOpen()) {
+                Debug::LogError("Missing file descriptor");
+                co_return false;
+            }
+
+            const FileSizeInt size = descriptor.GetSize();
+            co_return co_await CoRunBlockingWork([&] { return CopyFile(descriptor, entryPath, 0, size, size); });
+        }
+
+        connection->m_fileNameMap.Erase(requestID);
+
+        FileSizeInt offset;
+        FileSizeInt size;
+        FileSizeInt totalSize;
+
+        package.GetValue(offset);
+        package.GetValue(size);
+        package.GetValue(totalSize);
+
+        const bool copied = descriptor.IsOpen() && co_await CoRunBlockingWork([&] { return CopyFile(descriptor, filePath, offset, size, totalSize); });
+        connection->CompleteFileRequest(requestID, copied);
+
+        co_return copied;
+    }
+
+    static bool CopyFile(const FileDescriptor& source, const std::filesystem::path& filePath, const FileSizeInt offset, const FileSizeInt size, const FileSizeInt totalSize) {
+        ZoneScoped;
+        const FileDescriptor destination = FileDescriptor::OpenWrite(filePath, offset == 0 && size == totalSize);
+
+        if (!destination.IsOpen() || (destination.GetSize() != totalSize && !destination.Resize(totalSize))) {
+            Debug::LogError("Could not open file {}", filePath.string());
+            return false;
+        }
+
+        if (!FileDescriptor::CopyRange(source.Get(), destination.Get(), offset, size)) {
+            Debug::LogError("Could not copy file {}", filePath.string());
+            return false;
+        }
+
+        return true;
+    }
+
+    void SetConnectionState(const ConnectionState state) {
+        ZoneScoped;
+        m_connectionState.store(state, std::memory_order_release);
+
+        if (state == ConnectionState::DISCONNECTED) {
+            FailFileRequests();
+        }
+    }
+
+    void CompleteFileRequest(const size_t requestID, const bool succeeded) {
+        std::function<void(bool)> callback;
+
+        {
+            std::lock_guard lock(m_fileCallbackMutex);
+            const auto entry = m_fileCallbacks.find(requestID);
+            if (entry == m_fileCallbacks.end()) {
+                return;
+            }
+
+            callback = std::move(entry->second);
+            m_fileCallbacks.erase(entry);
+        }
+
+        callback(succeeded);
+    }
+
+    void FailFileRequests() {
+        std::unordered_map<size_t, std::function<void(bool)>> callbacks;
+
+        {
+            std::lock_guard lock(m_fileCallbackMutex);
+            callbacks.swap(m_fileCallbacks);
+        }
+
+        for (auto& [requestID, callback] : callbacks) {
+            callback(false);
+        }
+    }
+
+    IOContext& m_context;
+    UnixSocket m_socket;
+    UnixSocket m_fileStreamSocket;
+
+    AwaitableFlag m_sendMessageAwaitableFlag;
+    AwaitableFlag m_sendFileAwaitableFlag;
+
+    BandwidthLimiter   m_bandwidthLimiter;
+    asio::steady_timer m_messageRateTimer;
+
+    std::atomic<ConnectionState> m_connectionState;
+
+    moodycamel::ConcurrentQueue<std::unique_ptr<Package<T>>>    m_outQueue;
+    moodycamel::ConcurrentQueue<std::unique_ptr<OutgoingBlob>>  m_outBlobQueue;
+    moodycamel::ConcurrentQueue<std::unique_ptr<PackageIn<T>>>& m_inQueue;
+
+    std::deque<std::unique_ptr<Package<T>>> m_fileRequestQueue;
+
+    ConcurrentUnorderedMap<size_t, std::string> m_fileNameMap;
+    std::atomic<size_t>                         m_fileCurrentID{0};
+
+    std::unordered_map<size_t, std::function<void(bool)>> m_fileCallbacks;
+    std::mutex                                            m_fileCallbackMutex;
+
+    BlobAssembler<T>    m_blobAssembler;
+    std::atomic<size_t> m_blobCurrentID{0};
+
+    IPAddress                          m_address;
+    std::array<uint16_t, 2>            m_ports;
+    std::vector<std::filesystem::path> m_socketPaths;
+};
+
+#endif
+
+#endif //P2P_UNIX_CONNECTION_H
@@ -0,0 +1,98 @@
+#include <BandwidthLimiter.h>
+#include <tracy/Tracy.hpp>
+
+#include <algorithm>
+
+std::shared_ptr<TokenBucket> BandwidthLimiter::s_globalBucket = std::make_shared<TokenBucket>();
+
+TokenBucket::TokenBucket(std::shared_ptr<TokenBucket> parent) : m_parent(std::move(parent)) { }
+
+void TokenBucket::SetRate(const uint64_t bytesPerSecond, const uint64_t burstSize) {
+    std::lock_guard lock(m_mutex);
+    m_rate = bytesPerSecond;
+    m_burstSize = burstSize != 0 ? burstSize : std::max(bytesPerSecond / 4, TOKEN_BUCKET_MIN_BURST_SIZE);
+    m_tokens = std::min(m_tokens, static_cast<double>(m_burstSize));
+    m_lastRefill = Clock::now();
+}
+
+TokenBucket::Clock::duration TokenBucket::Consume(const uint64_t size, const bool waitForParents, const Clock::time_point now) {
+    ZoneScoped;
+    Clock::duration delay = Charge(size, now);
+
+    for (TokenBucket* parent = m_parent.get(); parent != nullptr; parent = parent->m_parent.get()) {
+        const Clock::duration parentDelay = parent->Charge(size, now);
+
+        if (waitForParents) {
+            delay = std::max(delay, parentDelay);
+        }
+    }
+
+    return delay;
+}
+
+uint64_t TokenBucket::GetRate() const {
+    std::lock_guard lock(m_mutex);
+    return m_rate;
+}
+
+uint64_t TokenBucket::GetBurstSize() const {
+    std::lock_guard lock(m_mutex);
+    return m_burstSize;
+}
+
+TokenBucket::Clock::duration TokenBucket::Charge(const uint64_t size, const Clock::time_point now) {
+    std::lock_guard lock(m_mutex);
+    if (m_rate == 0) {
+        return Clock::duration::zero();
+    }
+
+    if (now > m_lastRefill) {
+        const double elapsed = std::chrono::duration<double>(now - m_lastRefill).count();
+        m_tokens = std::min(m_tokens + elapsed * static_cast<double>(m_rate), static_cast<double>(m_burstSize));
+        m_lastRefill = now;
+    }
+
+    m_tokens -= static_cast<double>(size);
+    if (m_tokens >= 0.0) {
+        return Clock::duration::zero();
+    }
+
+    return std::chrono::ceil<Clock::duration>(std::chrono::duration<double>(-m_tokens / static_cast<double>(m_rate)));
+}
+
+BandwidthLimiter::BandwidthLimiter()
+    : m_connectionBucket(std::make_shared<TokenBucket>(s_globalBucket)),
+      m_fileBucket(std::make_shared<TokenBucket>(m_connectionBucket)),
+      m_messageBucket(std::make_shared<TokenBucket>(m_connectionBucket)) { }
+
+void BandwidthLimiter::SetGlobalRate(const uint64_t bytesPerSecond, const uint64_t burstSize) {
+    s_globalBucket->SetRate(bytesPerSecond, burstSize);
+}
+
+uint64_t BandwidthLimiter::GetGlobalRate() {
+    return s_globalBucket->GetRate();
+}
+
+void BandwidthLimiter::SetRate(const TrafficClass trafficClass, const uint64_t bytesPerSecond, const uint64_t burstSize) {
+    GetBucket(trafficClass).SetRate(bytesPerSecond, burstSize);
+}
+
+uint64_t BandwidthLimiter::GetRate(const TrafficClass trafficClass) const {
+    return GetBucket(trafficClass).GetRate();
+}
+
+TokenBucket::Clock::duration BandwidthLimiter::Acquire(const TrafficClass trafficClass, const uint64_t size) {
+    ZoneScoped;
+    return GetBucket(trafficClass).Consume(size, trafficClass != TrafficClass::MESSAGE);
+}
+
+TokenBucket& BandwidthLimiter::GetBucket(const TrafficClass trafficClass) const {
+    switch (trafficClass) {
+        case TrafficClass::FILE:
+            return *m_fileBucket;
+        case TrafficClass::MESSAGE:
+            return *m_messageBucket;
+        default:
+            return *m_connectionBucket;
+    }
+}
@@ -0,0 +1,12 @@
+#include <BlobTransfer.h>
+
+OutgoingBlob::OutgoingBlob(const size_t blobID, const PackageTypeInt type, const uint8_t flags, const char* data, const FileSizeInt size, std::shared_ptr<const void> owner)
+    : m_blobID(blobID), m_type(type), m_flags(flags), m_data(data), m_size(size), m_owner(std::move(owner)) { }
+
+size_t OutgoingBlob::GetBlobID() const {
+    return m_blobID;
+}
+
+bool OutgoingBlob::IsFinished() const {
+    return m_started && m_offset == m_size;
+}
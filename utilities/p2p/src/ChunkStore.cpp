@@ -0,0 +1,351 @@
+#include <ChunkStore.h>
+#include <DebugLog.h>
+#include <Settings.h>
+#include <tracy/Tracy.hpp>
+#include <boost/endian/conversion.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <functional>
+#include <thread>
+
+static constexpr std::array<uint64_t, 256> CreateGearTable() {
+    std::array<uint64_t, 256> table{};
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+
+    for (uint64_t& value : table) {
+        state += 0x9E3779B97F4A7C15ull;
+        uint64_t mixed = state;
+        mixed = (mixed ^ (mixed >> 30)) * 0xBF58476D1CE4E5B9ull;
+        mixed = (mixed ^ (mixed >> 27)) * 0x94D049BB133111EBull;
+        value = mixed ^ (mixed >> 31);
+    }
+
+    return table;
+}
+
+static constexpr uint64_t CreateBoundaryMask(const int bits) {
+    return ((uint64_t{1} << bits) - 1) << (64 - bits);
+}
+
+static constexpr std::array<uint64_t, 256> GEAR_TABLE = CreateGearTable();
+static constexpr int AVERAGE_CHUNK_BITS = std::countr_zero(CHUNK_STORE_AVERAGE_CHUNK_SIZE);
+static constexpr uint64_t STRICT_BOUNDARY_MASK = CreateBoundaryMask(AVERAGE_CHUNK_BITS + 2);
+static constexpr uint64_t LOOSE_BOUNDARY_MASK = CreateBoundaryMask(AVERAGE_CHUNK_BITS - 2);
+
+static constexpr char HEX_DIGITS[] = "0123456789abcdef";
+
+static std::string ToHex(const ChunkHash& hash) {
+    std::string hex;
+    hex.reserve(hash.size() * 2);
+
+    for (const uint8_t byte : hash) {
+        hex.push_back(HEX_DIGITS[byte >> 4]);
+        hex.push_back(HEX_DIGITS[byte & 0xF]);
+    }
+
+    return hex;
+}
+
+// Splits the file into content-defined chunks until the callback asks to stop
+static bool ForEachChunk(const std::filesystem::path& path, const std::function<bool(const char*, size_t)>& callback) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        Debug::LogError("Could not open file");
+        return false;
+    }
+
+    std::vector<char> data;
+    size_t position = 0;
+    bool endOfFile = false;
+
+    while (!endOfFile || position < data.size()) {
+        if (!endOfFile && data.size() - position < CHUNK_STORE_MAX_CHUNK_SIZE) {
+            data.erase(data.begin(), data.begin() + static_cast<std::ptrdiff_t>(position));
+            position = 0;
+
+            const size_t previousSize = data.size();
+            data.resize(previousSize + FILE_BUFFER_SIZE + CHUNK_STORE_MAX_CHUNK_SIZE);
+            file.read(data.data() + previousSize, static_cast<std::streamsize>(FILE_BUFFER_SIZE + CHUNK_STORE_MAX_CHUNK_SIZE));
+
+            const auto bytesRead = static_cast<size_t>(file.gcount());
+            data.resize(previousSize + bytesRead);
+            endOfFile = bytesRead < FILE_BUFFER_SIZE + CHUNK_STORE_MAX_CHUNK_SIZE;
+            continue;
+        }
+
+        const size_t size = ContentDefinedChunker::FindBoundary(data.data() + position, data.size() - position);
+        if (!callback(data.data() + position, size)) {
+            return false;
+        }
+
+        position += size;
+    }
+
+    return true;
+}
+
+size_t ChunkHashHasher::operator()(const ChunkHash& hash) const noexcept {
+    size_t value;
+    std::memcpy(&value, hash.data(), sizeof(value));
+    return value;
+}
+
+size_t ContentDefinedChunker::FindBoundary(const char* data, const size_t size) {
+    ZoneScoped;
+    if (size <= CHUNK_STORE_MIN_CHUNK_SIZE) {
+        return size;
+    }
+
+    const size_t end = std::min<size_t>(size, CHUNK_STORE_MAX_CHUNK_SIZE);
+    const size_t normalEnd = std::min<size_t>(end, CHUNK_STORE_AVERAGE_CHUNK_SIZE);
+    uint64_t fingerprint = 0;
+    size_t position = CHUNK_STORE_MIN_CHUNK_SIZE;
+
+    for (; position < normalEnd; ++position) {
+        fingerprint = (fingerprint << 1) + GEAR_TABLE[static_cast<uint8_t>(data[position])];
+        if ((fingerprint & STRICT_BOUNDARY_MASK) == 0) {
+            return position + 1;
+        }
+    }
+
+    for (; position < end; ++position) {
+        fingerprint = (fingerprint << 1) + GEAR_TABLE[static_cast<uint8_t>(data[position])];
+        if ((fingerprint & LOOSE_BOUNDARY_MASK) == 0) {
+            return position + 1;
+        }
+    }
+
+    return end;
+}
+
+ChunkHash ChunkStore::ComputeHash(const char* data, const size_t size) {
+    return DeltaSync::ComputeStrongChecksum(data, size);
+}
+
+std::filesystem::path ChunkStore::GetChunkPath(const ChunkHash& hash) {
+    const std::string hex = ToHex(hash);
+    return P2PSettings::GetChunkStoreDirectory() / hex.substr(0, 2) / hex;
+}
+
+bool ChunkStore::Contains(const ChunkHash& hash) {
+    std::error_code errorCode;
+    return std::filesystem::exists(GetChunkPath(hash), errorCode);
+}
+
+bool ChunkStore::Load(const ChunkHash& hash, std::vector<char>& data) {
+    ZoneScoped;
+    const std::filesystem::path path = GetChunkPath(hash);
+    std::ifstream file(path, std::ios::binary);
+
+    std::error_code errorCode;
+    const uintmax_t size = std::filesystem::file_size(path, errorCode);
+
+    if (!file.is_open() || errorCode || size > CHUNK_STORE_MAX_CHUNK_SIZE) {
+        return false;
+    }
+
+    data.resize(size);
+    if (!file.read(data.data(), static_cast<std::streamsize>(size)) || ComputeHash(data.data(), data.size()) != hash) {
+        Debug::LogError("Discarding corrupted chunk {}", path.string());
+        file.close();
+        std::filesystem::remove(path, errorCode);
+        return false;
+    }
+
+    return true;
+}
+
+bool ChunkStore::Store(const ChunkHash& hash, const char* data, const size_t size) {
+    ZoneScoped;
+    const std::filesystem::path path = GetChunkPath(hash);
+    std::error_code errorCode;
+
+    if (std::filesystem::exists(path, errorCode)) {
+        return true;
+    }
+
+    std::filesystem::create_directories(path.parent_path(), errorCode);
+
+    std::filesystem::path temporaryPath = path;
+    temporaryPath += ".tmp" + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!file.write(data, static_cast<std::streamsize>(size))) {
+            Debug::LogError("Could not write chunk {}", path.string());
+            file.close();
+            std::filesystem::remove(temporaryPath, errorCode);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(temporaryPath, path, errorCode);
+    if (errorCode) {
+        Debug::LogError("Could not store chunk {} ({})", path.string(), errorCode.message());
+        std::filesystem::remove(temporaryPath, errorCode);
+        return false;
+    }
+
+    return true;
+}
+
+bool ChunkStore::Import(const std::filesystem::path& path) {
+    ZoneScoped;
+    return ForEachChunk(path, [](const char* data, const size_t size) {
+        return Store(ComputeHash(data, size), data, size);
+    });
+}
+
+std::vector<uint8_t> ChunkStore::ComputeManifest(const std::filesystem::path& path, const size_t limit) {
+    ZoneScoped;
+    std::vector<uint8_t> hashes;
+    std::unordered_set<ChunkHash, ChunkHashHasher> seen;
+
+    ForEachChunk(path, [&](const char* data, const size_t size) {
+        const ChunkHash hash = ComputeHash(data, size);
+        if (seen.insert(hash).second) {
+            hashes.insert(hashes.end(), hash.begin(), hash.end());
+        }
+
+        return seen.size() < limit;
+    });
+
+    return hashes;
+}
+
+std::vector<uint8_t> ChunkStore::FindMissing(const std::vector<uint8_t>& manifest) {
+    ZoneScoped;
+    std::vector<uint8_t> missing;
+
+    for (size_t offset = 0; offset + CHUNK_STORE_HASH_SIZE <= manifest.size(); offset += CHUNK_STORE_HASH_SIZE) {
+        ChunkHash hash;
+        std::memcpy(hash.data(), manifest.data() + offset, CHUNK_STORE_HASH_SIZE);
+
+        if (!Contains(hash)) {
+            missing.insert(missing.end(), hash.begin(), hash.end());
+        }
+    }
+
+    return missing;
+}
+
+std::vector<uint8_t> ChunkStore::Subtract(const std::vector<uint8_t>& manifest, const std::vector<uint8_t>& missing) {
+    ZoneScoped;
+    std::unordered_set<ChunkHash, ChunkHashHasher> removed;
+    for (size_t offset = 0; offset + CHUNK_STORE_HASH_SIZE <= missing.size(); offset += CHUNK_STORE_HASH_SIZE) {
+        ChunkHash hash;
+        std::memcpy(hash.data(), missing.data() + offset, CHUNK_STORE_HASH_SIZE);
+        removed.insert(hash);
+    }
+
+    std::vector<uint8_t> remaining;
+    for (size_t offset = 0; offset + CHUNK_STORE_HASH_SIZE <= manifest.size(); offset += CHUNK_STORE_HASH_SIZE) {
+        ChunkHash hash;
+        std::memcpy(hash.data(), manifest.data() + offset, CHUNK_STORE_HASH_SIZE);
+
+        if (!removed.contains(hash)) {
+            remaining.insert(remaining.end(), hash.begin(), hash.end());
+        }
+    }
+
+    return remaining;
+}
+
+void ChunkStore::WriteInstruction(std::vector<char>& instructions, const ChunkInstruction instruction, uint32_t value) {
+    const size_t offset = instructions.size();
+    instructions.resize(offset + CHUNK_INSTRUCTION_HEADER_SIZE);
+
+    instructions[offset] = static_cast<char>(instruction);
+    boost::endian::native_to_big_inplace(value);
+    std::memcpy(instructions.data() + offset + 1, &value, sizeof(value));
+}
+
+std::pair<ChunkInstruction, uint32_t> ChunkStore::ReadInstruction(const char* source) {
+    uint32_t value;
+    std::memcpy(&value, source + 1, sizeof(value));
+    boost::endian::big_to_native_inplace(value);
+    return {static_cast<ChunkInstruction>(source[0]), value};
+}
+
+ChunkEncoder::ChunkEncoder(const std::vector<uint8_t>& knownChunks) {
+    ZoneScoped;
+    for (size_t offset = 0; offset + CHUNK_STORE_HASH_SIZE <= knownChunks.size(); offset += CHUNK_STORE_HASH_SIZE) {
+        ChunkHash hash;
+        std::memcpy(hash.data(), knownChunks.data() + offset, CHUNK_STORE_HASH_SIZE);
+        m_knownChunks.insert(hash);
+    }
+}
+
+bool ChunkEncoder::Open(const std::filesystem::path& path) {
+    ZoneScoped;
+    m_file.open(path, std::ios::binary);
+    return m_file.is_open();
+}
+
+bool ChunkEncoder::Next(std::vector<char>& instructions) {
+    ZoneScoped;
+    instructions.clear();
+
+    if (m_finished) {
+        return false;
+    }
+
+    while (instructions.size() < FILE_BUFFER_SIZE) {
+        Fill();
+
+        if (m_position == m_data.size()) {
+            ChunkStore::WriteInstruction(instructions, ChunkInstruction::END, 0);
+            m_finished = true;
+            break;
+        }
+
+        const char* chunk = m_data.data() + m_position;
+        const size_t size = ContentDefinedChunker::FindBoundary(chunk, m_data.size() - m_position);
+        const ChunkHash hash = ChunkStore::ComputeHash(chunk, size);
+
+        if (m_knownChunks.contains(hash)) {
+            ChunkStore::WriteInstruction(instructions, ChunkInstruction::REFERENCE, static_cast<uint32_t>(size));
+            instructions.insert(instructions.end(), hash.begin(), hash.end());
+            m_referencedSize += size;
+        } else {
+            ChunkStore::WriteInstruction(instructions, ChunkInstruction::LITERAL, static_cast<uint32_t>(size));
+            instructions.insert(instructions.end(), chunk, chunk + size);
+            m_knownChunks.insert(hash);
+        }
+
+        m_position += size;
+    }
+
+    return true;
+}
+
+void ChunkEncoder::SetHasher(PipelinedHasher* hasher) {
+    m_hasher = hasher;
+}
+
+void ChunkEncoder::Fill() {
+    ZoneScoped;
+    if (m_endOfFile || m_data.size() - m_position >= CHUNK_STORE_MAX_CHUNK_SIZE) {
+        return;
+    }
+
+    m_data.erase(m_data.begin(), m_data.begin() + static_cast<std::ptrdiff_t>(m_position));
+    m_position = 0;
+
+    const size_t previousSize = m_data.size();
+    const size_t readSize = static_cast<size_t>(CHUNK_STORE_MAX_CHUNK_SIZE) + FILE_BUFFER_SIZE;
+    m_data.resize(previousSize + readSize);
+
+    m_file.read(m_data.data() + previousSize, static_cast<std::streamsize>(readSize));
+    const auto bytesRead = static_cast<size_t>(m_file.gcount());
+
+    m_data.resize(previousSize + bytesRead);
+    m_readSize += bytesRead;
+    m_endOfFile = bytesRead < readSize;
+
+    if (m_hasher != nullptr) {
+        m_hasher->Update(m_data.data() + previousSize, bytesRead);
+    }
+}
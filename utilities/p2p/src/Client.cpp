@@ -9,12 +9,14 @@
 * Number higher than 1 may lead to occasional asio errors (TLS mostly, more rarely TCP)
 */
 static constexpr int ASIO_THREAD_COUNT = 1;
+static constexpr std::chrono::seconds TLS_CONTEXT_WAIT_TIMEOUT{10};
 
 namespace P2P {
 
     Client::Client(): m_clientMode(ClientMode::TLS_Client), m_contextWorkGuard(m_context.get_executor()) {
         ZoneScoped;
 
+        TLS::ContextProvider::Start();
         HandleIncomingPackages();
 
         for (int i = 0; i < ASIO_THREAD_COUNT; i++) {
@@ -53,31 +55,67 @@ namespace P2P {
     void Client::SeekLocalConnection(const std::function<void(void)> connectionSeekCallback, const std::function<void(void)> callback) {
         ZoneScoped;
 
-        const IPAddress ipAddress = AddressResolver::GetPrivateIPv4();
+        if (m_clientMode == ClientMode::UNIX_Client) {
+            const IPAddress loopback = asio::ip::address_v4::loopback();
+            m_localAddresses = {loopback};
 
-        if (ipAddress == IPAddress{}) {
+            CreateUnixConnection();
+            m_connection->Seek(loopback, {0, 0}, connectionSeekCallback, callback);
+            return;
+        }
+
+        const IPAddress ipv6Address = AddressResolver::GetPrivateIPv6();
+        const IPAddress ipv4Address = AddressResolver::GetPrivateIPv4();
+
+        m_localAddresses.clear();
+        for (const IPAddress& address : {ipv6Address, ipv4Address}) {
+            if (address != IPAddress{}) {
+                m_localAddresses.push_back(address);
+            }
+        }
+
+        if (m_localAddresses.empty()) {
             return;
         }
 
         if (m_clientMode == ClientMode::TCP_Client) {
             CreateTCPConnection();
-        } else {
-            CreateTLSConnection(true);
+        } else if (m_clientMode == ClientMode::RUDP_Client) {
+            CreateReliableUDPConnection();
+            m_localAddresses.resize(1);
+        } else if (!CreateTLSConnection(true)) {
+            asio::co_spawn(m_context, CoCreateTLSConnection(true, [this, connectionSeekCallback, callback] {
+                m_connection->Seek(m_localAddresses, {0, 0}, connectionSeekCallback, callback);
+            }, connectionSeekCallback), asio::detached);
+            return;
         }
 
-        m_connection->Seek(ipAddress, {0, 0}, connectionSeekCallback, callback);
+        m_connection->Seek(m_localAddresses, {0, 0}, connectionSeekCallback, callback);
     }
 
 
     void Client::Connect(const IPAddress address, const std::array<uint16_t, 2> ports, const std::function<void(void)> callback) {
+        Connect(std::vector{address}, ports, callback);
+    }
+
+    void Client::Connect(std::vector<IPAddress> addresses, const std::array<uint16_t, 2> ports, const std::function<void(void)> callback) {
         ZoneScoped;
         if (m_clientMode == ClientMode::TCP_Client) {
             CreateTCPConnection();
-        } else {
-            CreateTLSConnection(false);
+        } else if (m_clientMode == ClientMode::UNIX_Client) {
+            CreateUnixConnection();
+        } else if (m_clientMode == ClientMode::RUDP_Client) {
+            CreateReliableUDPConnection();
+        } else if (!CreateTLSConnection(false)) {
+            m_localAddresses.clear();
+            asio::co_spawn(m_context, CoCreateTLSConnection(false, [this, addresses = std::move(addresses), ports, callback] {
+                m_connection->Start(addresses, ports, callback);
+            }, callback), asio::detached);
+            return;
         }
 
-        m_connection->Start(address, ports, callback);
+        m_localAddresses.clear();
+        m_connection->Start(std::move(addresses), ports, callback);
     }
 
     void Client::Disconnect() const {
@@ -98,13 +136,31 @@ namespace P2P {
         m_connection->Send(std::move(message));
     }
 
-    void Client::RequestFile(const std::string& requestedFilePath, const std::string& fileName) const {
+    void Client::SendBlob(const MessageType type, std::shared_ptr<const std::vector<char>> data) const {
         ZoneScoped;
         if (m_connection == nullptr || m_connection->GetConnectionState() != ConnectionState::CONNECTED) {
             return;
         }
 
-        m_connection->RequestFile(requestedFilePath, fileName);
+        m_connection->SendBlob(type, std::move(data));
+    }
+
+    void Client::RequestFile(const std::string& requestedFilePath, const std::string& fileName, const uint8_t weight) const {
+        ZoneScoped;
+        if (m_connection == nullptr || m_connection->GetConnectionState() != ConnectionState::CONNECTED) {
+            return;
+        }
+
+        m_connection->RequestFile(requestedFilePath, fileName, weight);
+    }
+
+    void Client::RequestDirectory(const std::string& requestedDirectoryPath, const std::string& directoryName, const uint8_t weight) const {
+        ZoneScoped;
+        if (m_connection == nullptr || m_connection->GetConnectionState() != ConnectionState::CONNECTED) {
+            return;
+        }
+
+        m_connection->RequestDirectory(requestedDirectoryPath, directoryName, weight);
     }
 
     void Client::SetClientMode(const ClientMode mode) {
@@ -112,6 +168,15 @@ namespace P2P {
         m_clientMode = mode;
     }
 
+    void Client::SetUnreliable(const MessageType type, const bool unreliable) {
+        ZoneScoped;
+        m_unreliableTypes[static_cast<size_t>(type)] = unreliable;
+
+        if (m_connection != nullptr) {
+            m_connection->SetUnreliable(type, unreliable);
+        }
+    }
+
     ClientMode Client::GetClientMode() const {
         ZoneScoped;
         return m_clientMode;
@@ -128,38 +193,109 @@ namespace P2P {
 
     IPAddress Client::GetConnectionAddress() const {
         ZoneScoped;
-        return m_connection->GetAddress();
+        const IPAddress address = m_connection != nullptr ? m_connection->GetAddress() : IPAddress{};
+
+        if (address.is_unspecified() && !m_localAddresses.empty()) {
+            return m_localAddresses.back();
+        }
+
+        return address;
+    }
+
+    std::vector<IPAddress> Client::GetConnectionAddresses() const {
+        ZoneScoped;
+        if (!m_localAddresses.empty() || m_connection == nullptr) {
+            return m_localAddresses;
+        }
+
+        return {m_connection->GetAddress()};
     }
 
     std::array<uint16_t, 2> Client::GetConnectionPorts() const {
         ZoneScoped;
+        if (m_connection == nullptr) {
+            return {0, 0};
+        }
+
         return m_connection->GetPorts();
     }
 
+    std::shared_ptr<ConnectionParent<MessageType>> Client::GetConnection() const {
+        return m_connection;
+    }
+
     void Client::AddHandler(MessageType type, std::function<void(std::unique_ptr<PackageIn<MessageType>>)> handler) {
         ZoneScoped;
         m_handlers[static_cast<size_t>(type)] = handler;
     }
 
-    void Client::CreateTLSConnection(const bool isServer) {
+    bool Client::CreateTLSConnection(const bool isServer) {
         ZoneScoped;
-        static const std::filesystem::path certificatePath = "./certificates/";
-
-        if (!TLS::CertificateManager::IsCertificateValid(certificatePath)) {
-            TLS::CertificateManager::GenerateCertificate(certificatePath);
+        std::shared_ptr<SSLContext> sslContext = TLS::ContextProvider::Get(isServer);
+        if (sslContext == nullptr) {
+            return false;
         }
 
-        if (m_sslContext == nullptr) {
-            m_sslContext = TLSConnection<MessageType>::CreateSSLContext(certificatePath, isServer);
-        }
+        m_connection = TLSConnection<MessageType>::Create(m_context, std::move(sslContext), m_packagesIn);
+        ConfigureConnection();
+        return true;
+    }
 
-        m_connection = TLSConnection<MessageType>::Create(m_context, m_sslContext, m_packagesIn);
+    // The provider had no context yet, so the connection starts once it has built one; if it never does, the callback still
+    // runs so the caller can see the connection stayed disconnected
+    asio::awaitable<void> Client::CoCreateTLSConnection(const bool isServer, const std::function<void()> start, const std::function<void()> callback) {
+        ZoneScoped;
+        const auto readyTimer = std::make_shared<asio::steady_timer>(m_context, TLS_CONTEXT_WAIT_TIMEOUT);
 
+        TLS::ContextProvider::OnReady([weakTimer = std::weak_ptr(readyTimer)] {
+            if (const std::shared_ptr<asio::steady_timer> timer = weakTimer.lock()) {
+                asio::post(timer->get_executor(), [timer] { timer->cancel(); });
+            }
+        });
+
+        asio::error_code errorCode;
+        co_await readyTimer->async_wait(asio::redirect_error(asio::use_awaitable, errorCode));
+
+        if (CreateTLSConnection(isServer)) {
+            start();
+            co_return;
+        }
+
+        Debug::LogError("No TLS context after {} seconds, giving up on the connection", TLS_CONTEXT_WAIT_TIMEOUT.count());
+        if (callback) {
+            callback();
+        }
     }
 
     void Client::CreateTCPConnection() {
         ZoneScoped;
         m_connection = TCPConnection<MessageType>::Create(m_context, m_packagesIn);
+        ConfigureConnection();
+    }
+
+    void Client::CreateUnixConnection() {
+        ZoneScoped;
+#if FILE_DESCRIPTOR_PASSING_SUPPORTED
+        m_connection = UnixConnection<MessageType>::Create(m_context, m_packagesIn);
+        ConfigureConnection();
+#else
+        Debug::LogError("Unix domain sockets are not supported on this platform, falling back to TCP");
+        CreateTCPConnection();
+#endif
+    }
+
+    void Client::CreateReliableUDPConnection() {
+        ZoneScoped;
+        m_connection = ReliableUDPConnection<MessageType>::Create(m_context, m_packagesIn);
+        ConfigureConnection();
+    }
+
+    void Client::ConfigureConnection() const {
+        for (size_t type = 0; type < m_unreliableTypes.size(); type++) {
+            if (m_unreliableTypes[type]) {
+                m_connection->SetUnreliable(static_cast<MessageType>(type), true);
+            }
+        }
     }
 
     void Client::HandleIncomingPackages() {
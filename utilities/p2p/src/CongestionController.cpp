@@ -0,0 +1,128 @@
+#include <CongestionController.h>
+#include <tracy/Tracy.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+static constexpr double CUBIC_SCALE = 0.4;
+static constexpr double CUBIC_BETA = 0.7;
+static constexpr double CUBIC_RENO_ALPHA = 3.0 * (1.0 - CUBIC_BETA) / (1.0 + CUBIC_BETA);
+static constexpr double SEGMENT_SIZE = static_cast<double>(CONGESTION_MAX_DATAGRAM_SIZE);
+
+std::unique_ptr<CongestionController> CongestionController::Create(const CongestionControlAlgorithm algorithm) {
+    if (algorithm == CongestionControlAlgorithm::NEW_RENO) {
+        return std::make_unique<NewRenoController>();
+    }
+
+    return std::make_unique<CubicController>();
+}
+
+void NewRenoController::OnPacketAcked(const size_t size, const Clock::time_point sentTime, Clock::time_point) {
+    ZoneScoped;
+    if (sentTime <= m_recoveryStart) {
+        return;
+    }
+
+    if (m_window < m_slowStartThreshold) {
+        m_window += size;
+        return;
+    }
+
+    m_ackedBytes += size;
+    if (m_ackedBytes >= m_window) {
+        m_ackedBytes -= m_window;
+        m_window += CONGESTION_MAX_DATAGRAM_SIZE;
+    }
+}
+
+void NewRenoController::OnPacketLost(const Clock::time_point sentTime, const Clock::time_point now) {
+    ZoneScoped;
+    if (sentTime <= m_recoveryStart) {
+        return;
+    }
+
+    m_recoveryStart = now;
+    m_window = std::max(m_window / 2, CONGESTION_MIN_WINDOW);
+    m_slowStartThreshold = m_window;
+    m_ackedBytes = 0;
+}
+
+void NewRenoController::OnRetransmissionTimeout() {
+    m_slowStartThreshold = std::max(m_window / 2, CONGESTION_MIN_WINDOW);
+    m_window = CONGESTION_MIN_WINDOW;
+    m_ackedBytes = 0;
+}
+
+size_t NewRenoController::GetCongestionWindow() const {
+    return m_window;
+}
+
+CongestionControlAlgorithm NewRenoController::GetAlgorithm() const {
+    return CongestionControlAlgorithm::NEW_RENO;
+}
+
+void CubicController::OnPacketAcked(const size_t size, const Clock::time_point sentTime, const Clock::time_point now) {
+    ZoneScoped;
+    if (sentTime <= m_recoveryStart) {
+        return;
+    }
+
+    if (m_window < m_slowStartThreshold) {
+        m_window += size;
+        return;
+    }
+
+    const double window = static_cast<double>(m_window) / SEGMENT_SIZE;
+
+    if (m_epochStart == Clock::time_point{}) {
+        m_epochStart = now;
+        m_renoWindow = window;
+
+        if (window < m_maxWindow) {
+            m_period = std::cbrt((m_maxWindow - window) / CUBIC_SCALE);
+        } else {
+            m_period = 0.0;
+            m_maxWindow = window;
+        }
+    }
+
+    const double elapsed = std::chrono::duration<double>(now - m_epochStart).count() - m_period;
+    const double target = CUBIC_SCALE * elapsed * elapsed * elapsed + m_maxWindow;
+
+    m_renoWindow += CUBIC_RENO_ALPHA * static_cast<double>(size) / SEGMENT_SIZE / window;
+
+    if (target < m_renoWindow) {
+        m_window = static_cast<size_t>(m_renoWindow * SEGMENT_SIZE);
+    } else if (target > window) {
+        m_window += static_cast<size_t>((target - window) / window * static_cast<double>(size));
+    }
+}
+
+void CubicController::OnPacketLost(const Clock::time_point sentTime, const Clock::time_point now) {
+    ZoneScoped;
+    if (sentTime <= m_recoveryStart) {
+        return;
+    }
+
+    const double window = static_cast<double>(m_window) / SEGMENT_SIZE;
+
+    m_recoveryStart = now;
+    m_epochStart = Clock::time_point{};
+    m_maxWindow = window < m_maxWindow ? window * (1.0 + CUBIC_BETA) / 2.0 : window;
+    m_window = std::max(static_cast<size_t>(static_cast<double>(m_window) * CUBIC_BETA), CONGESTION_MIN_WINDOW);
+    m_slowStartThreshold = m_window;
+}
+
+void CubicController::OnRetransmissionTimeout() {
+    m_slowStartThreshold = std::max(static_cast<size_t>(static_cast<double>(m_window) * CUBIC_BETA), CONGESTION_MIN_WINDOW);
+    m_window = CONGESTION_MIN_WINDOW;
+    m_epochStart = Clock::time_point{};
+}
+
+size_t CubicController::GetCongestionWindow() const {
+    return m_window;
+}
+
+CongestionControlAlgorithm CubicController::GetAlgorithm() const {
+    return CongestionControlAlgorithm::CUBIC;
+}
@@ -0,0 +1,221 @@
+#include <DatagramChannel.h>
+#include <DebugLog.h>
+#include <tracy/Tracy.hpp>
+
+#include <openssl/evp.h>
+#include <openssl/ssl.h>
+#include <cstring>
+
+static constexpr char DATAGRAM_KEY_LABEL[] = "EXPORTER-pablo-connect-datagram";
+
+using CipherContext = std::unique_ptr<EVP_CIPHER_CTX, decltype(&EVP_CIPHER_CTX_free)>;
+
+static std::array<unsigned char, DATAGRAM_NONCE_SIZE> MakeNonce(uint64_t sequence) {
+    std::array<unsigned char, DATAGRAM_NONCE_SIZE> nonce{};
+    boost::endian::native_to_big_inplace(sequence);
+    std::memcpy(nonce.data() + nonce.size() - sizeof(sequence), &sequence, sizeof(sequence));
+    return nonce;
+}
+
+static bool SealDatagram(const DatagramKey& key, const uint64_t sequence, char* datagram, const size_t payloadSize) {
+    ZoneScoped;
+    const CipherContext context(EVP_CIPHER_CTX_new(), EVP_CIPHER_CTX_free);
+    const auto nonce = MakeNonce(sequence);
+    auto* header = reinterpret_cast<unsigned char*>(datagram);
+    unsigned char* payload = header + sizeof(DatagramHeader);
+    int length = 0;
+
+    return context != nullptr &&
+        EVP_EncryptInit_ex(context.get(), EVP_aes_256_gcm(), nullptr, nullptr, nullptr) == 1 &&
+        EVP_CIPHER_CTX_ctrl(context.get(), EVP_CTRL_GCM_SET_IVLEN, static_cast<int>(nonce.size()), nullptr) == 1 &&
+        EVP_EncryptInit_ex(context.get(), nullptr, nullptr, key.data(), nonce.data()) == 1 &&
+        EVP_EncryptUpdate(context.get(), nullptr, &length, header, sizeof(DatagramHeader)) == 1 &&
+        EVP_EncryptUpdate(context.get(), payload, &length, payload, static_cast<int>(payloadSize)) == 1 &&
+        EVP_EncryptFinal_ex(context.get(), payload + length, &length) == 1 &&
+        EVP_CIPHER_CTX_ctrl(context.get(), EVP_CTRL_GCM_GET_TAG, DATAGRAM_TAG_SIZE, payload + payloadSize) == 1;
+}
+
+static bool OpenDatagram(const DatagramKey& key, const uint64_t sequence, char* datagram, const size_t payloadSize) {
+    ZoneScoped;
+    const CipherContext context(EVP_CIPHER_CTX_new(), EVP_CIPHER_CTX_free);
+    const auto nonce = MakeNonce(sequence);
+    auto* header = reinterpret_cast<unsigned char*>(datagram);
+    unsigned char* payload = header + sizeof(DatagramHeader);
+    int length = 0;
+
+    return context != nullptr &&
+        EVP_DecryptInit_ex(context.get(), EVP_aes_256_gcm(), nullptr, nullptr, nullptr) == 1 &&
+        EVP_CIPHER_CTX_ctrl(context.get(), EVP_CTRL_GCM_SET_IVLEN, static_cast<int>(nonce.size()), nullptr) == 1 &&
+        EVP_DecryptInit_ex(context.get(), nullptr, nullptr, key.data(), nonce.data()) == 1 &&
+        EVP_DecryptUpdate(context.get(), nullptr, &length, header, sizeof(DatagramHeader)) == 1 &&
+        EVP_DecryptUpdate(context.get(), payload, &length, payload, static_cast<int>(payloadSize)) == 1 &&
+        EVP_CIPHER_CTX_ctrl(context.get(), EVP_CTRL_GCM_SET_TAG, DATAGRAM_TAG_SIZE, payload + payloadSize) == 1 &&
+        EVP_DecryptFinal_ex(context.get(), payload + length, &length) == 1;
+}
+
+DatagramChannel::DatagramChannel(IOContext& context) : m_socket(context) { }
+
+bool DatagramChannel::ExportKeys(SSL* ssl, const bool isServer, DatagramKey& sendKey, DatagramKey& receiveKey) {
+    ZoneScoped;
+    std::array<uint8_t, 2 * DATAGRAM_KEY_SIZE> material{};
+
+    if (SSL_export_keying_material(ssl, material.data(), material.size(), DATAGRAM_KEY_LABEL, sizeof(DATAGRAM_KEY_LABEL) - 1, nullptr, 0, 0) != 1) {
+        return false;
+    }
+
+    const auto serverKey = material.begin();
+    const auto clientKey = material.begin() + DATAGRAM_KEY_SIZE;
+
+    std::copy_n(isServer ? serverKey : clientKey, DATAGRAM_KEY_SIZE, sendKey.begin());
+    std::copy_n(isServer ? clientKey : serverKey, DATAGRAM_KEY_SIZE, receiveKey.begin());
+    return true;
+}
+
+uint16_t DatagramChannel::Open(const IPAddress& address) {
+    ZoneScoped;
+    asio::error_code errorCode;
+    const UDPEndpoint endpoint(address, 0);
+
+    m_socket.open(endpoint.protocol(), errorCode);
+    if (!errorCode) {
+        m_socket.bind(endpoint, errorCode);
+    }
+
+    if (errorCode) {
+        Debug::LogError("Could not open datagram channel ({})", errorCode.message());
+        Close();
+        return 0;
+    }
+
+    m_port = m_socket.local_endpoint().port();
+    return m_port;
+}
+
+void DatagramChannel::SetKeys(const DatagramKey& sendKey, const DatagramKey& receiveKey) {
+    m_sendKey = sendKey;
+    m_receiveKey = receiveKey;
+}
+
+void DatagramChannel::Start(ReceiveHandler handler) {
+    ZoneScoped;
+    m_handler = std::move(handler);
+    asio::co_spawn(m_socket.get_executor(), CoReceive(shared_from_this()), asio::detached);
+}
+
+void DatagramChannel::Connect(const UDPEndpoint& peer) {
+    ZoneScoped;
+    if (!m_socket.is_open()) {
+        return;
+    }
+
+    m_peer = peer;
+    m_connected.store(true, std::memory_order_release);
+}
+
+void DatagramChannel::Close() {
+    ZoneScoped;
+    m_connected.store(false, std::memory_order_release);
+
+    asio::error_code errorCode;
+    m_socket.close(errorCode);
+}
+
+bool DatagramChannel::Send(const PackageHeader& header, const uint8_t* body) {
+    ZoneScoped;
+    if (!IsConnected() || header.flags != 0 || header.size > DATAGRAM_MAX_PAYLOAD_SIZE) {
+        return false;
+    }
+
+    if (m_inFlight.load(std::memory_order_relaxed) >= DATAGRAM_MAX_IN_FLIGHT) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    const size_t tagSize = m_sendKey ? DATAGRAM_TAG_SIZE : 0;
+    auto datagram = std::make_shared<std::vector<char>>(sizeof(DatagramHeader) + header.size + tagSize);
+
+    DatagramHeader datagramHeader{m_sequence.fetch_add(1, std::memory_order_relaxed), header};
+    const uint64_t sequence = datagramHeader.sequence;
+    datagramHeader.FromNativeToBigEndian();
+
+    std::memcpy(datagram->data(), &datagramHeader, sizeof(DatagramHeader));
+    std::memcpy(datagram->data() + sizeof(DatagramHeader), body, header.size);
+
+    if (m_sendKey && !SealDatagram(*m_sendKey, sequence, datagram->data(), header.size)) {
+        Debug::LogError("Could not seal datagram");
+        return false;
+    }
+
+    m_inFlight.fetch_add(1, std::memory_order_relaxed);
+    asio::post(m_socket.get_executor(), [channel = shared_from_this(), datagram] {
+        channel->m_socket.async_send_to(asio::buffer(*datagram), channel->m_peer, [channel, datagram](const asio::error_code&, size_t) {
+            channel->m_inFlight.fetch_sub(1, std::memory_order_relaxed);
+        });
+    });
+
+    return true;
+}
+
+void DatagramChannel::SetUnreliable(const PackageTypeInt type, const bool unreliable) {
+    std::lock_guard lock(m_unreliableMutex);
+    if (unreliable) {
+        m_unreliableTypes.insert(type);
+    } else {
+        m_unreliableTypes.erase(type);
+    }
+}
+
+bool DatagramChannel::IsUnreliable(const PackageTypeInt type) const {
+    std::lock_guard lock(m_unreliableMutex);
+    return m_unreliableTypes.contains(type);
+}
+
+asio::awaitable<void> DatagramChannel::CoReceive(std::shared_ptr<DatagramChannel> channel) {
+    std::vector<char> buffer(DATAGRAM_MAX_SIZE);
+    UDPEndpoint sender;
+
+    while (channel->m_socket.is_open()) {
+        asio::error_code errorCode;
+        const size_t size = co_await channel->m_socket.async_receive_from(asio::buffer(buffer), sender, asio::redirect_error(asio::use_awaitable, errorCode));
+
+        if (errorCode == asio::error::operation_aborted || errorCode == asio::error::bad_descriptor) {
+            co_return;
+        }
+
+        if (errorCode || !channel->IsConnected() || sender != channel->m_peer || !channel->Accept(buffer.data(), size)) {
+            channel->m_dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+bool DatagramChannel::Accept(char* datagram, const size_t size) {
+    ZoneScoped;
+    const size_t tagSize = m_receiveKey ? DATAGRAM_TAG_SIZE : 0;
+    if (size < sizeof(DatagramHeader) + tagSize) {
+        return false;
+    }
+
+    DatagramHeader header;
+    std::memcpy(&header, datagram, sizeof(DatagramHeader));
+    header.FromBigEndianToNative();
+
+    if (header.package.flags != 0 || sizeof(DatagramHeader) + header.package.size + tagSize != size) {
+        return false;
+    }
+
+    if (m_receiveKey && !OpenDatagram(*m_receiveKey, header.sequence, datagram, header.package.size)) {
+        return false;
+    }
+
+    const auto [entry, inserted] = m_lastSequences.try_emplace(header.package.type, header.sequence);
+    if (!inserted) {
+        if (header.sequence <= entry->second) {
+            return false;
+        }
+
+        entry->second = header.sequence;
+    }
+
+    m_handler(header.package, datagram + sizeof(DatagramHeader));
+    return true;
+}
@@ -0,0 +1,309 @@
+#include <DeltaSync.h>
+#include <DebugLog.h>
+#include <tracy/Tracy.hpp>
+#include <boost/endian/conversion.hpp>
+#include <openssl/evp.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+void RollingChecksum::Reset(const char* data, const size_t size) {
+    m_a = 0;
+    m_b = 0;
+    m_size = static_cast<uint32_t>(size);
+
+    for (size_t i = 0; i < size; ++i) {
+        const auto value = static_cast<uint8_t>(data[i]);
+        m_a += value;
+        m_b += static_cast<uint32_t>(size - i) * value;
+    }
+
+    m_a &= 0xFFFF;
+    m_b &= 0xFFFF;
+}
+
+void RollingChecksum::Roll(const uint8_t outgoing, const uint8_t incoming) {
+    m_a = (m_a - outgoing + incoming) & 0xFFFF;
+    m_b = (m_b - m_size * outgoing + m_a) & 0xFFFF;
+}
+
+PackageSizeInt DeltaSync::GetBlockSize(const FileSizeInt fileSize) {
+    const auto root = static_cast<FileSizeInt>(std::sqrt(static_cast<double>(fileSize)));
+    const FileSizeInt aligned = (root + 1023) / 1024 * 1024;
+    return static_cast<PackageSizeInt>(std::clamp<FileSizeInt>(aligned, DELTA_MIN_BLOCK_SIZE, DELTA_MAX_BLOCK_SIZE));
+}
+
+bool DeltaSync::ComputeSignature(const std::filesystem::path& path, DeltaSignature& signature) {
+    ZoneScoped;
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        Debug::LogError("Could not open file");
+        return false;
+    }
+
+    const FileSizeInt fileSize = std::filesystem::file_size(path);
+    signature.blockSize = GetBlockSize(fileSize);
+
+    const FileSizeInt blockCount = fileSize / signature.blockSize;
+    signature.weakChecksums.clear();
+    signature.strongChecksums.clear();
+    signature.weakChecksums.reserve(blockCount);
+    signature.strongChecksums.reserve(static_cast<size_t>(blockCount) * DELTA_STRONG_CHECKSUM_SIZE);
+
+    std::vector<char> block(signature.blockSize);
+    RollingChecksum checksum;
+
+    for (FileSizeInt i = 0; i < blockCount; ++i) {
+        if (!file.read(block.data(), signature.blockSize)) {
+            Debug::LogError("Could not read file");
+            return false;
+        }
+
+        checksum.Reset(block.data(), block.size());
+        signature.weakChecksums.push_back(checksum.GetValue());
+
+        const auto strongChecksum = ComputeStrongChecksum(block.data(), block.size());
+        signature.strongChecksums.insert(signature.strongChecksums.end(), strongChecksum.begin(), strongChecksum.end());
+    }
+
+    return true;
+}
+
+std::array<uint8_t, DELTA_STRONG_CHECKSUM_SIZE> DeltaSync::ComputeStrongChecksum(const char* data, const size_t size) {
+    std::array<uint8_t, EVP_MAX_MD_SIZE> digest{};
+    unsigned int digestSize = 0;
+    EVP_Digest(data, size, digest.data(), &digestSize, EVP_sha256(), nullptr);
+
+    std::array<uint8_t, DELTA_STRONG_CHECKSUM_SIZE> strongChecksum{};
+    std::memcpy(strongChecksum.data(), digest.data(), DELTA_STRONG_CHECKSUM_SIZE);
+    return strongChecksum;
+}
+
+void DeltaSync::WriteInstruction(char* destination, const DeltaInstruction instruction, uint32_t value) {
+    destination[0] = static_cast<char>(instruction);
+    boost::endian::native_to_big_inplace(value);
+    std::memcpy(destination + 1, &value, sizeof(value));
+}
+
+std::pair<DeltaInstruction, uint32_t> DeltaSync::ReadInstruction(const char* source) {
+    uint32_t value;
+    std::memcpy(&value, source + 1, sizeof(value));
+    boost::endian::big_to_native_inplace(value);
+    return {static_cast<DeltaInstruction>(source[0]), value};
+}
+
+DeltaEncoder::DeltaEncoder(DeltaSignature signature) : m_signature(std::move(signature)) {
+    ZoneScoped;
+    for (uint32_t i = 0; i < m_signature.weakChecksums.size(); ++i) {
+        m_blocks[m_signature.weakChecksums[i]].push_back(i);
+    }
+}
+
+bool DeltaEncoder::Open(const std::filesystem::path& path) {
+    ZoneScoped;
+    if (m_signature.blockSize == 0 || m_signature.strongChecksums.size() != m_signature.weakChecksums.size() * DELTA_STRONG_CHECKSUM_SIZE) {
+        Debug::LogError("Malformed delta signature");
+        return false;
+    }
+
+    m_file.open(path, std::ios::binary);
+    return m_file.is_open();
+}
+
+bool DeltaEncoder::Next(std::vector<char>& instructions) {
+    ZoneScoped;
+    instructions.clear();
+
+    if (m_finished) {
+        return false;
+    }
+
+    const size_t blockSize = m_signature.blockSize;
+
+    while (instructions.size() < FILE_BUFFER_SIZE) {
+        Fill();
+
+        if (m_data.size() - m_position < blockSize) {
+            m_position = m_data.size();
+            AppendLiteral(instructions);
+            AppendInstruction(instructions, DeltaInstruction::END, 0);
+            m_finished = true;
+            break;
+        }
+
+        if (!m_checksumValid) {
+            m_checksum.Reset(m_data.data() + m_position, blockSize);
+            m_checksumValid = true;
+        }
+
+        if (const std::optional<uint32_t> block = FindBlock()) {
+            AppendLiteral(instructions);
+            AppendInstruction(instructions, DeltaInstruction::COPY, *block);
+
+            m_position += blockSize;
+            m_literalStart = m_position;
+            m_checksumValid = false;
+            continue;
+        }
+
+        if (m_position + blockSize < m_data.size()) {
+            m_checksum.Roll(static_cast<uint8_t>(m_data[m_position]), static_cast<uint8_t>(m_data[m_position + blockSize]));
+        } else {
+            m_checksumValid = false;
+        }
+
+        ++m_position;
+
+        if (m_position - m_literalStart >= DELTA_MAX_LITERAL_SIZE) {
+            AppendLiteral(instructions);
+        }
+    }
+
+    return true;
+}
+
+void DeltaEncoder::Fill() {
+    ZoneScoped;
+    if (m_endOfFile || m_data.size() - m_position > m_signature.blockSize) {
+        return;
+    }
+
+    m_data.erase(m_data.begin(), m_data.begin() + static_cast<std::ptrdiff_t>(m_literalStart));
+    m_position -= m_literalStart;
+    m_literalStart = 0;
+
+    const size_t previousSize = m_data.size();
+    const size_t readSize = static_cast<size_t>(m_signature.blockSize) + FILE_BUFFER_SIZE;
+    m_data.resize(previousSize + readSize);
+
+    m_file.read(m_data.data() + previousSize, static_cast<std::streamsize>(readSize));
+    const auto bytesRead = static_cast<size_t>(m_file.gcount());
+
+    m_data.resize(previousSize + bytesRead);
+    m_readSize += bytesRead;
+    m_endOfFile = bytesRead < readSize;
+
+    if (m_hasher != nullptr) {
+        m_hasher->Update(m_data.data() + previousSize, bytesRead);
+    }
+}
+
+void DeltaEncoder::SetHasher(PipelinedHasher* hasher) {
+    m_hasher = hasher;
+}
+
+std::optional<uint32_t> DeltaEncoder::FindBlock() const {
+    ZoneScoped;
+    const auto candidates = m_blocks.find(m_checksum.GetValue());
+    if (candidates == m_blocks.end()) {
+        return std::nullopt;
+    }
+
+    const auto strongChecksum = DeltaSync::ComputeStrongChecksum(m_data.data() + m_position, m_signature.blockSize);
+
+    for (const uint32_t block : candidates->second) {
+        if (std::memcmp(strongChecksum.data(), m_signature.strongChecksums.data() + static_cast<size_t>(block) * DELTA_STRONG_CHECKSUM_SIZE, DELTA_STRONG_CHECKSUM_SIZE) == 0) {
+            return block;
+        }
+    }
+
+    return std::nullopt;
+}
+
+void DeltaEncoder::AppendLiteral(std::vector<char>& instructions) {
+    while (m_literalStart < m_position) {
+        const size_t size = std::min<size_t>(m_position - m_literalStart, DELTA_MAX_LITERAL_SIZE);
+
+        AppendInstruction(instructions, DeltaInstruction::LITERAL, static_cast<uint32_t>(size));
+        instructions.insert(instructions.end(), m_data.begin() + static_cast<std::ptrdiff_t>(m_literalStart), m_data.begin() + static_cast<std::ptrdiff_t>(m_literalStart + size));
+        m_literalStart += size;
+    }
+}
+
+void DeltaEncoder::AppendInstruction(std::vector<char>& instructions, const DeltaInstruction instruction, const uint32_t value) {
+    const size_t offset = instructions.size();
+    instructions.resize(offset + DELTA_INSTRUCTION_HEADER_SIZE);
+    DeltaSync::WriteInstruction(instructions.data() + offset, instruction, value);
+}
+
+DeltaPatcher::DeltaPatcher(std::filesystem::path basisPath, const PackageSizeInt blockSize)
+    : m_basisPath(std::move(basisPath)), m_blockSize(blockSize) {
+    m_temporaryPath = m_basisPath;
+    m_temporaryPath += ".delta";
+}
+
+bool DeltaPatcher::Open() {
+    ZoneScoped;
+    if (m_blockSize < DELTA_MIN_BLOCK_SIZE || m_blockSize > DELTA_MAX_BLOCK_SIZE) {
+        Debug::LogError("Invalid delta block size");
+        return false;
+    }
+
+    m_basis.open(m_basisPath, std::ios::binary);
+    m_output.open(m_temporaryPath, std::ios::binary | std::ios::trunc);
+
+    if (!m_basis.is_open() || !m_output.is_open()) {
+        Debug::LogError("Could not open file");
+        return false;
+    }
+
+    m_blockCount = static_cast<uint32_t>(std::filesystem::file_size(m_basisPath) / m_blockSize);
+    m_blockBuffer.resize(m_blockSize);
+    return true;
+}
+
+bool DeltaPatcher::ApplyCopy(const uint32_t block) {
+    ZoneScoped;
+    if (block >= m_blockCount) {
+        Debug::LogError("Delta block reference out of range");
+        return false;
+    }
+
+    m_basis.seekg(static_cast<std::streamoff>(block) * m_blockSize);
+    if (!m_basis.read(m_blockBuffer.data(), m_blockSize)) {
+        Debug::LogError("Could not read file");
+        return false;
+    }
+
+    return ApplyLiteral(m_blockBuffer.data(), m_blockSize);
+}
+
+bool DeltaPatcher::ApplyLiteral(const char* data, const size_t size) {
+    m_output.write(data, static_cast<std::streamsize>(size));
+
+    if (m_hasher != nullptr) {
+        m_hasher->Update(data, size);
+    }
+
+    m_writtenSize += size;
+    return m_output.good();
+}
+
+bool DeltaPatcher::Commit() {
+    ZoneScoped;
+    m_basis.close();
+    m_output.close();
+
+    std::error_code errorCode;
+    std::filesystem::rename(m_temporaryPath, m_basisPath, errorCode);
+    if (errorCode) {
+        Debug::LogError("Could not replace file ({})", errorCode.message());
+        return false;
+    }
+
+    return true;
+}
+
+void DeltaPatcher::Abort() {
+    ZoneScoped;
+    m_basis.close();
+    m_output.close();
+
+    std::error_code errorCode;
+    std::filesystem::remove(m_temporaryPath, errorCode);
+}
+
+void DeltaPatcher::SetHasher(PipelinedHasher* hasher) {
+    m_hasher = hasher;
+}
@@ -0,0 +1,93 @@
+#include <FileChunkCache.h>
+#include <tracy/Tracy.hpp>
+
+std::mutex                 FileChunkCache::s_mutex{};
+FileChunkCache::EntryList  FileChunkCache::s_entries{};
+FileChunkCache::EntryIndex FileChunkCache::s_index{};
+size_t                     FileChunkCache::s_size{0};
+size_t                     FileChunkCache::s_capacity{FILE_CHUNK_CACHE_DEFAULT_CAPACITY};
+uint64_t                   FileChunkCache::s_hits{0};
+uint64_t                   FileChunkCache::s_misses{0};
+uint64_t                   FileChunkCache::s_bytesSaved{0};
+
+size_t FileChunkKeyHash::operator()(const FileChunkKey& key) const {
+    size_t seed = std::hash<std::string>{}(key.path);
+
+    for (const uint64_t value : {static_cast<uint64_t>(key.modificationTime), key.fileSize, key.offset}) {
+        seed ^= std::hash<uint64_t>{}(value) + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+    }
+
+    return seed;
+}
+
+FileChunkCache::Chunk FileChunkCache::Find(const FileChunkKey& key) {
+    ZoneScoped;
+    std::lock_guard lock(s_mutex);
+
+    const auto it = s_index.find(key);
+    if (it == s_index.end()) {
+        ++s_misses;
+        return nullptr;
+    }
+
+    s_entries.splice(s_entries.begin(), s_entries, it->second);
+
+    ++s_hits;
+    s_bytesSaved += it->second->chunk->size();
+    return it->second->chunk;
+}
+
+void FileChunkCache::Insert(const FileChunkKey& key, Chunk chunk) {
+    ZoneScoped;
+    std::lock_guard lock(s_mutex);
+
+    if (chunk == nullptr || chunk->size() > s_capacity || s_index.contains(key)) {
+        return;
+    }
+
+    s_size += chunk->size();
+    s_entries.push_front({key, std::move(chunk)});
+    s_index.emplace(key, s_entries.begin());
+
+    Evict(s_capacity);
+}
+
+void FileChunkCache::SetCapacity(const size_t capacity) {
+    std::lock_guard lock(s_mutex);
+    s_capacity = capacity;
+    Evict(s_capacity);
+}
+
+size_t FileChunkCache::GetCapacity() {
+    std::lock_guard lock(s_mutex);
+    return s_capacity;
+}
+
+bool FileChunkCache::IsEnabled() {
+    std::lock_guard lock(s_mutex);
+    return s_capacity > 0;
+}
+
+FileChunkCacheStats FileChunkCache::GetStats() {
+    std::lock_guard lock(s_mutex);
+    return {s_hits, s_misses, s_bytesSaved, s_size, s_capacity};
+}
+
+void FileChunkCache::Clear() {
+    std::lock_guard lock(s_mutex);
+    s_entries.clear();
+    s_index.clear();
+    s_size = 0;
+    s_hits = 0;
+    s_misses = 0;
+    s_bytesSaved = 0;
+}
+
+void FileChunkCache::Evict(const size_t capacity) {
+    while (s_size > capacity && !s_entries.empty()) {
+        const Entry& entry = s_entries.back();
+        s_size -= entry.chunk->size();
+        s_index.erase(entry.key);
+        s_entries.pop_back();
+    }
+}
@@ -0,0 +1,1136 @@
+#include <FileTransfer.h>
+#include <BlockingWork.h>
+#include <DebugLog.h>
+#include <Settings.h>
+#include <tracy/Tracy.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+template <typename V>
+static void AppendManifestValue(std::vector<char>& manifest, V value) {
+    boost::endian::native_to_big_inplace(value);
+    const auto* bytes = reinterpret_cast<const char*>(&value);
+    manifest.insert(manifest.end(), bytes, bytes + sizeof(V));
+}
+
+template <typename V>
+static bool ReadManifestValue(const std::vector<char>& manifest, size_t& offset, V& value) {
+    if (manifest.size() - offset < sizeof(V)) {
+        return false;
+    }
+
+    std::memcpy(&value, manifest.data() + offset, sizeof(V));
+    boost::endian::big_to_native_inplace(value);
+    offset += sizeof(V);
+    return true;
+}
+
+static void AppendManifestEntry(std::vector<char>& manifest, const TreeEntryType type, const std::string& path, const uint64_t size) {
+    AppendManifestValue(manifest, static_cast<uint8_t>(type));
+    AppendManifestValue(manifest, static_cast<uint16_t>(path.size()));
+    manifest.insert(manifest.end(), path.begin(), path.end());
+    AppendManifestValue(manifest, size);
+}
+
+FileTransferSource::FileTransferSource(const size_t requestID, const uint8_t weight)
+    : m_requestID(requestID), m_weight(std::max<uint8_t>(weight, 1)) { }
+
+void FileTransferSource::Release() { }
+
+void FileTransferSource::SetChunkSize(const PackageSizeInt chunkSize) {
+    m_chunkSize = std::clamp<PackageSizeInt>(chunkSize, 1, FILE_CHUNK_MAX_SIZE);
+}
+
+HashDigest FileTransferSource::Finish() {
+    ZoneScoped;
+    return m_hasher.Finish();
+}
+
+asio::awaitable<void> FileTransferSource::CoWaitReadable() {
+    co_await m_hasher.CoWaitForSpace(m_chunkSize);
+}
+
+asio::awaitable<HashDigest> FileTransferSource::CoFinish() {
+    co_return co_await m_hasher.CoFinish();
+}
+
+RangeFileSource::RangeFileSource(const size_t requestID, const uint8_t weight, std::filesystem::path filePath, const FileSizeInt offset, const FileSizeInt size)
+    : FileTransferSource(requestID, weight), m_filePath(std::move(filePath)), m_offset(offset), m_size(size) { }
+
+bool RangeFileSource::Open() {
+    ZoneScoped;
+    m_file.open(m_filePath, std::ios::binary | std::ios::in);
+    if (!m_file.is_open()) {
+        Debug::LogError("Could not open file");
+        return false;
+    }
+
+    m_totalSize = std::filesystem::file_size(m_filePath);
+    if (m_offset > m_totalSize) {
+        Debug::LogError("Requested range out of file bounds");
+        return false;
+    }
+
+    if (m_size == 0 || m_size > m_totalSize - m_offset) {
+        m_size = m_totalSize - m_offset;
+    }
+
+    m_cacheEnabled = FileChunkCache::IsEnabled();
+    if (m_cacheEnabled) {
+        std::error_code errorCode;
+        m_cacheKey.path = std::filesystem::absolute(m_filePath, errorCode).lexically_normal().string();
+        m_cacheKey.modificationTime = std::filesystem::last_write_time(m_filePath, errorCode).time_since_epoch().count();
+        m_cacheKey.fileSize = m_totalSize;
+        m_cacheEnabled = !errorCode;
+    }
+
+    m_extents = SparseFile::GetDataExtents(m_filePath, m_offset, m_size);
+    for (const FileExtent& extent : m_extents) {
+        m_dataSize += extent.size;
+    }
+
+    return true;
+}
+
+bool RangeFileSource::Read() {
+    ZoneScoped;
+    const FileExtent& extent = m_extents[m_extentIndex];
+    const FileSizeInt position = extent.offset + m_extentRead;
+    const auto readSize = static_cast<PackageSizeInt>(std::min<FileSizeInt>(extent.size - m_extentRead, m_chunkSize));
+
+    if (m_cacheEnabled) {
+        if (!ReadCached(position, readSize)) {
+            return false;
+        }
+
+        Advance(readSize);
+        return true;
+    }
+
+    if (m_seekRequired) {
+        m_file.seekg(static_cast<std::streamoff>(position));
+        m_seekRequired = false;
+    }
+
+    m_chunk = m_hasher.AcquireBuffer(readSize);
+    if (!m_file.read(m_chunk.data(), readSize)) {
+        Debug::LogError("Could not read file");
+        return false;
+    }
+
+    Advance(readSize);
+    return true;
+}
+
+bool RangeFileSource::ReadCached(const FileSizeInt position, const PackageSizeInt size) {
+    ZoneScoped;
+    // A read that matches a whole block shares it; any other read is sliced out of the blocks it covers
+    if (position % FILE_CHUNK_CACHE_BLOCK_SIZE == 0) {
+        m_sharedChunk = LoadBlock(position);
+        if (m_sharedChunk == nullptr) {
+            return false;
+        }
+
+        if (m_sharedChunk->size() == size) {
+            return true;
+        }
+
+        m_sharedChunk = nullptr;
+    }
+
+    m_chunk = m_hasher.AcquireBuffer(size);
+    PackageSizeInt copied = 0;
+
+    while (copied < size) {
+        const FileSizeInt offset = position + copied;
+        const FileSizeInt blockOffset = offset / FILE_CHUNK_CACHE_BLOCK_SIZE * FILE_CHUNK_CACHE_BLOCK_SIZE;
+
+        const FileChunkCache::Chunk block = LoadBlock(blockOffset);
+        if (block == nullptr) {
+            return false;
+        }
+
+        const auto sliceSize = static_cast<PackageSizeInt>(std::min<FileSizeInt>(size - copied, block->size() - (offset - blockOffset)));
+        std::memcpy(m_chunk.data() + copied, block->data() + (offset - blockOffset), sliceSize);
+        copied += sliceSize;
+    }
+
+    return true;
+}
+
+FileChunkCache::Chunk RangeFileSource::LoadBlock(const FileSizeInt offset) {
+    if (m_block != nullptr && m_cacheKey.offset == offset) {
+        return m_block;
+    }
+
+    m_cacheKey.offset = offset;
+    m_block = FileChunkCache::Find(m_cacheKey);
+    if (m_block != nullptr) {
+        return m_block;
+    }
+
+    auto block = std::make_shared<std::vector<char>>(std::min(FILE_CHUNK_CACHE_BLOCK_SIZE, m_totalSize - offset));
+    m_file.seekg(static_cast<std::streamoff>(offset));
+
+    if (!m_file.read(block->data(), static_cast<std::streamsize>(block->size()))) {
+        Debug::LogError("Could not read file");
+        return nullptr;
+    }
+
+    m_block = std::move(block);
+    FileChunkCache::Insert(m_cacheKey, m_block);
+    return m_block;
+}
+
+void RangeFileSource::Advance(const PackageSizeInt size) {
+    m_sent += size;
+    m_extentRead += size;
+
+    if (m_extentRead == m_extents[m_extentIndex].size) {
+        ++m_extentIndex;
+        m_extentRead = 0;
+        m_seekRequired = true;
+    }
+}
+
+void RangeFileSource::Release() {
+    ZoneScoped;
+    if (m_sharedChunk != nullptr) {
+        m_hasher.SubmitShared(std::move(m_sharedChunk));
+        m_sharedChunk = nullptr;
+        return;
+    }
+
+    const size_t size = m_chunk.size();
+    m_hasher.Submit(std::move(m_chunk), size);
+    m_chunk.clear();
+}
+
+bool RangeFileSource::IsFinished() const {
+    return m_sent >= m_dataSize;
+}
+
+FileSizeInt RangeFileSource::GetRemainingSize() const {
+    return m_dataSize - m_sent;
+}
+
+bool RangeFileSource::IsSparse() const {
+    return m_dataSize != m_size;
+}
+
+DeltaFileSource::DeltaFileSource(const size_t requestID, const uint8_t weight, std::filesystem::path filePath, DeltaSignature signature)
+    : FileTransferSource(requestID, weight), m_filePath(std::move(filePath)), m_blockSize(signature.blockSize), m_encoder(std::move(signature)) {
+    m_encoder.SetHasher(&m_hasher);
+}
+
+bool DeltaFileSource::Open() {
+    ZoneScoped;
+    if (!m_encoder.Open(m_filePath)) {
+        Debug::LogError("Could not open file");
+        return false;
+    }
+
+    m_totalSize = std::filesystem::file_size(m_filePath);
+    return true;
+}
+
+bool DeltaFileSource::Read() {
+    ZoneScoped;
+    return m_encoder.Next(m_chunk);
+}
+
+bool DeltaFileSource::IsFinished() const {
+    return m_encoder.IsFinished();
+}
+
+FileSizeInt DeltaFileSource::GetRemainingSize() const {
+    return m_totalSize - std::min(m_encoder.GetReadSize(), m_totalSize);
+}
+
+ChunkedFileSource::ChunkedFileSource(const size_t requestID, const uint8_t weight, std::filesystem::path filePath, const std::vector<uint8_t>& knownChunks)
+    : FileTransferSource(requestID, weight), m_filePath(std::move(filePath)), m_encoder(knownChunks) {
+    m_encoder.SetHasher(&m_hasher);
+}
+
+bool ChunkedFileSource::Open() {
+    ZoneScoped;
+    if (!m_encoder.Open(m_filePath)) {
+        Debug::LogError("Could not open file");
+        return false;
+    }
+
+    m_totalSize = std::filesystem::file_size(m_filePath);
+    return true;
+}
+
+bool ChunkedFileSource::Read() {
+    ZoneScoped;
+    return m_encoder.Next(m_chunk);
+}
+
+bool ChunkedFileSource::IsFinished() const {
+    return m_encoder.IsFinished();
+}
+
+FileSizeInt ChunkedFileSource::GetRemainingSize() const {
+    return m_totalSize - std::min(m_encoder.GetReadSize(), m_totalSize);
+}
+
+TreeFileSource::TreeFileSource(const size_t requestID, const uint8_t weight, std::filesystem::path rootPath)
+    : FileTransferSource(requestID, weight), m_rootPath(std::move(rootPath)) { }
+
+bool TreeFileSource::Open() {
+    ZoneScoped;
+    std::error_code errorCode;
+    std::filesystem::recursive_directory_iterator iterator(m_rootPath, std::filesystem::directory_options::skip_permission_denied, errorCode);
+
+    if (errorCode) {
+        Debug::LogError("Could not open directory ({})", errorCode.message());
+        return false;
+    }
+
+    uint32_t entryCount = 0;
+    AppendManifestValue(m_manifest, entryCount);
+
+    for (const auto& entry : iterator) {
+        const std::string relativePath = entry.path().lexically_relative(m_rootPath).generic_string();
+        if (relativePath.size() > UINT16_MAX) {
+            Debug::LogError("Path too long");
+            return false;
+        }
+
+        if (entry.is_directory()) {
+            AppendManifestEntry(m_manifest, TreeEntryType::DIRECTORY, relativePath, 0);
+        } else if (entry.is_regular_file()) {
+            const FileSizeInt size = entry.file_size();
+            AppendManifestEntry(m_manifest, TreeEntryType::FILE, relativePath, size);
+
+            m_files.push_back({entry.path(), size});
+            m_contentSize += size;
+        } else {
+            continue;
+        }
+
+        ++entryCount;
+    }
+
+    if (m_manifest.size() > TREE_MANIFEST_MAX_SIZE) {
+        Debug::LogError("Directory manifest too large");
+        return false;
+    }
+
+    boost::endian::native_to_big_inplace(entryCount);
+    std::memcpy(m_manifest.data(), &entryCount, sizeof(entryCount));
+    return true;
+}
+
+bool TreeFileSource::Read() {
+    ZoneScoped;
+    const auto chunkSize = static_cast<PackageSizeInt>(std::min<FileSizeInt>(GetRemainingSize(), m_chunkSize));
+    m_chunk = m_hasher.AcquireBuffer(chunkSize);
+
+    PackageSizeInt filled = 0;
+
+    if (m_sent < m_manifest.size()) {
+        filled = static_cast<PackageSizeInt>(std::min<FileSizeInt>(chunkSize, m_manifest.size() - m_sent));
+        std::memcpy(m_chunk.data(), m_manifest.data() + m_sent, filled);
+    }
+
+    while (filled < chunkSize) {
+        if (m_fileRemaining == 0) {
+            m_file.close();
+            m_file.open(m_files[m_fileIndex].path, std::ios::binary | std::ios::in);
+            m_fileRemaining = m_files[m_fileIndex].size;
+            ++m_fileIndex;
+
+            if (!m_file.is_open()) {
+                Debug::LogError("Could not open file");
+                return false;
+            }
+
+            continue;
+        }
+
+        const auto readSize = static_cast<PackageSizeInt>(std::min<FileSizeInt>(chunkSize - filled, m_fileRemaining));
+        if (!m_file.read(m_chunk.data() + filled, readSize)) {
+            Debug::LogError("File changed during directory transfer");
+            return false;
+        }
+
+        filled += readSize;
+        m_fileRemaining -= readSize;
+    }
+
+    m_sent += chunkSize;
+    return true;
+}
+
+void TreeFileSource::Release() {
+    ZoneScoped;
+    const size_t size = m_chunk.size();
+    m_hasher.Submit(std::move(m_chunk), size);
+    m_chunk.clear();
+}
+
+bool TreeFileSource::IsFinished() const {
+    return GetRemainingSize() == 0;
+}
+
+FileSizeInt TreeFileSource::GetRemainingSize() const {
+    return m_manifest.size() + m_contentSize - m_sent;
+}
+
+char* FileTransferSink::Reserve(size_t) {
+    return nullptr;
+}
+
+bool FileTransferSink::Commit(size_t) {
+    return false;
+}
+
+bool FileTransferSink::IsVerified() const {
+    return true;
+}
+
+asio::awaitable<void> FileTransferSink::CoWaitWritable(const size_t size) {
+    co_await m_hasher.CoWaitForSpace(size);
+}
+
+asio::awaitable<bool> FileTransferSink::CoWrite(std::vector<char>& buffer, const size_t size) {
+    co_return Write(buffer, size);
+}
+
+asio::awaitable<bool> FileTransferSink::CoFinish(const HashDigest& digest) {
+    co_await m_hasher.CoWait();
+    co_return Finish(digest);
+}
+
+bool FileTransferSink::WriteCompressed(const std::vector<char>& buffer, const size_t size, std::vector<char>& decompressedBuffer) {
+    ZoneScoped;
+    CompressionAlgorithm algorithm;
+    uint32_t originalSize;
+
+    if (!Compression::ReadHeader(buffer.data(), size, algorithm, originalSize) || originalSize > FILE_CHUNK_MAX_SIZE) {
+        Debug::LogError("Invalid compressed file chunk");
+        return false;
+    }
+
+    if (char* destination = Reserve(originalSize)) {
+        if (!Compression::Decompress(buffer.data(), size, destination, originalSize)) {
+            Debug::LogError("Could not decompress file chunk");
+            return false;
+        }
+
+        return Commit(originalSize);
+    }
+
+    if (!Compression::Decompress(buffer.data(), size, decompressedBuffer, FILE_CHUNK_MAX_SIZE)) {
+        Debug::LogError("Could not decompress file chunk");
+        return false;
+    }
+
+    return Write(decompressedBuffer, decompressedBuffer.size());
+}
+
+asio::awaitable<bool> FileTransferSink::CoWriteCompressed(const std::vector<char>& buffer, const size_t size, std::vector<char>& decompressedBuffer) {
+    CompressionAlgorithm algorithm;
+    uint32_t originalSize;
+
+    if (Compression::ReadHeader(buffer.data(), size, algorithm, originalSize) && originalSize <= FILE_CHUNK_MAX_SIZE) {
+        co_await CoWaitWritable(originalSize);
+    }
+
+    co_return co_await CoRunCompressionWork(size, [&] { return WriteCompressed(buffer, size, decompressedBuffer); });
+}
+
+RangeFileSink::RangeFileSink(std::filesystem::path filePath, const FileSizeInt offset, const FileSizeInt size, const FileSizeInt totalSize)
+    : m_filePath(std::move(filePath)), m_offset(offset), m_size(size), m_totalSize(totalSize) { }
+
+RangeFileSink::~RangeFileSink() {
+    ZoneScoped;
+    m_hasher.Cancel();
+
+    if (m_finished || m_received == 0) {
+        return;
+    }
+
+    m_file.close();
+    m_mapped.Close();
+    m_checkpoint->MarkReceived(m_offset, GetCompletedSpan());
+    m_checkpoint->Save();
+}
+
+asio::awaitable<void> RangeFileSink::CoWaitWritable(const size_t size) {
+    // Moving the mapping unmaps views the hasher may still be reading
+    if (m_mapped.IsOpen() && FitsExtent(size) && !m_mapped.Contains(GetPosition(), size)) {
+        co_await m_hasher.CoWait();
+    }
+
+    co_await FileTransferSink::CoWaitWritable(size);
+}
+
+void RangeFileSink::SetDataExtents(std::vector<FileExtent> extents) {
+    m_extents = std::move(extents);
+    m_sparse = true;
+}
+
+bool RangeFileSink::Open() {
+    ZoneScoped;
+    m_checkpoint = FileTransferCheckpoint::Acquire(m_filePath);
+    std::ios::openmode openMode = std::ios::binary | std::ios::in | std::ios::out;
+    bool truncate = false;
+
+    if (!m_checkpoint->IsStarted() || m_checkpoint->GetTotalSize() != m_totalSize || !std::filesystem::exists(m_filePath)) {
+        if (m_checkpoint->IsStarted()) {
+            Debug::LogError("Partial file {} no longer matches its source, restarting transfer", m_filePath.string());
+        }
+
+        m_checkpoint->Reset(m_totalSize);
+        openMode |= std::ios::trunc;
+        truncate = true;
+    }
+
+    if (!m_sparse) {
+        m_extents.clear();
+        if (m_size != 0) {
+            m_extents.push_back({m_offset, m_size});
+        }
+    } else if (!SparseFile::IsValidExtentList(m_offset, m_size, m_extents)) {
+        Debug::LogError("Invalid data extents for {}", m_filePath.string());
+        return false;
+    }
+
+    for (const FileExtent& extent : m_extents) {
+        m_dataSize += extent.size;
+    }
+
+    if (P2PSettings::IsMemoryMappedReceiveEnabled() && MemoryMappedFile::IsSupported()) {
+        if (!m_mapped.Open(m_filePath, m_totalSize, truncate)) {
+            Debug::LogError("Could not map file {}, falling back to buffered writes", m_filePath.string());
+        }
+
+        // Holes stay unallocated; only the data this sink receives is reserved
+        for (const FileExtent& extent : m_extents) {
+            if (m_mapped.IsOpen() && !m_mapped.Allocate(extent.offset, extent.size)) {
+                Debug::LogError("Could not reserve space in {}, falling back to buffered writes", m_filePath.string());
+                m_mapped.Close();
+            }
+        }
+    }
+
+    if (!m_mapped.IsOpen()) {
+        m_file.open(m_filePath, openMode);
+        if (!m_file.is_open()) {
+            Debug::LogError("Could not open file");
+            return false;
+        }
+    }
+
+    if (m_sparse && !SparseFile::CreateHoles(m_filePath, m_totalSize, SparseFile::GetHoles(m_offset, m_size, m_extents))) {
+        Debug::LogError("Could not create holes in {}", m_filePath.string());
+        return false;
+    }
+
+    return true;
+}
+
+char* RangeFileSink::Reserve(const size_t size) {
+    ZoneScoped;
+    m_reserved = nullptr;
+    if (!m_mapped.IsOpen() || size == 0 || !FitsExtent(size)) {
+        return nullptr;
+    }
+
+    const FileSizeInt position = GetPosition();
+    if (m_mapped.Contains(position, size)) {
+        m_reserved = m_mapped.At(position);
+    } else {
+        // Returns at once after CoWaitWritable; only decompression on the worker pool can still block here
+        m_hasher.Wait();
+
+        const FileSizeInt windowSize = std::min(std::max<FileSizeInt>(FILE_MMAP_WINDOW_SIZE, size), m_offset + m_size - position);
+        m_reserved = m_mapped.Map(position, windowSize);
+    }
+
+    return m_reserved;
+}
+
+bool RangeFileSink::Commit(const size_t size) {
+    ZoneScoped;
+    if (m_reserved == nullptr || !FitsExtent(size)) {
+        Debug::LogError("File chunk exceeds requested range");
+        return false;
+    }
+
+    m_hasher.SubmitView(m_reserved, size);
+    m_reserved = nullptr;
+    Advance(size);
+
+    if (m_received - m_lastCheckpoint >= FILE_CHECKPOINT_SAVE_INTERVAL) {
+        SaveCheckpoint();
+    }
+
+    return true;
+}
+
+bool RangeFileSink::Write(std::vector<char>& buffer, const size_t size) {
+    ZoneScoped;
+    if (size == 0) {
+        return true;
+    }
+
+    if (!FitsExtent(size)) {
+        Debug::LogError("File chunk exceeds requested range");
+        return false;
+    }
+
+    if (m_mapped.IsOpen()) {
+        char* destination = Reserve(size);
+        if (destination == nullptr) {
+            return false;
+        }
+
+        std::memcpy(destination, buffer.data(), size);
+        return Commit(size);
+    }
+
+    if (m_seekRequired) {
+        m_file.seekp(static_cast<std::streamoff>(GetPosition()));
+        m_seekRequired = false;
+    }
+
+    m_file.write(buffer.data(), static_cast<std::streamsize>(size));
+    Advance(size);
+
+    m_hasher.Submit(std::move(buffer), size);
+    buffer = m_hasher.AcquireBuffer(FILE_BUFFER_SIZE);
+
+    if (m_received - m_lastCheckpoint >= FILE_CHECKPOINT_SAVE_INTERVAL) {
+        SaveCheckpoint();
+    }
+
+    return m_file.good();
+}
+
+bool RangeFileSink::Finish(const HashDigest& digest) {
+    ZoneScoped;
+    m_finished = true;
+    const HashDigest receivedDigest = m_hasher.Finish();
+
+    m_file.close();
+    m_mapped.Close();
+    m_checkpoint->MarkReceived(m_offset, GetCompletedSpan());
+
+    if (m_received != m_dataSize) {
+        Debug::LogError("File range ended early ({} of {} bytes)", m_received, m_dataSize);
+        m_checkpoint->Save();
+        return false;
+    }
+
+    m_verified = receivedDigest == digest;
+
+    if (!m_verified) {
+        Debug::LogError("Integrity check failed for {} ({} bytes at offset {})", m_filePath.string(), m_size, m_offset);
+        m_checkpoint->MarkMissing(m_offset, m_size);
+        m_checkpoint->Save();
+    } else if (m_checkpoint->IsComplete()) {
+        m_checkpoint->Remove();
+    } else {
+        m_checkpoint->Save();
+    }
+
+    return true;
+}
+
+void RangeFileSink::SaveCheckpoint() {
+    ZoneScoped;
+    if (m_mapped.IsOpen()) {
+        m_mapped.Flush();
+    } else {
+        m_file.flush();
+    }
+
+    m_checkpoint->MarkReceived(m_offset, GetCompletedSpan());
+    m_checkpoint->Save();
+    m_lastCheckpoint = m_received;
+}
+
+void RangeFileSink::Advance(const size_t size) {
+    m_received += size;
+    m_extentReceived += size;
+
+    if (m_extentReceived == m_extents[m_extentIndex].size) {
+        ++m_extentIndex;
+        m_extentReceived = 0;
+        m_seekRequired = true;
+    }
+}
+
+bool RangeFileSink::FitsExtent(const size_t size) const {
+    return m_extentIndex < m_extents.size() && size <= m_extents[m_extentIndex].size - m_extentReceived;
+}
+
+bool RangeFileSink::IsVerified() const {
+    return m_verified;
+}
+
+FileSizeInt RangeFileSink::GetPosition() const {
+    return m_extents[m_extentIndex].offset + m_extentReceived;
+}
+
+FileSizeInt RangeFileSink::GetCompletedSpan() const {
+    if (m_extentIndex >= m_extents.size()) {
+        return m_size;
+    }
+
+    return GetPosition() - m_offset;
+}
+
+DeltaFileSink::DeltaFileSink(std::filesystem::path filePath, const PackageSizeInt blockSize, const FileSizeInt totalSize)
+    : m_filePath(std::move(filePath)), m_totalSize(totalSize), m_patcher(m_filePath, blockSize) {
+    m_patcher.SetHasher(&m_hasher);
+}
+
+DeltaFileSink::~DeltaFileSink() {
+    if (!m_finished) {
+        m_patcher.Abort();
+    }
+}
+
+bool DeltaFileSink::Open() {
+    ZoneScoped;
+    return m_patcher.Open();
+}
+
+bool DeltaFileSink::Write(std::vector<char>& buffer, const size_t size) {
+    ZoneScoped;
+    size_t offset = 0;
+
+    while (offset < size) {
+        if (m_ended || size - offset < DELTA_INSTRUCTION_HEADER_SIZE) {
+            Debug::LogError("Malformed delta stream");
+            return false;
+        }
+
+        const auto [instruction, value] = DeltaSync::ReadInstruction(buffer.data() + offset);
+        offset += DELTA_INSTRUCTION_HEADER_SIZE;
+
+        bool applied = false;
+        if (instruction == DeltaInstruction::END) {
+            m_ended = true;
+            applied = true;
+        } else if (instruction == DeltaInstruction::COPY) {
+            applied = m_patcher.ApplyCopy(value);
+        } else if (instruction == DeltaInstruction::LITERAL && value <= size - offset) {
+            applied = m_patcher.ApplyLiteral(buffer.data() + offset, value);
+            offset += value;
+        }
+
+        if (!applied) {
+            Debug::LogError("Malformed delta stream");
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool DeltaFileSink::Finish(const HashDigest& digest) {
+    ZoneScoped;
+    m_finished = true;
+
+    if (!m_ended || m_patcher.GetWrittenSize() != m_totalSize) {
+        Debug::LogError("Delta result size mismatch");
+        m_patcher.Abort();
+        return false;
+    }
+
+    m_verified = m_hasher.Finish() == digest;
+
+    if (!m_verified) {
+        Debug::LogError("Integrity check failed for {}, keeping previous version", m_filePath.string());
+        m_patcher.Abort();
+        return true;
+    }
+
+    return m_patcher.Commit();
+}
+
+bool DeltaFileSink::IsVerified() const {
+    return m_verified;
+}
+
+ChunkedFileSink::ChunkedFileSink(std::filesystem::path filePath, const FileSizeInt totalSize)
+    : m_filePath(std::move(filePath)), m_totalSize(totalSize) {
+    m_temporaryPath = m_filePath;
+    m_temporaryPath += ".chunked";
+}
+
+ChunkedFileSink::~ChunkedFileSink() {
+    if (!m_finished) {
+        Abort();
+    }
+}
+
+bool ChunkedFileSink::Open() {
+    ZoneScoped;
+    m_output.open(m_temporaryPath, std::ios::binary | std::ios::trunc);
+    if (!m_output.is_open()) {
+        Debug::LogError("Could not open file");
+        return false;
+    }
+
+    return true;
+}
+
+bool ChunkedFileSink::Write(std::vector<char>& buffer, const size_t size) {
+    ZoneScoped;
+    size_t offset = 0;
+
+    while (offset < size) {
+        if (m_ended || size - offset < CHUNK_INSTRUCTION_HEADER_SIZE) {
+            Debug::LogError("Malformed chunk stream");
+            return false;
+        }
+
+        const auto [instruction, value] = ChunkStore::ReadInstruction(buffer.data() + offset);
+        offset += CHUNK_INSTRUCTION_HEADER_SIZE;
+
+        bool applied = false;
+        if (instruction == ChunkInstruction::END) {
+            m_ended = true;
+            applied = true;
+        } else if (instruction == ChunkInstruction::LITERAL && value <= size - offset && value <= CHUNK_STORE_MAX_CHUNK_SIZE) {
+            const char* data = buffer.data() + offset;
+            applied = ChunkStore::Store(ChunkStore::ComputeHash(data, value), data, value) && Append(data, value);
+            offset += value;
+        } else if (instruction == ChunkInstruction::REFERENCE && CHUNK_STORE_HASH_SIZE <= size - offset) {
+            ChunkHash hash;
+            std::memcpy(hash.data(), buffer.data() + offset, CHUNK_STORE_HASH_SIZE);
+            offset += CHUNK_STORE_HASH_SIZE;
+
+            if (!ChunkStore::Load(hash, m_chunk) || m_chunk.size() != value) {
+                Debug::LogError("Referenced chunk missing from local store");
+                return false;
+            }
+
+            applied = Append(m_chunk.data(), m_chunk.size());
+        }
+
+        if (!applied) {
+            Debug::LogError("Malformed chunk stream");
+            return false;
+        }
+    }
+
+    return true;
+}
+
+asio::awaitable<bool> ChunkedFileSink::CoWrite(std::vector<char>& buffer, const size_t size) {
+    // Literals are stored and references loaded from the chunk store, one file per chunk
+    co_return co_await CoRunBlockingWork([&] { return Write(buffer, size); });
+}
+
+bool ChunkedFileSink::Finish(const HashDigest& digest) {
+    ZoneScoped;
+    m_finished = true;
+
+    if (!m_ended || m_writtenSize != m_totalSize) {
+        Debug::LogError("Chunked result size mismatch");
+        Abort();
+        return false;
+    }
+
+    m_verified = m_hasher.Finish() == digest;
+
+    if (!m_verified) {
+        Debug::LogError("Integrity check failed for {}", m_filePath.string());
+        Abort();
+        return true;
+    }
+
+    m_output.close();
+
+    std::error_code errorCode;
+    std::filesystem::rename(m_temporaryPath, m_filePath, errorCode);
+    if (errorCode) {
+        Debug::LogError("Could not replace file ({})", errorCode.message());
+        return false;
+    }
+
+    return true;
+}
+
+bool ChunkedFileSink::IsVerified() const {
+    return m_verified;
+}
+
+bool ChunkedFileSink::Append(const char* data, const size_t size) {
+    m_output.write(data, static_cast<std::streamsize>(size));
+    m_hasher.Update(data, size);
+    m_writtenSize += size;
+    return m_output.good();
+}
+
+void ChunkedFileSink::Abort() {
+    ZoneScoped;
+    m_output.close();
+
+    std::error_code errorCode;
+    std::filesystem::remove(m_temporaryPath, errorCode);
+}
+
+TreeFileSink::TreeFileSink(std::filesystem::path rootPath, const PackageSizeInt manifestSize, const FileSizeInt contentSize)
+    : m_rootPath(std::move(rootPath)), m_manifestSize(manifestSize), m_contentSize(contentSize) { }
+
+TreeFileSink::~TreeFileSink() {
+    ZoneScoped;
+    if (m_verified || m_discarded) {
+        return;
+    }
+
+    // The stream was cut off or never finished: drop the queued files and remove whatever part of the tree arrived
+    m_writer.Cancel();
+    m_largeFile.close();
+    Discard();
+}
+
+bool TreeFileSink::Open() {
+    ZoneScoped;
+    if (m_manifestSize < sizeof(uint32_t) || m_manifestSize > TREE_MANIFEST_MAX_SIZE) {
+        Debug::LogError("Invalid directory manifest size");
+        return false;
+    }
+
+    std::error_code errorCode;
+    if (std::filesystem::create_directories(m_rootPath, errorCode)) {
+        m_createdDirectories.push_back(m_rootPath);
+    }
+
+    if (errorCode) {
+        Debug::LogError("Could not create directory ({})", errorCode.message());
+        return false;
+    }
+
+    m_manifest.reserve(m_manifestSize);
+    return true;
+}
+
+bool TreeFileSink::Write(std::vector<char>& buffer, const size_t size) {
+    ZoneScoped;
+    size_t offset = 0;
+
+    if (!m_manifestParsed) {
+        offset = std::min<size_t>(size, m_manifestSize - m_manifest.size());
+        m_manifest.insert(m_manifest.end(), buffer.data(), buffer.data() + offset);
+
+        if (m_manifest.size() == m_manifestSize && (!ParseManifest() || !OpenNextFile())) {
+            return false;
+        }
+    }
+
+    if (!ConsumeContent(buffer.data() + offset, size - offset)) {
+        return false;
+    }
+
+    m_hasher.Submit(std::move(buffer), size);
+    buffer = m_hasher.AcquireBuffer(FILE_BUFFER_SIZE);
+    return true;
+}
+
+bool TreeFileSink::Finish(const HashDigest& digest) {
+    ZoneScoped;
+    m_largeFile.close();
+
+    if (!m_writer.Wait()) {
+        Debug::LogError("Could not write directory {}", m_rootPath.string());
+        return false;
+    }
+
+    if (!m_manifestParsed || m_fileIndex != m_files.size()) {
+        Debug::LogError("Directory stream ended early");
+        return false;
+    }
+
+    m_verified = m_hasher.Finish() == digest;
+
+    if (!m_verified) {
+        Debug::LogError("Integrity check failed for {}, discarding received tree", m_rootPath.string());
+        Discard();
+    }
+
+    return true;
+}
+
+bool TreeFileSink::IsVerified() const {
+    return m_verified;
+}
+
+asio::awaitable<void> TreeFileSink::CoWaitWritable(const size_t size) {
+    co_await m_writer.CoWaitForSpace();
+    co_await FileTransferSink::CoWaitWritable(size);
+}
+
+asio::awaitable<bool> TreeFileSink::CoFinish(const HashDigest& digest) {
+    co_await m_writer.CoWait();
+    co_return co_await FileTransferSink::CoFinish(digest);
+}
+
+bool TreeFileSink::ParseManifest() {
+    ZoneScoped;
+    m_manifestParsed = true;
+
+    size_t   offset = 0;
+    uint32_t entryCount;
+    uint64_t contentSize = 0;
+
+    if (!ReadManifestValue(m_manifest, offset, entryCount)) {
+        Debug::LogError("Malformed directory manifest");
+        return false;
+    }
+
+    for (uint32_t i = 0; i < entryCount; ++i) {
+        uint8_t  type;
+        uint16_t pathSize;
+        uint64_t size;
+
+        if (!ReadManifestValue(m_manifest, offset, type) || !ReadManifestValue(m_manifest, offset, pathSize) || m_manifest.size() - offset < pathSize) {
+            Debug::LogError("Malformed directory manifest");
+            return false;
+        }
+
+        const std::filesystem::path relativePath = std::filesystem::path(std::string(m_manifest.data() + offset, pathSize)).lexically_normal();
+        offset += pathSize;
+
+        if (!ReadManifestValue(m_manifest, offset, size)) {
+            Debug::LogError("Malformed directory manifest");
+            return false;
+        }
+
+        if (relativePath.empty() || relativePath.has_root_path() || *relativePath.begin() == "..") {
+            Debug::LogError("Directory manifest escapes its root");
+            return false;
+        }
+
+        if (type == static_cast<uint8_t>(TreeEntryType::DIRECTORY)) {
+            std::error_code errorCode;
+            if (std::filesystem::create_directories(m_rootPath / relativePath, errorCode)) {
+                m_createdDirectories.push_back(m_rootPath / relativePath);
+            }
+
+            if (errorCode) {
+                Debug::LogError("Could not create directory ({})", errorCode.message());
+                return false;
+            }
+        } else if (type == static_cast<uint8_t>(TreeEntryType::FILE)) {
+            m_files.push_back({m_rootPath / relativePath, size});
+            contentSize += size;
+        } else {
+            Debug::LogError("Malformed directory manifest");
+            return false;
+        }
+    }
+
+    if (contentSize != m_contentSize) {
+        Debug::LogError("Directory manifest does not match its content size");
+        return false;
+    }
+
+    m_manifest = {};
+    return true;
+}
+
+bool TreeFileSink::ConsumeContent(const char* data, size_t size) {
+    while (size > 0) {
+        if (m_fileIndex >= m_files.size()) {
+            Debug::LogError("Directory stream exceeds its manifest");
+            return false;
+        }
+
+        const size_t writeSize = std::min<size_t>(size, m_fileRemaining);
+
+        if (m_files[m_fileIndex].size <= TREE_PARALLEL_WRITE_MAX_SIZE) {
+            m_smallFile.insert(m_smallFile.end(), data, data + writeSize);
+        } else {
+            m_largeFile.write(data, static_cast<std::streamsize>(writeSize));
+        }
+
+        data += writeSize;
+        size -= writeSize;
+        m_fileRemaining -= writeSize;
+
+        if (m_fileRemaining == 0 && !CompleteFile()) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool TreeFileSink::CompleteFile() {
+    const Entry& entry = m_files[m_fileIndex];
+
+    if (entry.size <= TREE_PARALLEL_WRITE_MAX_SIZE) {
+        m_writer.Write(entry.path, std::move(m_smallFile));
+        m_smallFile = {};
+    } else {
+        m_largeFile.close();
+        if (m_largeFile.fail()) {
+            Debug::LogError("Could not write file");
+            return false;
+        }
+    }
+
+    ++m_fileIndex;
+    return OpenNextFile();
+}
+
+bool TreeFileSink::OpenNextFile() {
+    while (m_fileIndex < m_files.size()) {
+        const Entry& entry = m_files[m_fileIndex];
+        m_fileRemaining = entry.size;
+
+        if (entry.size == 0) {
+            m_writer.Write(entry.path, {});
+            ++m_fileIndex;
+            continue;
+        }
+
+        if (entry.size <= TREE_PARALLEL_WRITE_MAX_SIZE) {
+            m_smallFile.reserve(entry.size);
+        } else {
+            m_largeFile.open(entry.path, std::ios::binary | std::ios::trunc);
+            if (!m_largeFile.is_open()) {
+                Debug::LogError("Could not open file");
+                return false;
+            }
+        }
+
+        break;
+    }
+
+    return true;
+}
+
+void TreeFileSink::Discard() {
+    ZoneScoped;
+    m_discarded = true;
+    std::error_code errorCode;
+
+    // Only files the stream reached were replaced; the large file in progress was truncated when it was opened
+    size_t reachedCount = std::min(m_fileIndex, m_files.size());
+    if (reachedCount < m_files.size() && m_files[reachedCount].size > TREE_PARALLEL_WRITE_MAX_SIZE) {
+        ++reachedCount;
+    }
+
+    for (size_t i = 0; i < reachedCount; ++i) {
+        std::filesystem::remove(m_files[i].path, errorCode);
+    }
+
+    // Directories are created parent first, so walking them backwards removes children before their parents;
+    // remove() leaves any directory that still holds files the sink did not write
+    for (auto directory = m_createdDirectories.rbegin(); directory != m_createdDirectories.rend(); ++directory) {
+        std::filesystem::remove(*directory, errorCode);
+    }
+}
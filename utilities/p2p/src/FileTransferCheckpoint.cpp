@@ -0,0 +1,269 @@
+#include <FileTransferCheckpoint.h>
+#include <DebugLog.h>
+#include <tracy/Tracy.hpp>
+#include <boost/endian/conversion.hpp>
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <limits>
+
+static constexpr std::array<char, 4> CHECKPOINT_MAGIC = {'P', 'C', 'C', 'K'};
+static constexpr uint8_t CHECKPOINT_VERSION = 1;
+
+std::mutex                                                             FileTransferCheckpoint::s_registryMutex{};
+std::unordered_map<std::string, std::weak_ptr<FileTransferCheckpoint>> FileTransferCheckpoint::s_registry{};
+
+FileTransferCheckpoint::FileTransferCheckpoint(std::filesystem::path filePath) : m_filePath(std::move(filePath)) {}
+
+std::shared_ptr<FileTransferCheckpoint> FileTransferCheckpoint::Acquire(const std::filesystem::path& filePath) {
+    ZoneScoped;
+    const std::string key = std::filesystem::absolute(filePath).lexically_normal().string();
+
+    std::lock_guard lock(s_registryMutex);
+
+    if (const auto it = s_registry.find(key); it != s_registry.end()) {
+        if (std::shared_ptr<FileTransferCheckpoint> checkpoint = it->second.lock()) {
+            return checkpoint;
+        }
+    }
+
+    auto checkpoint = std::make_shared<FileTransferCheckpoint>(filePath);
+    checkpoint->Load();
+    s_registry[key] = checkpoint;
+
+    return checkpoint;
+}
+
+std::filesystem::path FileTransferCheckpoint::GetSidecarPath(const std::filesystem::path& filePath) {
+    std::filesystem::path sidecarPath = filePath;
+    sidecarPath += ".checkpoint";
+    return sidecarPath;
+}
+
+void FileTransferCheckpoint::Reset(const FileSizeInt totalSize) {
+    ZoneScoped;
+    std::lock_guard lock(m_mutex);
+
+    m_totalSize = totalSize;
+    m_started = true;
+    m_receivedChunks.assign((GetChunkCount() + 7) / 8, 0);
+}
+
+void FileTransferCheckpoint::MarkReceived(const FileSizeInt offset, const FileSizeInt size) {
+    ZoneScoped;
+    std::lock_guard lock(m_mutex);
+
+    const uint64_t end = std::min<uint64_t>(offset + size, m_totalSize);
+    const uint64_t firstChunk = (offset + FILE_CHECKPOINT_CHUNK_SIZE - 1) / FILE_CHECKPOINT_CHUNK_SIZE;
+
+    for (uint64_t chunk = firstChunk; chunk < GetChunkCount(); ++chunk) {
+        const uint64_t chunkEnd = std::min<uint64_t>((chunk + 1) * FILE_CHECKPOINT_CHUNK_SIZE, m_totalSize);
+        if (chunkEnd > end) {
+            break;
+        }
+
+        SetChunkReceived(chunk, true);
+    }
+}
+
+void FileTransferCheckpoint::MarkMissing(const FileSizeInt offset, const FileSizeInt size) {
+    ZoneScoped;
+    std::lock_guard lock(m_mutex);
+
+    if (size == 0) {
+        return;
+    }
+
+    const uint64_t end = offset + size;
+    for (uint64_t chunk = offset / FILE_CHECKPOINT_CHUNK_SIZE; chunk < GetChunkCount() && chunk * FILE_CHECKPOINT_CHUNK_SIZE < end; ++chunk) {
+        SetChunkReceived(chunk, false);
+    }
+}
+
+std::vector<std::pair<FileSizeInt, FileSizeInt>> FileTransferCheckpoint::GetMissingRanges() const {
+    ZoneScoped;
+    std::lock_guard lock(m_mutex);
+    std::vector<std::pair<FileSizeInt, FileSizeInt>> ranges;
+
+    for (size_t chunk = 0; chunk < GetChunkCount(); ++chunk) {
+        if (IsChunkReceived(chunk)) {
+            continue;
+        }
+
+        const auto offset = static_cast<FileSizeInt>(chunk) * FILE_CHECKPOINT_CHUNK_SIZE;
+        const auto size = std::min<FileSizeInt>(FILE_CHECKPOINT_CHUNK_SIZE, m_totalSize - offset);
+
+        if (!ranges.empty() && ranges.back().first + ranges.back().second == offset) {
+            ranges.back().second += size;
+        } else {
+            ranges.emplace_back(offset, size);
+        }
+    }
+
+    return ranges;
+}
+
+FileSizeInt FileTransferCheckpoint::GetTotalSize() const {
+    std::lock_guard lock(m_mutex);
+    return m_totalSize;
+}
+
+bool FileTransferCheckpoint::IsStarted() const {
+    std::lock_guard lock(m_mutex);
+    return m_started;
+}
+
+bool FileTransferCheckpoint::IsComplete() const {
+    ZoneScoped;
+    std::lock_guard lock(m_mutex);
+
+    return m_started && IsEveryChunkReceived();
+}
+
+bool FileTransferCheckpoint::Save() const {
+    ZoneScoped;
+    std::lock_guard lock(m_mutex);
+
+    if (!m_started) {
+        return false;
+    }
+
+    const std::filesystem::path sidecarPath = GetSidecarPath(m_filePath);
+    std::filesystem::path temporaryPath = sidecarPath;
+    temporaryPath += ".tmp";
+
+    {
+        std::ofstream stream(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!stream.is_open()) {
+            Debug::LogError("Could not open checkpoint file");
+            return false;
+        }
+
+        const uint64_t totalSize = boost::endian::native_to_little(static_cast<uint64_t>(m_totalSize));
+        const uint32_t chunkSize = boost::endian::native_to_little(FILE_CHECKPOINT_CHUNK_SIZE);
+
+        stream.write(CHECKPOINT_MAGIC.data(), CHECKPOINT_MAGIC.size());
+        stream.write(reinterpret_cast<const char*>(&CHECKPOINT_VERSION), sizeof(CHECKPOINT_VERSION));
+        stream.write(reinterpret_cast<const char*>(&totalSize), sizeof(totalSize));
+        stream.write(reinterpret_cast<const char*>(&chunkSize), sizeof(chunkSize));
+        stream.write(reinterpret_cast<const char*>(m_receivedChunks.data()), static_cast<std::streamsize>(m_receivedChunks.size()));
+
+        if (!stream.good()) {
+            Debug::LogError("Could not write checkpoint file");
+            return false;
+        }
+    }
+
+    std::error_code errorCode;
+    std::filesystem::rename(temporaryPath, sidecarPath, errorCode);
+    if (errorCode) {
+        Debug::LogError("Could not replace checkpoint file ({})", errorCode.message());
+        return false;
+    }
+
+    return true;
+}
+
+void FileTransferCheckpoint::Remove() {
+    ZoneScoped;
+    std::lock_guard lock(m_mutex);
+
+    if (m_holds == 0) {
+        Clear();
+    }
+
+    std::error_code errorCode;
+    std::filesystem::remove(GetSidecarPath(m_filePath), errorCode);
+}
+
+void FileTransferCheckpoint::Hold() {
+    std::lock_guard lock(m_mutex);
+    ++m_holds;
+}
+
+void FileTransferCheckpoint::Release() {
+    ZoneScoped;
+    std::lock_guard lock(m_mutex);
+
+    if (--m_holds == 0 && m_started && IsEveryChunkReceived()) {
+        Clear();
+
+        std::error_code errorCode;
+        std::filesystem::remove(GetSidecarPath(m_filePath), errorCode);
+    }
+}
+
+bool FileTransferCheckpoint::Load() {
+    ZoneScoped;
+    std::lock_guard lock(m_mutex);
+
+    std::ifstream stream(GetSidecarPath(m_filePath), std::ios::binary);
+    if (!stream.is_open()) {
+        return false;
+    }
+
+    std::array<char, 4> magic{};
+    uint8_t version = 0;
+    uint64_t totalSize = 0;
+    uint32_t chunkSize = 0;
+
+    stream.read(magic.data(), magic.size());
+    stream.read(reinterpret_cast<char*>(&version), sizeof(version));
+    stream.read(reinterpret_cast<char*>(&totalSize), sizeof(totalSize));
+    stream.read(reinterpret_cast<char*>(&chunkSize), sizeof(chunkSize));
+
+    boost::endian::little_to_native_inplace(totalSize);
+    boost::endian::little_to_native_inplace(chunkSize);
+
+    if (!stream.good() || magic != CHECKPOINT_MAGIC || version != CHECKPOINT_VERSION || chunkSize != FILE_CHECKPOINT_CHUNK_SIZE) {
+        Debug::LogError("Discarding unreadable checkpoint for {}", m_filePath.string());
+        return false;
+    }
+
+    m_totalSize = totalSize;
+    m_receivedChunks.assign((GetChunkCount() + 7) / 8, 0);
+    stream.read(reinterpret_cast<char*>(m_receivedChunks.data()), static_cast<std::streamsize>(m_receivedChunks.size()));
+
+    if (!stream.good()) {
+        Debug::LogError("Discarding truncated checkpoint for {}", m_filePath.string());
+        m_totalSize = 0;
+        m_receivedChunks.clear();
+        return false;
+    }
+
+    m_started = true;
+    return true;
+}
+
+size_t FileTransferCheckpoint::GetChunkCount() const {
+    return (static_cast<uint64_t>(m_totalSize) + FILE_CHECKPOINT_CHUNK_SIZE - 1) / FILE_CHECKPOINT_CHUNK_SIZE;
+}
+
+bool FileTransferCheckpoint::IsChunkReceived(const size_t chunk) const {
+    return (m_receivedChunks[chunk / 8] & (1 << (chunk % 8))) != 0;
+}
+
+void FileTransferCheckpoint::SetChunkReceived(const size_t chunk, const bool received) {
+    if (received) {
+        m_receivedChunks[chunk / 8] |= static_cast<uint8_t>(1 << (chunk % 8));
+    } else {
+        m_receivedChunks[chunk / 8] &= static_cast<uint8_t>(~(1 << (chunk % 8)));
+    }
+}
+
+bool FileTransferCheckpoint::IsEveryChunkReceived() const {
+    for (size_t chunk = 0; chunk < GetChunkCount(); ++chunk) {
+        if (!IsChunkReceived(chunk)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void FileTransferCheckpoint::Clear() {
+    m_totalSize = 0;
+    m_started = false;
+    m_receivedChunks.clear();
+}
@@ -0,0 +1,99 @@
+#include <FileTransferScheduler.h>
+#include <tracy/Tracy.hpp>
+
+#include <algorithm>
+
+FileTransferScheduler::FileTransferScheduler(const FileSchedulingPolicy policy) : m_policy(policy) { }
+
+void FileTransferScheduler::SetPolicy(const FileSchedulingPolicy policy) {
+    m_policy = policy;
+}
+
+void FileTransferScheduler::Add(std::unique_ptr<FileTransferSource> source) {
+    ZoneScoped;
+    const uint64_t pass = GetMinimumPass();
+    m_entries.push_back({std::move(source), pass});
+}
+
+void FileTransferScheduler::Remove(const FileTransferSource* source) {
+    ZoneScoped;
+    const auto entry = Find(source);
+    if (entry == m_entries.end()) {
+        return;
+    }
+
+    const auto index = static_cast<size_t>(entry - m_entries.begin());
+    m_entries.erase(entry);
+
+    if (index < m_cursor) {
+        --m_cursor;
+    }
+
+    if (m_cursor >= m_entries.size()) {
+        m_cursor = 0;
+    }
+}
+
+void FileTransferScheduler::Charge(const FileTransferSource* source, const PackageSizeInt size) {
+    ZoneScoped;
+    const auto entry = Find(source);
+    if (entry == m_entries.end()) {
+        return;
+    }
+
+    entry->pass += std::max<uint64_t>(size, 1) * STRIDE / entry->source->GetWeight();
+}
+
+FileTransferSource* FileTransferScheduler::Next() {
+    ZoneScoped;
+    if (m_entries.empty()) {
+        return nullptr;
+    }
+
+    switch (m_policy) {
+        case FileSchedulingPolicy::SHORTEST_REMAINING_FIRST: {
+            const auto entry = std::ranges::min_element(m_entries, {}, [](const Entry& candidate) {
+                return candidate.source->GetRemainingSize();
+            });
+
+            return entry->source.get();
+        }
+        case FileSchedulingPolicy::WEIGHTED: {
+            const auto entry = std::ranges::min_element(m_entries, {}, &Entry::pass);
+            return entry->source.get();
+        }
+        case FileSchedulingPolicy::ROUND_ROBIN:
+        default: {
+            m_cursor %= m_entries.size();
+            FileTransferSource* source = m_entries[m_cursor].source.get();
+            ++m_cursor;
+            return source;
+        }
+    }
+}
+
+FileSchedulingPolicy FileTransferScheduler::GetPolicy() const {
+    return m_policy;
+}
+
+size_t FileTransferScheduler::GetSize() const {
+    return m_entries.size();
+}
+
+bool FileTransferScheduler::IsEmpty() const {
+    return m_entries.empty();
+}
+
+std::vector<FileTransferScheduler::Entry>::iterator FileTransferScheduler::Find(const FileTransferSource* source) {
+    return std::ranges::find_if(m_entries, [source](const Entry& entry) {
+        return entry.source.get() == source;
+    });
+}
+
+uint64_t FileTransferScheduler::GetMinimumPass() const {
+    if (m_entries.empty()) {
+        return 0;
+    }
+
+    return std::ranges::min_element(m_entries, {}, &Entry::pass)->pass;
+}
@@ -0,0 +1,109 @@
+#include <FileTransferTuner.h>
+#include <DebugLog.h>
+#include <FileTransfer.h>
+#include <Settings.h>
+#include <TcpConnectionInfo.h>
+#include <tracy/Tracy.hpp>
+
+#include <algorithm>
+#include <bit>
+
+FileTransferTuner::FileTransferTuner(const FileTransferDirection direction) : m_direction(direction) { }
+
+void FileTransferTuner::RecordTransfer(const size_t size, const std::chrono::steady_clock::duration elapsed) {
+    std::lock_guard lock(m_mutex);
+    m_sampleSize += size;
+    m_sampleTime += elapsed;
+}
+
+void FileTransferTuner::RecordRoundTripTime(const std::chrono::microseconds roundTripTime) {
+    std::lock_guard lock(m_mutex);
+    if (roundTripTime.count() <= 0) {
+        return;
+    }
+
+    if (m_tuning.roundTripTime.count() == 0) {
+        m_tuning.roundTripTime = roundTripTime;
+    } else {
+        m_tuning.roundTripTime = (7 * m_tuning.roundTripTime + roundTripTime) / 8;
+    }
+}
+
+void FileTransferTuner::RecordDeliveryRate(const uint64_t bytesPerSecond) {
+    std::lock_guard lock(m_mutex);
+    m_deliveryRate = bytesPerSecond;
+}
+
+bool FileTransferTuner::Update() {
+    ZoneScoped;
+    const auto [minChunkSize, maxChunkSize] = P2PSettings::GetFileChunkSizeBounds();
+    const auto [minBufferSize, maxBufferSize] = P2PSettings::GetSocketBufferSizeBounds();
+
+    std::lock_guard lock(m_mutex);
+
+    const auto sampleMicroseconds = std::chrono::duration_cast<std::chrono::microseconds>(m_sampleTime).count();
+    if (m_sampleSize < FILE_TUNING_SAMPLE_SIZE || sampleMicroseconds <= 0) {
+        return false;
+    }
+
+    // A completed write only means the data was copied into the socket buffer, so the kernel's delivery rate wins when known
+    const uint64_t bandwidth = m_deliveryRate != 0 ? m_deliveryRate : m_sampleSize * 1'000'000ull / static_cast<uint64_t>(sampleMicroseconds);
+    m_tuning.bandwidth = m_tuning.bandwidth == 0 ? bandwidth : (3 * m_tuning.bandwidth + bandwidth) / 4;
+    m_sampleSize = 0;
+    m_sampleTime = std::chrono::steady_clock::duration::zero();
+    m_deliveryRate = 0;
+
+    if (m_tuning.roundTripTime.count() == 0) {
+        return false;
+    }
+
+    const uint64_t bandwidthDelayProduct = m_tuning.bandwidth * static_cast<uint64_t>(m_tuning.roundTripTime.count()) / 1'000'000ull;
+
+    const auto chunkSize = static_cast<PackageSizeInt>(std::clamp<uint64_t>(std::bit_floor(std::max<uint64_t>(bandwidthDelayProduct, 1)), minChunkSize, std::min(maxChunkSize, FILE_CHUNK_MAX_SIZE)));
+    const auto socketBufferSize = static_cast<PackageSizeInt>(std::clamp<uint64_t>(2 * bandwidthDelayProduct, minBufferSize, maxBufferSize));
+
+    if (chunkSize == m_tuning.chunkSize && socketBufferSize == m_tuning.socketBufferSize) {
+        return false;
+    }
+
+    m_tuning.chunkSize = chunkSize;
+    m_tuning.socketBufferSize = socketBufferSize;
+    return true;
+}
+
+void FileTransferTuner::Tune(TCPSocket::lowest_layer_type& socket) {
+    ZoneScoped;
+    if (TcpConnectionInfo info; TcpConnectionInfo::Query(static_cast<int>(socket.native_handle()), info)) {
+        RecordRoundTripTime(info.roundTripTime);
+
+        // The delivery rate describes data this side sends, and an application-limited sample understates the link;
+        // a receiver's reads already wait on the link, so its own timing stands
+        if (m_direction == FileTransferDirection::SEND && info.deliveryRate != 0 && !info.applicationLimited) {
+            RecordDeliveryRate(info.deliveryRate);
+        }
+    }
+
+    if (!Update()) {
+        return;
+    }
+
+    // The buffer size is only reported: setting SO_SNDBUF or SO_RCVBUF on a connected socket turns off kernel autotuning
+    const FileTransferTuning tuning = GetTuning();
+    Debug::Log("File stream tuned to {} byte chunks, link needs a {} byte socket buffer ({} B/s, {} us RTT)",
+        tuning.chunkSize, tuning.socketBufferSize, tuning.bandwidth, tuning.roundTripTime.count());
+}
+
+bool FileTransferTuner::IsUpdateDue() const {
+    std::lock_guard lock(m_mutex);
+    return m_sampleSize >= FILE_TUNING_SAMPLE_SIZE;
+}
+
+PackageSizeInt FileTransferTuner::GetChunkSize() const {
+    std::lock_guard lock(m_mutex);
+    return m_tuning.chunkSize;
+}
+
+FileTransferTuning FileTransferTuner::GetTuning() const {
+    std::lock_guard lock(m_mutex);
+    return m_tuning;
+}
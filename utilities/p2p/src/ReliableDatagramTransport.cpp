@@ -0,0 +1,930 @@
+#include <ReliableDatagramTransport.h>
+#include <Settings.h>
+#include <tracy/Tracy.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+template <typename V>
+static void AppendValue(std::vector<char>& datagram, V value) {
+    boost::endian::native_to_big_inplace(value);
+    const auto* bytes = reinterpret_cast<const char*>(&value);
+    datagram.insert(datagram.end(), bytes, bytes + sizeof(V));
+}
+
+template <typename V>
+static V ReadValue(const char* data) {
+    V value;
+    std::memcpy(&value, data, sizeof(V));
+    boost::endian::big_to_native_inplace(value);
+    return value;
+}
+
+static void AppendHeader(std::vector<char>& datagram, ReliablePacketHeader header) {
+    header.FromNativeToBigEndian();
+    const auto* bytes = reinterpret_cast<const char*>(&header);
+    datagram.insert(datagram.begin(), bytes, bytes + sizeof(ReliablePacketHeader));
+}
+
+ReliableDatagramTransport::ReliableDatagramTransport(asio::any_io_executor executor, const size_t streamCount)
+    : m_executor(std::move(executor)), m_streamCount(streamCount), m_socket(m_executor), m_sendTimer(m_executor), m_establishedFlag(m_executor),
+      m_sendStreams(streamCount), m_receiveStreams(streamCount),
+      m_congestionController(CongestionController::Create(P2PSettings::GetCongestionControlAlgorithm())) {
+    for (size_t i = 0; i < streamCount; i++) {
+        m_streams.emplace_back(*this, i);
+    }
+}
+
+uint16_t ReliableDatagramTransport::Bind(const UDPEndpoint& endpoint) {
+    ZoneScoped;
+    m_socket.open(endpoint.protocol());
+
+    if (endpoint.address().is_v6()) {
+        asio::error_code errorCode;
+        m_socket.set_option(asio::ip::v6_only(false), errorCode);
+    }
+
+    m_socket.bind(endpoint);
+    return m_socket.local_endpoint().port();
+}
+
+asio::awaitable<void> ReliableDatagramTransport::Accept() {
+    {
+        std::lock_guard lock(m_mutex);
+        if (m_state != State::IDLE) {
+            throw asio::system_error(asio::error::already_started);
+        }
+
+        m_state = State::LISTENING;
+    }
+
+    Start();
+    co_await m_establishedFlag.Wait();
+
+    std::lock_guard lock(m_mutex);
+    if (m_state != State::ESTABLISHED) {
+        throw asio::system_error(m_errorCode);
+    }
+}
+
+asio::awaitable<void> ReliableDatagramTransport::Connect(const UDPEndpoint& peer) {
+    if (!m_socket.is_open()) {
+        Bind(UDPEndpoint(peer.protocol(), 0));
+    }
+
+    {
+        std::lock_guard lock(m_mutex);
+        if (m_state != State::IDLE) {
+            throw asio::system_error(asio::error::already_started);
+        }
+
+        const Clock::time_point now = Clock::now();
+        m_peer = peer;
+        m_connectionID = std::uniform_int_distribution<uint32_t>(1, UINT32_MAX)(m_random);
+        m_state = State::CONNECTING;
+        m_handshakeDeadline = now + RELIABLE_HANDSHAKE_TIMEOUT;
+        m_nextHelloTime = now;
+    }
+
+    Start();
+    co_await m_establishedFlag.Wait();
+
+    std::lock_guard lock(m_mutex);
+    if (m_state != State::ESTABLISHED) {
+        throw asio::system_error(m_errorCode);
+    }
+}
+
+void ReliableDatagramTransport::Close() {
+    ZoneScoped;
+    Shutdown(asio::error::operation_aborted, true);
+}
+
+void ReliableDatagramTransport::SetImpairment(const DatagramImpairment& impairment) {
+    std::lock_guard lock(m_mutex);
+    m_impairment = impairment;
+}
+
+void ReliableDatagramTransport::SetCongestionController(std::unique_ptr<CongestionController> controller) {
+    if (controller == nullptr) {
+        return;
+    }
+
+    std::lock_guard lock(m_mutex);
+    m_congestionController = std::move(controller);
+}
+
+bool ReliableDatagramTransport::IsOpen() const {
+    std::lock_guard lock(m_mutex);
+    return m_state != State::IDLE && m_state != State::CLOSED;
+}
+
+bool ReliableDatagramTransport::IsClosed() const {
+    std::lock_guard lock(m_mutex);
+    return m_state == State::CLOSED;
+}
+
+UDPEndpoint ReliableDatagramTransport::GetPeer() const {
+    std::lock_guard lock(m_mutex);
+    return m_peer;
+}
+
+std::chrono::microseconds ReliableDatagramTransport::GetRoundTripTime() const {
+    std::lock_guard lock(m_mutex);
+    if (!m_hasRoundTripTime) {
+        return std::chrono::microseconds::zero();
+    }
+
+    return std::chrono::duration_cast<std::chrono::microseconds>(m_smoothedRoundTripTime);
+}
+
+ReliableTransportStats ReliableDatagramTransport::GetStats() const {
+    std::lock_guard lock(m_mutex);
+    return {
+        std::chrono::duration_cast<std::chrono::microseconds>(m_smoothedRoundTripTime),
+        m_congestionController->GetCongestionWindow(),
+        m_bytesInFlight,
+        m_packetsSent,
+        m_packetsLost
+    };
+}
+
+ReliableDatagramTransport::Stream& ReliableDatagramTransport::GetStream(const MultiplexedStream stream) {
+    return m_streams[static_cast<size_t>(stream)];
+}
+
+void ReliableDatagramTransport::InsertRange(std::map<uint64_t, uint64_t>& ranges, uint64_t begin, uint64_t end) {
+    auto next = ranges.upper_bound(begin);
+
+    if (next != ranges.begin()) {
+        const auto previous = std::prev(next);
+        if (previous->second >= begin) {
+            begin = previous->first;
+            end = std::max(end, previous->second);
+            next = ranges.erase(previous);
+        }
+    }
+
+    while (next != ranges.end() && next->first <= end) {
+        end = std::max(end, next->second);
+        next = ranges.erase(next);
+    }
+
+    ranges.emplace(begin, end);
+}
+
+size_t ReliableDatagramTransport::Read(const size_t index, void* destination, const size_t size) {
+    ZoneScoped;
+    bool windowUpdate = false;
+    size_t read;
+
+    {
+        std::lock_guard lock(m_mutex);
+        ReceiveStream& stream = m_receiveStreams[index];
+
+        read = std::min(size, stream.readable.size());
+        std::copy_n(stream.readable.begin(), read, static_cast<char*>(destination));
+        stream.readable.erase(stream.readable.begin(), stream.readable.begin() + static_cast<std::ptrdiff_t>(read));
+        stream.consumedOffset += read;
+
+        if (m_state == State::ESTABLISHED && stream.consumedOffset + RELIABLE_STREAM_WINDOW - stream.advertisedLimit >= RELIABLE_STREAM_WINDOW_UPDATE_THRESHOLD) {
+            m_ackPending = true;
+            m_ackDeadline = Clock::now();
+            windowUpdate = true;
+        }
+    }
+
+    if (windowUpdate) {
+        Wake();
+    }
+
+    return read;
+}
+
+size_t ReliableDatagramTransport::Write(const size_t index, const void* source, const size_t size) {
+    ZoneScoped;
+    size_t written;
+
+    {
+        std::lock_guard lock(m_mutex);
+        if (m_state == State::CLOSED) {
+            return 0;
+        }
+
+        SendStream& stream = m_sendStreams[index];
+        const auto* bytes = static_cast<const char*>(source);
+
+        written = std::min(size, RELIABLE_STREAM_BUFFER_SIZE - stream.buffer.size());
+        stream.buffer.insert(stream.buffer.end(), bytes, bytes + written);
+    }
+
+    if (written > 0) {
+        Wake();
+    }
+
+    return written;
+}
+
+void ReliableDatagramTransport::Park(const size_t index, const bool isWrite, std::move_only_function<void()> waiter) {
+    bool ready;
+
+    {
+        std::lock_guard lock(m_mutex);
+        if (isWrite) {
+            ready = m_state == State::CLOSED || m_sendStreams[index].buffer.size() < RELIABLE_STREAM_BUFFER_SIZE;
+        } else {
+            ready = m_state == State::CLOSED || !m_receiveStreams[index].readable.empty();
+        }
+
+        if (!ready) {
+            (isWrite ? m_sendStreams[index].waiter : m_receiveStreams[index].waiter) = std::move(waiter);
+        }
+    }
+
+    if (ready) {
+        asio::post(m_executor, std::move(waiter));
+    }
+}
+
+void ReliableDatagramTransport::Resume(std::move_only_function<void()>& waiter) const {
+    if (waiter) {
+        asio::post(m_executor, std::move(waiter));
+        waiter = nullptr;
+    }
+}
+
+void ReliableDatagramTransport::Start() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_lastReceiveTime = Clock::now();
+        m_lastSendTime = m_lastReceiveTime;
+    }
+
+    asio::co_spawn(m_executor, CoReceive(shared_from_this()), asio::detached);
+    asio::co_spawn(m_executor, CoSend(shared_from_this()), asio::detached);
+}
+
+void ReliableDatagramTransport::Wake() {
+    if (m_wakePending.exchange(true)) {
+        return;
+    }
+
+    asio::post(m_executor, [transport = shared_from_this()] {
+        transport->m_sendTimer.cancel();
+    });
+}
+
+void ReliableDatagramTransport::Shutdown(const asio::error_code& errorCode, const bool notifyPeer) {
+    ZoneScoped;
+    bool sendClose;
+
+    {
+        std::lock_guard lock(m_mutex);
+        if (m_state == State::CLOSED) {
+            return;
+        }
+
+        sendClose = notifyPeer && m_state == State::ESTABLISHED;
+        m_state = State::CLOSED;
+        m_errorCode = errorCode;
+
+        for (size_t i = 0; i < m_streamCount; i++) {
+            Resume(m_sendStreams[i].waiter);
+            Resume(m_receiveStreams[i].waiter);
+        }
+    }
+
+    m_establishedFlag.Signal();
+
+    asio::post(m_executor, [transport = shared_from_this(), sendClose] {
+        transport->m_sendTimer.cancel();
+
+        if (!sendClose || !transport->m_socket.is_open()) {
+            transport->CloseSocket();
+            return;
+        }
+
+        auto datagram = std::make_shared<std::vector<char>>();
+        {
+            std::lock_guard lock(transport->m_mutex);
+            transport->BuildControl(*datagram, ReliablePacketType::CLOSE);
+        }
+
+        transport->m_socket.async_send_to(asio::buffer(*datagram), transport->m_peer, [transport, datagram](const asio::error_code&, size_t) {
+            transport->CloseSocket();
+        });
+    });
+}
+
+void ReliableDatagramTransport::CloseSocket() {
+    asio::error_code errorCode;
+    m_socket.close(errorCode);
+}
+
+asio::awaitable<void> ReliableDatagramTransport::CoReceive(std::shared_ptr<ReliableDatagramTransport> transport) {
+    std::vector<char> buffer(RELIABLE_DATAGRAM_MAX_SIZE);
+    UDPEndpoint sender;
+
+    while (transport->m_socket.is_open()) {
+        asio::error_code errorCode;
+        const size_t size = co_await transport->m_socket.async_receive_from(asio::buffer(buffer), sender, asio::redirect_error(asio::use_awaitable, errorCode));
+
+        if (errorCode == asio::error::operation_aborted || errorCode == asio::error::bad_descriptor || transport->IsClosed()) {
+            co_return;
+        }
+
+        if (errorCode || size < sizeof(ReliablePacketHeader)) {
+            continue;
+        }
+
+        ReliablePacketHeader header;
+        std::memcpy(&header, buffer.data(), sizeof(ReliablePacketHeader));
+        header.FromBigEndianToNative();
+
+        if (sizeof(ReliablePacketHeader) + header.size != size) {
+            continue;
+        }
+
+        transport->ProcessPacket(header, buffer.data() + sizeof(ReliablePacketHeader), sender, Clock::now());
+    }
+}
+
+asio::awaitable<void> ReliableDatagramTransport::CoSend(std::shared_ptr<ReliableDatagramTransport> transport) {
+    while (true) {
+        auto datagram = std::make_shared<std::vector<char>>();
+        Clock::time_point deadline = Clock::time_point::max();
+        bool built = false;
+        bool expired = false;
+
+        transport->m_wakePending.store(false);
+
+        {
+            std::lock_guard lock(transport->m_mutex);
+            if (transport->m_state == State::CLOSED) {
+                co_return;
+            }
+
+            const Clock::time_point now = Clock::now();
+            expired = !transport->HandleTimers(now);
+
+            if (!expired) {
+                built = transport->BuildPacket(*datagram, now, deadline);
+            }
+        }
+
+        if (expired) {
+            transport->Shutdown(asio::error::timed_out, true);
+            co_return;
+        }
+
+        if (built) {
+            co_await transport->CoSendDatagram(datagram);
+            continue;
+        }
+
+        if (transport->m_wakePending.load()) {
+            continue;
+        }
+
+        asio::error_code errorCode;
+        transport->m_sendTimer.expires_at(deadline);
+        co_await transport->m_sendTimer.async_wait(asio::redirect_error(asio::use_awaitable, errorCode));
+    }
+}
+
+asio::awaitable<void> ReliableDatagramTransport::CoSendDatagram(std::shared_ptr<std::vector<char>> datagram) {
+    DatagramImpairment impairment;
+    UDPEndpoint peer;
+    double roll;
+    std::chrono::microseconds delay;
+
+    {
+        std::lock_guard lock(m_mutex);
+        impairment = m_impairment;
+        peer = m_peer;
+        roll = std::uniform_real_distribution<double>(0.0, 1.0)(m_random);
+        delay = impairment.latency;
+
+        if (impairment.jitter.count() > 0) {
+            delay += std::chrono::microseconds(std::uniform_int_distribution<int64_t>(0, impairment.jitter.count())(m_random));
+        }
+    }
+
+    if (roll < impairment.lossRate) {
+        co_return;
+    }
+
+    if (delay.count() > 0) {
+        auto timer = std::make_shared<asio::steady_timer>(m_executor, delay);
+        timer->async_wait([transport = shared_from_this(), timer, datagram, peer](const asio::error_code& errorCode) {
+            if (errorCode || !transport->m_socket.is_open()) {
+                return;
+            }
+
+            transport->m_socket.async_send_to(asio::buffer(*datagram), peer, [transport, datagram](const asio::error_code&, size_t) { });
+        });
+
+        co_return;
+    }
+
+    asio::error_code errorCode;
+    co_await m_socket.async_send_to(asio::buffer(*datagram), peer, asio::redirect_error(asio::use_awaitable, errorCode));
+}
+
+void ReliableDatagramTransport::ProcessPacket(const ReliablePacketHeader& header, const char* payload, const UDPEndpoint& sender, const Clock::time_point now) {
+    ZoneScoped;
+    const auto type = static_cast<ReliablePacketType>(header.type);
+    bool established = false;
+    bool closed = false;
+
+    {
+        std::lock_guard lock(m_mutex);
+        switch (m_state) {
+            case State::LISTENING:
+                if (type != ReliablePacketType::HELLO || header.connectionID == 0) {
+                    return;
+                }
+
+                m_peer = sender;
+                m_connectionID = header.connectionID;
+                m_state = State::ESTABLISHED;
+                m_helloAckPending = true;
+                m_lastReceiveTime = now;
+                established = true;
+                break;
+
+            case State::CONNECTING:
+            case State::ESTABLISHED:
+                if (sender != m_peer || header.connectionID != m_connectionID) {
+                    return;
+                }
+
+                if (m_state == State::CONNECTING) {
+                    m_state = State::ESTABLISHED;
+                    established = true;
+                }
+
+                m_lastReceiveTime = now;
+
+                switch (type) {
+                    case ReliablePacketType::HELLO:
+                        m_helloAckPending = true;
+                        break;
+                    case ReliablePacketType::DATA:
+                        RecordPacket(header.packetNumber, now);
+                        ProcessData(header, payload);
+                        break;
+                    case ReliablePacketType::ACK:
+                        ProcessAck(payload, header.size, now);
+                        break;
+                    case ReliablePacketType::PING:
+                        RecordPacket(header.packetNumber, now);
+                        break;
+                    case ReliablePacketType::BLOCKED:
+                        // The ACK carries the stream limits, so answering at once re-sends a window update that may have been lost
+                        RecordPacket(header.packetNumber, now);
+                        m_ackDeadline = now;
+                        break;
+                    case ReliablePacketType::CLOSE:
+                        closed = true;
+                        break;
+                    default:
+                        break;
+                }
+                break;
+
+            default:
+                return;
+        }
+    }
+
+    if (established) {
+        m_establishedFlag.Signal();
+    }
+
+    if (closed) {
+        Shutdown(asio::error::eof, false);
+        return;
+    }
+
+    Wake();
+}
+
+void ReliableDatagramTransport::RecordPacket(const uint64_t packetNumber, const Clock::time_point now) {
+    bool immediate = packetNumber <= m_largestReceived || (m_largestReceived != 0 && packetNumber != m_largestReceived + 1);
+
+    InsertRange(m_receivedPackets, packetNumber, packetNumber + 1);
+    while (m_receivedPackets.size() > RELIABLE_MAX_ACK_RANGES) {
+        m_receivedPackets.erase(m_receivedPackets.begin());
+    }
+
+    if (packetNumber > m_largestReceived) {
+        m_largestReceived = packetNumber;
+        m_largestReceivedTime = now;
+    }
+
+    if (!m_ackPending) {
+        m_ackPending = true;
+        m_ackDeadline = now + RELIABLE_MAX_ACK_DELAY;
+    }
+
+    if (++m_unackedCount >= RELIABLE_ACK_FREQUENCY) {
+        immediate = true;
+    }
+
+    if (immediate) {
+        m_ackDeadline = now;
+    }
+}
+
+void ReliableDatagramTransport::ProcessData(const ReliablePacketHeader& header, const char* payload) {
+    ZoneScoped;
+    if (header.stream >= m_streamCount) {
+        return;
+    }
+
+    ReceiveStream& stream = m_receiveStreams[header.stream];
+    const uint64_t begin = header.offset;
+    const uint64_t end = begin + header.size;
+
+    if (end <= stream.receivedOffset || end > stream.consumedOffset + RELIABLE_STREAM_WINDOW) {
+        return;
+    }
+
+    if (begin > stream.receivedOffset) {
+        // Only the bytes no other segment holds are kept, so everything buffered stays within the advertised window
+        uint64_t position = begin;
+        auto next = stream.segments.upper_bound(position);
+
+        if (next != stream.segments.begin()) {
+            const auto previous = std::prev(next);
+            position = std::max<uint64_t>(position, previous->first + previous->second.size());
+        }
+
+        while (position < end) {
+            const uint64_t gapEnd = next != stream.segments.end() ? std::min(end, next->first) : end;
+            if (gapEnd > position) {
+                stream.segments.emplace_hint(next, position, std::vector<char>(payload + (position - begin), payload + (gapEnd - begin)));
+            }
+
+            if (next == stream.segments.end()) {
+                break;
+            }
+
+            position = std::max<uint64_t>(position, next->first + next->second.size());
+            ++next;
+        }
+
+        return;
+    }
+
+    stream.readable.insert(stream.readable.end(), payload + (stream.receivedOffset - begin), payload + header.size);
+    stream.receivedOffset = end;
+
+    for (auto segment = stream.segments.begin(); segment != stream.segments.end() && segment->first <= stream.receivedOffset; segment = stream.segments.erase(segment)) {
+        const uint64_t segmentEnd = segment->first + segment->second.size();
+        if (segmentEnd > stream.receivedOffset) {
+            stream.readable.insert(stream.readable.end(), segment->second.begin() + static_cast<std::ptrdiff_t>(stream.receivedOffset - segment->first), segment->second.end());
+            stream.receivedOffset = segmentEnd;
+        }
+    }
+
+    Resume(stream.waiter);
+}
+
+void ReliableDatagramTransport::ProcessAck(const char* payload, const size_t size, const Clock::time_point now) {
+    ZoneScoped;
+    if (size < sizeof(ReliableAckHeader)) {
+        return;
+    }
+
+    ReliableAckHeader ackHeader;
+    std::memcpy(&ackHeader, payload, sizeof(ReliableAckHeader));
+    ackHeader.FromBigEndianToNative();
+
+    if (size != sizeof(ReliableAckHeader) + ackHeader.rangeCount * 2 * sizeof(uint64_t) + ackHeader.streamCount * sizeof(uint64_t)) {
+        return;
+    }
+
+    const char* cursor = payload + sizeof(ReliableAckHeader);
+    uint64_t largest = 0;
+    Clock::time_point largestSentTime;
+
+    for (uint16_t i = 0; i < ackHeader.rangeCount; i++, cursor += 2 * sizeof(uint64_t)) {
+        const auto first = ReadValue<uint64_t>(cursor);
+        const auto last = ReadValue<uint64_t>(cursor + sizeof(uint64_t));
+
+        for (auto packet = m_sentPackets.lower_bound(first); packet != m_sentPackets.end() && packet->first <= last; packet = m_sentPackets.erase(packet)) {
+            const SentPacket& sent = packet->second;
+            m_bytesInFlight -= sent.size;
+            m_congestionController->OnPacketAcked(sent.size, sent.sentTime, now);
+            MarkAcked(m_sendStreams[sent.stream], sent.offset, sent.payloadSize);
+
+            if (packet->first > largest) {
+                largest = packet->first;
+                largestSentTime = sent.sentTime;
+            }
+        }
+    }
+
+    for (uint16_t i = 0; i < ackHeader.streamCount; i++, cursor += sizeof(uint64_t)) {
+        if (i < m_streamCount) {
+            SendStream& stream = m_sendStreams[i];
+            const auto limit = ReadValue<uint64_t>(cursor);
+
+            if (limit > stream.peerLimit) {
+                stream.peerLimit = limit;
+                m_blockedCount = 0;
+            }
+        }
+    }
+
+    if (largest == 0) {
+        return;
+    }
+
+    if (largest > m_largestAcked) {
+        m_largestAcked = largest;
+        UpdateRoundTripTime(now - largestSentTime, std::chrono::microseconds(ackHeader.ackDelay));
+    }
+
+    m_ptoCount = 0;
+    DetectLosses(now);
+}
+
+void ReliableDatagramTransport::MarkAcked(SendStream& stream, const uint64_t offset, const size_t size) {
+    if (offset + size <= stream.ackedOffset) {
+        return;
+    }
+
+    InsertRange(stream.ackedRanges, offset, offset + size);
+
+    const auto range = stream.ackedRanges.begin();
+    if (range->first > stream.ackedOffset) {
+        return;
+    }
+
+    const uint64_t end = range->second;
+    stream.ackedRanges.erase(range);
+    stream.buffer.erase(stream.buffer.begin(), stream.buffer.begin() + static_cast<std::ptrdiff_t>(end - stream.ackedOffset));
+    stream.ackedOffset = end;
+
+    Resume(stream.waiter);
+}
+
+void ReliableDatagramTransport::DeclareLost(const SentPacket& packet, const Clock::time_point now) {
+    m_bytesInFlight -= packet.size;
+    m_sendStreams[packet.stream].retransmissions.emplace_back(packet.offset, packet.payloadSize);
+    m_congestionController->OnPacketLost(packet.sentTime, now);
+    m_packetsLost++;
+}
+
+void ReliableDatagramTransport::DetectLosses(const Clock::time_point now) {
+    ZoneScoped;
+    m_lossTime = Clock::time_point::max();
+    if (m_largestAcked == 0) {
+        return;
+    }
+
+    const Clock::duration lossDelay = std::max<Clock::duration>(9 * std::max(m_smoothedRoundTripTime, m_latestRoundTripTime) / 8, std::chrono::milliseconds(1));
+
+    for (auto packet = m_sentPackets.begin(); packet != m_sentPackets.end() && packet->first < m_largestAcked;) {
+        if (m_largestAcked - packet->first >= RELIABLE_PACKET_THRESHOLD || packet->second.sentTime + lossDelay <= now) {
+            DeclareLost(packet->second, now);
+            packet = m_sentPackets.erase(packet);
+            continue;
+        }
+
+        m_lossTime = std::min(m_lossTime, packet->second.sentTime + lossDelay);
+        ++packet;
+    }
+}
+
+void ReliableDatagramTransport::UpdateRoundTripTime(const Clock::duration latest, Clock::duration ackDelay) {
+    m_latestRoundTripTime = latest;
+
+    if (!m_hasRoundTripTime) {
+        m_hasRoundTripTime = true;
+        m_minRoundTripTime = latest;
+        m_smoothedRoundTripTime = latest;
+        m_roundTripTimeVariance = latest / 2;
+        return;
+    }
+
+    m_minRoundTripTime = std::min(m_minRoundTripTime, latest);
+    ackDelay = std::min<Clock::duration>(ackDelay, RELIABLE_MAX_ACK_DELAY);
+
+    const Clock::duration adjusted = latest >= m_minRoundTripTime + ackDelay ? latest - ackDelay : latest;
+    const Clock::duration difference = m_smoothedRoundTripTime > adjusted ? m_smoothedRoundTripTime - adjusted : adjusted - m_smoothedRoundTripTime;
+
+    m_roundTripTimeVariance = (3 * m_roundTripTimeVariance + difference) / 4;
+    m_smoothedRoundTripTime = (7 * m_smoothedRoundTripTime + adjusted) / 8;
+}
+
+bool ReliableDatagramTransport::HandleTimers(const Clock::time_point now) {
+    if (m_state == State::CONNECTING) {
+        return now < m_handshakeDeadline;
+    }
+
+    if (m_state != State::ESTABLISHED) {
+        return true;
+    }
+
+    if (now - m_lastReceiveTime >= RELIABLE_IDLE_TIMEOUT) {
+        return false;
+    }
+
+    if (m_lossTime <= now) {
+        DetectLosses(now);
+    }
+
+    if (!m_sentPackets.empty() && m_lastAckElicitingTime + GetProbeTimeout() <= now) {
+        const auto oldest = m_sentPackets.begin();
+        const SentPacket& packet = oldest->second;
+
+        m_bytesInFlight -= packet.size;
+        m_sendStreams[packet.stream].retransmissions.emplace_front(packet.offset, packet.payloadSize);
+        m_sentPackets.erase(oldest);
+        m_packetsLost++;
+
+        if (++m_ptoCount >= 2) {
+            m_congestionController->OnRetransmissionTimeout();
+        }
+
+        m_probeCount = 1;
+        m_lastAckElicitingTime = now;
+    }
+
+    return true;
+}
+
+bool ReliableDatagramTransport::BuildPacket(std::vector<char>& datagram, const Clock::time_point now, Clock::time_point& deadline) {
+    ZoneScoped;
+    if (m_state == State::CONNECTING) {
+        if (now >= m_nextHelloTime) {
+            BuildControl(datagram, ReliablePacketType::HELLO);
+            m_nextHelloTime = now + m_helloInterval;
+            m_helloInterval = std::min<Clock::duration>(m_helloInterval * 2, RELIABLE_HANDSHAKE_MAX_INTERVAL);
+            return true;
+        }
+
+        deadline = std::min(m_nextHelloTime, m_handshakeDeadline);
+        return false;
+    }
+
+    if (m_state != State::ESTABLISHED) {
+        return false;
+    }
+
+    if (m_helloAckPending) {
+        m_helloAckPending = false;
+        BuildControl(datagram, ReliablePacketType::HELLO_ACK);
+        return true;
+    }
+
+    if (m_ackPending && m_ackDeadline <= now) {
+        BuildAck(datagram, now);
+        return true;
+    }
+
+    if (m_ackPending) {
+        deadline = std::min(deadline, m_ackDeadline);
+    }
+
+    deadline = std::min(deadline, m_lossTime);
+    deadline = std::min(deadline, m_lastReceiveTime + RELIABLE_IDLE_TIMEOUT);
+
+    if (!m_sentPackets.empty()) {
+        deadline = std::min(deadline, m_lastAckElicitingTime + GetProbeTimeout());
+    }
+
+    if (m_probeCount > 0 || m_bytesInFlight + RELIABLE_DATAGRAM_MAX_SIZE <= m_congestionController->GetCongestionWindow()) {
+        if (m_probeCount == 0 && m_nextSendTime > now) {
+            deadline = std::min(deadline, m_nextSendTime);
+        } else if (BuildData(datagram, now)) {
+            m_probeCount -= m_probeCount > 0 ? 1 : 0;
+            m_lastSendTime = now;
+            return true;
+        }
+    }
+
+    // Window updates ride on ACKs, which are never retransmitted, so a sender stalled on credit asks again after each probe timeout
+    if (m_sentPackets.empty() && IsFlowControlBlocked()) {
+        if (now >= m_nextBlockedTime) {
+            BuildControl(datagram, ReliablePacketType::BLOCKED);
+            m_nextBlockedTime = now + GetProbeTimeout() * (1 << std::min<uint32_t>(m_blockedCount++, 6));
+            m_lastSendTime = now;
+            return true;
+        }
+
+        deadline = std::min(deadline, m_nextBlockedTime);
+    }
+
+    if (now - m_lastSendTime >= RELIABLE_KEEPALIVE_INTERVAL) {
+        BuildControl(datagram, ReliablePacketType::PING);
+        m_lastSendTime = now;
+        return true;
+    }
+
+    deadline = std::min(deadline, m_lastSendTime + RELIABLE_KEEPALIVE_INTERVAL);
+    return false;
+}
+
+void ReliableDatagramTransport::BuildControl(std::vector<char>& datagram, const ReliablePacketType type) {
+    datagram.clear();
+    AppendHeader(datagram, {m_nextPacketNumber++, 0, m_connectionID, 0, static_cast<uint8_t>(type), 0});
+}
+
+void ReliableDatagramTransport::BuildAck(std::vector<char>& datagram, const Clock::time_point now) {
+    ZoneScoped;
+    const auto ackDelay = std::chrono::duration_cast<std::chrono::microseconds>(now - m_largestReceivedTime);
+
+    ReliableAckHeader ackHeader{
+        static_cast<uint32_t>(std::min<int64_t>(ackDelay.count(), UINT32_MAX)),
+        static_cast<uint16_t>(m_receivedPackets.size()),
+        static_cast<uint16_t>(m_streamCount)
+    };
+    ackHeader.FromNativeToBigEndian();
+
+    const auto* bytes = reinterpret_cast<const char*>(&ackHeader);
+    datagram.assign(bytes, bytes + sizeof(ReliableAckHeader));
+
+    for (auto range = m_receivedPackets.rbegin(); range != m_receivedPackets.rend(); ++range) {
+        AppendValue<uint64_t>(datagram, range->first);
+        AppendValue<uint64_t>(datagram, range->second - 1);
+    }
+
+    for (ReceiveStream& stream : m_receiveStreams) {
+        stream.advertisedLimit = stream.consumedOffset + RELIABLE_STREAM_WINDOW;
+        AppendValue<uint64_t>(datagram, stream.advertisedLimit);
+    }
+
+    AppendHeader(datagram, {m_nextPacketNumber++, 0, m_connectionID, static_cast<uint16_t>(datagram.size()), static_cast<uint8_t>(ReliablePacketType::ACK), 0});
+
+    m_ackPending = false;
+    m_unackedCount = 0;
+    m_ackDeadline = Clock::time_point::max();
+}
+
+bool ReliableDatagramTransport::BuildData(std::vector<char>& datagram, const Clock::time_point now) {
+    ZoneScoped;
+    for (size_t i = 0; i < m_streamCount; i++) {
+        const size_t index = (m_nextStream + i) % m_streamCount;
+        SendStream& stream = m_sendStreams[index];
+        uint64_t offset = 0;
+        uint64_t size = 0;
+
+        while (!stream.retransmissions.empty() && size == 0) {
+            const auto [retransmitOffset, retransmitSize] = stream.retransmissions.front();
+            stream.retransmissions.pop_front();
+
+            if (retransmitOffset + retransmitSize > stream.ackedOffset) {
+                offset = std::max<uint64_t>(retransmitOffset, stream.ackedOffset);
+                size = retransmitOffset + retransmitSize - offset;
+            }
+        }
+
+        if (size == 0) {
+            const uint64_t available = stream.ackedOffset + stream.buffer.size() - stream.sentOffset;
+            const uint64_t credit = stream.peerLimit > stream.sentOffset ? stream.peerLimit - stream.sentOffset : 0;
+
+            offset = stream.sentOffset;
+            size = std::min<uint64_t>({available, credit, RELIABLE_MAX_PAYLOAD_SIZE});
+            stream.sentOffset += size;
+        }
+
+        if (size == 0) {
+            continue;
+        }
+
+        m_nextStream = index + 1;
+
+        const uint64_t packetNumber = m_nextPacketNumber++;
+        const auto source = stream.buffer.begin() + static_cast<std::ptrdiff_t>(offset - stream.ackedOffset);
+
+        datagram.assign(source, source + static_cast<std::ptrdiff_t>(size));
+        AppendHeader(datagram, {packetNumber, offset, m_connectionID, static_cast<uint16_t>(size), static_cast<uint8_t>(ReliablePacketType::DATA), static_cast<uint8_t>(index)});
+
+        m_sentPackets.emplace(packetNumber, SentPacket{now, offset, static_cast<uint16_t>(size), static_cast<uint16_t>(datagram.size()), static_cast<uint8_t>(index)});
+        m_bytesInFlight += datagram.size();
+        m_lastAckElicitingTime = now;
+        m_packetsSent++;
+
+        const Clock::duration interval = m_smoothedRoundTripTime * static_cast<Clock::rep>(datagram.size()) * 4 / static_cast<Clock::rep>(5 * m_congestionController->GetCongestionWindow());
+        m_nextSendTime = std::max(m_nextSendTime, now - interval * static_cast<Clock::rep>(RELIABLE_PACING_BURST)) + interval;
+        return true;
+    }
+
+    return false;
+}
+
+ReliableDatagramTransport::Clock::duration ReliableDatagramTransport::GetProbeTimeout() const {
+    const Clock::duration timeout = m_smoothedRoundTripTime + std::max<Clock::duration>(4 * m_roundTripTimeVariance, std::chrono::milliseconds(1)) + RELIABLE_MAX_ACK_DELAY;
+    return timeout * (1 << std::min<uint32_t>(m_ptoCount, 6));
+}
+
+bool ReliableDatagramTransport::IsFlowControlBlocked() const {
+    return std::ranges::any_of(m_sendStreams, [](const SendStream& stream) {
+        return stream.sentOffset >= stream.peerLimit && stream.ackedOffset + stream.buffer.size() > stream.sentOffset;
+    });
+}
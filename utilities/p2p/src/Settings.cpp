@@ -1,7 +1,20 @@
 #include <Settings.h>
+#include <FileTransfer.h>
 
-std::mutex P2PSettings::m_mutex{};
-std::filesystem::path P2PSettings::m_fileDownloadDirectory{};
+std::mutex                                P2PSettings::m_mutex{};
+std::filesystem::path                     P2PSettings::m_fileDownloadDirectory{};
+bool                                      P2PSettings::m_deltaSyncEnabled{true};
+bool                                      P2PSettings::m_chunkStoreEnabled{false};
+std::filesystem::path                     P2PSettings::m_chunkStoreDirectory{".chunk-store"};
+FileSchedulingPolicy                      P2PSettings::m_fileSchedulingPolicy{FileSchedulingPolicy::ROUND_ROBIN};
+bool                                      P2PSettings::m_memoryMappedReceiveEnabled{true};
+std::pair<PackageSizeInt, PackageSizeInt> P2PSettings::m_fileChunkSizeBounds{16 * 1024, FILE_CHUNK_MAX_SIZE};
+std::pair<PackageSizeInt, PackageSizeInt> P2PSettings::m_socketBufferSizeBounds{256 * 1024, 16 * 1024 * 1024};
+CompressionAlgorithm                      P2PSettings::m_compressionAlgorithm{CompressionAlgorithm::NONE};
+bool                                      P2PSettings::m_streamMultiplexingEnabled{true};
+bool                                      P2PSettings::m_sharedMemoryEnabled{true};
+bool                                      P2PSettings::m_datagramChannelEnabled{true};
+CongestionControlAlgorithm                P2PSettings::m_congestionControlAlgorithm{CongestionControlAlgorithm::CUBIC};
 
 void P2PSettings::SetFileDownloadDirectory(const std::filesystem::path& directory) {
     std::lock_guard lock(m_mutex);
@@ -12,3 +25,121 @@ std::filesystem::path P2PSettings::GetFileDownloadDirectory() {
     return m_fileDownloadDirectory;
 }
 
+void P2PSettings::SetDeltaSyncEnabled(const bool enabled) {
+    std::lock_guard lock(m_mutex);
+    m_deltaSyncEnabled = enabled;
+}
+
+bool P2PSettings::IsDeltaSyncEnabled() {
+    std::lock_guard lock(m_mutex);
+    return m_deltaSyncEnabled;
+}
+
+void P2PSettings::SetChunkStoreEnabled(const bool enabled) {
+    std::lock_guard lock(m_mutex);
+    m_chunkStoreEnabled = enabled;
+}
+
+bool P2PSettings::IsChunkStoreEnabled() {
+    std::lock_guard lock(m_mutex);
+    return m_chunkStoreEnabled;
+}
+
+void P2PSettings::SetChunkStoreDirectory(const std::filesystem::path& directory) {
+    std::lock_guard lock(m_mutex);
+    m_chunkStoreDirectory = directory;
+}
+
+std::filesystem::path P2PSettings::GetChunkStoreDirectory() {
+    std::lock_guard lock(m_mutex);
+    return m_chunkStoreDirectory;
+}
+
+void P2PSettings::SetFileSchedulingPolicy(const FileSchedulingPolicy policy) {
+    std::lock_guard lock(m_mutex);
+    m_fileSchedulingPolicy = policy;
+}
+
+FileSchedulingPolicy P2PSettings::GetFileSchedulingPolicy() {
+    std::lock_guard lock(m_mutex);
+    return m_fileSchedulingPolicy;
+}
+
+void P2PSettings::SetMemoryMappedReceiveEnabled(const bool enabled) {
+    std::lock_guard lock(m_mutex);
+    m_memoryMappedReceiveEnabled = enabled;
+}
+
+bool P2PSettings::IsMemoryMappedReceiveEnabled() {
+    std::lock_guard lock(m_mutex);
+    return m_memoryMappedReceiveEnabled;
+}
+
+void P2PSettings::SetFileChunkSizeBounds(const PackageSizeInt minSize, const PackageSizeInt maxSize) {
+    std::lock_guard lock(m_mutex);
+    m_fileChunkSizeBounds = {std::min(minSize, maxSize), std::min(std::max(minSize, maxSize), FILE_CHUNK_MAX_SIZE)};
+}
+
+std::pair<PackageSizeInt, PackageSizeInt> P2PSettings::GetFileChunkSizeBounds() {
+    std::lock_guard lock(m_mutex);
+    return m_fileChunkSizeBounds;
+}
+
+void P2PSettings::SetSocketBufferSizeBounds(const PackageSizeInt minSize, const PackageSizeInt maxSize) {
+    std::lock_guard lock(m_mutex);
+    m_socketBufferSizeBounds = {std::min(minSize, maxSize), std::max(minSize, maxSize)};
+}
+
+std::pair<PackageSizeInt, PackageSizeInt> P2PSettings::GetSocketBufferSizeBounds() {
+    std::lock_guard lock(m_mutex);
+    return m_socketBufferSizeBounds;
+}
+
+void P2PSettings::SetCompressionAlgorithm(const CompressionAlgorithm algorithm) {
+    std::lock_guard lock(m_mutex);
+    m_compressionAlgorithm = algorithm;
+}
+
+CompressionAlgorithm P2PSettings::GetCompressionAlgorithm() {
+    std::lock_guard lock(m_mutex);
+    return m_compressionAlgorithm;
+}
+void P2PSettings::SetStreamMultiplexingEnabled(const bool enabled) {
+    std::lock_guard lock(m_mutex);
+    m_streamMultiplexingEnabled = enabled;
+}
+
+bool P2PSettings::IsStreamMultiplexingEnabled() {
+    std::lock_guard lock(m_mutex);
+    return m_streamMultiplexingEnabled;
+}
+
+void P2PSettings::SetSharedMemoryEnabled(const bool enabled) {
+    std::lock_guard lock(m_mutex);
+    m_sharedMemoryEnabled = enabled;
+}
+
+bool P2PSettings::IsSharedMemoryEnabled() {
+    std::lock_guard lock(m_mutex);
+    return m_sharedMemoryEnabled;
+}
+
+void P2PSettings::SetDatagramChannelEnabled(const bool enabled) {
+    std::lock_guard lock(m_mutex);
+    m_datagramChannelEnabled = enabled;
+}
+
+bool P2PSettings::IsDatagramChannelEnabled() {
+    std::lock_guard lock(m_mutex);
+    return m_datagramChannelEnabled;
+}
+
+void P2PSettings::SetCongestionControlAlgorithm(const CongestionControlAlgorithm algorithm) {
+    std::lock_guard lock(m_mutex);
+    m_congestionControlAlgorithm = algorithm;
+}
+
+CongestionControlAlgorithm P2PSettings::GetCongestionControlAlgorithm() {
+    std::lock_guard lock(m_mutex);
+    return m_congestionControlAlgorithm;
+}
@@ -0,0 +1,233 @@
+#include <SharedMemoryChannel.h>
+#include <DebugLog.h>
+#include <tracy/Tracy.hpp>
+
+#include <iomanip>
+#include <random>
+#include <sstream>
+
+static constexpr uint32_t SHARED_MEMORY_MAGIC = 0x50434D53;
+
+struct SharedMemoryChannel::Layout {
+    SharedMemoryDoorbellState doorbells[2];
+    alignas(64) std::atomic<uint32_t> closed{0};
+    uint32_t magic{SHARED_MEMORY_MAGIC};
+    uint32_t streamCount{0};
+    uint64_t ringSize{SHARED_MEMORY_RING_SIZE};
+};
+
+static constexpr size_t RING_FOOTPRINT = sizeof(SharedMemoryRingControl) + SHARED_MEMORY_RING_SIZE;
+
+SharedMemoryChannel::SharedMemoryChannel(asio::any_io_executor executor, const SharedMemorySide side, const size_t streamCount)
+    : m_executor(std::move(executor)), m_side(side), m_streamCount(streamCount), m_waiters(streamCount) {
+    for (size_t i = 0; i < streamCount; i++) {
+        m_streams.emplace_back(*this, i);
+    }
+}
+
+SharedMemoryChannel::~SharedMemoryChannel() {
+    Close();
+
+    if (m_thread.joinable()) {
+        m_thread.request_stop();
+        SharedMemoryDoorbell::Ring(m_layout->doorbells[static_cast<size_t>(m_side)]);
+        m_thread.join();
+    }
+}
+
+bool SharedMemoryChannel::IsSupported() {
+    return SharedMemoryRegion::IsSupported();
+}
+
+bool SharedMemoryChannel::Create() {
+    ZoneScoped;
+    std::random_device device;
+    std::ostringstream name;
+    name << "/pablo-connect-" << std::hex << std::setfill('0');
+
+    for (int i = 0; i < 4; i++) {
+        name << std::setw(8) << device();
+    }
+
+    if (!m_region.Create(name.str(), GetRegionSize(m_streamCount))) {
+        return false;
+    }
+
+    m_layout = new (m_region.GetData()) Layout();
+    m_layout->streamCount = static_cast<uint32_t>(m_streamCount);
+
+    for (size_t i = 0; i < m_streamCount * 2; i++) {
+        new (m_region.GetData() + sizeof(Layout) + i * RING_FOOTPRINT) SharedMemoryRingControl();
+    }
+
+    Attach();
+    return true;
+}
+
+bool SharedMemoryChannel::Open(const std::string& name) {
+    ZoneScoped;
+    if (!m_region.Open(name, GetRegionSize(m_streamCount))) {
+        return false;
+    }
+
+    m_layout = reinterpret_cast<Layout*>(m_region.GetData());
+    if (m_layout->magic != SHARED_MEMORY_MAGIC || m_layout->streamCount != m_streamCount || m_layout->ringSize != SHARED_MEMORY_RING_SIZE) {
+        m_layout = nullptr;
+        m_region.Close();
+        return false;
+    }
+
+    Attach();
+    return true;
+}
+
+void SharedMemoryChannel::Unlink() {
+    m_region.Unlink();
+}
+
+void SharedMemoryChannel::Start() {
+    ZoneScoped;
+    if (m_layout == nullptr || m_thread.joinable()) {
+        return;
+    }
+
+    m_thread = std::jthread([this](const std::stop_token& stopToken) { Run(stopToken); });
+}
+
+void SharedMemoryChannel::Close() {
+    ZoneScoped;
+    if (m_layout == nullptr || m_layout->closed.exchange(1) != 0) {
+        return;
+    }
+
+    SharedMemoryDoorbell::Ring(m_layout->doorbells[0]);
+    SharedMemoryDoorbell::Ring(m_layout->doorbells[1]);
+}
+
+bool SharedMemoryChannel::IsClosed() const {
+    return m_layout == nullptr || m_layout->closed.load(std::memory_order_acquire) != 0;
+}
+
+const std::string& SharedMemoryChannel::GetName() const {
+    return m_region.GetName();
+}
+
+SharedMemoryChannel::Stream& SharedMemoryChannel::GetStream(const MultiplexedStream stream) {
+    return m_streams[static_cast<size_t>(stream)];
+}
+
+size_t SharedMemoryChannel::GetRegionSize(const size_t streamCount) {
+    return sizeof(Layout) + streamCount * 2 * RING_FOOTPRINT;
+}
+
+void SharedMemoryChannel::Attach() {
+    const size_t side = static_cast<size_t>(m_side);
+
+    for (size_t i = 0; i < m_streamCount; i++) {
+        for (size_t direction = 0; direction < 2; direction++) {
+            char* ring = m_region.GetData() + sizeof(Layout) + (i * 2 + direction) * RING_FOOTPRINT;
+            auto* control = reinterpret_cast<SharedMemoryRingControl*>(ring);
+
+            (direction == side ? m_outRings : m_inRings).emplace_back(control, ring + sizeof(SharedMemoryRingControl), SHARED_MEMORY_RING_SIZE);
+        }
+    }
+}
+
+bool SharedMemoryChannel::CheckConsistency() {
+    for (size_t i = 0; i < m_streamCount; i++) {
+        if (!m_inRings[i].IsConsistent() || !m_outRings[i].IsConsistent()) {
+            Debug::LogError("Shared memory ring {} is corrupt, closing channel", i);
+            Close();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+size_t SharedMemoryChannel::Read(const size_t index, void* destination, const size_t size) {
+    const size_t read = m_inRings[index].Read(destination, size);
+    if (read > 0) {
+        SharedMemoryDoorbell::Ring(m_layout->doorbells[1 - static_cast<size_t>(m_side)]);
+    } else if (!m_inRings[index].IsConsistent()) {
+        CheckConsistency();
+    }
+
+    return read;
+}
+
+size_t SharedMemoryChannel::Write(const size_t index, const void* source, const size_t size) {
+    const size_t written = m_outRings[index].Write(source, size);
+    if (written > 0) {
+        SharedMemoryDoorbell::Ring(m_layout->doorbells[1 - static_cast<size_t>(m_side)]);
+    } else if (!m_outRings[index].IsConsistent()) {
+        CheckConsistency();
+    }
+
+    return written;
+}
+
+void SharedMemoryChannel::Park(const size_t index, const bool isWrite, std::move_only_function<void()> waiter) {
+    {
+        std::lock_guard lock(m_mutex);
+        m_waiters[index][isWrite ? 1 : 0] = std::move(waiter);
+    }
+
+    SharedMemoryDoorbell::Ring(m_layout->doorbells[static_cast<size_t>(m_side)]);
+}
+
+void SharedMemoryChannel::Run(const std::stop_token& stopToken) {
+    SharedMemoryDoorbellState& doorbell = m_layout->doorbells[static_cast<size_t>(m_side)];
+    std::vector<std::move_only_function<void()>> ready;
+    uint32_t spins = 0;
+
+    while (true) {
+        // Sampled before the stop check, so a stop request rung in between makes the futex wait return at once
+        const uint32_t sequence = doorbell.sequence.load(std::memory_order_acquire);
+        if (stopToken.stop_requested()) {
+            return;
+        }
+
+        const bool closed = IsClosed() || !CheckConsistency();
+        bool waiting = false;
+
+        {
+            std::lock_guard lock(m_mutex);
+            for (size_t i = 0; i < m_streamCount; i++) {
+                for (size_t operation = 0; operation < 2; operation++) {
+                    std::move_only_function<void()>& waiter = m_waiters[i][operation];
+                    if (!waiter) {
+                        continue;
+                    }
+
+                    if (closed || (operation == 0 ? m_inRings[i].IsReadable() : m_outRings[i].IsWritable())) {
+                        ready.push_back(std::move(waiter));
+                        waiter = nullptr;
+                    } else {
+                        waiting = true;
+                    }
+                }
+            }
+        }
+
+        if (!ready.empty()) {
+            for (std::move_only_function<void()>& waiter : ready) {
+                asio::post(m_executor, std::move(waiter));
+            }
+
+            ready.clear();
+            spins = SHARED_MEMORY_SPIN_COUNT;
+            continue;
+        }
+
+        // Spinning only pays off right after progress, while the peer is likely to be mid-transfer
+        if (waiting && spins > 0) {
+            spins--;
+            std::this_thread::yield();
+            continue;
+        }
+
+        spins = 0;
+        SharedMemoryDoorbell::Wait(doorbell, sequence);
+    }
+}
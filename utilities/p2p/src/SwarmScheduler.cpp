@@ -0,0 +1,191 @@
+#include <SwarmScheduler.h>
+#include <tracy/Tracy.hpp>
+
+#include <algorithm>
+
+SwarmScheduler::SwarmScheduler(const std::vector<std::pair<FileSizeInt, FileSizeInt>>& missingRanges, const FileSizeInt pieceSize) {
+    for (const auto& [offset, size] : missingRanges) {
+        for (FileSizeInt position = 0; position < size; position += pieceSize) {
+            m_pieces.push_back({offset + position, std::min(pieceSize, size - position), PieceState::MISSING, {}});
+        }
+    }
+
+    m_remaining = m_pieces.size();
+}
+
+size_t SwarmScheduler::AddPeer() {
+    m_peers.emplace_back();
+    return m_peers.size() - 1;
+}
+
+void SwarmScheduler::RemovePeer(const size_t peer) {
+    ZoneScoped;
+    if (!m_peers[peer].active) {
+        return;
+    }
+
+    m_peers[peer].active = false;
+    m_peers[peer].outstanding = 0;
+
+    for (Piece& piece : m_pieces) {
+        if (piece.state == PieceState::REQUESTED) {
+            ReleasePiece(piece, peer);
+        }
+    }
+}
+
+std::vector<SwarmAssignment> SwarmScheduler::Assign(const Clock::time_point now) {
+    ZoneScoped;
+    std::vector<SwarmAssignment> assignments;
+
+    for (size_t peer = 0; peer < m_peers.size(); ++peer) {
+        while (m_peers[peer].active && m_peers[peer].outstanding < SWARM_PEER_PIPELINE_DEPTH) {
+            size_t index = FindMissingPiece();
+            if (index == NO_PIECE) {
+                index = FindSlowPiece(peer, now);
+            }
+
+            if (index == NO_PIECE) {
+                break;
+            }
+
+            Piece& piece = m_pieces[index];
+            piece.state = PieceState::REQUESTED;
+            piece.owners.push_back({peer, now});
+            ++m_peers[peer].outstanding;
+
+            assignments.push_back({peer, index, piece.offset, piece.size});
+        }
+    }
+
+    return assignments;
+}
+
+void SwarmScheduler::Complete(const size_t peer, const size_t index, const bool verified, const Clock::time_point now) {
+    ZoneScoped;
+    Piece& piece = m_pieces[index];
+    const auto owner = std::ranges::find(piece.owners, peer, &Owner::peer);
+
+    if (owner == piece.owners.end()) {
+        return;
+    }
+
+    const Clock::duration elapsed = now - owner->requested;
+    Peer& source = m_peers[peer];
+
+    --source.outstanding;
+
+    if (!verified) {
+        ReleasePiece(piece, peer);
+
+        if (++source.failures >= SWARM_MAX_PEER_FAILURES) {
+            RemovePeer(peer);
+        }
+
+        return;
+    }
+
+    piece.owners.erase(owner);
+    source.received += piece.size;
+    source.busyTime += elapsed;
+
+    if (piece.state != PieceState::RECEIVED) {
+        piece.state = PieceState::RECEIVED;
+        m_received += piece.size;
+        --m_remaining;
+    }
+}
+
+bool SwarmScheduler::IsFinished() const {
+    return m_remaining == 0;
+}
+
+bool SwarmScheduler::IsStalled() const {
+    return !IsFinished() && std::ranges::none_of(m_peers, &Peer::active);
+}
+
+bool SwarmScheduler::IsPeerActive(const size_t peer) const {
+    return m_peers[peer].active;
+}
+
+uint64_t SwarmScheduler::GetPeerBandwidth(const size_t peer) const {
+    const auto busyTime = std::chrono::duration_cast<std::chrono::microseconds>(m_peers[peer].busyTime).count();
+    if (busyTime <= 0) {
+        return 0;
+    }
+
+    return m_peers[peer].received * 1'000'000 / static_cast<uint64_t>(busyTime);
+}
+
+FileSizeInt SwarmScheduler::GetPeerReceivedSize(const size_t peer) const {
+    return m_peers[peer].received;
+}
+
+FileSizeInt SwarmScheduler::GetReceivedSize() const {
+    return m_received;
+}
+
+size_t SwarmScheduler::GetOutstandingCount() const {
+    size_t outstanding = 0;
+    for (const Peer& peer : m_peers) {
+        outstanding += peer.outstanding;
+    }
+
+    return outstanding;
+}
+
+size_t SwarmScheduler::GetPieceCount() const {
+    return m_pieces.size();
+}
+
+size_t SwarmScheduler::FindMissingPiece() {
+    for (; m_cursor < m_pieces.size(); ++m_cursor) {
+        if (m_pieces[m_cursor].state == PieceState::MISSING) {
+            return m_cursor;
+        }
+    }
+
+    for (size_t index = 0; index < m_pieces.size(); ++index) {
+        if (m_pieces[index].state == PieceState::MISSING) {
+            return index;
+        }
+    }
+
+    return NO_PIECE;
+}
+
+size_t SwarmScheduler::FindSlowPiece(const size_t peer, const Clock::time_point now) const {
+    const uint64_t bandwidth = GetPeerBandwidth(peer);
+    if (bandwidth == 0) {
+        return NO_PIECE;
+    }
+
+    size_t slowest = NO_PIECE;
+    Clock::duration slowestElapsed{0};
+
+    for (size_t index = 0; index < m_pieces.size(); ++index) {
+        const Piece& piece = m_pieces[index];
+        if (piece.state != PieceState::REQUESTED || piece.owners.size() != 1 || piece.owners.front().peer == peer) {
+            continue;
+        }
+
+        const Clock::duration elapsed = now - piece.owners.front().requested;
+        const std::chrono::microseconds expected(piece.size * 1'000'000 / bandwidth);
+
+        if (elapsed > SWARM_SLOW_PEER_FACTOR * expected && elapsed > slowestElapsed) {
+            slowest = index;
+            slowestElapsed = elapsed;
+        }
+    }
+
+    return slowest;
+}
+
+void SwarmScheduler::ReleasePiece(Piece& piece, const size_t peer) {
+    std::erase_if(piece.owners, [peer](const Owner& owner) { return owner.peer == peer; });
+
+    if (piece.state == PieceState::REQUESTED && piece.owners.empty()) {
+        piece.state = PieceState::MISSING;
+        m_cursor = 0;
+    }
+}
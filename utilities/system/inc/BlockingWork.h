@@ -0,0 +1,25 @@
+#ifndef BLOCKING_WORK_H
+#define BLOCKING_WORK_H
+
+#include <asio.hpp>
+#include <asio/awaitable.hpp>
+#include <type_traits>
+
+#ifndef NO_DISCARD
+#define NO_DISCARD [[nodiscard]]
+#endif
+
+class BlockingWork final {
+public:
+    // Shared by every job that would otherwise stall an io thread: compression, hashing and file copies
+    NO_DISCARD static asio::thread_pool& GetPool();
+};
+
+template <typename Work>
+asio::awaitable<std::invoke_result_t<Work&>> CoRunBlockingWork(Work work) {
+    co_return co_await asio::co_spawn(BlockingWork::GetPool(), [&work]() -> asio::awaitable<std::invoke_result_t<Work&>> {
+        co_return work();
+    }, asio::use_awaitable);
+}
+
+#endif //BLOCKING_WORK_H
@@ -0,0 +1,52 @@
+#ifndef COMPRESSION_H
+#define COMPRESSION_H
+
+#include <BlockingWork.h>
+#include <asio.hpp>
+#include <asio/awaitable.hpp>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#ifndef NO_DISCARD
+#define NO_DISCARD [[nodiscard]]
+#endif
+
+constexpr size_t COMPRESSION_MIN_SIZE = 256;
+constexpr size_t COMPRESSION_OFFLOAD_MIN_SIZE = 16 * 1024;
+constexpr size_t COMPRESSION_ENTROPY_SAMPLE_SIZE = 4096;
+constexpr double COMPRESSION_MAX_ENTROPY = 7.5;
+constexpr size_t COMPRESSION_HEADER_SIZE = sizeof(uint8_t) + sizeof(uint32_t);
+constexpr int    COMPRESSION_ZSTD_LEVEL = 3;
+
+enum class CompressionAlgorithm : uint8_t {
+    NONE = 0,
+    LZ4  = 1,
+    ZSTD = 2
+};
+
+class Compression final {
+public:
+    NO_DISCARD static uint8_t GetSupportedAlgorithms();
+    NO_DISCARD static CompressionAlgorithm Negotiate(CompressionAlgorithm preferred, uint8_t peerSupportedAlgorithms);
+
+    NO_DISCARD static double EstimateEntropy(const char* data, size_t size);
+    NO_DISCARD static bool IsWorthCompressing(const char* data, size_t size);
+
+    static bool Compress(CompressionAlgorithm algorithm, const char* data, size_t size, std::vector<char>& output);
+    static bool Decompress(const char* data, size_t size, std::vector<char>& output, size_t maxSize);
+    static bool Decompress(const char* data, size_t size, char* output, size_t outputSize);
+
+    NO_DISCARD static bool ReadHeader(const char* data, size_t size, CompressionAlgorithm& algorithm, uint32_t& originalSize);
+};
+
+template <typename Work>
+asio::awaitable<std::invoke_result_t<Work&>> CoRunCompressionWork(const size_t size, Work work) {
+    if (size < COMPRESSION_OFFLOAD_MIN_SIZE) {
+        co_return work();
+    }
+
+    co_return co_await CoRunBlockingWork(std::move(work));
+}
+
+#endif //COMPRESSION_H
@@ -0,0 +1,58 @@
+#ifndef FILE_DESCRIPTOR_H
+#define FILE_DESCRIPTOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define FILE_DESCRIPTOR_PASSING_SUPPORTED 1
+#else
+#define FILE_DESCRIPTOR_PASSING_SUPPORTED 0
+#endif
+
+#ifndef NO_DISCARD
+#define NO_DISCARD [[nodiscard]]
+#endif
+
+constexpr uint64_t FILE_DESCRIPTOR_COPY_BLOCK_SIZE = 1024 * 1024;
+
+class FileDescriptor final {
+public:
+    FileDescriptor() = default;
+    explicit FileDescriptor(int descriptor);
+    ~FileDescriptor();
+
+    FileDescriptor(FileDescriptor&& other) noexcept;
+    FileDescriptor& operator=(FileDescriptor&& other) noexcept;
+
+    FileDescriptor(const FileDescriptor&) = delete;
+    FileDescriptor& operator=(const FileDescriptor&) = delete;
+
+    NO_DISCARD static bool IsPassingSupported();
+
+    NO_DISCARD static FileDescriptor OpenRead(const std::filesystem::path& path);
+    NO_DISCARD static FileDescriptor OpenWrite(const std::filesystem::path& path, bool truncate);
+
+    static int64_t Send(int socket, const void* data, size_t size, int descriptor);
+    static int64_t Receive(int socket, void* data, size_t size, FileDescriptor& descriptor);
+
+    static bool CopyRange(int source, int destination, uint64_t offset, uint64_t size);
+
+    NO_DISCARD uint64_t GetSize() const;
+    bool Resize(uint64_t size) const;
+    void Close();
+
+    NO_DISCARD int Get() const {
+        return m_descriptor;
+    }
+
+    NO_DISCARD bool IsOpen() const {
+        return m_descriptor >= 0;
+    }
+
+private:
+    int m_descriptor{-1};
+};
+
+#endif //FILE_DESCRIPTOR_H
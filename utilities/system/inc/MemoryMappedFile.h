@@ -0,0 +1,57 @@
+#ifndef MEMORY_MAPPED_FILE_H
+#define MEMORY_MAPPED_FILE_H
+
+#include <cstdint>
+#include <filesystem>
+
+// Writes through a mapping fault with SIGBUS when the disk fills up, so mapping is only offered where
+// posix_fallocate can reserve the blocks first
+#if defined(__linux__)
+#define MEMORY_MAPPED_FILE_SUPPORTED 1
+#else
+#define MEMORY_MAPPED_FILE_SUPPORTED 0
+#endif
+
+#ifndef NO_DISCARD
+#define NO_DISCARD [[nodiscard]]
+#endif
+
+class MemoryMappedFile final {
+public:
+    MemoryMappedFile() = default;
+    ~MemoryMappedFile();
+
+    MemoryMappedFile(const MemoryMappedFile&) = delete;
+    MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+    NO_DISCARD static bool IsSupported();
+
+    bool Open(const std::filesystem::path& path, uint64_t size, bool truncate);
+    bool Allocate(uint64_t offset, uint64_t size);
+    NO_DISCARD char* Map(uint64_t offset, uint64_t size);
+    void Flush();
+    void Close();
+
+    NO_DISCARD bool IsOpen() const {
+        return m_descriptor >= 0;
+    }
+
+    NO_DISCARD bool Contains(const uint64_t offset, const uint64_t size) const {
+        return m_window != nullptr && offset >= m_windowOffset && offset + size <= m_windowOffset + m_windowSize;
+    }
+
+    NO_DISCARD char* At(const uint64_t offset) const {
+        return m_window + (offset - m_windowOffset);
+    }
+
+private:
+    void Unmap();
+
+    int      m_descriptor{-1};
+    char*    m_window{nullptr};
+    uint64_t m_windowOffset{0};
+    uint64_t m_windowSize{0};
+    uint64_t m_size{0};
+};
+
+#endif //MEMORY_MAPPED_FILE_H
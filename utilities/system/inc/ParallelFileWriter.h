@@ -0,0 +1,66 @@
+#ifndef PARALLEL_FILE_WRITER_H
+#define PARALLEL_FILE_WRITER_H
+
+#include <AwaitableFlag.h>
+#include <asio.hpp>
+#include <asio/awaitable.hpp>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifndef NO_DISCARD
+#define NO_DISCARD [[nodiscard]]
+#endif
+
+class ParallelFileWriter final {
+public:
+    explicit ParallelFileWriter(size_t threadCount = std::thread::hardware_concurrency(), size_t maxPendingBytes = 32 * 1024 * 1024);
+    ~ParallelFileWriter();
+
+    ParallelFileWriter(const ParallelFileWriter&) = delete;
+    ParallelFileWriter& operator=(const ParallelFileWriter&) = delete;
+
+    // Write queues without blocking; callers on an io thread bound the queue by awaiting CoWaitForSpace between writes
+    void Write(std::filesystem::path path, std::vector<char>&& data);
+    NO_DISCARD bool Wait();
+    void Cancel();
+
+    asio::awaitable<void> CoWaitForSpace();
+    asio::awaitable<bool> CoWait();
+
+private:
+    struct Job {
+        std::filesystem::path path;
+        std::vector<char>     data;
+    };
+
+    struct Waiter {
+        asio::any_io_executor executor;
+        AwaitableFlag*        flag;
+    };
+
+    void Run();
+    void NotifyWaiters();
+    asio::awaitable<void> CoWaitUntil(bool idle);
+
+    NO_DISCARD bool IsIdle() const {
+        return m_jobs.empty() && m_activeJobs == 0;
+    }
+
+    std::mutex               m_mutex;
+    std::condition_variable  m_jobCondition;
+    std::condition_variable  m_idleCondition;
+    std::deque<Job>          m_jobs;
+    std::vector<Waiter>      m_waiters;
+    size_t                   m_maxPendingBytes;
+    size_t                   m_pendingBytes{0};
+    size_t                   m_activeJobs{0};
+    bool                     m_failed{false};
+    bool                     m_stopping{false};
+    std::vector<std::thread> m_workers;
+};
+
+#endif //PARALLEL_FILE_WRITER_H
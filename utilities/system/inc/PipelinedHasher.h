@@ -0,0 +1,86 @@
+#ifndef PIPELINED_HASHER_H
+#define PIPELINED_HASHER_H
+
+#include <AwaitableFlag.h>
+#include <asio.hpp>
+#include <asio/awaitable.hpp>
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#ifndef NO_DISCARD
+#define NO_DISCARD [[nodiscard]]
+#endif
+
+typedef struct evp_md_ctx_st EVP_MD_CTX;
+
+constexpr size_t HASH_DIGEST_SIZE = 32;
+constexpr size_t HASH_MAX_PENDING_BYTES = 8 * 1024 * 1024;
+constexpr size_t HASH_MAX_WORKERS = 4;
+using HashDigest = std::array<uint8_t, HASH_DIGEST_SIZE>;
+
+class PipelinedHasher final {
+public:
+    PipelinedHasher();
+    ~PipelinedHasher();
+
+    PipelinedHasher(const PipelinedHasher&) = delete;
+    PipelinedHasher& operator=(const PipelinedHasher&) = delete;
+
+    NO_DISCARD std::vector<char> AcquireBuffer(size_t size);
+    void Submit(std::vector<char>&& buffer, size_t size);
+    void Update(const char* data, size_t size);
+    void SubmitView(const char* data, size_t size);
+    void SubmitShared(std::shared_ptr<const std::vector<char>> buffer);
+    void Wait();
+    void Cancel();
+    NO_DISCARD HashDigest Finish();
+
+    // Awaitable counterparts for io threads: the worker posts its progress back to the awaiting executor instead of
+    // the caller blocking on a condition variable
+    asio::awaitable<void> CoWaitForSpace(size_t size);
+    asio::awaitable<void> CoWait();
+    asio::awaitable<HashDigest> CoFinish();
+
+private:
+    class WorkerPool;
+
+    struct Chunk {
+        std::vector<char>                        buffer;
+        std::shared_ptr<const std::vector<char>> shared;
+        const char*                              data;
+        size_t                                   size;
+    };
+
+    struct Waiter {
+        asio::any_io_executor executor;
+        AwaitableFlag*        flag;
+    };
+
+    void Enqueue(Chunk&& chunk);
+    bool ProcessNext();
+    void NotifyWaiters();
+    asio::awaitable<void> CoWaitUntil(bool idle, size_t size);
+
+    NO_DISCARD bool HasSpace(size_t size) const;
+    NO_DISCARD bool IsIdle() const;
+
+    static constexpr size_t MAX_FREE_BUFFERS = 4;
+
+    std::mutex                     m_mutex;
+    std::condition_variable        m_spaceCondition;
+    std::condition_variable        m_idleCondition;
+    std::deque<Chunk>              m_pending;
+    size_t                         m_pendingBytes{0};
+    std::vector<std::vector<char>> m_freeBuffers;
+    std::vector<Waiter>            m_waiters;
+    bool                           m_scheduled{false};
+
+    EVP_MD_CTX* m_context{nullptr};
+};
+
+#endif //PIPELINED_HASHER_H
@@ -0,0 +1,53 @@
+#ifndef SHARED_MEMORY_REGION_H
+#define SHARED_MEMORY_REGION_H
+
+#include <cstddef>
+#include <string>
+
+#if defined(__linux__)
+#define SHARED_MEMORY_SUPPORTED 1
+#else
+#define SHARED_MEMORY_SUPPORTED 0
+#endif
+
+#ifndef NO_DISCARD
+#define NO_DISCARD [[nodiscard]]
+#endif
+
+class SharedMemoryRegion final {
+public:
+    SharedMemoryRegion() = default;
+    ~SharedMemoryRegion();
+
+    SharedMemoryRegion(const SharedMemoryRegion&) = delete;
+    SharedMemoryRegion& operator=(const SharedMemoryRegion&) = delete;
+
+    NO_DISCARD static bool IsSupported();
+
+    bool Create(const std::string& name, size_t size);
+    bool Open(const std::string& name, size_t size);
+    void Unlink();
+    void Close();
+
+    NO_DISCARD char* GetData() const {
+        return m_data;
+    }
+
+    NO_DISCARD size_t GetSize() const {
+        return m_size;
+    }
+
+    NO_DISCARD const std::string& GetName() const {
+        return m_name;
+    }
+
+private:
+    bool Map(int descriptor, size_t size);
+
+    std::string m_name;
+    char*       m_data{nullptr};
+    size_t      m_size{0};
+    bool        m_owner{false};
+};
+
+#endif //SHARED_MEMORY_REGION_H
@@ -0,0 +1,58 @@
+#ifndef SHARED_MEMORY_RING_H
+#define SHARED_MEMORY_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#ifndef NO_DISCARD
+#define NO_DISCARD [[nodiscard]]
+#endif
+
+struct SharedMemoryRingControl {
+    alignas(64) std::atomic<uint64_t> head{0};
+    alignas(64) std::atomic<uint64_t> tail{0};
+};
+
+struct SharedMemoryDoorbellState {
+    alignas(64) std::atomic<uint32_t> sequence{0};
+    std::atomic<uint32_t>             sleeping{0};
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free);
+
+class SharedMemoryRing final {
+public:
+    SharedMemoryRing() = default;
+    SharedMemoryRing(SharedMemoryRingControl* control, char* data, size_t capacity)
+        : m_control(control), m_data(data), m_capacity(capacity) { }
+
+    size_t Write(const void* source, size_t size);
+    size_t Read(void* destination, size_t size);
+
+    NO_DISCARD bool IsReadable() const {
+        return m_control->head.load(std::memory_order_acquire) != m_control->tail.load(std::memory_order_relaxed);
+    }
+
+    NO_DISCARD bool IsWritable() const {
+        return m_control->head.load(std::memory_order_relaxed) - m_control->tail.load(std::memory_order_acquire) < m_capacity;
+    }
+
+    // One of the counters is written by the peer, so a ring that claims to hold more than its capacity is corrupt
+    NO_DISCARD bool IsConsistent() const {
+        return m_control->head.load(std::memory_order_acquire) - m_control->tail.load(std::memory_order_acquire) <= m_capacity;
+    }
+
+private:
+    SharedMemoryRingControl* m_control{nullptr};
+    char*                    m_data{nullptr};
+    size_t                   m_capacity{0};
+};
+
+class SharedMemoryDoorbell final {
+public:
+    static void Ring(SharedMemoryDoorbellState& state);
+    static void Wait(SharedMemoryDoorbellState& state, uint32_t sequence);
+};
+
+#endif //SHARED_MEMORY_RING_H
@@ -0,0 +1,33 @@
+#ifndef SPARSE_FILE_H
+#define SPARSE_FILE_H
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#ifndef NO_DISCARD
+#define NO_DISCARD [[nodiscard]]
+#endif
+
+constexpr size_t SPARSE_FILE_MAX_EXTENTS = 64 * 1024;
+constexpr uint64_t SPARSE_FILE_ZERO_BLOCK_SIZE = 1024 * 1024;
+
+struct FileExtent {
+    uint64_t offset;
+    uint64_t size;
+
+    bool operator==(const FileExtent&) const = default;
+};
+
+class SparseFile final {
+public:
+    NO_DISCARD static bool IsSupported();
+
+    NO_DISCARD static std::vector<FileExtent> GetDataExtents(const std::filesystem::path& path, uint64_t offset, uint64_t size);
+    NO_DISCARD static std::vector<FileExtent> GetHoles(uint64_t offset, uint64_t size, const std::vector<FileExtent>& dataExtents);
+    NO_DISCARD static bool IsValidExtentList(uint64_t offset, uint64_t size, const std::vector<FileExtent>& extents);
+
+    static bool CreateHoles(const std::filesystem::path& path, uint64_t fileSize, const std::vector<FileExtent>& holes);
+};
+
+#endif //SPARSE_FILE_H
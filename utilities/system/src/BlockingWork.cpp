@@ -0,0 +1,9 @@
+#include <BlockingWork.h>
+
+#include <algorithm>
+#include <thread>
+
+asio::thread_pool& BlockingWork::GetPool() {
+    static asio::thread_pool pool(std::max(2u, std::thread::hardware_concurrency() / 2));
+    return pool;
+}
@@ -0,0 +1,172 @@
+#include <Compression.h>
+#include <tracy/Tracy.hpp>
+#include <lz4.h>
+#include <zstd.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+uint8_t Compression::GetSupportedAlgorithms() {
+    return 1 << static_cast<uint8_t>(CompressionAlgorithm::LZ4) | 1 << static_cast<uint8_t>(CompressionAlgorithm::ZSTD);
+}
+
+CompressionAlgorithm Compression::Negotiate(const CompressionAlgorithm preferred, const uint8_t peerSupportedAlgorithms) {
+    if (preferred == CompressionAlgorithm::NONE) {
+        return CompressionAlgorithm::NONE;
+    }
+
+    const uint8_t common = GetSupportedAlgorithms() & peerSupportedAlgorithms;
+
+    if ((common & 1 << static_cast<uint8_t>(preferred)) != 0) {
+        return preferred;
+    }
+
+    if ((common & 1 << static_cast<uint8_t>(CompressionAlgorithm::LZ4)) != 0) {
+        return CompressionAlgorithm::LZ4;
+    }
+
+    return CompressionAlgorithm::NONE;
+}
+
+double Compression::EstimateEntropy(const char* data, const size_t size) {
+    ZoneScoped;
+    if (size == 0) {
+        return 0.0;
+    }
+
+    constexpr size_t segmentCount = 4;
+    constexpr size_t segmentSize = COMPRESSION_ENTROPY_SAMPLE_SIZE / segmentCount;
+
+    std::array<uint32_t, 256> histogram{};
+    size_t sampled = 0;
+
+    const auto sample = [&](const size_t offset, const size_t length) {
+        for (size_t i = offset; i < offset + length; ++i) {
+            ++histogram[static_cast<uint8_t>(data[i])];
+        }
+
+        sampled += length;
+    };
+
+    if (size <= COMPRESSION_ENTROPY_SAMPLE_SIZE) {
+        sample(0, size);
+    } else {
+        const size_t stride = (size - segmentSize) / (segmentCount - 1);
+
+        for (size_t segment = 0; segment < segmentCount; ++segment) {
+            sample(segment * stride, segmentSize);
+        }
+    }
+
+    double entropy = 0.0;
+    for (const uint32_t count : histogram) {
+        if (count == 0) {
+            continue;
+        }
+
+        const double probability = static_cast<double>(count) / static_cast<double>(sampled);
+        entropy -= probability * std::log2(probability);
+    }
+
+    return entropy;
+}
+
+bool Compression::IsWorthCompressing(const char* data, const size_t size) {
+    return size >= COMPRESSION_MIN_SIZE && EstimateEntropy(data, size) < COMPRESSION_MAX_ENTROPY;
+}
+
+bool Compression::Compress(const CompressionAlgorithm algorithm, const char* data, const size_t size, std::vector<char>& output) {
+    ZoneScoped;
+    if (algorithm == CompressionAlgorithm::NONE || size > std::numeric_limits<int>::max() || !IsWorthCompressing(data, size)) {
+        return false;
+    }
+
+    size_t bound;
+    if (algorithm == CompressionAlgorithm::LZ4) {
+        bound = static_cast<size_t>(LZ4_compressBound(static_cast<int>(size)));
+    } else {
+        bound = ZSTD_compressBound(size);
+    }
+
+    output.resize(COMPRESSION_HEADER_SIZE + bound);
+    char* payload = output.data() + COMPRESSION_HEADER_SIZE;
+    size_t compressedSize = 0;
+
+    if (algorithm == CompressionAlgorithm::LZ4) {
+        const int result = LZ4_compress_default(data, payload, static_cast<int>(size), static_cast<int>(bound));
+        compressedSize = result > 0 ? static_cast<size_t>(result) : 0;
+    } else {
+        const size_t result = ZSTD_compress(payload, bound, data, size, COMPRESSION_ZSTD_LEVEL);
+        compressedSize = ZSTD_isError(result) ? 0 : result;
+    }
+
+    if (compressedSize == 0 || COMPRESSION_HEADER_SIZE + compressedSize >= size - size / 16) {
+        return false;
+    }
+
+    output[0] = static_cast<char>(algorithm);
+    for (size_t i = 0; i < sizeof(uint32_t); ++i) {
+        output[sizeof(uint8_t) + i] = static_cast<char>(size >> (8 * (sizeof(uint32_t) - 1 - i)));
+    }
+
+    output.resize(COMPRESSION_HEADER_SIZE + compressedSize);
+    return true;
+}
+
+bool Compression::Decompress(const char* data, const size_t size, std::vector<char>& output, const size_t maxSize) {
+    ZoneScoped;
+    CompressionAlgorithm algorithm;
+    uint32_t originalSize;
+
+    if (!ReadHeader(data, size, algorithm, originalSize) || originalSize > maxSize) {
+        return false;
+    }
+
+    output.resize(originalSize);
+    return Decompress(data, size, output.data(), originalSize);
+}
+
+bool Compression::Decompress(const char* data, const size_t size, char* output, const size_t outputSize) {
+    ZoneScoped;
+    CompressionAlgorithm algorithm;
+    uint32_t originalSize;
+
+    if (!ReadHeader(data, size, algorithm, originalSize) || originalSize != outputSize) {
+        return false;
+    }
+
+    const char* payload = data + COMPRESSION_HEADER_SIZE;
+    const size_t payloadSize = size - COMPRESSION_HEADER_SIZE;
+
+    if (algorithm == CompressionAlgorithm::LZ4) {
+        if (payloadSize > std::numeric_limits<int>::max() || outputSize > std::numeric_limits<int>::max()) {
+            return false;
+        }
+
+        return LZ4_decompress_safe(payload, output, static_cast<int>(payloadSize), static_cast<int>(outputSize)) == static_cast<int>(outputSize);
+    }
+
+    const size_t result = ZSTD_decompress(output, outputSize, payload, payloadSize);
+    return !ZSTD_isError(result) && result == outputSize;
+}
+
+bool Compression::ReadHeader(const char* data, const size_t size, CompressionAlgorithm& algorithm, uint32_t& originalSize) {
+    if (size < COMPRESSION_HEADER_SIZE) {
+        return false;
+    }
+
+    algorithm = static_cast<CompressionAlgorithm>(data[0]);
+    if (algorithm != CompressionAlgorithm::LZ4 && algorithm != CompressionAlgorithm::ZSTD) {
+        return false;
+    }
+
+    originalSize = 0;
+    for (size_t i = 0; i < sizeof(uint32_t); ++i) {
+        originalSize = originalSize << 8 | static_cast<uint8_t>(data[sizeof(uint8_t) + i]);
+    }
+
+    return true;
+}
@@ -0,0 +1,244 @@
+#include <FileDescriptor.h>
+#include <tracy/Tracy.hpp>
+
+#include <algorithm>
+#include <vector>
+
+#if FILE_DESCRIPTOR_PASSING_SUPPORTED
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#if defined(MSG_NOSIGNAL)
+static constexpr int SEND_FLAGS = MSG_NOSIGNAL | MSG_DONTWAIT;
+#elif FILE_DESCRIPTOR_PASSING_SUPPORTED
+static constexpr int SEND_FLAGS = MSG_DONTWAIT;
+#endif
+
+#if defined(MSG_CMSG_CLOEXEC)
+static constexpr int RECEIVE_FLAGS = MSG_CMSG_CLOEXEC | MSG_DONTWAIT;
+#elif FILE_DESCRIPTOR_PASSING_SUPPORTED
+static constexpr int RECEIVE_FLAGS = MSG_DONTWAIT;
+#endif
+
+FileDescriptor::FileDescriptor(const int descriptor) : m_descriptor(descriptor) { }
+
+FileDescriptor::~FileDescriptor() {
+    Close();
+}
+
+FileDescriptor::FileDescriptor(FileDescriptor&& other) noexcept : m_descriptor(other.m_descriptor) {
+    other.m_descriptor = -1;
+}
+
+FileDescriptor& FileDescriptor::operator=(FileDescriptor&& other) noexcept {
+    if (this != &other) {
+        Close();
+        m_descriptor = other.m_descriptor;
+        other.m_descriptor = -1;
+    }
+
+    return *this;
+}
+
+bool FileDescriptor::IsPassingSupported() {
+    return FILE_DESCRIPTOR_PASSING_SUPPORTED;
+}
+
+#if FILE_DESCRIPTOR_PASSING_SUPPORTED
+
+FileDescriptor FileDescriptor::OpenRead(const std::filesystem::path& path) {
+    ZoneScoped;
+    return FileDescriptor(::open(path.c_str(), O_RDONLY | O_CLOEXEC));
+}
+
+FileDescriptor FileDescriptor::OpenWrite(const std::filesystem::path& path, const bool truncate) {
+    ZoneScoped;
+    return FileDescriptor(::open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC | (truncate ? O_TRUNC : 0), 0644));
+}
+
+int64_t FileDescriptor::Send(const int socket, const void* data, const size_t size, const int descriptor) {
+    ZoneScoped;
+    iovec vector{const_cast<void*>(data), size};
+    msghdr message{};
+    message.msg_iov = &vector;
+    message.msg_iovlen = 1;
+
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+
+    if (descriptor >= 0) {
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+
+        cmsghdr* header = CMSG_FIRSTHDR(&message);
+        header->cmsg_level = SOL_SOCKET;
+        header->cmsg_type = SCM_RIGHTS;
+        header->cmsg_len = CMSG_LEN(sizeof(int));
+        std::memcpy(CMSG_DATA(header), &descriptor, sizeof(int));
+    }
+
+    return ::sendmsg(socket, &message, SEND_FLAGS);
+}
+
+int64_t FileDescriptor::Receive(const int socket, void* data, const size_t size, FileDescriptor& descriptor) {
+    ZoneScoped;
+    iovec vector{data, size};
+    msghdr message{};
+    message.msg_iov = &vector;
+    message.msg_iovlen = 1;
+
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+
+    const ssize_t received = ::recvmsg(socket, &message, RECEIVE_FLAGS);
+    if (received < 0) {
+        return received;
+    }
+
+    for (cmsghdr* header = CMSG_FIRSTHDR(&message); header != nullptr; header = CMSG_NXTHDR(&message, header)) {
+        if (header->cmsg_level != SOL_SOCKET || header->cmsg_type != SCM_RIGHTS) {
+            continue;
+        }
+
+        const size_t count = (header->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        for (size_t i = 0; i < count; i++) {
+            int passed;
+            std::memcpy(&passed, CMSG_DATA(header) + i * sizeof(int), sizeof(int));
+
+            if (descriptor.IsOpen()) {
+                ::close(passed);
+            } else {
+                descriptor = FileDescriptor(passed);
+            }
+        }
+    }
+
+    if ((message.msg_flags & MSG_CTRUNC) != 0) {
+        descriptor.Close();
+        errno = EMSGSIZE;
+        return -1;
+    }
+
+    return received;
+}
+
+static bool CopyBuffered(const int source, const int destination, uint64_t offset, uint64_t size) {
+    ZoneScoped;
+    std::vector<char> buffer(std::min(size, FILE_DESCRIPTOR_COPY_BLOCK_SIZE));
+
+    while (size > 0) {
+        const ssize_t read = ::pread(source, buffer.data(), std::min<uint64_t>(size, buffer.size()), static_cast<off_t>(offset));
+        if (read < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (read <= 0) {
+            return false;
+        }
+
+        for (ssize_t written = 0; written < read;) {
+            const ssize_t result = ::pwrite(destination, buffer.data() + written, read - written, static_cast<off_t>(offset + written));
+            if (result < 0 && errno == EINTR) {
+                continue;
+            }
+
+            if (result <= 0) {
+                return false;
+            }
+
+            written += result;
+        }
+
+        offset += read;
+        size -= read;
+    }
+
+    return true;
+}
+
+bool FileDescriptor::CopyRange(const int source, const int destination, const uint64_t offset, const uint64_t size) {
+    ZoneScoped;
+    uint64_t copied = 0;
+
+#if defined(__linux__)
+    while (copied < size) {
+        off_t sourceOffset = static_cast<off_t>(offset + copied);
+        off_t destinationOffset = sourceOffset;
+
+        const ssize_t result = ::copy_file_range(source, &sourceOffset, destination, &destinationOffset, std::min(size - copied, FILE_DESCRIPTOR_COPY_BLOCK_SIZE * 64), 0);
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (result <= 0) {
+            break;
+        }
+
+        copied += result;
+    }
+#endif
+
+    return copied == size || CopyBuffered(source, destination, offset + copied, size - copied);
+}
+
+uint64_t FileDescriptor::GetSize() const {
+    struct stat status{};
+    if (::fstat(m_descriptor, &status) != 0) {
+        return 0;
+    }
+
+    return static_cast<uint64_t>(status.st_size);
+}
+
+bool FileDescriptor::Resize(const uint64_t size) const {
+    return ::ftruncate(m_descriptor, static_cast<off_t>(size)) == 0;
+}
+
+void FileDescriptor::Close() {
+    if (m_descriptor >= 0) {
+        ::close(m_descriptor);
+        m_descriptor = -1;
+    }
+}
+
+#else
+
+FileDescriptor FileDescriptor::OpenRead(const std::filesystem::path&) {
+    return FileDescriptor();
+}
+
+FileDescriptor FileDescriptor::OpenWrite(const std::filesystem::path&, bool) {
+    return FileDescriptor();
+}
+
+int64_t FileDescriptor::Send(int, const void*, size_t, int) {
+    return -1;
+}
+
+int64_t FileDescriptor::Receive(int, void*, size_t, FileDescriptor&) {
+    return -1;
+}
+
+bool FileDescriptor::CopyRange(int, int, uint64_t, uint64_t) {
+    return false;
+}
+
+uint64_t FileDescriptor::GetSize() const {
+    return 0;
+}
+
+bool FileDescriptor::Resize(uint64_t) const {
+    return false;
+}
+
+void FileDescriptor::Close() {
+    m_descriptor = -1;
+}
+
+#endif
@@ -0,0 +1,133 @@
+#include <MemoryMappedFile.h>
+#include <tracy/Tracy.hpp>
+
+#if MEMORY_MAPPED_FILE_SUPPORTED
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MemoryMappedFile::~MemoryMappedFile() {
+    Close();
+}
+
+bool MemoryMappedFile::IsSupported() {
+    return MEMORY_MAPPED_FILE_SUPPORTED;
+}
+
+#if MEMORY_MAPPED_FILE_SUPPORTED
+
+bool MemoryMappedFile::Open(const std::filesystem::path& path, const uint64_t size, const bool truncate) {
+    ZoneScoped;
+    Close();
+
+    m_descriptor = ::open(path.c_str(), O_RDWR | O_CREAT | (truncate ? O_TRUNC : 0), 0644);
+    if (m_descriptor < 0) {
+        return false;
+    }
+
+    struct stat status{};
+    if (::fstat(m_descriptor, &status) != 0) {
+        Close();
+        return false;
+    }
+
+    if (static_cast<uint64_t>(status.st_size) < size && ::ftruncate(m_descriptor, static_cast<off_t>(size)) != 0) {
+        Close();
+        return false;
+    }
+
+    m_size = size;
+    return true;
+}
+
+// Extending the file only sets its length; every range written through a mapping has to be reserved here first
+bool MemoryMappedFile::Allocate(const uint64_t offset, const uint64_t size) {
+    ZoneScoped;
+    if (m_descriptor < 0 || offset + size > m_size) {
+        return false;
+    }
+
+    return size == 0 || ::posix_fallocate(m_descriptor, static_cast<off_t>(offset), static_cast<off_t>(size)) == 0;
+}
+
+char* MemoryMappedFile::Map(const uint64_t offset, const uint64_t size) {
+    ZoneScoped;
+    if (m_descriptor < 0 || offset + size > m_size || size == 0) {
+        return nullptr;
+    }
+
+    Unmap();
+
+    static const auto pageSize = static_cast<uint64_t>(::sysconf(_SC_PAGESIZE));
+    const uint64_t alignedOffset = offset / pageSize * pageSize;
+    const uint64_t windowSize = offset - alignedOffset + size;
+
+    void* window = ::mmap(nullptr, windowSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_descriptor, static_cast<off_t>(alignedOffset));
+    if (window == MAP_FAILED) {
+        return nullptr;
+    }
+
+    ::madvise(window, windowSize, MADV_SEQUENTIAL);
+
+    m_window = static_cast<char*>(window);
+    m_windowOffset = alignedOffset;
+    m_windowSize = windowSize;
+
+    return m_window + (offset - alignedOffset);
+}
+
+void MemoryMappedFile::Flush() {
+    ZoneScoped;
+    if (m_window != nullptr) {
+        ::msync(m_window, m_windowSize, MS_ASYNC);
+    }
+}
+
+void MemoryMappedFile::Close() {
+    ZoneScoped;
+    Unmap();
+
+    if (m_descriptor >= 0) {
+        ::close(m_descriptor);
+        m_descriptor = -1;
+    }
+
+    m_size = 0;
+}
+
+void MemoryMappedFile::Unmap() {
+    if (m_window == nullptr) {
+        return;
+    }
+
+    ::msync(m_window, m_windowSize, MS_ASYNC);
+    ::munmap(m_window, m_windowSize);
+
+    m_window = nullptr;
+    m_windowOffset = 0;
+    m_windowSize = 0;
+}
+
+#else
+
+bool MemoryMappedFile::Open(const std::filesystem::path&, uint64_t, bool) {
+    return false;
+}
+
+bool MemoryMappedFile::Allocate(uint64_t, uint64_t) {
+    return false;
+}
+
+char* MemoryMappedFile::Map(uint64_t, uint64_t) {
+    return nullptr;
+}
+
+void MemoryMappedFile::Flush() { }
+
+void MemoryMappedFile::Close() { }
+
+void MemoryMappedFile::Unmap() { }
+
+#endif
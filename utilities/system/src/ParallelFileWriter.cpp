@@ -0,0 +1,149 @@
+#include <ParallelFileWriter.h>
+#include <tracy/Tracy.hpp>
+
+#include <algorithm>
+#include <fstream>
+
+static constexpr size_t MAX_WRITER_THREADS = 8;
+
+ParallelFileWriter::ParallelFileWriter(const size_t threadCount, const size_t maxPendingBytes) : m_maxPendingBytes(maxPendingBytes) {
+    ZoneScoped;
+    const size_t workerCount = std::clamp<size_t>(threadCount, 1, MAX_WRITER_THREADS);
+
+    for (size_t i = 0; i < workerCount; ++i) {
+        m_workers.emplace_back([this]() {
+            Run();
+        });
+    }
+}
+
+ParallelFileWriter::~ParallelFileWriter() {
+    ZoneScoped;
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopping = true;
+    }
+
+    m_jobCondition.notify_all();
+
+    for (auto& worker : m_workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+void ParallelFileWriter::Write(std::filesystem::path path, std::vector<char>&& data) {
+    ZoneScoped;
+    {
+        std::lock_guard lock(m_mutex);
+        m_pendingBytes += data.size();
+        m_jobs.push_back({std::move(path), std::move(data)});
+    }
+
+    m_jobCondition.notify_one();
+}
+
+bool ParallelFileWriter::Wait() {
+    ZoneScoped;
+    std::unique_lock lock(m_mutex);
+    m_idleCondition.wait(lock, [this]() {
+        return IsIdle();
+    });
+
+    return !m_failed;
+}
+
+// Drops the queued files and waits for the ones already being written, so the caller can remove what was written
+void ParallelFileWriter::Cancel() {
+    ZoneScoped;
+    std::unique_lock lock(m_mutex);
+    for (const Job& job : m_jobs) {
+        m_pendingBytes -= job.data.size();
+    }
+
+    m_jobs.clear();
+    m_waiters.clear();
+
+    m_idleCondition.wait(lock, [this]() {
+        return m_activeJobs == 0;
+    });
+}
+
+asio::awaitable<void> ParallelFileWriter::CoWaitForSpace() {
+    co_await CoWaitUntil(false);
+}
+
+asio::awaitable<bool> ParallelFileWriter::CoWait() {
+    co_await CoWaitUntil(true);
+
+    std::lock_guard lock(m_mutex);
+    co_return !m_failed;
+}
+
+asio::awaitable<void> ParallelFileWriter::CoWaitUntil(const bool idle) {
+    const asio::any_io_executor executor = co_await asio::this_coro::executor;
+    AwaitableFlag progress(executor);
+
+    while (true) {
+        progress.Reset();
+        {
+            std::lock_guard lock(m_mutex);
+            if (idle ? IsIdle() : m_pendingBytes < m_maxPendingBytes) {
+                co_return;
+            }
+
+            m_waiters.push_back({executor, &progress});
+        }
+
+        co_await progress.Wait();
+    }
+}
+
+void ParallelFileWriter::Run() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock lock(m_mutex);
+            m_jobCondition.wait(lock, [this]() {
+                return !m_jobs.empty() || m_stopping;
+            });
+
+            if (m_jobs.empty()) {
+                return;
+            }
+
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+            ++m_activeJobs;
+        }
+
+        bool written;
+        {
+            ZoneScopedN("ParallelFileWriter::Write");
+            std::ofstream file(job.path, std::ios::binary | std::ios::trunc);
+            file.write(job.data.data(), static_cast<std::streamsize>(job.data.size()));
+            written = file.good();
+        }
+
+        {
+            std::lock_guard lock(m_mutex);
+            m_pendingBytes -= job.data.size();
+            --m_activeJobs;
+            m_failed |= !written;
+            NotifyWaiters();
+        }
+
+        m_idleCondition.notify_all();
+    }
+}
+
+void ParallelFileWriter::NotifyWaiters() {
+    for (const Waiter& waiter : m_waiters) {
+        asio::post(waiter.executor, [flag = waiter.flag]() {
+            flag->Signal();
+        });
+    }
+
+    m_waiters.clear();
+}
@@ -0,0 +1,275 @@
+#include <PipelinedHasher.h>
+#include <tracy/Tracy.hpp>
+#include <openssl/evp.h>
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+class PipelinedHasher::WorkerPool {
+public:
+    static WorkerPool& Get() {
+        static WorkerPool pool;
+        return pool;
+    }
+
+    void Schedule(PipelinedHasher* hasher) {
+        {
+            std::lock_guard lock(m_mutex);
+            m_queue.push_back(hasher);
+        }
+
+        m_condition.notify_one();
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard lock(m_mutex);
+            m_stopping = true;
+        }
+
+        m_condition.notify_all();
+
+        for (std::thread& worker : m_workers) {
+            worker.join();
+        }
+    }
+
+private:
+    WorkerPool() {
+        const size_t workerCount = std::clamp<size_t>(std::thread::hardware_concurrency() / 2, 1, HASH_MAX_WORKERS);
+
+        for (size_t i = 0; i < workerCount; i++) {
+            m_workers.emplace_back([this]() {
+                Run();
+            });
+        }
+    }
+
+    void Run() {
+        while (true) {
+            PipelinedHasher* hasher;
+            {
+                std::unique_lock lock(m_mutex);
+                m_condition.wait(lock, [this]() {
+                    return !m_queue.empty() || m_stopping;
+                });
+
+                if (m_queue.empty()) {
+                    return;
+                }
+
+                hasher = m_queue.front();
+                m_queue.pop_front();
+            }
+
+            if (hasher->ProcessNext()) {
+                Schedule(hasher);
+            }
+        }
+    }
+
+    std::mutex                   m_mutex;
+    std::condition_variable      m_condition;
+    std::deque<PipelinedHasher*> m_queue;
+    std::vector<std::thread>     m_workers;
+    bool                         m_stopping{false};
+};
+
+PipelinedHasher::PipelinedHasher() {
+    ZoneScoped;
+    m_context = EVP_MD_CTX_new();
+    EVP_DigestInit_ex(m_context, EVP_sha256(), nullptr);
+}
+
+PipelinedHasher::~PipelinedHasher() {
+    ZoneScoped;
+    Cancel();
+    EVP_MD_CTX_free(m_context);
+}
+
+std::vector<char> PipelinedHasher::AcquireBuffer(const size_t size) {
+    ZoneScoped;
+    std::vector<char> buffer;
+    {
+        std::lock_guard lock(m_mutex);
+        if (!m_freeBuffers.empty()) {
+            buffer = std::move(m_freeBuffers.back());
+            m_freeBuffers.pop_back();
+        }
+    }
+
+    buffer.resize(size);
+    return buffer;
+}
+
+void PipelinedHasher::Submit(std::vector<char>&& buffer, const size_t size) {
+    ZoneScoped;
+    const char* data = buffer.data();
+    Enqueue({std::move(buffer), nullptr, data, size});
+}
+
+void PipelinedHasher::Update(const char* data, const size_t size) {
+    ZoneScoped;
+    if (size == 0) {
+        return;
+    }
+
+    std::vector<char> buffer = AcquireBuffer(size);
+    std::memcpy(buffer.data(), data, size);
+    Submit(std::move(buffer), size);
+}
+
+void PipelinedHasher::SubmitView(const char* data, const size_t size) {
+    ZoneScoped;
+    Enqueue({{}, nullptr, data, size});
+}
+
+void PipelinedHasher::SubmitShared(std::shared_ptr<const std::vector<char>> buffer) {
+    ZoneScoped;
+    const char* data = buffer->data();
+    const size_t size = buffer->size();
+    Enqueue({{}, std::move(buffer), data, size});
+}
+
+void PipelinedHasher::Wait() {
+    ZoneScoped;
+    std::unique_lock lock(m_mutex);
+    m_idleCondition.wait(lock, [this]() {
+        return IsIdle();
+    });
+}
+
+// Drops the queued chunks and waits only for the one a worker may be digesting, so callers can release the memory
+// behind submitted views without hashing the rest
+void PipelinedHasher::Cancel() {
+    ZoneScoped;
+    std::unique_lock lock(m_mutex);
+    m_pending.clear();
+    m_pendingBytes = 0;
+    m_waiters.clear();
+
+    m_idleCondition.wait(lock, [this]() {
+        return !m_scheduled;
+    });
+}
+
+HashDigest PipelinedHasher::Finish() {
+    ZoneScoped;
+    Wait();
+
+    HashDigest digest{};
+    unsigned int digestSize = 0;
+    EVP_DigestFinal_ex(m_context, digest.data(), &digestSize);
+
+    return digest;
+}
+
+asio::awaitable<void> PipelinedHasher::CoWaitForSpace(const size_t size) {
+    co_await CoWaitUntil(false, size);
+}
+
+asio::awaitable<void> PipelinedHasher::CoWait() {
+    co_await CoWaitUntil(true, 0);
+}
+
+asio::awaitable<HashDigest> PipelinedHasher::CoFinish() {
+    co_await CoWait();
+    co_return Finish();
+}
+
+asio::awaitable<void> PipelinedHasher::CoWaitUntil(const bool idle, const size_t size) {
+    const asio::any_io_executor executor = co_await asio::this_coro::executor;
+    AwaitableFlag progress(executor);
+
+    while (true) {
+        progress.Reset();
+        {
+            std::lock_guard lock(m_mutex);
+            if (idle ? IsIdle() : HasSpace(size)) {
+                co_return;
+            }
+
+            m_waiters.push_back({executor, &progress});
+        }
+
+        co_await progress.Wait();
+    }
+}
+
+void PipelinedHasher::Enqueue(Chunk&& chunk) {
+    bool schedule;
+    {
+        std::unique_lock lock(m_mutex);
+        m_spaceCondition.wait(lock, [this, &chunk]() {
+            return HasSpace(chunk.size);
+        });
+
+        m_pendingBytes += chunk.size;
+        m_pending.push_back(std::move(chunk));
+
+        schedule = !m_scheduled;
+        m_scheduled = true;
+    }
+
+    if (schedule) {
+        WorkerPool::Get().Schedule(this);
+    }
+}
+
+bool PipelinedHasher::ProcessNext() {
+    Chunk chunk;
+    {
+        std::lock_guard lock(m_mutex);
+        if (m_pending.empty()) {
+            m_scheduled = false;
+            m_idleCondition.notify_all();
+            NotifyWaiters();
+            return false;
+        }
+
+        chunk = std::move(m_pending.front());
+        m_pending.pop_front();
+    }
+
+    {
+        ZoneScopedN("PipelinedHasher::Digest");
+        EVP_DigestUpdate(m_context, chunk.data, chunk.size);
+    }
+
+    // Notifications are issued under the lock: once m_scheduled drops, the destructor may run.
+    std::lock_guard lock(m_mutex);
+    m_pendingBytes -= std::min(m_pendingBytes, chunk.size);
+    m_spaceCondition.notify_all();
+
+    if (chunk.buffer.capacity() > 0 && m_freeBuffers.size() < MAX_FREE_BUFFERS) {
+        m_freeBuffers.push_back(std::move(chunk.buffer));
+    }
+
+    if (m_pending.empty()) {
+        m_scheduled = false;
+        m_idleCondition.notify_all();
+    }
+
+    NotifyWaiters();
+    return !m_pending.empty();
+}
+
+void PipelinedHasher::NotifyWaiters() {
+    // Flags belong to the awaiting coroutines, so they are signalled on their own executors
+    for (const Waiter& waiter : m_waiters) {
+        asio::post(waiter.executor, [flag = waiter.flag]() {
+            flag->Signal();
+        });
+    }
+
+    m_waiters.clear();
+}
+
+bool PipelinedHasher::HasSpace(const size_t size) const {
+    return m_pendingBytes == 0 || m_pendingBytes + size <= HASH_MAX_PENDING_BYTES;
+}
+
+bool PipelinedHasher::IsIdle() const {
+    return m_pending.empty() && !m_scheduled;
+}
@@ -0,0 +1,112 @@
+#include <SharedMemoryRegion.h>
+#include <tracy/Tracy.hpp>
+
+#if SHARED_MEMORY_SUPPORTED
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+SharedMemoryRegion::~SharedMemoryRegion() {
+    Close();
+}
+
+bool SharedMemoryRegion::IsSupported() {
+    return SHARED_MEMORY_SUPPORTED;
+}
+
+#if SHARED_MEMORY_SUPPORTED
+
+bool SharedMemoryRegion::Create(const std::string& name, const size_t size) {
+    ZoneScoped;
+    Close();
+
+    const int descriptor = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (descriptor < 0) {
+        return false;
+    }
+
+    m_name = name;
+    m_owner = true;
+
+    if (::ftruncate(descriptor, static_cast<off_t>(size)) != 0 || !Map(descriptor, size)) {
+        ::close(descriptor);
+        Close();
+        return false;
+    }
+
+    ::close(descriptor);
+    return true;
+}
+
+bool SharedMemoryRegion::Open(const std::string& name, const size_t size) {
+    ZoneScoped;
+    Close();
+
+    const int descriptor = ::shm_open(name.c_str(), O_RDWR, 0600);
+    if (descriptor < 0) {
+        return false;
+    }
+
+    struct stat status{};
+    if (::fstat(descriptor, &status) != 0 || static_cast<size_t>(status.st_size) != size || !Map(descriptor, size)) {
+        ::close(descriptor);
+        return false;
+    }
+
+    ::close(descriptor);
+    m_name = name;
+    return true;
+}
+
+void SharedMemoryRegion::Unlink() {
+    if (m_owner && !m_name.empty()) {
+        ::shm_unlink(m_name.c_str());
+        m_owner = false;
+    }
+}
+
+void SharedMemoryRegion::Close() {
+    ZoneScoped;
+    Unlink();
+
+    if (m_data != nullptr) {
+        ::munmap(m_data, m_size);
+        m_data = nullptr;
+    }
+
+    m_size = 0;
+    m_name.clear();
+}
+
+bool SharedMemoryRegion::Map(const int descriptor, const size_t size) {
+    void* data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+
+    m_data = static_cast<char*>(data);
+    m_size = size;
+    return true;
+}
+
+#else
+
+bool SharedMemoryRegion::Create(const std::string&, size_t) {
+    return false;
+}
+
+bool SharedMemoryRegion::Open(const std::string&, size_t) {
+    return false;
+}
+
+void SharedMemoryRegion::Unlink() { }
+
+void SharedMemoryRegion::Close() { }
+
+bool SharedMemoryRegion::Map(int, size_t) {
+    return false;
+}
+
+#endif
@@ -0,0 +1,88 @@
+#include <SharedMemoryRing.h>
+#include <SharedMemoryRegion.h>
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+#if SHARED_MEMORY_SUPPORTED
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+size_t SharedMemoryRing::Write(const void* source, const size_t size) {
+    const uint64_t head = m_control->head.load(std::memory_order_relaxed);
+    const uint64_t tail = m_control->tail.load(std::memory_order_acquire);
+
+    if (head - tail > m_capacity) {
+        return 0;
+    }
+
+    const size_t writable = std::min(size, m_capacity - static_cast<size_t>(head - tail));
+
+    if (writable == 0) {
+        return 0;
+    }
+
+    const size_t offset = static_cast<size_t>(head % m_capacity);
+    const size_t first = std::min(writable, m_capacity - offset);
+
+    std::memcpy(m_data + offset, source, first);
+    std::memcpy(m_data, static_cast<const char*>(source) + first, writable - first);
+
+    m_control->head.store(head + writable, std::memory_order_release);
+    return writable;
+}
+
+size_t SharedMemoryRing::Read(void* destination, const size_t size) {
+    const uint64_t tail = m_control->tail.load(std::memory_order_relaxed);
+    const uint64_t head = m_control->head.load(std::memory_order_acquire);
+
+    if (head - tail > m_capacity) {
+        return 0;
+    }
+
+    const size_t readable = std::min(size, static_cast<size_t>(head - tail));
+
+    if (readable == 0) {
+        return 0;
+    }
+
+    const size_t offset = static_cast<size_t>(tail % m_capacity);
+    const size_t first = std::min(readable, m_capacity - offset);
+
+    std::memcpy(destination, m_data + offset, first);
+    std::memcpy(static_cast<char*>(destination) + first, m_data, readable - first);
+
+    m_control->tail.store(tail + readable, std::memory_order_release);
+    return readable;
+}
+
+void SharedMemoryDoorbell::Ring(SharedMemoryDoorbellState& state) {
+    state.sequence.fetch_add(1, std::memory_order_seq_cst);
+
+    if (state.sleeping.load(std::memory_order_seq_cst) == 0) {
+        return;
+    }
+
+#if SHARED_MEMORY_SUPPORTED
+    ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&state.sequence), FUTEX_WAKE, 1, nullptr, nullptr, 0);
+#endif
+}
+
+void SharedMemoryDoorbell::Wait(SharedMemoryDoorbellState& state, const uint32_t sequence) {
+#if SHARED_MEMORY_SUPPORTED
+    state.sleeping.store(1, std::memory_order_seq_cst);
+
+    if (state.sequence.load(std::memory_order_seq_cst) == sequence) {
+        ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&state.sequence), FUTEX_WAIT, sequence, nullptr, nullptr, 0);
+    }
+
+    state.sleeping.store(0, std::memory_order_seq_cst);
+#else
+    static_cast<void>(state);
+    static_cast<void>(sequence);
+    std::this_thread::yield();
+#endif
+}
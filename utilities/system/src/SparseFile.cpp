@@ -0,0 +1,173 @@
+#include <SparseFile.h>
+#include <tracy/Tracy.hpp>
+
+#include <algorithm>
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+#if (defined(__unix__) || defined(__APPLE__)) && defined(SEEK_DATA) && defined(SEEK_HOLE)
+#define SPARSE_FILE_SUPPORTED 1
+#else
+#define SPARSE_FILE_SUPPORTED 0
+#endif
+
+static bool ZeroFill(const std::filesystem::path& path, const uint64_t fileSize, const std::vector<FileExtent>& holes) {
+    ZoneScoped;
+    std::error_code errorCode;
+    if (std::filesystem::file_size(path, errorCode) < fileSize && !errorCode) {
+        std::filesystem::resize_file(path, fileSize, errorCode);
+    }
+
+    if (errorCode) {
+        return false;
+    }
+
+    std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    const std::vector<char> zeros(SPARSE_FILE_ZERO_BLOCK_SIZE, 0);
+    for (const FileExtent& hole : holes) {
+        file.seekp(static_cast<std::streamoff>(hole.offset));
+
+        for (uint64_t written = 0; written < hole.size;) {
+            const uint64_t size = std::min<uint64_t>(hole.size - written, zeros.size());
+            file.write(zeros.data(), static_cast<std::streamsize>(size));
+            written += size;
+        }
+    }
+
+    return file.good();
+}
+
+bool SparseFile::IsSupported() {
+    return SPARSE_FILE_SUPPORTED;
+}
+
+std::vector<FileExtent> SparseFile::GetHoles(const uint64_t offset, const uint64_t size, const std::vector<FileExtent>& dataExtents) {
+    std::vector<FileExtent> holes;
+    uint64_t position = offset;
+
+    for (const FileExtent& extent : dataExtents) {
+        if (extent.offset > position) {
+            holes.push_back({position, extent.offset - position});
+        }
+
+        position = extent.offset + extent.size;
+    }
+
+    if (offset + size > position) {
+        holes.push_back({position, offset + size - position});
+    }
+
+    return holes;
+}
+
+bool SparseFile::IsValidExtentList(const uint64_t offset, const uint64_t size, const std::vector<FileExtent>& extents) {
+    uint64_t position = offset;
+
+    for (const FileExtent& extent : extents) {
+        if (extent.size == 0 || extent.offset < position || extent.offset > offset + size || extent.size > offset + size - extent.offset) {
+            return false;
+        }
+
+        position = extent.offset + extent.size;
+    }
+
+    return true;
+}
+
+#if SPARSE_FILE_SUPPORTED
+
+std::vector<FileExtent> SparseFile::GetDataExtents(const std::filesystem::path& path, const uint64_t offset, const uint64_t size) {
+    ZoneScoped;
+    const std::vector<FileExtent> dense = size != 0 ? std::vector<FileExtent>{{offset, size}} : std::vector<FileExtent>{};
+
+    const int descriptor = ::open(path.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+        return dense;
+    }
+
+    std::vector<FileExtent> extents;
+    const auto end = static_cast<off_t>(offset + size);
+    auto position = static_cast<off_t>(offset);
+
+    while (position < end) {
+        const off_t dataStart = ::lseek(descriptor, position, SEEK_DATA);
+        if (dataStart < 0) {
+            if (errno != ENXIO) {
+                extents = dense;
+            }
+
+            break;
+        }
+
+        if (dataStart >= end) {
+            break;
+        }
+
+        off_t holeStart = ::lseek(descriptor, dataStart, SEEK_HOLE);
+        if (holeStart < 0 || holeStart > end) {
+            holeStart = end;
+        }
+
+        extents.push_back({static_cast<uint64_t>(dataStart), static_cast<uint64_t>(holeStart - dataStart)});
+        position = holeStart;
+
+        if (extents.size() > SPARSE_FILE_MAX_EXTENTS) {
+            extents = dense;
+            break;
+        }
+    }
+
+    ::close(descriptor);
+    return extents;
+}
+
+bool SparseFile::CreateHoles(const std::filesystem::path& path, const uint64_t fileSize, const std::vector<FileExtent>& holes) {
+    ZoneScoped;
+    const int descriptor = ::open(path.c_str(), O_WRONLY);
+    if (descriptor < 0) {
+        return false;
+    }
+
+    struct stat status{};
+    bool created = ::fstat(descriptor, &status) == 0;
+
+    if (created && static_cast<uint64_t>(status.st_size) < fileSize) {
+        created = ::ftruncate(descriptor, static_cast<off_t>(fileSize)) == 0;
+    }
+
+    std::vector<FileExtent> unpunched;
+    for (const FileExtent& hole : holes) {
+        bool punched = false;
+#if defined(__linux__) && defined(FALLOC_FL_PUNCH_HOLE)
+        punched = ::fallocate(descriptor, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, static_cast<off_t>(hole.offset), static_cast<off_t>(hole.size)) == 0;
+#endif
+        if (!punched) {
+            unpunched.push_back(hole);
+        }
+    }
+
+    ::close(descriptor);
+    return created && (unpunched.empty() || ZeroFill(path, fileSize, unpunched));
+}
+
+#else
+
+std::vector<FileExtent> SparseFile::GetDataExtents(const std::filesystem::path&, const uint64_t offset, const uint64_t size) {
+    return size != 0 ? std::vector<FileExtent>{{offset, size}} : std::vector<FileExtent>{};
+}
+
+bool SparseFile::CreateHoles(const std::filesystem::path& path, const uint64_t fileSize, const std::vector<FileExtent>& holes) {
+    return ZeroFill(path, fileSize, holes);
+}
+
+#endif